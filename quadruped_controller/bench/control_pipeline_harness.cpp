@@ -0,0 +1,527 @@
+/**
+ * @file control_pipeline_harness.cpp
+ * @author agent
+ * @date 2026-10-17
+ * @brief ROS-free closed-loop harness for the control pipeline
+ *
+ * @details Drives the ControlPipeline with synthetic robot state for many ticks
+ * and reports ticks/sec, per stage cost, and heap allocations. Does not require
+ * roscore, so the hot path can be profiled directly with perf:
+ *
+ *    perf record -g control_pipeline_harness --ticks 1000000 --gait trot
+ *
+ * @ARGUMENTS:
+ *    --ticks N - number of control ticks (default: 1000000)
+ *    --gait stance|trot - gait to run, stance poses the body (default: trot)
+ *    --frequency HZ - simulated control frequency (default: 1000)
+ *    --mpc - GRFs from the nonlinear MPC instead of the balance QP
+ *    --lqr - GRFs from the LQR instead of the balance QP while standing
+ *    --torque-limits - balance QP keeps the stance leg torques within the limits
+ *    --explicit PATH - explicit balance QP solutions from explicit_qp_generator
+ *    --qp-backend qpoases|admm - balance QP solver (default: qpoases)
+ *    --solve-rate - update the last balance QP solution instead of solving similar
+ *                   problems
+ *    --max-updates N - ticks between balance QP solves with --solve-rate (default: 20)
+ *    --leg-executor serial|parallel|batched - per leg work of a tick (default: serial)
+ *    --leg-threads N - pool threads of the parallel leg executor (default: 3)
+ *    --task-graph - run the stages as a task graph and chart the mean timeline of
+ *                   the tasks and the parallelism achieved
+ *    --graph-threads N - task graph threads besides the tick thread (default: 1)
+ */
+
+// C++
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/control_pipeline.hpp>
+#include <quadruped_controller/explicit_balance_qp.hpp>
+#include <quadruped_controller/math/numerics.hpp>
+#include <quadruped_controller/math/rigid3d.hpp>
+
+using arma::eye;
+using arma::mat;
+using arma::vec;
+using arma::vec3;
+
+using namespace quadruped_controller;
+
+/////////////////////////////////////////////////////////
+// Allocation counting
+static std::atomic<uint64_t> allocation_count{ 0 };
+
+void* operator new(std::size_t size)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+  return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+static uint64_t allocations()
+{
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////
+// Synthetic robot state
+namespace
+{
+/** @brief Pipeline configuration from mit_cheetah_config.yaml */
+ControlPipelineConfig make_config()
+{
+  ControlPipelineConfig config;
+  config.t_stance = 0.8;
+  config.t_swing = 0.18;
+  config.height = 0.08;
+  config.mu = 0.8;
+  config.mass = 11.0;
+  config.fzmin = 10.0;
+  config.fzmax = 120.0;
+  config.Ib = arma::diagmat(vec({ 0.011253, 0.036203, 0.042673 }));
+  config.S = arma::diagmat(vec({ 1.0, 1.0, 1.0, 10.0, 10.0, 5.0 }));
+  config.W = eye(12, 12) * 1e-5;
+  config.kff = { 0.0, 0.0, 0.15, 0.0, 0.0, 0.0 };
+  config.kp_p = { 100.0, 100.0, 100.0 };
+  config.kd_p = { 50.0, 50.0, 50.0 };
+  config.kp_w = { 5000.0, 5000.0, 5000.0 };
+  config.kd_w = { 500.0, 500.0, 500.0 };
+  config.jc_kff = { 0.0, 0.0, 0.0 };
+  config.jc_kp = { 40.0, 40.0, 50.0 };
+  config.jc_kd = { 1.0, 1.0, 1.0 };
+  config.tau_min = -20.0;
+  config.tau_max = 20.0;
+
+  return config;
+}
+
+/** @brief Standing robot swaying around the nominal standing pose */
+RobotStateCoM synthetic_com_state(double t, double vx)
+{
+  const auto s = std::sin(2.0 * math::PI * 1.5 * t);
+  const auto c = std::cos(2.0 * math::PI * 1.5 * t);
+
+  RobotStateCoM com_state;
+  com_state.x = { vx * t, 0.004 * s, 0.26 + 0.003 * c };
+  com_state.xdot = { vx, 0.04 * c, -0.03 * s };
+  com_state.w = { 0.05 * c, 0.03 * s, 0.0 };
+  com_state.Rwb = math::Rotation3d(0.01 * s, 0.008 * c, 0.0).matrix();
+
+  return com_state;
+}
+
+/** @brief Joint states near the standing configuration */
+void synthetic_joint_states(double t, JointStatesMap& joint_states_map)
+{
+  const auto s = std::sin(2.0 * math::PI * 1.5 * t);
+  const auto c = std::cos(2.0 * math::PI * 1.5 * t);
+
+  for (auto& [leg_name, joint_states] : joint_states_map)
+  {
+    const auto hip = (leg_name == "RL" || leg_name == "FL") ? 0.056 : -0.056;
+    joint_states.q = { hip + 0.01 * s, 0.90 + 0.05 * c, -1.94 - 0.05 * s };
+    joint_states.qdot = { 0.09 * c, -0.47 * s, -0.47 * c };
+  }
+}
+
+/** @brief Task graph timelines summed over the ticks */
+struct TaskProfile
+{
+  std::vector<double> start;      // task start after the first task (s)
+  std::vector<double> end;        // task end after the first task (s)
+  std::vector<uint64_t> threads;  // runs per task and thread, task major
+  double makespan = 0.0;          // first task start to last task end (s)
+  double busy = 0.0;              // task durations (s)
+  uint64_t runs = 0;              // graph runs
+};
+
+/** @brief Empty profile of a task graph, allocated before the ticks are counted */
+TaskProfile make_task_profile(const realtime::TaskGraph& graph)
+{
+  TaskProfile profile;
+  profile.start.assign(graph.size(), 0.0);
+  profile.end.assign(graph.size(), 0.0);
+  profile.threads.assign(graph.size() * graph.threads(), 0);
+
+  return profile;
+}
+
+/** @brief Add the last run of the task graph to the profile */
+void add_task_profile(const realtime::TaskGraph& graph, TaskProfile& profile)
+{
+  const std::vector<realtime::TaskRecord>& timeline = graph.timeline();
+  int64_t first = timeline.front().start_ns;
+  int64_t last = timeline.front().end_ns;
+  for (const auto& record : timeline)
+  {
+    first = std::min(first, record.start_ns);
+    last = std::max(last, record.end_ns);
+  }
+
+  for (unsigned int i = 0; i < graph.size(); i++)
+  {
+    const realtime::TaskRecord& record = timeline[i];
+    profile.start[i] += 1.0e-9 * static_cast<double>(record.start_ns - first);
+    profile.end[i] += 1.0e-9 * static_cast<double>(record.end_ns - first);
+    profile.threads[i * graph.threads() + record.thread]++;
+    profile.busy += 1.0e-9 * static_cast<double>(record.end_ns - record.start_ns);
+  }
+
+  profile.makespan += 1.0e-9 * static_cast<double>(last - first);
+  profile.runs++;
+}
+
+/**
+ * @brief Chart the mean task timeline
+ * @details Each row spans the mean start to the mean end of a task scaled to the
+ * mean duration of the graph, # marks the critical path. The parallelism is the
+ * task time over the graph duration, 1 if the tasks never overlap.
+ */
+void print_task_profile(const realtime::TaskGraph& graph, const TaskProfile& profile)
+{
+  constexpr unsigned int width = 50;
+  const auto runs = static_cast<double>(profile.runs);
+  const double makespan = profile.makespan / runs;
+
+  std::printf("\ntask graph: %u threads, mean makespan: %.3f us, parallelism: %.2f\n",
+              graph.threads(), 1.0e6 * makespan, profile.busy / profile.makespan);
+  std::printf("%-20s %-*s %10s %10s  %s\n", "task", width + 2, "timeline", "start (us)",
+              "end (us)", "runs per thread");
+  for (unsigned int i = 0; i < graph.size(); i++)
+  {
+    const double start = profile.start[i] / runs;
+    const double end = profile.end[i] / runs;
+    const auto first = static_cast<unsigned int>(width * start / makespan);
+    const auto last = static_cast<unsigned int>(width * end / makespan);
+
+    char bar[width + 1];
+    for (unsigned int j = 0; j < width; j++)
+    {
+      bar[j] = j >= first && j <= last ? (graph.critical(i) ? '#' : '=') : '.';
+    }
+    bar[width] = '\0';
+
+    std::printf("%-20s |%s| %10.3f %10.3f ", graph.name(i), bar, 1.0e6 * start,
+                1.0e6 * end);
+    for (unsigned int j = 0; j < graph.threads(); j++)
+    {
+      const auto thread_runs = profile.threads[i * graph.threads() + j];
+      std::printf(" %5.1f%%", 100.0 * static_cast<double>(thread_runs) / runs);
+    }
+    std::printf("\n");
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  uint64_t num_ticks = 1000000;
+  std::string gait = "trot";
+  double frequency = 1000.0;
+  bool use_mpc = false;
+  bool use_lqr = false;
+  bool torque_limits = false;
+  std::string explicit_path;
+  std::string qp_backend = "qpoases";
+  bool solve_rate = false;
+  unsigned int max_updates = SolveRateSettings().max_updates;
+  std::string leg_executor = "serial";
+  unsigned int leg_threads = LegExecutorConfig().threads;
+  bool task_graph = false;
+  unsigned int graph_threads = ControlPipelineConfig().task_graph_threads;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--ticks" && i + 1 < argc)
+    {
+      num_ticks = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--gait" && i + 1 < argc)
+    {
+      gait = argv[++i];
+    }
+    else if (arg == "--frequency" && i + 1 < argc)
+    {
+      frequency = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--mpc")
+    {
+      use_mpc = true;
+    }
+    else if (arg == "--lqr")
+    {
+      use_lqr = true;
+    }
+    else if (arg == "--torque-limits")
+    {
+      torque_limits = true;
+    }
+    else if (arg == "--explicit" && i + 1 < argc)
+    {
+      explicit_path = argv[++i];
+    }
+    else if (arg == "--qp-backend" && i + 1 < argc)
+    {
+      qp_backend = argv[++i];
+    }
+    else if (arg == "--solve-rate")
+    {
+      solve_rate = true;
+    }
+    else if (arg == "--max-updates" && i + 1 < argc)
+    {
+      max_updates = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--leg-executor" && i + 1 < argc)
+    {
+      leg_executor = argv[++i];
+    }
+    else if (arg == "--leg-threads" && i + 1 < argc)
+    {
+      leg_threads = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--task-graph")
+    {
+      task_graph = true;
+    }
+    else if (arg == "--graph-threads" && i + 1 < argc)
+    {
+      graph_threads = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--ticks N] [--gait stance|trot] [--frequency HZ] "
+                   "[--mpc] [--lqr] [--torque-limits] [--explicit PATH] "
+                   "[--qp-backend qpoases|admm] [--solve-rate] [--max-updates N] "
+                   "[--leg-executor serial|parallel|batched] [--leg-threads N] "
+                   "[--task-graph] [--graph-threads N]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  if (gait != "stance" && gait != "trot")
+  {
+    std::fprintf(stderr, "Unknown gait: %s\n", gait.c_str());
+    return 1;
+  }
+
+  ControlPipelineConfig config = make_config();
+  if (!qp_backend_from_name(qp_backend, config.qp_backend))
+  {
+    std::fprintf(stderr, "Unknown QP backend: %s\n", qp_backend.c_str());
+    return 1;
+  }
+
+  if (!leg_executor_from_name(leg_executor, config.leg_executor.type))
+  {
+    std::fprintf(stderr, "Unknown leg executor: %s\n", leg_executor.c_str());
+    return 1;
+  }
+  config.leg_executor.threads = leg_threads;
+  config.use_task_graph = task_graph;
+  config.task_graph_threads = graph_threads;
+
+  config.use_nonlinear_mpc = use_mpc;
+  config.nonlinear_mpc.period = 1.0 / frequency;
+  config.use_lqr_stance = use_lqr;
+  config.lqr_stance.dt = 1.0 / frequency;
+  config.torque_limited_qp = torque_limits;
+  config.solve_rate.enabled = solve_rate;
+  config.solve_rate.max_updates = max_updates;
+  if (!explicit_path.empty())
+  {
+    auto explicit_qp = std::make_shared<ExplicitBalanceQP>(
+        config.mu, config.fzmin, config.fzmax, config.S, config.W);
+    if (!explicit_qp->load(explicit_path))
+    {
+      std::fprintf(stderr, "Failed to load %s\n", explicit_path.c_str());
+      return 1;
+    }
+
+    config.explicit_qp = explicit_qp;
+  }
+
+  const vec phase_offset = { 0.0, 0.5, 0.5, 0.0 };
+  const GaitScheduler gait_scheduler(config.t_swing, config.t_stance, phase_offset);
+
+  ControlPipeline pipeline(config);
+  pipeline.setAllocationCounter(allocations);
+
+  const bool walking = gait == "trot";
+  const auto vx = walking ? 0.2 : 0.0;
+  const vec Vb = { vx, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+  JointStatesMap joint_states_map;
+  for (const auto& leg_name : config.leg_names)
+  {
+    joint_states_map.emplace(leg_name, LegJointStates());
+  }
+
+  const GaitMap stance_gait_map = make_stance_gait();
+  const auto dt = 1.0 / frequency;
+  bool gait_running = false;
+  double checksum = 0.0;
+  double first_tick = 0.0;
+  uint64_t explicit_ticks = 0;
+  uint64_t sensitivity_ticks = 0;
+  std::array<uint64_t, num_balance_solvers> solver_ticks{};
+  TaskProfile task_profile;
+  if (pipeline.taskGraph())
+  {
+    task_profile = make_task_profile(*pipeline.taskGraph());
+  }
+
+  const uint64_t start_allocations = allocations();
+  const auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t tick = 0; tick < num_ticks; tick++)
+  {
+    const auto t = static_cast<double>(tick) * dt;
+
+    const RobotStateCoM com_state = synthetic_com_state(t, vx);
+    synthetic_joint_states(t, joint_states_map);
+
+    if (walking && tick % 10 == 0)
+    {
+      pipeline.setCommand(Vb);
+    }
+    else if (!walking && tick % 10 == 0)
+    {
+      // Pose [-, -, z, roll, pitch, yaw] while standing in place
+      const vec pose = { 0.0, 0.0, 0.03 * std::sin(t), 0.2 * std::sin(2.0 * t),
+                         0.2 * std::cos(2.0 * t), 0.0 };
+      pipeline.setCommand(pose);
+    }
+
+    const GaitMap gait_map = gait_running ? gait_scheduler.schedule(t) : stance_gait_map;
+    const TorqueMap& torque_map =
+        pipeline.update(com_state, joint_states_map, gait_map, gait_running);
+    const auto torque = torque_map.find("FL");
+    checksum += torque != torque_map.end() ? torque->second(1) : 0.0;
+    solver_ticks.at(pipeline.balanceSolver())++;
+    if (pipeline.balanceSolver() == BalanceSolver::balance_qp)
+    {
+      explicit_ticks += pipeline.balanceStatus().explicit_solution;
+      sensitivity_ticks += pipeline.balanceStatus().sensitivity_update;
+    }
+    if (pipeline.taskGraph())
+    {
+      add_task_profile(*pipeline.taskGraph(), task_profile);
+    }
+
+    if (tick == 0)
+    {
+      first_tick = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                       .count();
+    }
+
+    gait_running = walking && pipeline.standing();
+  }
+
+  const auto elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const uint64_t total_allocations = allocations() - start_allocations;
+
+  // Report
+  const PipelineStats& stats = pipeline.stats();
+  const auto ticks = static_cast<double>(stats.ticks);
+
+  double stage_total = 0.0;
+  for (const auto time : stats.total_time)
+  {
+    stage_total += time;
+  }
+
+  std::printf("gait: %s, qp backend: %s, leg executor: %s, ticks: %lu, elapsed: %.3f s\n",
+              gait.c_str(), qp_backend_name(config.qp_backend),
+              leg_executor_name(config.leg_executor.type),
+              static_cast<unsigned long>(stats.ticks), elapsed);
+  std::printf("ticks/sec: %.1f, mean tick: %.3f us, first tick: %.3f us\n",
+              ticks / elapsed, 1.0e6 * elapsed / ticks, 1.0e6 * first_tick);
+  std::printf("allocations/tick: %.2f (total %lu)\n",
+              static_cast<double>(total_allocations) / ticks,
+              static_cast<unsigned long>(total_allocations));
+  std::printf("checksum: %.6f\n", checksum);
+  std::printf("balance solver ticks:");
+  for (unsigned int i = 0; i < num_balance_solvers; i++)
+  {
+    std::printf(" %s %lu", balance_solver_name(static_cast<BalanceSolver>(i)),
+                static_cast<unsigned long>(solver_ticks.at(i)));
+  }
+  std::printf("\n");
+  if (use_mpc)
+  {
+    const MPCStatus& mpc_status = pipeline.mpcStatus();
+    std::printf("last mpc solve: %s, %u iterations, %.3f us\n",
+                mpc_status.solved ? "solved" : "failed", mpc_status.iterations,
+                1.0e6 * mpc_status.solve_time);
+  }
+  if (config.explicit_qp)
+  {
+    std::printf("explicit balance QP: %.1f%% of ticks\n",
+                100.0 * static_cast<double>(explicit_ticks) / ticks);
+  }
+  if (solve_rate)
+  {
+    std::printf("balance QP solves skipped: %.1f%% of ticks\n",
+                100.0 * static_cast<double>(sensitivity_ticks) / ticks);
+  }
+  std::printf("\n");
+
+  std::printf("%-20s %12s %8s %14s\n", "stage", "mean (us)", "share", "allocs/tick");
+  for (unsigned int i = 0; i < num_pipeline_stages; i++)
+  {
+    std::printf("%-20s %12.3f %7.1f%% %14.2f\n",
+                pipeline_stage_name(static_cast<PipelineStage>(i)),
+                1.0e6 * stats.total_time.at(i) / ticks,
+                100.0 * stats.total_time.at(i) / stage_total,
+                static_cast<double>(stats.allocations.at(i)) / ticks);
+  }
+
+  if (pipeline.taskGraph() && task_profile.runs > 0)
+  {
+    print_task_profile(*pipeline.taskGraph(), task_profile);
+  }
+
+  return 0;
+}
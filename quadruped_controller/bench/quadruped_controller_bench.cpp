@@ -0,0 +1,760 @@
+/**
+ * @file quadruped_controller_bench.cpp
+ * @author agent
+ * @date 2026-10-17
+ * @brief Microbenchmarks for the quadruped_controller library
+ *
+ * @details Results are written as JSON to quadruped_controller_bench.json unless
+ * --benchmark_out is given on the command line, so regressions can be tracked
+ * between runs (e.g. with benchmark's compare.py).
+ */
+
+// C++
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Benchmark
+#include <benchmark/benchmark.h>
+
+// Quadruped Control
+#include <quadruped_controller/balance_controller.hpp>
+#include <quadruped_controller/explicit_balance_qp.hpp>
+#include <quadruped_controller/gait.hpp>
+#include <quadruped_controller/gait_table.hpp>
+#include <quadruped_controller/joint_controller.hpp>
+#include <quadruped_controller/kinematics.hpp>
+#include <quadruped_controller/leg_executor.hpp>
+#include <quadruped_controller/lqr_balance_controller.hpp>
+#include <quadruped_controller/nonlinear_mpc.hpp>
+#include <quadruped_controller/state_estimator.hpp>
+#include <quadruped_controller/trajectory.hpp>
+#include <quadruped_controller/math/numerics.hpp>
+#include <quadruped_controller/math/rigid3d.hpp>
+#include <quadruped_controller/realtime/task_graph.hpp>
+
+using arma::eye;
+using arma::mat;
+using arma::mat33;
+using arma::vec;
+using arma::vec3;
+
+using namespace quadruped_controller;
+
+namespace
+{
+const std::vector<std::string> leg_names = { "RL", "FL", "RR", "FR" };
+
+/** @brief Standing joint configuration from config/fake_gait.yaml */
+JointStatesMap stand_joint_states()
+{
+  const vec3 qdot = { 0.1, -0.2, 0.3 };
+
+  JointStatesMap joint_states_map;
+  joint_states_map.emplace("RL", LegJointStates({ 0.056, 0.90, -1.94 }, qdot));
+  joint_states_map.emplace("FL", LegJointStates({ 0.056, 0.90, -1.94 }, qdot));
+  joint_states_map.emplace("RR", LegJointStates({ -0.056, 0.90, -1.94 }, qdot));
+  joint_states_map.emplace("FR", LegJointStates({ -0.056, 0.90, -1.94 }, qdot));
+  return joint_states_map;
+}
+
+/** @brief Trot gait mid swing, RL and FR in stance */
+GaitMap trot_gait()
+{
+  GaitMap gait_map;
+  gait_map.emplace("RL", std::make_pair(LegState::stance, 0.3));
+  gait_map.emplace("FL", std::make_pair(LegState::swing, 0.8));
+  gait_map.emplace("RR", std::make_pair(LegState::swing, 0.8));
+  gait_map.emplace("FR", std::make_pair(LegState::stance, 0.3));
+  return gait_map;
+}
+
+/**
+ * @brief Explicit balance QP around the benchmark standing pose
+ * @param gait_map - gait schedule whose stance legs are solved
+ * @details Few samples keep the benchmark setup short. The benchmark states stay in
+ * the parameter box, consecutive states mostly share a region like the control loop.
+ */
+std::shared_ptr<const ExplicitBalanceQP> make_explicit_qp(const GaitMap& gait_map)
+{
+  const mat S = arma::diagmat(vec({ 1.0, 1.0, 1.0, 10.0, 10.0, 5.0 }));
+  const mat W = eye(12, 12) * 1e-5;
+  auto explicit_qp = std::make_shared<ExplicitBalanceQP>(0.8, 10.0, 120.0, S, W);
+
+  const QuadrupedKinematics kinematics;
+  const FootholdMap foot_map = kinematics.forwardKinematics(stand_joint_states());
+
+  ExplicitQPSampling sampling;
+  sampling.stance_mask = stance_mask(gait_map, leg_names);
+  sampling.feet = mat(3, leg_names.size());
+  for (unsigned int i = 0; i < leg_names.size(); i++)
+  {
+    sampling.feet.col(i) = foot_map.at(leg_names.at(i));
+  }
+  sampling.moment_max = { 20.0, 20.0, 20.0 };
+  sampling.samples = 2000;
+  explicit_qp->generate(sampling);
+
+  return explicit_qp;
+}
+
+/**
+ * @brief Balance controller with the gains in mit_cheetah_config.yaml
+ * @param torque_limits - constrain the stance leg joint torques
+ * @param explicit_qp - explicit balance QP, null to always solve the QP
+ * @param qp_backend - QP solver
+ * @param solve_rate - tolerances to update the last solution instead of solving
+ */
+BalanceController
+make_balance_controller(bool torque_limits = false,
+                        std::shared_ptr<const ExplicitBalanceQP> explicit_qp = nullptr,
+                        QpBackendType qp_backend = QpBackendType::qpoases,
+                        const SolveRateSettings& solve_rate = SolveRateSettings())
+{
+  const mat Ib = arma::diagmat(vec({ 0.011253, 0.036203, 0.042673 }));
+  const mat S = arma::diagmat(vec({ 1.0, 1.0, 1.0, 10.0, 10.0, 5.0 }));
+  const mat W = eye(12, 12) * 1e-5;
+  const vec kff = { 0.0, 0.0, 0.15, 0.0, 0.0, 0.0 };
+  const vec kp_p = { 100.0, 100.0, 100.0 };
+  const vec kd_p = { 50.0, 50.0, 50.0 };
+  const vec kp_w = { 5000.0, 5000.0, 5000.0 };
+  const vec kd_w = { 500.0, 500.0, 500.0 };
+
+  return BalanceController(0.8, 11.0, 10.0, 120.0, Ib, S, W, kff, kp_p, kd_p, kp_w, kd_w,
+                           leg_names, torque_limits, -20.0, 20.0, explicit_qp,
+                           qp_backend, AdmmSettings(), solve_rate);
+}
+
+/** @brief Balance controller inputs of one tick */
+struct BalanceInputs
+{
+  mat Rwb;                   // COM orientation
+  vec3 x;                    // COM position
+  vec3 xdot;                 // COM linear velocity
+  vec3 w;                    // COM angular velocity
+  FootholdMap foot_map;      // feet in body frame
+  JacobianMap jacobian_map;  // foot Jacobians
+};
+
+/**
+ * @brief One second of balance controller inputs sampled at 1 kHz
+ * @details The body sways and bounces at 1 and 2 Hz around the benchmark standing
+ * pose, and the joints move so the feet shift a few millimeters in the body frame. The
+ * motion is periodic so the sequence wraps around smoothly. Every tick the QP and the
+ * solve rate tolerances see a new problem as in the control loop.
+ */
+std::vector<BalanceInputs> balance_inputs()
+{
+  const QuadrupedKinematics kinematics;
+  const double dt = 0.001;
+
+  std::vector<BalanceInputs> inputs(1000);
+  for (unsigned int i = 0; i < inputs.size(); i++)
+  {
+    const double t = i * dt;
+    const double s1 = std::sin(2.0 * math::PI * t);
+    const double c1 = std::cos(2.0 * math::PI * t);
+    const double s2 = std::sin(4.0 * math::PI * t);
+    const double c2 = std::cos(4.0 * math::PI * t);
+
+    BalanceInputs& input = inputs.at(i);
+    input.Rwb = math::Rotation3d(0.02 * s2, -0.01 + 0.01 * c2, 0.05 + 0.02 * s1).matrix();
+    input.x = { 0.01 + 0.005 * s1, -0.005 + 0.003 * c1, 0.255 + 0.004 * s2 };
+    input.xdot = { 0.18 + 0.03 * c1, 0.01 - 0.02 * s1, -0.02 + 0.05 * c2 };
+    input.w = { 0.05 * c2, -0.03 + 0.02 * s2, 0.02 + 0.1 * c1 };
+
+    JointStatesMap joint_states_map = stand_joint_states();
+    for (auto& [leg_name, joint_states] : joint_states_map)
+    {
+      joint_states.q += vec3({ 0.01 * s1, 0.02 * s2, -0.03 * s2 });
+    }
+
+    input.foot_map = kinematics.forwardKinematics(joint_states_map);
+    for (const auto& [leg_name, joint_states] : joint_states_map)
+    {
+      input.jacobian_map.emplace(leg_name,
+                                 kinematics.legJacobian(leg_name, joint_states.q));
+    }
+  }
+
+  return inputs;
+}
+
+void run_balance_controller(
+    benchmark::State& state, const GaitMap& gait_map, bool torque_limits = false,
+    std::shared_ptr<const ExplicitBalanceQP> explicit_qp = nullptr,
+    QpBackendType qp_backend = QpBackendType::qpoases,
+    const SolveRateSettings& solve_rate = SolveRateSettings())
+{
+  const BalanceController balance_controller =
+      make_balance_controller(torque_limits, explicit_qp, qp_backend, solve_rate);
+  const std::vector<BalanceInputs> inputs = balance_inputs();
+
+  const mat Rwb_d = eye(3, 3);
+  const vec3 x_d = { 0.0, 0.0, 0.26 };
+  const vec3 xdot_d = { 0.2, 0.0, 0.0 };
+  const vec3 w_d(arma::fill::zeros);
+
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    const BalanceInputs& input = inputs[i];
+    i = (i + 1) % inputs.size();
+
+    ForceMap force_map = balance_controller.control(
+        input.Rwb, Rwb_d, input.x, input.xdot, input.w, x_d, xdot_d, w_d,
+        input.foot_map, gait_map, input.jacobian_map);
+    benchmark::DoNotOptimize(force_map);
+  }
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////
+// BalanceController
+static void BM_BalanceControllerStance(benchmark::State& state)
+{
+  run_balance_controller(state, make_stance_gait());
+}
+BENCHMARK(BM_BalanceControllerStance);
+
+static void BM_BalanceControllerTrot(benchmark::State& state)
+{
+  run_balance_controller(state, trot_gait());
+}
+BENCHMARK(BM_BalanceControllerTrot);
+
+static void BM_BalanceControllerTrotTorqueLimits(benchmark::State& state)
+{
+  run_balance_controller(state, trot_gait(), true);
+}
+BENCHMARK(BM_BalanceControllerTrotTorqueLimits);
+
+static void BM_BalanceControllerStanceExplicit(benchmark::State& state)
+{
+  const GaitMap gait_map = make_stance_gait();
+  run_balance_controller(state, gait_map, false, make_explicit_qp(gait_map));
+}
+BENCHMARK(BM_BalanceControllerStanceExplicit);
+
+static void BM_BalanceControllerTrotExplicit(benchmark::State& state)
+{
+  const GaitMap gait_map = trot_gait();
+  run_balance_controller(state, gait_map, false, make_explicit_qp(gait_map));
+}
+BENCHMARK(BM_BalanceControllerTrotExplicit);
+
+static void BM_BalanceControllerStanceAdmm(benchmark::State& state)
+{
+  run_balance_controller(state, make_stance_gait(), false, nullptr, QpBackendType::admm);
+}
+BENCHMARK(BM_BalanceControllerStanceAdmm);
+
+static void BM_BalanceControllerTrotAdmm(benchmark::State& state)
+{
+  run_balance_controller(state, trot_gait(), false, nullptr, QpBackendType::admm);
+}
+BENCHMARK(BM_BalanceControllerTrotAdmm);
+
+// Slowly changing problems, ticks within the tolerances update the last solution
+static void BM_BalanceControllerStanceSolveRate(benchmark::State& state)
+{
+  SolveRateSettings solve_rate;
+  solve_rate.enabled = true;
+  run_balance_controller(state, make_stance_gait(), false, nullptr,
+                         QpBackendType::qpoases, solve_rate);
+}
+BENCHMARK(BM_BalanceControllerStanceSolveRate);
+
+static void BM_BalanceControllerTrotSolveRate(benchmark::State& state)
+{
+  SolveRateSettings solve_rate;
+  solve_rate.enabled = true;
+  run_balance_controller(state, trot_gait(), false, nullptr, QpBackendType::qpoases,
+                         solve_rate);
+}
+BENCHMARK(BM_BalanceControllerTrotSolveRate);
+
+// QP at a quarter of the rate with first order updates in between
+static void BM_BalanceControllerTrotQuarterRate(benchmark::State& state)
+{
+  SolveRateSettings solve_rate;
+  solve_rate.enabled = true;
+  solve_rate.max_updates = 3;
+  run_balance_controller(state, trot_gait(), false, nullptr, QpBackendType::qpoases,
+                         solve_rate);
+}
+BENCHMARK(BM_BalanceControllerTrotQuarterRate);
+
+static void BM_LQRBalanceControllerStance(benchmark::State& state)
+{
+  const QuadrupedKinematics kinematics;
+  const FootholdMap foot_map = kinematics.forwardKinematics(stand_joint_states());
+  const mat Ib = arma::diagmat(vec({ 0.011253, 0.036203, 0.042673 }));
+  const LQRBalanceController lqr_controller(LQRBalanceConfig(), 0.8, 11.0, 10.0, 120.0,
+                                            Ib, foot_map, leg_names);
+
+  RobotStateCoM com_state;
+  com_state.x = { 0.01, -0.005, 0.255 };
+  com_state.xdot = { 0.18, 0.01, -0.02 };
+  com_state.w = { 0.05, -0.03, 0.02 };
+  com_state.Rwb = math::Rotation3d(0.02, -0.01, 0.05).matrix();
+
+  RobotStateCoM desired_state;
+  desired_state.x = { 0.0, 0.0, 0.26 };
+  desired_state.xdot.zeros();
+  desired_state.w.zeros();
+  desired_state.Rwb = math::Rotation3d(0.1, 0.15, 0.0).matrix();
+
+  for (auto _ : state)
+  {
+    ForceMap force_map = lqr_controller.control(com_state, desired_state, foot_map);
+    benchmark::DoNotOptimize(force_map);
+  }
+}
+BENCHMARK(BM_LQRBalanceControllerStance);
+
+/////////////////////////////////////////////////////////
+// NonlinearMPC
+static void BM_NonlinearMPCTrot(benchmark::State& state)
+{
+  NonlinearMPCConfig config;
+  config.period = 0.001;
+  const mat Ib = arma::diagmat(vec({ 0.011253, 0.036203, 0.042673 }));
+  NonlinearMPC mpc(config, 0.8, 11.0, 10.0, 120.0, Ib, 0.18, 0.8, leg_names);
+
+  const QuadrupedKinematics kinematics;
+  const FootholdMap foot_map = kinematics.forwardKinematics(stand_joint_states());
+  const FootholdMap foothold_map;
+  const GaitMap gait_map = trot_gait();
+
+  RobotStateCoM com_state;
+  com_state.x = { 0.01, -0.005, 0.255 };
+  com_state.xdot = { 0.18, 0.01, -0.02 };
+  com_state.w = { 0.05, -0.03, 0.02 };
+  com_state.Rwb = math::Rotation3d(0.02, -0.01, 0.05).matrix();
+
+  RobotStateCoM desired_state;
+  desired_state.x = { 0.0, 0.0, 0.26 };
+  desired_state.xdot = { 0.2, 0.0, 0.0 };
+  desired_state.w = { 0.0, 0.0, 0.3 };
+  desired_state.Rwb = eye(3, 3);
+
+  // Warm started solves like the control loop
+  for (auto _ : state)
+  {
+    ForceMap force_map =
+        mpc.control(com_state, desired_state, foot_map, foothold_map, gait_map, true);
+    benchmark::DoNotOptimize(force_map);
+  }
+}
+BENCHMARK(BM_NonlinearMPCTrot);
+
+/////////////////////////////////////////////////////////
+// QuadrupedKinematics
+static void BM_ForwardKinematics(benchmark::State& state)
+{
+  const QuadrupedKinematics kinematics;
+  const JointStatesMap joint_states_map = stand_joint_states();
+
+  for (auto _ : state)
+  {
+    FootholdMap foot_map = kinematics.forwardKinematics(joint_states_map);
+    benchmark::DoNotOptimize(foot_map);
+  }
+}
+BENCHMARK(BM_ForwardKinematics);
+
+static void BM_LegInverseKinematics(benchmark::State& state)
+{
+  const QuadrupedKinematics kinematics;
+  const vec3 foothold = { 0.21, 0.13, -0.24 };
+
+  for (auto _ : state)
+  {
+    vec3 q = kinematics.legInverseKinematics("FL", foothold);
+    benchmark::DoNotOptimize(q);
+  }
+}
+BENCHMARK(BM_LegInverseKinematics);
+
+static void BM_LegJacobian(benchmark::State& state)
+{
+  const QuadrupedKinematics kinematics;
+  const vec3 q = { 0.056, 0.90, -1.94 };
+
+  for (auto _ : state)
+  {
+    mat33 J = kinematics.legJacobian("FL", q);
+    benchmark::DoNotOptimize(J);
+  }
+}
+BENCHMARK(BM_LegJacobian);
+
+static void BM_LegJacobianInverse(benchmark::State& state)
+{
+  const QuadrupedKinematics kinematics;
+  const vec3 q = { 0.056, 0.90, -1.94 };
+
+  for (auto _ : state)
+  {
+    mat33 Jinv = kinematics.legJacobianInverse("FL", q);
+    benchmark::DoNotOptimize(Jinv);
+  }
+}
+BENCHMARK(BM_LegJacobianInverse);
+
+static void BM_JacobianTransposeControl(benchmark::State& state)
+{
+  const QuadrupedKinematics kinematics;
+  const JointStatesMap joint_states_map = stand_joint_states();
+
+  ForceMap force_map;
+  force_map.emplace("RL", vec3{ 1.5, -0.5, -27.0 });
+  force_map.emplace("FL", vec3{ 1.5, 0.5, -27.0 });
+  force_map.emplace("RR", vec3{ -1.5, -0.5, -27.0 });
+  force_map.emplace("FR", vec3{ -1.5, 0.5, -27.0 });
+
+  for (auto _ : state)
+  {
+    TorqueMap torque_map =
+        kinematics.jacobianTransposeControl(joint_states_map, force_map);
+    benchmark::DoNotOptimize(torque_map);
+  }
+}
+BENCHMARK(BM_JacobianTransposeControl);
+
+/////////////////////////////////////////////////////////
+// LegExecutor
+/** @brief FK and J.T*f of all legs as in a tick, the joint angles change every tick */
+static void run_leg_executor(benchmark::State& state, LegExecutorType type)
+{
+  LegExecutorConfig config;
+  config.type = type;
+  LegExecutor leg_executor(config, { "RL", "FL", "RR", "FR" });
+
+  JointStatesMap joint_states_map = stand_joint_states();
+  ForceMap force_map;
+  force_map.emplace("RL", vec3{ 1.5, -0.5, -27.0 });
+  force_map.emplace("FL", vec3{ 1.5, 0.5, -27.0 });
+  force_map.emplace("RR", vec3{ -1.5, -0.5, -27.0 });
+  force_map.emplace("FR", vec3{ -1.5, 0.5, -27.0 });
+
+  FootholdMap foot_map;
+  double offset = 1e-3;
+  for (auto _ : state)
+  {
+    for (auto& [leg_name, joint_states] : joint_states_map)
+    {
+      joint_states.q += offset;
+    }
+    offset = -offset;
+
+    leg_executor.forwardKinematics(joint_states_map, foot_map);
+    TorqueMap torque_map =
+        leg_executor.jacobianTransposeControl(joint_states_map, force_map);
+    benchmark::DoNotOptimize(foot_map);
+    benchmark::DoNotOptimize(torque_map);
+  }
+}
+
+static void BM_LegExecutorSerial(benchmark::State& state)
+{
+  run_leg_executor(state, LegExecutorType::serial);
+}
+BENCHMARK(BM_LegExecutorSerial);
+
+static void BM_LegExecutorParallel(benchmark::State& state)
+{
+  run_leg_executor(state, LegExecutorType::parallel);
+}
+BENCHMARK(BM_LegExecutorParallel);
+
+static void BM_LegExecutorBatched(benchmark::State& state)
+{
+  run_leg_executor(state, LegExecutorType::batched);
+}
+BENCHMARK(BM_LegExecutorBatched);
+
+/////////////////////////////////////////////////////////
+// TaskGraph
+/** @brief Scheduling overhead of the pipeline stage graph with empty tasks */
+static void BM_TaskGraphPipeline(benchmark::State& state)
+{
+  realtime::TaskGraph graph(static_cast<unsigned int>(state.range(0)));
+  const auto fk = graph.addTask("forward_kinematics", [] {}, true);
+  const auto footholds = graph.addTask("foothold_planning", [] {});
+  const auto swing = graph.addTask("swing_trajectory", [] {});
+  const auto joint = graph.addTask("joint_control", [] {});
+  const auto balance = graph.addTask("balance_control", [] {}, true);
+  const auto merge = graph.addTask("torque_merge", [] {}, true);
+  graph.addDependency(fk, footholds);
+  graph.addDependency(footholds, swing);
+  graph.addDependency(swing, joint);
+  graph.addDependency(joint, merge);
+  graph.addDependency(fk, balance);
+  graph.addDependency(balance, merge);
+
+  for (auto _ : state)
+  {
+    graph.run();
+  }
+}
+BENCHMARK(BM_TaskGraphPipeline)->Arg(0)->Arg(1)->Arg(2);
+
+/////////////////////////////////////////////////////////
+// Trajectories
+static void BM_FootTrajectoryGenerate(benchmark::State& state)
+{
+  const FootTrajectory foot_traj;
+  const vec3 p_start = { 0.19, 0.13, 0.0 };
+  const vec3 p_final = { 0.26, 0.13, 0.0 };
+  const vec3 p_center = { 0.225, 0.13, 0.08 };
+
+  for (auto _ : state)
+  {
+    bool success = foot_traj.generateTrajetory(p_start, p_center, p_final);
+    benchmark::DoNotOptimize(success);
+  }
+}
+BENCHMARK(BM_FootTrajectoryGenerate);
+
+static void BM_FootTrajectoryTrack(benchmark::State& state)
+{
+  const FootTrajectory foot_traj;
+  foot_traj.generateTrajetory({ 0.19, 0.13, 0.0 }, { 0.225, 0.13, 0.08 },
+                              { 0.26, 0.13, 0.0 });
+
+  auto t = 0.0;
+  for (auto _ : state)
+  {
+    FootState foot_state = foot_traj.trackTrajectory(t);
+    benchmark::DoNotOptimize(foot_state);
+
+    t += 0.01;
+    if (t > 1.0)
+    {
+      t = 0.0;
+    }
+  }
+}
+BENCHMARK(BM_FootTrajectoryTrack);
+
+static void BM_FootTrajectoryManagerPlan(benchmark::State& state)
+{
+  const FootTrajectoryManager foot_traj_manager(0.08, 0.18, 0.8);
+  const GaitMap gait_map = trot_gait();
+
+  FootTrajBoundsMap foot_traj_bounds_map;
+  foot_traj_bounds_map.emplace("FL",
+                               FootTrajBounds({ 0.19, 0.13, 0.0 }, { 0.26, 0.13, 0.0 }));
+  foot_traj_bounds_map.emplace(
+      "RR", FootTrajBounds({ -0.19, -0.13, 0.0 }, { -0.12, -0.13, 0.0 }));
+
+  for (auto _ : state)
+  {
+    FootStateMap foot_states_map =
+        foot_traj_manager.referenceStates(gait_map, foot_traj_bounds_map);
+    benchmark::DoNotOptimize(foot_states_map);
+  }
+}
+BENCHMARK(BM_FootTrajectoryManagerPlan);
+
+static void BM_SupportPolygonPosition(benchmark::State& state)
+{
+  const SupportPolygon support_polygon;
+
+  ScheduledPhasesMap schedule_map;
+  schedule_map.emplace("RL", LegScheduledPhases{ 0.0, 0.5, 0.5, 1.0 });
+  schedule_map.emplace("FL", LegScheduledPhases{ 0.5, 1.0, 0.0, 0.5 });
+  schedule_map.emplace("RR", LegScheduledPhases{ 0.5, 1.0, 0.0, 0.5 });
+  schedule_map.emplace("FR", LegScheduledPhases{ 0.0, 0.5, 0.5, 1.0 });
+
+  FootholdMap foot_map;
+  foot_map.emplace("RL", vec3{ -0.196, 0.127, 0.0 });
+  foot_map.emplace("FL", vec3{ 0.196, 0.127, 0.0 });
+  foot_map.emplace("RR", vec3{ -0.196, -0.127, 0.0 });
+  foot_map.emplace("FR", vec3{ 0.196, -0.127, 0.0 });
+
+  const GaitMap gait_map = trot_gait();
+
+  for (auto _ : state)
+  {
+    vec zeta = support_polygon.position(schedule_map, foot_map, gait_map);
+    benchmark::DoNotOptimize(zeta);
+  }
+}
+BENCHMARK(BM_SupportPolygonPosition);
+
+/////////////////////////////////////////////////////////
+// Gait and joint control
+/** @brief Schedule at the tick time as the commander does, advancing 1 ms per tick */
+static void BM_GaitSchedulerSchedule(benchmark::State& state)
+{
+  const GaitScheduler gait_scheduler(0.18, 0.8, vec({ 0.0, 0.5, 0.5, 0.0 }));
+
+  double t = 0.0;
+  for (auto _ : state)
+  {
+    GaitMap gait_map = gait_scheduler.schedule(t);
+    benchmark::DoNotOptimize(gait_map);
+    t += 0.001;
+  }
+}
+BENCHMARK(BM_GaitSchedulerSchedule);
+
+static void BM_GaitTableBuild(benchmark::State& state)
+{
+  // One trot cycle at 1 ms
+  GaitTableConfig config;
+  config.t_swing = 0.18;
+  config.t_stance = 0.8;
+  config.offset = vec({ 0.0, 0.5, 0.5, 0.0 });
+  config.x = { 0.0, 0.0, 0.26 };
+  config.xdot = { 0.2, 0.0, 0.0 };
+  config.q_stance = { 0.056, 0.90, -1.94, 0.056, 0.90, -1.94,
+                      -0.056, 0.90, -1.94, -0.056, 0.90, -1.94 };
+
+  for (auto _ : state)
+  {
+    GaitTable gait_table(config, leg_names);
+    benchmark::DoNotOptimize(gait_table);
+  }
+}
+BENCHMARK(BM_GaitTableBuild);
+
+static void BM_JointControllerControl(benchmark::State& state)
+{
+  const JointController joint_controller({ 0.0, 0.0, 0.0 }, { 40.0, 40.0, 50.0 },
+                                         { 1.0, 1.0, 1.0 });
+  const JointStatesMap joint_states_map = stand_joint_states();
+
+  const vec3 qdot_ref = { 0.0, 2.0, -3.0 };
+
+  JointStatesMap swing_leg_js_map;
+  swing_leg_js_map.emplace("FL", LegJointStates({ 0.05, 1.1, -2.2 }, qdot_ref));
+  swing_leg_js_map.emplace("RR", LegJointStates({ -0.05, 1.1, -2.2 }, qdot_ref));
+
+  for (auto _ : state)
+  {
+    TorqueMap torque_map = joint_controller.control(swing_leg_js_map, joint_states_map);
+    benchmark::DoNotOptimize(torque_map);
+  }
+}
+BENCHMARK(BM_JointControllerControl);
+
+/////////////////////////////////////////////////////////
+// State estimation
+static void BM_StateEstimatorUpdate(benchmark::State& state)
+{
+  StateEstimator estimator;
+  const JointStatesMap joint_states_map = stand_joint_states();
+  const GaitMap gait_map = trot_gait();
+
+  ImuMeasurement imu;
+  imu.Rwb = math::Rotation3d(0.02, -0.01, 0.05).matrix();
+  imu.omega = { 0.05, -0.03, 0.02 };
+  imu.accel = { 0.1, -0.05, 9.7 };
+
+  for (auto _ : state)
+  {
+    const RobotStateCoM& com_state = estimator.update(imu, joint_states_map, gait_map);
+    benchmark::DoNotOptimize(com_state);
+  }
+}
+BENCHMARK(BM_StateEstimatorUpdate);
+
+/////////////////////////////////////////////////////////
+// rigid3d
+static void BM_QuaternionToMatrix(benchmark::State& state)
+{
+  const math::Quaternion quat(0.9990, 0.0100, -0.0200, 0.0374);
+
+  for (auto _ : state)
+  {
+    mat R = quat.rotation().matrix();
+    benchmark::DoNotOptimize(R);
+  }
+}
+BENCHMARK(BM_QuaternionToMatrix);
+
+static void BM_MatrixToQuaternion(benchmark::State& state)
+{
+  const mat R = math::Rotation3d(0.02, -0.01, 0.05).matrix();
+
+  for (auto _ : state)
+  {
+    math::Quaternion quat(R);
+    benchmark::DoNotOptimize(quat);
+  }
+}
+BENCHMARK(BM_MatrixToQuaternion);
+
+static void BM_RotationAngleAxis(benchmark::State& state)
+{
+  const mat Rwb = math::Rotation3d(0.02, -0.01, 0.05).matrix();
+  const mat Rwb_d = eye(3, 3);
+
+  for (auto _ : state)
+  {
+    vec aa = math::Rotation3d(Rwb_d * Rwb.t()).angleAxisTotal();
+    benchmark::DoNotOptimize(aa);
+  }
+}
+BENCHMARK(BM_RotationAngleAxis);
+
+static void BM_TransformAdjoint(benchmark::State& state)
+{
+  const math::Pose pose(math::Rotation3d(0.02, -0.01, 0.05), vec3{ 0.1, -0.05, 0.26 });
+  const vec Vb = { 0.2, 0.0, 0.0, 0.0, 0.0, 0.05 };
+
+  for (auto _ : state)
+  {
+    vec Vw = pose.transform().adjoint() * Vb;
+    benchmark::DoNotOptimize(Vw);
+  }
+}
+BENCHMARK(BM_TransformAdjoint);
+
+static void BM_IntegrateTwistYaw(benchmark::State& state)
+{
+  const math::Pose pose(math::Rotation3d(0.02, -0.01, 0.05), vec3{ 0.1, -0.05, 0.26 });
+  const vec Vb = { 0.2, 0.0, 0.0, 0.0, 0.0, 0.05 };
+
+  for (auto _ : state)
+  {
+    math::Pose pose_desired = integrate_twist_yaw(pose, Vb, 0.001);
+    benchmark::DoNotOptimize(pose_desired);
+  }
+}
+BENCHMARK(BM_IntegrateTwistYaw);
+
+int main(int argc, char** argv)
+{
+  // Default to a JSON report next to the console output
+  std::vector<char*> args(argv, argv + argc);
+  bool has_out = false;
+  for (int i = 1; i < argc; i++)
+  {
+    has_out |= std::string(argv[i]).rfind("--benchmark_out=", 0) == 0;
+  }
+
+  std::string out_arg = "--benchmark_out=quadruped_controller_bench.json";
+  std::string format_arg = "--benchmark_out_format=json";
+  if (!has_out)
+  {
+    args.push_back(out_arg.data());
+    args.push_back(format_arg.data());
+  }
+
+  int args_size = static_cast<int>(args.size());
+  benchmark::Initialize(&args_size, args.data());
+  if (benchmark::ReportUnrecognizedArguments(args_size, args.data()))
+  {
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
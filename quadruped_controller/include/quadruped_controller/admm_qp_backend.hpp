@@ -0,0 +1,143 @@
+/**
+ * @file admm_qp_backend.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief First order QP solver based on ADMM
+ *
+ * @details Operator splitting QP solver in the style of OSQP [R1]. The problem
+ * min 1/2*x.T*Q*x + x.T*c s.t. l <= C*x <= u is split with z = C*x and every
+ * iteration solves the linear system
+ *
+ *    (Q + sigma*I + C.T*diag(rho)*C)*x = sigma*x - c + C.T*(rho*z - y)
+ *
+ * followed by a projection of z onto [l, u] and a dual update of y. The matrix does
+ * not depend on c, l, or u, so its Cholesky factor is cached and only recomputed
+ * when Q, C, the set of equality constraints, or rho change. rho is rescaled to
+ * balance the primal and dual residuals and kept between solves. Iterations start
+ * from the last solution and stop once the residuals are within the tolerances.
+ * The solution is then polished by solving the KKT system of the active set
+ * guessed from the dual variables, which recovers an accurate solution from a low
+ * accuracy ADMM iterate.
+ *
+ * All work arrays are allocated in the constructor, solve() does not allocate.
+ *
+ * References:
+ *   [R1] B. Stellato, G. Banjac, P. Goulart, A. Bemporad, and S. Boyd. OSQP: an
+ *        operator splitting solver for quadratic programs. Mathematical Programming
+ *        Computation, 2020.
+ */
+#ifndef ADMM_QP_BACKEND_HPP
+#define ADMM_QP_BACKEND_HPP
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/qp_backend.hpp>
+
+namespace quadruped_controller
+{
+/** @brief ADMM QP backend */
+class AdmmQpBackend : public QpBackend
+{
+public:
+  /**
+   * @brief Constructor
+   * @param num_variables - number of variables n
+   * @param num_constraints - number of constraints m
+   * @param settings - ADMM parameters
+   */
+  AdmmQpBackend(unsigned int num_variables, unsigned int num_constraints,
+                const AdmmSettings& settings = AdmmSettings());
+
+  /**
+   * @details Returns RET_MAX_NWSR_REACHED if the residuals are not within the
+   * tolerances after the max iterations and polishing fails, and RET_INIT_FAILED if
+   * the linear system can not be factorized.
+   */
+  QPStatus solve(const real_t* Q, const real_t* c, const real_t* C, const real_t* lbC,
+                 const real_t* ubC, real_t* x) override;
+
+  bool isInitialised() const override;
+
+  QpBackendType type() const override;
+
+  /** @brief Return the number of factorizations of the ADMM linear system */
+  uint64_t factorizations() const;
+
+  /** @brief Return true if the last solution was polished */
+  bool polished() const;
+
+private:
+  /**
+   * @brief Set the penalty of each constraint from its bounds and rho
+   * @param lbC - constraint lower bounds (m)
+   * @param ubC - constraint upper bounds (m)
+   * @return true if a penalty changed
+   */
+  bool updatePenalties(const real_t* lbC, const real_t* ubC);
+
+  /**
+   * @brief Factorize Q + sigma*I + C.T*diag(rho)*C
+   * @return false if the matrix is not positive definite
+   */
+  bool factorize();
+
+  /**
+   * @brief Rescale rho by the ratio of the residuals of the last check [R1] Sec 5.2
+   * @return true if rho changed
+   */
+  bool adaptRho();
+
+  /**
+   * @brief Compute the primal and dual residuals of the current iterate
+   * @param c - linear cost (n)
+   * @return true if both are within the tolerances
+   */
+  bool converged(const real_t* c);
+
+  /**
+   * @brief Solve the KKT system of the active set of the current iterate
+   * @param c - linear cost (n)
+   * @param lbC - constraint lower bounds (m)
+   * @param ubC - constraint upper bounds (m)
+   * @return true if the polished solution is feasible and within the tolerances, in
+   * which case it replaces the iterate
+   */
+  bool polish(const real_t* c, const real_t* lbC, const real_t* ubC);
+
+private:
+  unsigned int n_;        // number of variables
+  unsigned int m_;        // number of constraints
+  AdmmSettings settings_;  // parameters
+  bool initialised_;      // a problem has been solved
+  bool polished_;         // last solution was polished
+  uint64_t factorizations_;  // factorizations of the linear system
+  double rho_scalar_;        // rho of the inequality constraints
+
+  std::vector<double> Q_;    // Hessian of the cached factorization (n x n)
+  std::vector<double> C_;    // constraints of the cached factorization (m x n)
+  std::vector<double> rho_;  // penalty per constraint (m)
+  std::vector<double> L_;    // Cholesky factor, lower triangle (n x n)
+
+  std::vector<double> x_, z_, y_;  // iterate, kept between solves for warm start
+  std::vector<double> xt_, zt_;    // linear system solution and its projection
+  std::vector<double> Cx_, Qx_, Cty_;  // residual terms
+  std::vector<double> lb_, ub_;        // bounds with the infinite bounds removed
+
+  std::vector<double> Lp_;          // polishing Cholesky factor (n x n)
+  std::vector<double> xp_, yp_;     // polished solution
+  std::vector<double> dx_, rp_;     // polishing refinement terms
+  std::vector<double> bp_;          // bound of each active constraint
+  std::vector<int8_t> active_;      // -1 lower, 1 upper, 0 inactive
+
+  double eps_primal_;   // primal tolerance of the last residual check
+  double eps_dual_;     // dual tolerance of the last residual check
+  double res_primal_;   // primal residual of the last residual check
+  double res_dual_;     // dual residual of the last residual check
+  double primal_scale_;  // max(|C*x|, |z|) of the last residual check
+  double dual_scale_;    // max(|Q*x|, |C.T*y|, |c|) of the last residual check
+};
+}  // namespace quadruped_controller
+#endif
@@ -7,11 +7,14 @@
 #ifndef BALANCE_CONTROLLER_HPP
 #define BALANCE_CONTROLLER_HPP
 
-// QP solver
-#include <qpOASES.hpp>
+// C++
+#include <memory>
 
+#include <quadruped_controller/explicit_balance_qp.hpp>
 #include <quadruped_controller/math/rigid3d.hpp>
 #include <quadruped_controller/gait.hpp>
+#include <quadruped_controller/qp_backend.hpp>
+#include <quadruped_controller/solve_rate_controller.hpp>
 
 namespace quadruped_controller
 {
@@ -25,10 +28,7 @@ using math::Quaternion;
 using math::Rotation3d;
 using math::skew_symmetric;
 
-using qpOASES::Options;
 using qpOASES::real_t;
-using qpOASES::returnValue;
-using qpOASES::SQProblem;
 
 /**
  * @brief Copy vector to array
@@ -81,11 +81,24 @@ public:
    * @param kp_w - kp gain on COM orientaion (3x1)
    * @param kd_w - kd gain on COM angular velocities (3x1)
    * @param leg_names - vector of legs names
+   * @param torque_limits - constrain the stance leg joint torques J.T*f
+   * @param tau_min - min joint torque (N*m)
+   * @param tau_max - max joint torque (N*m)
+   * @param explicit_qp - explicit solutions of the QP for common contact patterns,
+   * null to always solve the QP
+   * @param qp_backend - QP solver
+   * @param admm_settings - parameters of the ADMM QP solver
+   * @param solve_rate - tolerances to update the last solution instead of solving
    */
   BalanceController(double mu, double mass, double fzmin, double fzmax, const mat& Ib,
                     const mat& S, const mat& W, const vec& kff, const vec& kp_p,
                     const vec& kd_p, const vec& kp_w, const vec& kd_w,
-                    const std::vector<std::string>& leg_names);
+                    const std::vector<std::string>& leg_names, bool torque_limits = false,
+                    double tau_min = -20.0, double tau_max = 20.0,
+                    std::shared_ptr<const ExplicitBalanceQP> explicit_qp = nullptr,
+                    QpBackendType qp_backend = QpBackendType::qpoases,
+                    const AdmmSettings& admm_settings = AdmmSettings(),
+                    const SolveRateSettings& solve_rate = SolveRateSettings());
 
   /**
    * @brief Compose ground reaction forces
@@ -99,12 +112,52 @@ public:
    * @param w_d - desired COM angular velocity in world [wx, wy, wz] (3x1)
    * @param foot_map - postions of feet in body frame
    * @param gait_map - gait schedule
+   * @param jacobian_map - foot Jacobians, with torque limits the joint torques J.T*f
+   * of these legs are kept within [tau_min, tau_max]
    * @return ground reaction forces in body frame (12x1)
+   * @details Without torque limits the last solution is updated through its
+   * sensitivity while the problem is within the solve-rate tolerances. Otherwise the
+   * explicit solution is used when it contains the problem, once the QP solver is
+   * initialized so a fallback can hotstart.
    */
   ForceMap control(const mat& Rwb, const mat& Rwb_d, const vec& x, const vec& xdot,
                    const vec& w, const vec& x_d, const vec& xdot_d, const vec& w_d,
                    const FootholdMap& foot_map,
-                   const GaitMap& gait_map = make_stance_gait()) const;
+                   const GaitMap& gait_map = make_stance_gait(),
+                   const JacobianMap& jacobian_map = JacobianMap()) const;
+
+  /**
+   * @brief Solve the nominal standing problem to initialize the QP solver
+   * @param foot_map - standing foot positions in body frame
+   * @param x_stand - standing COM position in world [x, y, z] (3x1)
+   * @return true if the QP is solved
+   * @details The first call to control() hotstarts from this solution instead of
+   * initializing the solver cold while the robot is falling.
+   */
+  bool warmStart(const FootholdMap& foot_map, const vec& x_stand) const;
+
+  /**
+   * @brief Replace the gains and weights
+   * @param S - positive-definite weight matrix on least sqaures (6x6)
+   * @param W - positive-definite weight matrix on GRFs (12x12)
+   * @param kff - COM feedforward gains (6x1)
+   * @param kp_p - kp gain on COM position (3x1)
+   * @param kd_p - kd gain on COM linear velocity (3x1)
+   * @param kp_w - kp gain on COM orientaion (3x1)
+   * @param kd_w - kd gain on COM angular velocities (3x1)
+   * @details The sizes must match the constructor arguments, the values are copied
+   * without allocating. The last solution is no longer updated through its
+   * sensitivity, and the explicit solutions are only used while S and W are the
+   * weights they were computed for.
+   */
+  void setGains(const mat& S, const mat& W, const vec& kff, const vec& kp_p,
+                const vec& kd_p, const vec& kp_w, const vec& kd_w);
+
+  /** @brief Return the status of the last QP solve */
+  const QPStatus& status() const;
+
+  /** @brief Return the QP solver */
+  QpBackendType qpBackend() const;
 
 private:
   /**
@@ -125,7 +178,8 @@ private:
 private:
   /**
    * @brief Construct friction cone contraint
-   * @return friction cone constraint matrix (20x12)
+   * @return friction cone constraint matrix (20x12), with torque limits followed by
+   * the zero torque rows (32x12)
    * @details The matrix diagonal contains the friction cone for each
    * leg and all other elements are zero.
    */
@@ -139,6 +193,24 @@ private:
    */
   void frictionConeBounds(const GaitMap& gait_map) const;
 
+  /**
+   * @brief Set the joint torque constraints of the stance legs
+   * @param Rwb - rotation from world to base_link (3x3)
+   * @param jacobian_map - foot Jacobians
+   * @details Only the 3x3 block of each leg is written, the torque rows are zero
+   * elsewhere. Legs without a Jacobian are unconstrained.
+   */
+  void torqueLimitConstraints(const mat& Rwb, const JacobianMap& jacobian_map) const;
+
+  /**
+   * @brief Compose the GRFs of the stance legs from the QP solution
+   * @param fw - GRFs the ground applies to the feet in world frame (12x1)
+   * @param Rwb - rotation from world to base_link (3x3)
+   * @param gait_map - gait schedule
+   * @return forces the stance feet apply to the ground in body frame
+   */
+  ForceMap stanceForces(const vec& fw, const mat& Rwb, const GaitMap& gait_map) const;
+
 private:
   // Dynamic properties
   double mu_;    // coefficient of friction (kg*m/s^2)
@@ -156,24 +228,38 @@ private:
   // QP variables
   static const uint64_t num_equations_qp_{ 6 };     // number of equations
   static const uint64_t num_variables_qp_{ 12 };    // number of variable (GRFs)
-  static const uint64_t num_constraints_qp_{ 20 };  // total constraints (5 per foot)
+  static const uint64_t num_friction_constraints_qp_{ 20 };  // 5 per foot
+  static const uint64_t num_torque_constraints_qp_{ 12 };    // 3 per foot
+  static const uint64_t max_constraints_qp_{ num_friction_constraints_qp_ +
+                                             num_torque_constraints_qp_ };
+
+  bool torque_limits_;           // joint torque constraints enabled
+  double tau_min_, tau_max_;     // joint torque limits (N*m)
+  uint64_t num_constraints_qp_;  // total constraints
+
+  std::unique_ptr<QpBackend> qp_backend_;  // QP solver
+  mutable QPStatus status_;                // status of last solve
+
+  std::shared_ptr<const ExplicitBalanceQP> explicit_qp_;  // explicit solutions
+  bool explicit_weights_;        // S and W are the weights of the explicit solutions
+  mutable int explicit_region_;  // region of the last explicit solution
 
-  mutable SQProblem QPSolver_;  // sequential QP solver
+  mutable SolveRateController solve_rate_;  // skips solves of similar problems
 
   int nWSR_;              // max working set recalculations
   double fzmin_, fzmax_;  // min and max normal reaction force (N)
   mat S_;                 // positive-definite weight matrix on least sqaures (6x6)
   mat W_;                 // positive-definite weight matrix on GRFs (12x12)
-  mat C_;                 // friction cone constraint matrix (20x12)
+  mat C_;                 // friction cone constraint matrix (20x12 or 32x12)
 
   real_t cpu_time_;  // max CPU time for QP solution (s)
   // QP standard form 1/2*x.T*Q*x + x.T*c
   mutable real_t qp_Q_[num_variables_qp_ * num_variables_qp_];
   mutable real_t qp_c_[num_variables_qp_];
 
-  mutable real_t qp_C_[num_constraints_qp_ * num_variables_qp_];  // constraint matrix
-  mutable real_t qp_lbC_[num_constraints_qp_];  // constraint lower bounds
-  mutable real_t qp_ubC_[num_constraints_qp_];  // constraint upper bounds
+  mutable real_t qp_C_[max_constraints_qp_ * num_variables_qp_];  // constraint matrix
+  mutable real_t qp_lbC_[max_constraints_qp_];  // constraint lower bounds
+  mutable real_t qp_ubC_[max_constraints_qp_];  // constraint upper bounds
 
   // Robot configuration
   std::vector<std::string> leg_names_;
@@ -0,0 +1,423 @@
+/**
+ * @file control_pipeline.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Per tick control pipeline
+ */
+#ifndef CONTROL_PIPELINE_HPP
+#define CONTROL_PIPELINE_HPP
+
+// C++
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Quadruped Control
+#include <quadruped_controller/balance_controller.hpp>
+#include <quadruped_controller/foot_planner.hpp>
+#include <quadruped_controller/gait.hpp>
+#include <quadruped_controller/joint_controller.hpp>
+#include <quadruped_controller/kinematics.hpp>
+#include <quadruped_controller/leg_executor.hpp>
+#include <quadruped_controller/lqr_balance_controller.hpp>
+#include <quadruped_controller/nonlinear_mpc.hpp>
+#include <quadruped_controller/realtime/rcu.hpp>
+#include <quadruped_controller/realtime/task_graph.hpp>
+#include <quadruped_controller/trajectory.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat;
+using arma::vec;
+using arma::vec3;
+
+/** @brief Parameters for the control pipeline */
+struct ControlPipelineConfig
+{
+  // Gait and swing leg trajectory
+  double t_stance = 0.3;  // stance time (s)
+  double t_swing = 0.3;   // swing time (s)
+  double height = 0.08;   // max foot height (m)
+
+  // Balance control
+  double mu = 0.8;       // coefficient of friction
+  double mass = 11.0;    // total mass (kg)
+  double fzmin = 10.0;   // min normal reaction force (N)
+  double fzmax = 160.0;  // max normal reaction force (N)
+  mat Ib;                // moment of inertia in body frame (3x3)
+  mat S;                 // weight on least squares (6x6)
+  mat W;                 // weight on GRFs (12x12)
+  vec kff;               // COM feedforward gains (6x1)
+  vec kp_p;              // kp gain on COM position (3x1)
+  vec kd_p;              // kd gain on COM linear velocity (3x1)
+  vec kp_w;              // kp gain on COM orientaion (3x1)
+  vec kd_w;              // kd gain on COM angular velocities (3x1)
+
+  // Explicit balance QP solutions, null to always solve the QP
+  std::shared_ptr<const ExplicitBalanceQP> explicit_qp;
+
+  // Balance QP solver
+  QpBackendType qp_backend = QpBackendType::qpoases;
+  AdmmSettings admm;
+
+  // Update the last balance QP solution instead of solving similar problems
+  SolveRateSettings solve_rate;
+
+  // LQR replaces the balance QP while standing with the gait stopped
+  bool use_lqr_stance = false;
+  LQRBalanceConfig lqr_stance;
+
+  // Nonlinear MPC replaces the balance QP in nominal mode, the QP is the fallback
+  bool use_nonlinear_mpc = false;
+  NonlinearMPCConfig nonlinear_mpc;
+
+  // Joint control
+  vec3 jc_kff;  // swing leg FF gains
+  vec3 jc_kp;   // swing leg kp gains
+  vec3 jc_kd;   // swing leg kd gains
+
+  // Torque limits (N*m)
+  double tau_min = -20.0;
+  double tau_max = 20.0;
+  bool torque_limited_qp = false;  // balance QP keeps stance leg torques within limits
+
+  // Default standing COM position in world [x, y, z]
+  vec3 x_stand = { 0.0, 0.0, 0.26 };
+
+  // Runs FK, swing leg IK and J^-1, and J.T*f per leg
+  LegExecutorConfig leg_executor;
+
+  // Run the stages as a task graph, balance control alongside the swing legs
+  bool use_task_graph = false;
+  unsigned int task_graph_threads = 1;  // threads in addition to the tick thread
+  std::vector<int> task_graph_cpus;     // CPUs the threads are pinned to, empty for none
+
+  // User cmd integration step (s)
+  double dt = 0.001;
+
+  // Leg names [RL FL RR FR]
+  std::vector<std::string> leg_names = { "RL", "FL", "RR", "FR" };
+};
+
+/** @brief Gains that can be changed while the pipeline runs */
+struct ControlGains
+{
+  // Balance control
+  mat S;     // weight on least squares (6x6)
+  mat W;     // weight on GRFs (12x12)
+  vec kff;   // COM feedforward gains (6x1)
+  vec kp_p;  // kp gain on COM position (3x1)
+  vec kd_p;  // kd gain on COM linear velocity (3x1)
+  vec kp_w;  // kp gain on COM orientaion (3x1)
+  vec kd_w;  // kd gain on COM angular velocities (3x1)
+
+  // Joint control
+  vec3 jc_kff;  // swing leg FF gains
+  vec3 jc_kp;   // swing leg kp gains
+  vec3 jc_kd;   // swing leg kd gains
+};
+
+/** @brief Stages of a control tick */
+enum PipelineStage
+{
+  forward_kinematics = 0,
+  foothold_planning = 1,
+  swing_trajectory = 2,
+  joint_control = 3,
+  balance_control = 4,
+  torque_merge = 5,
+  num_pipeline_stages = 6
+};
+
+/** @brief Return the name of a pipeline stage */
+const char* pipeline_stage_name(PipelineStage stage);
+
+/**
+ * @brief Cheaper modes of operation used when ticks miss their deadline
+ * @details Each mode includes the savings of the modes before it.
+ */
+enum DegradationMode
+{
+  nominal = 0,          // full pipeline
+  reuse_forces = 1,     // reuse the last GRFs with fresh Jacobians, no balance QP
+  skip_replanning = 2,  // also keep the current footholds and desired state
+  joint_pd_stand = 3,   // joint PD to the standing configuration only
+  num_degradation_modes = 4
+};
+
+/** @brief Return the name of a degradation mode */
+const char* degradation_mode_name(DegradationMode mode);
+
+/** @brief Controller that produced the GRFs of a tick */
+enum BalanceSolver
+{
+  no_solve = 0,     // no GRFs solved for, the last GRFs were reused or none are needed
+  balance_qp = 1,   // balance QP, by default and when the nonlinear MPC fails
+  lqr_balance = 2,  // LQR while standing
+  mpc_balance = 3,  // nonlinear MPC
+  num_balance_solvers = 4
+};
+
+/** @brief Return the name of a balance solver */
+const char* balance_solver_name(BalanceSolver solver);
+
+/** @brief Timing and allocation statistics of the control pipeline */
+struct PipelineStats
+{
+  /** @brief Reset all statistics */
+  void reset();
+
+  uint64_t ticks = 0;                                       // completed ticks
+  std::array<double, num_pipeline_stages> last_time{};      // last tick stage time (s)
+  std::array<double, num_pipeline_stages> total_time{};     // accumulated stage time (s)
+  std::array<uint64_t, num_pipeline_stages> allocations{};  // accumulated allocations
+};
+
+/**
+ * @brief Runs one control tick from the robot state to joint torques
+ * @details FK -> foothold planning -> swing trajectory -> IK -> joint PD ->
+ * balance QP, LQR, or nonlinear MPC -> torque merge. The pipeline has no ROS
+ * communication so it can be driven by the commander or by a standalone harness.
+ *
+ * The stages form a graph, only FK and the torque merge are shared by the balance
+ * control and the swing legs:
+ *
+ *    FK -> foothold planning -> swing trajectory -> joint control -> torque merge
+ *    FK -> balance control ---------------------------------------> torque merge
+ *
+ * With use_task_graph the stages run as a realtime::TaskGraph and the critical
+ * path FK -> balance control -> torque merge is taken first. The nonlinear MPC
+ * reads the footholds, with it balance control also waits for foothold planning.
+ * The command is integrated into the desired state before the graph. Stage
+ * allocation counts include the stages running at the same time.
+ */
+class ControlPipeline
+{
+public:
+  /**
+   * @brief Constructor
+   * @param config - pipeline parameters
+   */
+  ControlPipeline(const ControlPipelineConfig& config);
+
+  /**
+   * @brief Set the user commanded body twist
+   * @param Vb - body twist [vx, vy, vz, wx, wy, wz]
+   * @details The command is integrated on the next tick the gait is running. While
+   * standing with the gait stopped it is a pose instead, see poseCommand().
+   */
+  void setCommand(const vec& Vb);
+
+  /**
+   * @brief Run a single control tick
+   * @param com_state - COM state in world frame
+   * @param joint_states_map - actual joint states
+   * @param gait_map - gait schedule for this tick
+   * @param gait_running - true if the gait scheduler is running
+   * @return joint torques clamped to the torque limits for all legs
+   */
+  const TorqueMap& update(const RobotStateCoM& com_state,
+                          const JointStatesMap& joint_states_map, const GaitMap& gait_map,
+                          bool gait_running);
+
+  /**
+   * @brief Publish new gains, used from the start of the next tick
+   * @param gains - gains and weights, copied
+   * @return false if a gain has the wrong size, is not finite, a weight is not
+   * positive, or a kp or kd gain is negative. The current gains are kept.
+   * @details Thread safe. The gains are copied here, call it off the control thread.
+   * The tick takes them up without locking.
+   */
+  bool updateGains(const ControlGains& gains);
+
+  /**
+   * @brief Set the mode used on the following ticks
+   * @param mode - degradation mode
+   */
+  void setDegradationMode(DegradationMode mode);
+
+  /** @brief Return the degradation mode */
+  DegradationMode degradationMode() const;
+
+  /** @brief Return true once the standing height is achieved */
+  bool standing() const;
+
+  /** @brief Return true if new footholds were planned on the last tick */
+  bool newFootholds() const;
+
+  /** @brief Return the footholds planned on the last tick (world frame) */
+  const FootholdMap& footholds() const;
+
+  /** @brief Return the foot positions from the last tick (body frame) */
+  const FootholdMap& footPositions() const;
+
+  /** @brief Return the ground reaction forces from the last tick (body frame) */
+  const ForceMap& forces() const;
+
+  /** @brief Return the joint torques from the last tick */
+  const TorqueMap& torques() const;
+
+  /** @brief Return the desired COM state from the last tick (world frame) */
+  RobotStateCoM desiredState() const;
+
+  /**
+   * @brief Return the status of the last balance control QP solve
+   * @details Kept from an earlier tick while the LQR or the nonlinear MPC produce
+   * the GRFs, see balanceSolver().
+   */
+  const QPStatus& balanceStatus() const;
+
+  /** @brief Return the controller that produced the GRFs of the last tick */
+  BalanceSolver balanceSolver() const;
+
+  /**
+   * @brief Return true if the GRFs of the last tick were solved for
+   * @details False if balanceSolver() failed or was not run.
+   */
+  bool balanceSolved() const;
+
+  /** @brief Return the gains used by the last tick */
+  const ControlGains& gains() const;
+
+  /** @brief Return the number of gain updates taken up by the ticks so far */
+  uint64_t gainUpdates() const;
+
+  /** @brief Return the status of the last nonlinear MPC solve */
+  const MPCStatus& mpcStatus() const;
+
+  /** @brief Return the foot trajectory manager */
+  const FootTrajectoryManager& footTrajectoryManager() const;
+
+  /** @brief Return the stage task graph, null if the stages run in sequence */
+  const realtime::TaskGraph* taskGraph() const;
+
+  /** @brief Return pipeline statistics */
+  const PipelineStats& stats() const;
+
+  /** @brief Reset pipeline statistics */
+  void resetStats();
+
+  /**
+   * @brief Count heap allocations per stage
+   * @param counter - returns the total number of allocations so far
+   * @details Intended for profiling harnesses that hook operator new.
+   */
+  void setAllocationCounter(uint64_t (*counter)());
+
+private:
+  /** @brief Integrate the user command into the desired COM state */
+  void integrateCommand(const RobotStateCoM& com_state);
+
+  /**
+   * @brief Pose the body with the user command while standing in place
+   * @details The command [-, -, z, roll, pitch, yaw] offsets the standing pose. The
+   * height and the roll and pitch are limited to the LQR gain grid.
+   */
+  void poseCommand();
+
+  /**
+   * @brief Plan footholds and foot trajectories
+   * @param com_state - COM state in world frame
+   * @param gait_map - gait schedule
+   * @return reference foot states (world frame)
+   */
+  FootStateMap planFootholds(const RobotStateCoM& com_state, const GaitMap& gait_map);
+
+  /** @brief FK of all legs (body frame) */
+  void forwardKinematicsStage();
+
+  /** @brief Plan footholds and foot trajectories if replanning this tick */
+  void footholdStage();
+
+  /** @brief Swing leg reference joint states from the foot trajectories */
+  void swingStage();
+
+  /** @brief Joint PD control of the swing legs */
+  void jointControlStage();
+
+  /** @brief GRFs of the stance legs */
+  void balanceStage();
+
+  /** @brief Stance leg torques J.T*f merged with the swing leg torques */
+  void torqueMergeStage();
+
+  /**
+   * @brief Swing leg reference joint states of a leg
+   * @param leg - index into the leg names
+   * @details Reads the COM state and gait of the current tick, run by the leg
+   * executor.
+   */
+  void swingReference(std::size_t leg);
+
+  /**
+   * @brief Start timing a stage
+   * @param stage - stage, stages running at the same time are timed independently
+   */
+  void stageStart(PipelineStage stage);
+
+  /** @brief Stop timing a stage */
+  void stageEnd(PipelineStage stage);
+
+private:
+  ControlPipelineConfig config_;
+
+  BalanceController balance_controller_;        // GRF control
+  // GRF control while standing, null unless use_lqr_stance
+  std::unique_ptr<const LQRBalanceController> lqr_controller_;
+  NonlinearMPC nonlinear_mpc_;                  // GRF control over a horizon
+  JointController joint_controller_;            // swing leg PD control
+  const QuadrupedKinematics kinematics_;        // kinematic model
+  const FootPlanner foothold_planner_;          // foothold planner
+  const FootTrajectoryManager foot_traj_manager_;  // foot trajectories
+  LegExecutor leg_executor_;                    // per leg work of a tick
+  realtime::RcuCell<ControlGains> gains_;       // gains published by updateGains()
+  ControlGains tick_gains_;                     // gains taken up by the ticks
+  uint64_t gain_updates_;                       // updates taken up by the ticks
+
+  // Desired COM state
+  mat Rwb_d_;    // orientation in world
+  vec3 x_d_;     // position in world
+  vec3 xdot_d_;  // linear velocity
+  vec3 w_d_;     // angular velocity
+
+  vec Vb_;                        // user commanded body twist
+  bool cmd_received_;             // new user command
+  bool standing_;                 // standing height achieved
+  bool new_footholds_;            // footholds planned on last tick
+  DegradationMode mode_;          // cheaper mode after deadline misses
+  BalanceSolver balance_solver_;  // controller of the GRFs on the last tick
+  bool balance_solved_;           // GRFs solved for on the last tick
+
+  JointStatesMap stand_js_map_;     // standing joint states
+
+  FootholdMap foot_actual_map_;     // foot positions (body frame)
+  JacobianMap jacobian_map_;        // foot Jacobians for the torque limited QP
+  FootholdMap foothold_final_map_;  // planned footholds (world frame)
+  ForceMap force_map_;              // GRFs (body frame)
+  TorqueMap torque_map_;            // joint torques
+
+  // Inputs of the current tick read by the stages
+  const RobotStateCoM* tick_com_state_;
+  const JointStatesMap* tick_joint_states_map_;
+  const GaitMap* tick_gait_map_;
+  bool tick_gait_running_;
+  bool replanning_;  // footholds are planned this tick
+
+  // Swing leg references of the current tick, written per leg
+  std::vector<LegJointStates> swing_js_;  // reference joint states
+  std::vector<uint8_t> swing_legs_;       // leg is in swing, not a vector<bool>
+  const std::function<void(std::size_t)> swing_fn_;
+  TorqueMap swing_torque_map_;  // swing leg joint torques
+
+  std::unique_ptr<realtime::TaskGraph> task_graph_;  // stages, null to run in sequence
+
+  PipelineStats stats_;
+  uint64_t (*allocation_counter_)();
+  std::array<int64_t, num_pipeline_stages> stage_start_ns_{};
+  std::array<uint64_t, num_pipeline_stages> stage_start_allocations_{};
+};
+}  // namespace quadruped_controller
+#endif
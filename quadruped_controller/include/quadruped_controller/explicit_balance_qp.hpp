@@ -0,0 +1,259 @@
+/**
+ * @file explicit_balance_qp.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Explicit solution of the balance QP for common contact patterns
+ *
+ * @details For a contact pattern the balance QP has a fixed structure and its optimum
+ * is a piecewise affine function of the desired wrench and the stance foot positions.
+ * Each piece, or region, is identified by the set of active friction pyramid and
+ * normal force inequalities. The regions are found offline by solving the QP over a
+ * bounded parameter box and stored with a k-d tree over the parameter samples
+ * (explicit_qp_generator). Online the tree gives the candidate regions in O(log
+ * samples), the affine law of a region is evaluated from the KKT system of its active
+ * set, and the result is only accepted if it is primal and dual feasible, which is
+ * exactly the test that the parameter lies in the region. Otherwise the caller solves
+ * the QP.
+ *
+ *    ExplicitBalanceQP explicit_qp(mu, fzmin, fzmax, S, W);
+ *    explicit_qp.load("stand_trot.eqp");
+ *    const vec theta = explicit_qp.parameters(stance_mask, Rwb, ft_p, b);
+ *    if (!explicit_qp.solve(stance_mask, theta, Q, c, fw, region)) { solve the QP }
+ */
+#ifndef EXPLICIT_BALANCE_QP_HPP
+#define EXPLICIT_BALANCE_QP_HPP
+
+// C++
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat;
+using arma::vec;
+
+constexpr uint32_t EXPLICIT_QP_VERSION = 1;
+constexpr unsigned int EXPLICIT_QP_NUM_LEGS = 4;  // legs in order [RL FL RR FR]
+constexpr unsigned int EXPLICIT_QP_INEQUALITIES = 6;  // inequalities per stance leg
+constexpr unsigned int EXPLICIT_QP_MAX_DIM = 6 + 3 * EXPLICIT_QP_NUM_LEGS;
+
+/**
+ * @brief Return the stance legs of a gait schedule
+ * @param gait_map - gait schedule
+ * @param leg_names - legs names [RL FL RR FR]
+ * @return bit i is set if leg i is in stance
+ */
+uint32_t stance_mask(const GaitMap& gait_map, const std::vector<std::string>& leg_names);
+
+/**
+ * @brief Return the stance mask of a contact pattern name
+ * @param name - stand, trot, pace, or bound
+ * @return stance masks of the pattern, empty if the name is unknown
+ * @details Trot, pace, and bound have two stance masks, one per pair of legs.
+ */
+std::vector<uint32_t> contact_pattern_masks(const std::string& name);
+
+/** @brief Node of the k-d tree over the parameter samples of a pattern */
+struct ExplicitQPNode
+{
+  int32_t split_dim;   // split dimension, -1 for a leaf
+  uint32_t first;      // left child, or the first sample of a leaf
+  uint32_t second;     // right child, or one past the last sample of a leaf
+  uint32_t reserved;   // padding
+  double split_value;  // samples below the value are in the left child
+};
+
+/** @brief Explicit solution of the balance QP for one set of stance legs */
+struct ExplicitQPPattern
+{
+  uint32_t stance_mask = 0;                // bit i is set if leg i is in stance
+  unsigned int dim = 0;                    // parameter dimension 6 + 3*stance legs
+  vec center;                              // center of the parameter box
+  vec scale;                               // inverse half width of the parameter box
+  std::vector<uint32_t> regions;           // active inequalities of each region
+  mat samples;                             // normalized parameters, one per column
+  std::vector<uint32_t> sample_regions;    // region of each sample
+  std::vector<ExplicitQPNode> nodes;       // k-d tree, root first
+};
+
+/** @brief Parameter box the explicit solution of a pattern is computed over */
+struct ExplicitQPSampling
+{
+  uint32_t stance_mask = 0xF;     // stance legs
+  mat feet;                       // nominal feet relative to the COM (3x4)
+  double foot_range = 0.05;       // max foot offset from nominal in x and y (m)
+  double foot_height_range = 0.03;  // max foot offset from nominal in z (m)
+  vec3 force_min = { -40.0, -40.0, 20.0 };  // min desired net force (N)
+  vec3 force_max = { 40.0, 40.0, 200.0 };   // max desired net force (N)
+  vec3 moment_max = { 10.0, 15.0, 10.0 };   // max desired net moment about the COM (N*m)
+  unsigned int samples = 20000;   // QP solves
+  unsigned int seed = 0;          // random number generator seed
+};
+
+/** @brief Result of computing the explicit solution of a pattern */
+struct ExplicitQPSamplingStats
+{
+  unsigned int solved = 0;      // samples added to the pattern
+  unsigned int failed = 0;      // QP failed to solve
+  unsigned int degenerate = 0;  // optimal active set could not be verified
+};
+
+/** @brief Explicit balance QP lookup table */
+class ExplicitBalanceQP
+{
+public:
+  /**
+   * @brief Constructor
+   * @param mu - friction coefficient
+   * @param fzmin - minimum z-axis ground reaction force (N)
+   * @param fzmax - maximum z-axis ground reaction force (N)
+   * @param S - positive-definite weight matrix on least squares (6x6)
+   * @param W - positive-definite weight matrix on GRFs (12x12)
+   * @details The parameters must match the BalanceController the table is used with.
+   */
+  ExplicitBalanceQP(double mu, double fzmin, double fzmax, const mat& S, const mat& W);
+
+  /**
+   * @brief Load a table
+   * @param path - file written by save()
+   * @return true if the table is valid and was computed for the same parameters
+   */
+  bool load(const std::string& path);
+
+  /**
+   * @brief Save the table
+   * @param path - file path, truncated if it exists
+   * @return true if the table was written
+   */
+  bool save(const std::string& path) const;
+
+  /**
+   * @brief Compute the explicit solution of a pattern by sampling its parameter box
+   * @param sampling - stance legs and parameter box
+   * @return number of samples added and rejected
+   * @details Replaces the pattern if it already exists. Each sample is solved with
+   * qpOASES and its active set is verified before it is added.
+   */
+  ExplicitQPSamplingStats generate(const ExplicitQPSampling& sampling);
+
+  /**
+   * @brief Add the explicit solution of a pattern
+   * @param stance_mask - stance legs
+   * @param center - center of the parameter box
+   * @param half_width - half width of the parameter box
+   * @param parameters - parameter samples, one per column
+   * @param active_sets - optimal active set of each sample
+   * @details Samples with the same active set share a region. Builds the k-d tree.
+   */
+  void addPattern(uint32_t stance_mask, const vec& center, const vec& half_width,
+                  const mat& parameters, const std::vector<uint32_t>& active_sets);
+
+  /**
+   * @brief Compose the parameters of the QP
+   * @param stance_mask - stance legs
+   * @param Rwb - rotation from world to base_link (3x3)
+   * @param ft_p - positions of feet in body frame (3x4)
+   * @param b - desired wrench [force, moment about the COM] in world frame (6x1)
+   * @return desired wrench and stance foot positions relative to the COM in the
+   * heading frame (6 + 3*stance legs)
+   * @details The heading frame is the world frame rotated by the yaw of the body. Only
+   * the friction pyramid depends on yaw so few regions change with it, and the
+   * solution does not rely on it because every region is verified.
+   */
+  vec parameters(uint32_t stance_mask, const mat& Rwb, const mat& ft_p,
+                 const vec& b) const;
+
+  /**
+   * @brief Compose the QP of a parameter in the heading frame
+   * @param stance_mask - stance legs
+   * @param theta - parameters from parameters()
+   * @param Q[out] - Hessian of 1/2*x.T*Q*x + x.T*c (12x12)
+   * @param c[out] - linear cost (12x1)
+   */
+  void problem(uint32_t stance_mask, const vec& theta, mat& Q, vec& c) const;
+
+  /**
+   * @brief Solve the QP with the given active set
+   * @param stance_mask - stance legs
+   * @param active_set - bit j is set if inequality j of the stance legs is active
+   * @param Q - Hessian (12x12)
+   * @param c - linear cost (12x1)
+   * @param fw[out] - GRFs in world frame, zero for swing legs (12x1)
+   * @return true if the solution is primal and dual feasible and therefore optimal
+   */
+  bool solveActiveSet(uint32_t stance_mask, uint32_t active_set, const mat& Q,
+                      const vec& c, vec& fw) const;
+
+  /**
+   * @brief Look up the explicit solution
+   * @param stance_mask - stance legs
+   * @param theta - parameters from parameters()
+   * @param Q - Hessian (12x12)
+   * @param c - linear cost (12x1)
+   * @param fw[out] - GRFs in world frame, zero for swing legs (12x1)
+   * @param region[in,out] - region of the last solution, tried first, -1 if none
+   * @return true if fw is the optimum, false if the QP must be solved
+   */
+  bool solve(uint32_t stance_mask, const vec& theta, const mat& Q, const vec& c,
+             vec& fw, int& region) const;
+
+  /** @brief Return true if the table has an explicit solution for the stance legs */
+  bool hasPattern(uint32_t stance_mask) const;
+
+  /** @brief Return the patterns */
+  const std::vector<ExplicitQPPattern>& patterns() const;
+
+  /**
+   * @brief Check the weights the table was computed for
+   * @param S - weight matrix on least squares (6x6)
+   * @param W - weight matrix on GRFs (12x12)
+   * @return true if the solutions are valid for the weights
+   */
+  bool hasWeights(const mat& S, const mat& W) const;
+
+  /** @brief Return the file the table was loaded from, empty if none */
+  const std::string& path() const;
+
+  /** @brief Return the FNV-1a hash of the loaded file, 0 if none was loaded */
+  uint64_t fingerprint() const;
+
+private:
+  /** @brief Return the pattern of the stance legs, nullptr if there is none */
+  const ExplicitQPPattern* findPattern(uint32_t stance_mask) const;
+
+  /**
+   * @brief Compose the inequalities G*f <= h on the stance GRFs
+   * @param stance_mask - stance legs
+   * @param G[out] - inequality matrix (6*stance legs x 3*stance legs)
+   * @param h[out] - inequality bounds (6*stance legs)
+   */
+  void inequalities(uint32_t stance_mask, mat& G, vec& h) const;
+
+  /**
+   * @brief Build the k-d tree of a pattern
+   * @param pattern[in,out] - pattern with samples, the samples are reordered
+   * @param order[in,out] - sample indices, partitioned in place
+   * @param first - first sample of the subtree
+   * @param last - one past the last sample of the subtree
+   * @return index of the subtree root
+   */
+  uint32_t buildTree(ExplicitQPPattern& pattern, std::vector<uint32_t>& order,
+                     uint32_t first, uint32_t last) const;
+
+private:
+  double mu_;             // coefficient of friction
+  double fzmin_, fzmax_;  // min and max normal reaction force (N)
+  mat S_;                 // weight on least squares (6x6)
+  mat W_;                 // weight on GRFs (12x12)
+
+  std::vector<ExplicitQPPattern> patterns_;  // explicit solution per set of stance legs
+
+  std::string path_;      // file loaded
+  uint64_t fingerprint_;  // hash of the file loaded
+};
+}  // namespace quadruped_controller
+#endif
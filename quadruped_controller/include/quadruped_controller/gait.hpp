@@ -51,6 +51,15 @@ public:
   /** @brief Get the current gait schedule */
   GaitMap schedule() const;
 
+  /**
+   * @brief Compose the gait schedule at a given time
+   * @param t - time since the gait started (s)
+   * @return gait schedule
+   * @details Does not use the worker thread, the phases are composed
+   * directly from the phase offsets. Useful for deterministic playback.
+   */
+  GaitMap schedule(double t) const;
+
 private:
   /** @brief Run gait schedule in a separate thread */
   void execute() const;
@@ -0,0 +1,143 @@
+/**
+ * @file gait_table.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief One gait cycle precomputed for playback
+ *
+ * @details The leg phases, swing trajectories, joint positions, and support
+ * polygons of a full gait cycle are computed once at a fixed resolution, each
+ * quantity in its own pass over all samples. Playback then only looks up the
+ * sample at the playback time, so it can run at any speed, backwards, or jump to
+ * any phase of the cycle.
+ *
+ *    const GaitTable table(config, leg_names);
+ *    const unsigned int sample = table.index(t);
+ *    const double* q = table.jointPositions(sample);
+ */
+#ifndef GAIT_TABLE_HPP
+#define GAIT_TABLE_HPP
+
+// C++
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+/** @brief Gait and body state the table is computed for */
+struct GaitTableConfig
+{
+  double t_swing = 0.3;   // swing time (s)
+  double t_stance = 0.3;  // stance time (s)
+  double height = 0.08;   // max foot height (m)
+  vec offset;             // phase offsets of the legs
+  double dt = 0.001;      // time between samples (s)
+
+  mat33 Rwb = arma::eye(3, 3);      // body orientation
+  vec3 x = { 0.0, 0.0, 0.0 };       // body position (m)
+  vec3 xdot = { 0.0, 0.0, 0.0 };    // body linear velocity (m/s)
+  vec3 w = { 0.0, 0.0, 0.0 };       // body angular velocity (rad/s)
+  vec3 xdot_d = { 0.0, 0.0, 0.0 };  // desired linear velocity (m/s)
+  vec q_stance;                     // joints of stance legs, 3 per leg (rad)
+};
+
+/** @brief Stance legs of a sample ordered around the support polygon */
+struct SupportLegs
+{
+  uint8_t size = 0;                  // number of stance legs
+  std::array<uint8_t, 4> legs = {};  // leg indices, counterclockwise
+};
+
+/**
+ * @brief Gait cycle sampled at a fixed resolution
+ * @details The body stays at the configured pose, stance feet stay at the feet
+ * positions of q_stance, and swing feet follow the planned trajectories between
+ * them and the planned footholds. Samples are stored column wise.
+ */
+class GaitTable
+{
+public:
+  /**
+   * @brief Constructor
+   * @param config - gait and body state
+   * @param leg_names - legs in the order of the phase offsets and joint positions
+   * @details Four legs at most.
+   */
+  GaitTable(const GaitTableConfig& config, const std::vector<std::string>& leg_names);
+
+  /** @brief Return the number of samples in a cycle */
+  unsigned int size() const;
+
+  /** @brief Return the duration of a cycle (s) */
+  double period() const;
+
+  /** @brief Return the time between samples (s) */
+  double dt() const;
+
+  /**
+   * @brief Find the sample at a time
+   * @param t - playback time, wrapped onto the cycle, may be negative (s)
+   * @return sample index
+   */
+  unsigned int index(double t) const;
+
+  /**
+   * @brief Get the phase of a leg
+   * @param sample - sample index
+   * @param leg - leg index
+   * @return phase [0 1)
+   */
+  double phase(unsigned int sample, unsigned int leg) const;
+
+  /** @brief Return true if a leg is in swing at a sample */
+  bool swing(unsigned int sample, unsigned int leg) const;
+
+  /**
+   * @brief Get the foot position of a leg
+   * @param sample - sample index
+   * @param leg - leg index
+   * @return position in world frame (m)
+   */
+  vec3 footPosition(unsigned int sample, unsigned int leg) const;
+
+  /**
+   * @brief Get the joint positions of a sample
+   * @param sample - sample index
+   * @return pointer to the 3 joint positions of each leg in leg order (rad)
+   */
+  const double* jointPositions(unsigned int sample) const;
+
+  /** @brief Return the stance legs of a sample around the support polygon */
+  const SupportLegs& supportLegs(unsigned int sample) const;
+
+private:
+  /** @brief Leg phases and states of every sample */
+  void schedulePass(const GaitTableConfig& config);
+
+  /** @brief Plan the footholds and swing trajectories, then the feet of every sample */
+  void footPass(const GaitTableConfig& config);
+
+  /** @brief Joint positions of every sample */
+  void inverseKinematicsPass(const GaitTableConfig& config);
+
+  /** @brief Support polygon of every sample */
+  void supportPass();
+
+private:
+  std::vector<std::string> leg_names_;  // leg order
+  double period_;                       // cycle duration (s)
+  double dt_;                           // time between samples (s)
+  unsigned int size_;                   // samples per cycle
+
+  mat phases_;                            // leg phases (legs x samples)
+  std::vector<uint8_t> swing_;            // leg in swing (legs x samples)
+  mat feet_;                              // foot positions (3*legs x samples)
+  mat joints_;                            // joint positions (3*legs x samples)
+  std::vector<SupportLegs> support_;      // support polygon of each sample
+};
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,218 @@
+/**
+ * @file flight_recorder.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Always-on in-memory ring buffer of recent control ticks
+ *
+ * @details The control loop writes one fixed size record per tick into a
+ * preallocated ring. Writing is a handful of stores and never blocks or
+ * allocates. When something goes wrong the control loop only flags a dump request,
+ * a background thread copies the last N ticks out of the ring and writes them to
+ * disk. A crash file is created and mapped up front so a SIGSEGV handler only has
+ * to memcpy into it.
+ */
+#ifndef FLIGHT_RECORDER_HPP
+#define FLIGHT_RECORDER_HPP
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+// Quadruped Control
+#include <quadruped_controller/control_pipeline.hpp>
+#include <quadruped_controller/io/tick_log.hpp>
+
+namespace quadruped_controller
+{
+namespace io
+{
+constexpr uint32_t FLIGHT_RECORDER_VERSION = 2;
+
+/** @brief Reason the flight recorder was dumped */
+enum DumpReason
+{
+  dump_request = 0,
+  qp_failure = 1,
+  deadline_miss = 2,
+  crash = 3
+};
+
+/** @brief Max recorders dumped by the crash handler */
+constexpr unsigned int MAX_CRASH_RECORDERS = 16;
+
+/** @brief Return the name of a dump reason */
+const char* dump_reason_name(DumpReason reason);
+
+/** @brief State of a single control tick */
+struct FlightRecord
+{
+  uint64_t tick;                // control tick count
+  double stamp;                 // time since start (s)
+  double tick_time;             // control tick duration (s)
+  double x[3];                  // COM position in world
+  double xdot[3];               // COM linear velocity in world
+  double w[3];                  // COM angular velocity in world
+  double Rwb[9];                // COM orientation, column major (3x3)
+  double x_d[3];                // desired COM position in world
+  double xdot_d[3];             // desired COM linear velocity in world
+  double w_d[3];                // desired COM angular velocity in world
+  double Rwb_d[9];              // desired COM orientation, column major (3x3)
+  double q[NUM_JOINTS];         // joint positions [RL FL RR FR]
+  double qdot[NUM_JOINTS];      // joint velocities [RL FL RR FR]
+  double phase[NUM_LEGS];       // gait phase [RL FL RR FR]
+  double force[NUM_JOINTS];     // GRFs in body frame [RL FL RR FR]
+  double torque[NUM_JOINTS];    // commanded joint torques [RL FL RR FR]
+  double qp_cpu_time;           // QP solve time (s), 0 unless the QP ran this tick
+  int32_t qp_return_value;      // qpOASES returnValue, 0 unless the QP ran this tick
+  int32_t qp_iterations;        // QP working set recalculations, 0 unless the QP ran
+  uint8_t leg_state[NUM_LEGS];  // LegState [RL FL RR FR]
+  uint8_t balance_solver;       // BalanceSolver that produced the GRFs this tick
+  uint8_t balance_solved;       // the balance solver succeeded this tick
+  uint8_t degradation_mode;     // DegradationMode
+  uint8_t padding[1];
+};
+
+/** @brief Flight recorder dump file header */
+struct FlightRecorderHeader
+{
+  char magic[8];          // "QPFLIGHT"
+  uint32_t version;       // FLIGHT_RECORDER_VERSION
+  uint32_t record_size;   // sizeof(FlightRecord)
+  uint64_t num_records;   // records in chronological order
+  uint64_t trigger_tick;  // tick that triggered the dump
+  uint32_t reason;        // DumpReason
+  uint32_t padding;
+  double frequency;       // control frequency (Hz)
+};
+
+static_assert(std::is_trivially_copyable<FlightRecord>::value,
+              "FlightRecord must be trivially copyable");
+static_assert(sizeof(FlightRecord) % alignof(double) == 0,
+              "FlightRecord must keep records aligned");
+
+/**
+ * @brief Lock-free ring buffer of the most recent control ticks
+ * @details Single writer (the control loop). Each slot carries a sequence number
+ * so a snapshot taken concurrently with a write, or from a signal handler that
+ * interrupted a write, skips the torn record.
+ */
+class FlightRecorder
+{
+public:
+  /**
+   * @brief Constructor
+   * @param capacity - number of ticks held in memory
+   * @param frequency - control frequency (Hz)
+   * @param directory - directory dump files are written to
+   * @param name - prefix of the dump file names, unique per recorder in a process
+   */
+  FlightRecorder(std::size_t capacity, double frequency, const std::string& directory,
+                 const std::string& name = "flight_recorder");
+
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  /**
+   * @brief Record a control tick
+   * @param stamp - time since start (s)
+   * @param tick_time - control tick duration (s)
+   * @param com_state - COM state in world frame
+   * @param joint_states_map - actual joint states
+   * @param gait_map - gait schedule for this tick
+   * @param pipeline - control pipeline after update()
+   * @return record of the tick, valid until the next call
+   */
+  const FlightRecord& record(double stamp, double tick_time,
+                             const RobotStateCoM& com_state,
+                             const JointStatesMap& joint_states_map,
+                             const GaitMap& gait_map, const ControlPipeline& pipeline);
+
+  /**
+   * @brief Request a dump of the ring to a new file in the background
+   * @param reason - reason for the dump
+   * @param force - ignore the cool down between automatic dumps
+   * @return true if the dump was requested, false if it was skipped
+   * @details Never blocks or allocates, the writer thread snapshots the ring and
+   * writes it to <directory>/<name>_<pid>_<tick>_<reason>.bin within a poll period.
+   * Automatic dumps are skipped while a dump is being written and until the ring
+   * has been refilled since the last dump, so a fault that repeats every tick does
+   * not flood the disk.
+   */
+  bool dump(DumpReason reason, bool force = false);
+
+  /**
+   * @brief Dump the ring into the preallocated crash file
+   * @details Async-signal-safe, only copies memory.
+   */
+  void dumpCrash();
+
+  /**
+   * @brief Install SIGSEGV, SIGBUS, SIGFPE, and SIGABRT handlers that dump this
+   * recorder to the crash file and then re-raise the signal
+   * @details Up to MAX_CRASH_RECORDERS recorders in a process are dumped.
+   */
+  void installCrashHandler();
+
+  /** @brief Return the number of ticks recorded */
+  uint64_t size() const;
+
+  /** @brief Return the number of ticks held in memory */
+  std::size_t capacity() const;
+
+private:
+  /** @brief Ring buffer slot */
+  struct Slot
+  {
+    std::atomic<uint64_t> seq{ 0 };  // odd while being written
+    FlightRecord record;
+  };
+
+  /**
+   * @brief Copy the ring in chronological order
+   * @param records[out] - buffer of at least capacity() records
+   * @return number of records copied
+   */
+  std::size_t snapshot(FlightRecord* records) const;
+
+  /** @brief Write pending dumps to disk */
+  void writerThread();
+
+private:
+  std::size_t capacity_;         // ring size (ticks)
+  double frequency_;             // control frequency (Hz)
+  std::string directory_;        // dump directory
+  std::string name_;             // dump file prefix
+  std::unique_ptr<Slot[]> ring_;  // ring buffer
+  std::atomic<uint64_t> head_;   // ticks written
+
+  // Background dump, the writer thread owns the pending request while writing_ is set
+  std::unique_ptr<FlightRecord[]> pending_;  // snapshot written by the writer thread
+  DumpReason pending_reason_;                // reason of the requested dump
+  uint64_t pending_tick_;                    // tick that requested the dump
+  std::atomic<bool> writing_;                // a dump is requested or being written
+  std::atomic<bool> requested_;              // pending reason and tick are set
+  uint64_t last_dump_tick_;                  // tick of the last automatic dump
+  bool dumped_;                              // at least one automatic dump
+  bool running_;                             // writer thread running
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread writer_;
+
+  // Crash dump
+  std::string crash_path_;  // preallocated crash file
+  int crash_fd_;            // crash file descriptor
+  void* crash_map_;         // mapped crash file
+  std::size_t crash_size_;  // mapped bytes
+  std::atomic<bool> crashed_;  // crash file written
+};
+}  // namespace io
+}  // namespace quadruped_controller
+#endif
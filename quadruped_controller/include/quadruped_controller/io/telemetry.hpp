@@ -0,0 +1,347 @@
+/**
+ * @file telemetry.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Columnar binary telemetry log
+ *
+ * @details A telemetry log has a fixed schema of signals, each a fixed number of
+ * values of one type per row. Rows are stored in chunks and each chunk stores its
+ * signals as columns, optionally LZ4 compressed. The control loop scatters a row
+ * into the columns of a preallocated chunk and full chunks are written by a
+ * background thread. The reader maps the file and returns the uncompressed
+ * columns as spans into the mapping.
+ *
+ *    file:  TelemetryFileHeader, TelemetrySignal[num_signals], chunks...
+ *    chunk: TelemetryChunkHeader, uint64_t column_size[num_signals], columns...
+ *
+ * A column holds rows * width values, row major, and is padded to 8 bytes. A
+ * column is LZ4 compressed if its size is below rows * width * value size.
+ */
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/io/flight_recorder.hpp>
+#include <quadruped_controller/realtime/spsc_queue.hpp>
+
+namespace quadruped_controller
+{
+namespace io
+{
+constexpr uint32_t TELEMETRY_VERSION = 1;
+
+/** @brief Max chunks buffered between the control loop and the writer thread */
+constexpr std::size_t MAX_TELEMETRY_CHUNKS = 64;
+
+/** @brief Value type of a signal */
+enum TelemetryType
+{
+  float64 = 0,
+  int32 = 1,
+  uint64 = 2,
+  uint8 = 3
+};
+
+/** @brief Return the size of a value in bytes, 0 if the type is unknown */
+std::size_t telemetry_type_size(TelemetryType type);
+
+/** @brief Return the name of a value type */
+const char* telemetry_type_name(TelemetryType type);
+
+/** @brief Return the value type of a C++ type */
+template <class T>
+constexpr TelemetryType telemetry_type()
+{
+  static_assert(std::is_same<T, double>::value || std::is_same<T, int32_t>::value ||
+                    std::is_same<T, uint64_t>::value || std::is_same<T, uint8_t>::value,
+                "Telemetry values are double, int32_t, uint64_t, or uint8_t");
+  if constexpr (std::is_same<T, double>::value)
+  {
+    return TelemetryType::float64;
+  }
+  else if constexpr (std::is_same<T, int32_t>::value)
+  {
+    return TelemetryType::int32;
+  }
+  else if constexpr (std::is_same<T, uint64_t>::value)
+  {
+    return TelemetryType::uint64;
+  }
+  else
+  {
+    return TelemetryType::uint8;
+  }
+}
+
+/** @brief Signal of the schema */
+struct TelemetrySignal
+{
+  char name[24];    // null terminated
+  uint32_t type;    // TelemetryType
+  uint32_t width;   // values per row
+  uint32_t offset;  // byte offset of the values in the rows passed to the writer
+  uint32_t padding;
+};
+
+/** @brief Telemetry file header */
+struct TelemetryFileHeader
+{
+  char magic[8];         // "QPTELEM\0"
+  uint32_t version;      // TELEMETRY_VERSION
+  uint32_t num_signals;  // signals in the schema
+  uint32_t chunk_rows;   // max rows per chunk
+  uint32_t compressed;   // columns may be LZ4 compressed (0 or 1)
+  uint64_t num_chunks;   // chunks written, 0 until the log is closed
+  uint64_t num_rows;     // rows written, 0 until the log is closed
+  double frequency;      // row frequency (Hz)
+};
+
+/** @brief Chunk header */
+struct TelemetryChunkHeader
+{
+  char magic[4];          // "CHNK"
+  uint32_t rows;          // rows in the chunk
+  uint64_t payload_size;  // bytes of the column sizes and columns
+};
+
+static_assert(std::is_trivially_copyable<TelemetrySignal>::value &&
+                  sizeof(TelemetrySignal) % 8 == 0,
+              "TelemetrySignal must keep the chunks aligned");
+static_assert(sizeof(TelemetryFileHeader) % 8 == 0,
+              "TelemetryFileHeader must keep the chunks aligned");
+static_assert(sizeof(TelemetryChunkHeader) % 8 == 0,
+              "TelemetryChunkHeader must keep the columns aligned");
+
+/**
+ * @brief Compose a signal
+ * @param name - signal name, at most 23 characters
+ * @param type - value type
+ * @param width - values per row
+ * @param offset - byte offset of the values in the row
+ * @return signal
+ */
+TelemetrySignal make_telemetry_signal(const std::string& name, TelemetryType type,
+                                      uint32_t width, std::size_t offset);
+
+/** @brief Return the schema of a FlightRecord row */
+const std::vector<TelemetrySignal>& flight_record_signals();
+
+/** @brief Telemetry writer settings */
+struct TelemetrySettings
+{
+  uint32_t chunk_rows = 4096;  // rows per chunk
+  unsigned int chunks = 8;     // chunks buffered for the writer thread
+  bool compress = false;       // LZ4 compress the columns
+};
+
+/**
+ * @brief Columnar telemetry writer
+ * @details append() is called by one thread. It copies the signals of a row into
+ * the columns of the current chunk and never blocks or allocates. Full chunks are
+ * handed to a background thread that compresses and writes them. If the writer
+ * thread falls behind and all chunks are full the rows are dropped.
+ */
+class TelemetryWriter
+{
+public:
+  TelemetryWriter();
+
+  ~TelemetryWriter();
+
+  TelemetryWriter(const TelemetryWriter&) = delete;
+  TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+  /**
+   * @brief Create a new log and start the writer thread
+   * @param path - file path, truncated if it exists
+   * @param signals - schema, the offsets refer to the rows passed to append()
+   * @param row_size - bytes of a row
+   * @param frequency - row frequency (Hz)
+   * @param settings - chunk size, buffering, and compression
+   * @return true if the log was created
+   * @details Without LZ4 support the columns are stored uncompressed.
+   */
+  bool open(const std::string& path, const std::vector<TelemetrySignal>& signals,
+            std::size_t row_size, double frequency,
+            const TelemetrySettings& settings = TelemetrySettings());
+
+  /**
+   * @brief Append a row
+   * @param row - row of row_size bytes
+   * @return false if the row was dropped
+   */
+  bool append(const void* row);
+
+  /** @brief Append a flight record, the log must use flight_record_signals() */
+  bool append(const FlightRecord& record)
+  {
+    return append(static_cast<const void*>(&record));
+  }
+
+  /** @brief Write the last chunk, stop the writer thread, and close the file */
+  void close();
+
+  /** @brief Return true if a log is open */
+  bool isOpen() const;
+
+  /** @brief Return the number of rows appended */
+  uint64_t size() const;
+
+  /** @brief Return the number of rows dropped */
+  uint64_t dropped() const;
+
+private:
+  /** @brief Hand the current chunk to the writer thread */
+  void submit();
+
+  /** @brief Write submitted chunks until closed */
+  void writerThread();
+
+  /**
+   * @brief Write a chunk
+   * @param chunk - chunk index
+   * @return true on success
+   */
+  bool writeChunk(uint32_t chunk);
+
+private:
+  int fd_;                                // file descriptor
+  std::vector<TelemetrySignal> signals_;  // schema
+  std::vector<std::size_t> value_sizes_;  // bytes per row of each signal
+  std::vector<std::size_t> columns_;      // column offsets in a chunk buffer
+  std::size_t row_size_;                  // bytes of a row passed to append()
+  std::size_t chunk_size_;                // bytes of a chunk buffer
+  TelemetrySettings settings_;            // chunk size, buffering, and compression
+  TelemetryFileHeader header_;            // written again on close
+
+  // Chunk buffers, each owned by either the appending or the writer thread
+  std::unique_ptr<unsigned char[]> buffers_;
+  std::vector<uint32_t> rows_;  // rows in each chunk buffer
+  realtime::SPSCQueue<uint32_t, MAX_TELEMETRY_CHUNKS> full_;  // to the writer thread
+  realtime::SPSCQueue<uint32_t, MAX_TELEMETRY_CHUNKS> free_;  // to the appending thread
+  uint32_t chunk_;                 // chunk being appended to
+  bool have_chunk_;                // a chunk is being appended to
+  uint64_t appended_;              // rows appended
+  std::atomic<uint64_t> dropped_;  // rows dropped
+
+  // Writer thread, owns the file after open
+  std::vector<unsigned char> scratch_;  // column sizes and compressed columns
+  bool running_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread writer_;
+};
+
+/** @brief Memory mapped telemetry reader */
+class TelemetryReader
+{
+public:
+  TelemetryReader();
+
+  ~TelemetryReader();
+
+  TelemetryReader(const TelemetryReader&) = delete;
+  TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+  /**
+   * @brief Open a log
+   * @param path - file path
+   * @return true if the log is valid
+   * @details The chunks are indexed, a log cut short by a killed process is read up
+   * to its last complete chunk.
+   */
+  bool open(const std::string& path);
+
+  /** @brief Unmap the log */
+  void close();
+
+  /** @brief Return the file header */
+  const TelemetryFileHeader& header() const;
+
+  /** @brief Return the schema */
+  std::span<const TelemetrySignal> signals() const;
+
+  /**
+   * @brief Find a signal
+   * @param name - signal name
+   * @return signal index, -1 if there is none
+   */
+  int find(const std::string& name) const;
+
+  /** @brief Return the number of chunks */
+  std::size_t numChunks() const;
+
+  /** @brief Return the number of rows in a chunk */
+  uint32_t chunkRows(std::size_t chunk) const;
+
+  /** @brief Return the number of rows */
+  uint64_t size() const;
+
+  /**
+   * @brief Get the bytes of a column of a chunk
+   * @param chunk - chunk index
+   * @param signal - signal index
+   * @return rows * width values of the signal type, row major, empty if the column
+   * cannot be decompressed
+   * @details Uncompressed columns point into the mapping. Compressed columns are
+   * decompressed once and kept until the log is closed.
+   */
+  std::span<const unsigned char> columnBytes(std::size_t chunk, std::size_t signal) const;
+
+  /**
+   * @brief Get a column of a chunk
+   * @tparam T - value type of the signal
+   * @param chunk - chunk index
+   * @param signal - signal index
+   * @return rows * width values, row major, empty if T is not the signal type or the
+   * column cannot be decompressed
+   */
+  template <class T>
+  std::span<const T> column(std::size_t chunk, std::size_t signal) const
+  {
+    if (signals_[signal].type != telemetry_type<T>())
+    {
+      return {};
+    }
+
+    const std::span<const unsigned char> bytes = columnBytes(chunk, signal);
+    return { reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T) };
+  }
+
+private:
+  /** @brief Location of a chunk in the mapping */
+  struct Chunk
+  {
+    uint32_t rows;                     // rows in the chunk
+    const uint64_t* column_sizes;      // stored bytes of each column
+    std::vector<std::size_t> offsets;  // column offsets in the mapping
+  };
+
+private:
+  int fd_;                             // file descriptor
+  const unsigned char* map_;           // mapped file
+  std::size_t map_size_;               // mapped bytes
+  const TelemetryFileHeader* header_;  // file header
+  const TelemetrySignal* signals_;     // schema
+  std::vector<Chunk> chunks_;          // chunk index
+  uint64_t num_rows_;                  // rows in all chunks
+
+  // Decompressed columns, chunk major
+  mutable std::vector<std::unique_ptr<unsigned char[]>> decompressed_;
+};
+}  // namespace io
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,353 @@
+/**
+ * @file tick_log.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Binary record and replay of control pipeline ticks
+ *
+ * @details The log is a fixed size header followed by an append-only array of
+ * fixed size records. Each record holds the inputs of one control tick and the
+ * commanded joint torques. Gains updated while recording are stored in the header
+ * and each record counts the updates taken up by its tick. Files are written and read
+ * through mmap.
+ */
+#ifndef TICK_LOG_HPP
+#define TICK_LOG_HPP
+
+// C++
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Quadruped Control
+#include <quadruped_controller/control_pipeline.hpp>
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+namespace io
+{
+using arma::vec;
+
+constexpr uint32_t TICK_LOG_VERSION = 8;
+constexpr unsigned int TICK_LOG_MAX_GAIN_UPDATES = 64;  // gain updates stored per log
+constexpr unsigned int NUM_LEGS = 4;    // legs in order [RL FL RR FR]
+constexpr unsigned int NUM_JOINTS = 12;  // joints of all legs, [hip, thigh, calf] per leg
+
+/** @brief Leg order used for all per leg arrays in the log */
+const std::array<std::string, NUM_LEGS>& tick_log_leg_names();
+
+/** @brief Control pipeline parameters stored in the log header */
+struct TickLogConfig
+{
+  double t_stance;
+  double t_swing;
+  double height;
+  double mu;
+  double mass;
+  double fzmin;
+  double fzmax;
+  double Ib[9];    // column major (3x3)
+  double S[36];    // column major (6x6)
+  double W[144];   // column major (12x12)
+  double kff[6];
+  double kp_p[3];
+  double kd_p[3];
+  double kp_w[3];
+  double kd_w[3];
+  double jc_kff[3];
+  double jc_kp[3];
+  double jc_kd[3];
+  double tau_min;
+  double tau_max;
+  double x_stand[3];
+  double dt;
+  uint64_t torque_limited_qp;  // torque limits are balance QP constraints (0 or 1)
+  uint64_t qp_backend;         // QpBackendType
+  double admm_rho;
+  double admm_eps_abs;
+  double admm_eps_rel;
+  uint64_t admm_max_iterations;
+  uint64_t admm_warm_start;    // 0 or 1
+  uint64_t admm_polish;        // 0 or 1
+  uint64_t solve_rate_enabled;  // 0 or 1
+  double solve_rate_foot_tolerance;
+  double solve_rate_rotation_tolerance;
+  double solve_rate_force_tolerance;
+  double solve_rate_moment_tolerance;
+  uint64_t solve_rate_max_updates;
+  uint64_t use_nonlinear_mpc;  // 0 or 1
+  uint64_t mpc_horizon;
+  double mpc_dt;
+  double mpc_period;
+  double mpc_q[12];
+  double mpc_r;
+  double mpc_terminal_scale;
+  uint64_t mpc_max_iterations;
+  uint64_t mpc_max_outer_iterations;
+  double mpc_cost_tolerance;
+  double mpc_constraint_tolerance;
+  double mpc_penalty;
+  double mpc_penalty_scale;
+  double mpc_max_penalty;
+  double mpc_regularization;
+  uint64_t mpc_threads;
+  uint64_t use_lqr_stance;  // 0 or 1
+  double lqr_height_min;
+  double lqr_height_max;
+  uint64_t lqr_height_samples;
+  double lqr_angle_max;
+  uint64_t lqr_angle_samples;
+  double lqr_q[12];
+  double lqr_r;
+  double lqr_dt;
+  char explicit_qp_path[256];        // explicit balance QP file, empty if none
+  uint64_t explicit_qp_fingerprint;  // ExplicitBalanceQP::fingerprint(), 0 if none
+};
+
+/** @brief Gains taken up by the pipeline while recording */
+struct TickLogGains
+{
+  double S[36];   // column major (6x6)
+  double W[144];  // column major (12x12)
+  double kff[6];
+  double kp_p[3];
+  double kd_p[3];
+  double kp_w[3];
+  double kd_w[3];
+  double jc_kff[3];
+  double jc_kp[3];
+  double jc_kd[3];
+};
+
+/** @brief Log file header */
+struct TickLogHeader
+{
+  char magic[8];              // "QPTICKS\0"
+  uint32_t version;           // TICK_LOG_VERSION
+  uint32_t record_size;       // sizeof(TickRecord)
+  uint64_t num_records;       // records written
+  double frequency;           // control frequency (Hz)
+  TickLogConfig config;       // pipeline parameters at the start of recording
+  uint64_t num_gain_updates;  // gain updates while recording, stored or not
+  TickLogGains gain_updates[TICK_LOG_MAX_GAIN_UPDATES];  // first updates in order
+};
+
+/** @brief Inputs and outputs of a single control tick */
+struct TickRecord
+{
+  double stamp;                 // time since start of recording (s)
+  double x[3];                  // COM position in world
+  double xdot[3];               // COM linear velocity in world
+  double w[3];                  // COM angular velocity in world
+  double Rwb[9];                // COM orientation, column major (3x3)
+  double q[NUM_JOINTS];         // joint positions [RL FL RR FR]
+  double qdot[NUM_JOINTS];      // joint velocities [RL FL RR FR]
+  double Vb[6];                 // user commanded body twist
+  double phase[NUM_LEGS];       // gait phase [RL FL RR FR]
+  double torque[NUM_JOINTS];    // commanded joint torques [RL FL RR FR]
+  uint32_t gain_updates;        // gain updates taken up at or before this tick
+  uint8_t leg_state[NUM_LEGS];  // LegState [RL FL RR FR]
+  uint8_t cmd_received;         // new user command this tick
+  uint8_t gait_running;         // gait scheduler running
+  uint8_t degradation_mode;     // DegradationMode, 0 in logs recorded before it existed
+  uint8_t padding[5];
+};
+
+static_assert(std::is_trivially_copyable<TickLogHeader>::value,
+              "TickLogHeader must be trivially copyable");
+static_assert(std::is_trivially_copyable<TickRecord>::value,
+              "TickRecord must be trivially copyable");
+static_assert(sizeof(TickRecord) % alignof(double) == 0,
+              "TickRecord must keep records aligned");
+
+/**
+ * @brief Pack pipeline parameters into the log header format
+ * @param config - pipeline parameters
+ * @return parameters for the log header
+ */
+TickLogConfig pack_config(const ControlPipelineConfig& config);
+
+/**
+ * @brief Unpack pipeline parameters from the log header
+ * @param log_config - parameters from the log header
+ * @return pipeline parameters
+ * @details The explicit balance QP is not loaded, see explicit_qp_path.
+ */
+ControlPipelineConfig unpack_config(const TickLogConfig& log_config);
+
+/**
+ * @brief Pack gains into the log header format
+ * @param gains - gains taken up by the pipeline
+ * @return gains for the log header
+ */
+TickLogGains pack_gains(const ControlGains& gains);
+
+/** @brief Return the gains of a gain update from the log header */
+ControlGains unpack_gains(const TickLogGains& log_gains);
+
+/**
+ * @brief Pack the inputs of a control tick
+ * @param stamp - time since start of recording (s)
+ * @param com_state - COM state in world frame
+ * @param joint_states_map - actual joint states
+ * @param Vb - user commanded body twist
+ * @param cmd_received - true if Vb is a new command this tick
+ * @param gait_map - gait schedule for this tick
+ * @param gait_running - true if the gait scheduler is running
+ * @return record without torques
+ */
+TickRecord pack_inputs(double stamp, const RobotStateCoM& com_state,
+                       const JointStatesMap& joint_states_map, const vec& Vb,
+                       bool cmd_received, const GaitMap& gait_map, bool gait_running);
+
+/**
+ * @brief Pack commanded joint torques into a record
+ * @param torque_map - joint torques
+ * @param record[out] - record to update
+ */
+void pack_torques(const TorqueMap& torque_map, TickRecord& record);
+
+/** @brief Return COM state from a record */
+RobotStateCoM unpack_com_state(const TickRecord& record);
+
+/**
+ * @brief Unpack joint states from a record
+ * @param record - tick record
+ * @param joint_states_map[out] - joint states for all legs
+ */
+void unpack_joint_states(const TickRecord& record, JointStatesMap& joint_states_map);
+
+/** @brief Return the gait schedule from a record */
+GaitMap unpack_gait(const TickRecord& record);
+
+/** @brief Return the user commanded body twist from a record */
+vec unpack_cmd(const TickRecord& record);
+
+/** @brief Return the commanded joint torques from a record */
+TorqueMap unpack_torques(const TickRecord& record);
+
+/**
+ * @brief Append-only tick log writer
+ * @details The file is grown in chunks and mapped into memory so appending a
+ * record is a memcpy. The header record count is updated after each record so
+ * a log survives the process being killed.
+ */
+class TickLogWriter
+{
+public:
+  /**
+   * @brief Constructor
+   * @param chunk_records - number of records the file grows by
+   */
+  TickLogWriter(std::size_t chunk_records = 1 << 16);
+
+  ~TickLogWriter();
+
+  TickLogWriter(const TickLogWriter&) = delete;
+  TickLogWriter& operator=(const TickLogWriter&) = delete;
+
+  /**
+   * @brief Create a new log
+   * @param path - file path, truncated if it exists
+   * @param config - pipeline parameters
+   * @param frequency - control frequency (Hz)
+   * @return true if the log was created
+   */
+  bool open(const std::string& path, const ControlPipelineConfig& config,
+            double frequency);
+
+  /**
+   * @brief Append a record
+   * @param record - tick record, gain_updates is set by the writer
+   * @return true if the record was written
+   */
+  bool append(const TickRecord& record);
+
+  /**
+   * @brief Record gains taken up by the pipeline
+   * @param gains - gains used from the next appended record on
+   * @return false if the header has no room left, the update is still counted so
+   * the replay can tell the log is incomplete
+   */
+  bool appendGains(const ControlGains& gains);
+
+  /** @brief Unmap and truncate the file to the records written */
+  void close();
+
+  /** @brief Return true if a log is open */
+  bool isOpen() const;
+
+  /** @brief Return the number of records written */
+  uint64_t size() const;
+
+  /** @brief Return the number of gain updates recorded */
+  uint64_t gainUpdates() const;
+
+private:
+  /**
+   * @brief Grow the file and remap it
+   * @param capacity - new capacity in records
+   * @return true on success
+   */
+  bool reserve(std::size_t capacity);
+
+private:
+  std::size_t chunk_records_;  // records per file growth
+  std::size_t capacity_;       // records the mapping can hold
+  int fd_;                     // file descriptor
+  void* map_;                  // mapped file
+  std::size_t map_size_;       // mapped bytes
+};
+
+/** @brief Memory mapped tick log reader */
+class TickLogReader
+{
+public:
+  TickLogReader();
+
+  ~TickLogReader();
+
+  TickLogReader(const TickLogReader&) = delete;
+  TickLogReader& operator=(const TickLogReader&) = delete;
+
+  /**
+   * @brief Open a log
+   * @param path - file path
+   * @return true if the log is valid
+   */
+  bool open(const std::string& path);
+
+  /** @brief Unmap the log */
+  void close();
+
+  /** @brief Return the log header */
+  const TickLogHeader& header() const;
+
+  /** @brief Return the number of records */
+  uint64_t size() const;
+
+  /**
+   * @brief Return a record
+   * @param i - record index
+   */
+  const TickRecord& record(uint64_t i) const;
+
+  /**
+   * @brief Return a gain update
+   * @param i - update index, below the stored updates
+   */
+  const TickLogGains& gainUpdate(uint64_t i) const;
+
+private:
+  int fd_;                       // file descriptor
+  const void* map_;              // mapped file
+  std::size_t map_size_;         // mapped bytes
+  const TickLogHeader* header_;  // log header
+  const TickRecord* records_;    // first record
+  uint64_t num_records_;         // valid records
+};
+}  // namespace io
+}  // namespace quadruped_controller
+#endif
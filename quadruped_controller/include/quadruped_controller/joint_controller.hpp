@@ -19,6 +19,8 @@ class JointController
 public:
   JointController(const vec3& kff, const vec3& kp, const vec3& kd);
 
+  void setGains(const vec3& kff, const vec3& kp, const vec3& kd);
+
   TorqueMap control(const JointStatesMap& joints_ref_map,
                     const JointStatesMap& joints_map) const;
 
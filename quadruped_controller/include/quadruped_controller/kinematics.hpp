@@ -106,10 +106,33 @@ public:
   TorqueMap jacobianTransposeControl(const JointStatesMap& joint_states_map,
                                      const ForceMap& force_map) const;
 
+  /**
+   * @brief Return the translation from base_link to the hip of a leg
+   * @param leg_name - name of leg
+   * @return translation [x, y, z]
+   */
+  const vec3& hipTranslation(const std::string& leg_name) const;
+
+  /**
+   * @brief Return the link configuration of a leg
+   * @param leg_name - name of leg
+   * @return link lengths [l1, l2, l3] signed for the side of the leg
+   */
+  const vec3& legLinks(const std::string& leg_name) const;
+
 private:
   // Map leg name to leg link configuration and translation from base to hip
   std::map<std::string, std::pair<vec3, vec3>> link_map_;
   vec3 links_;  // lengths [l1 l2 l3]
 };
+
+/**
+ * @brief Transform a point in the world frame into the body frame
+ * @param Rwb - rotation from world to COM (3x3)
+ * @param x - COM position in the world frame
+ * @param p - point in the world frame
+ * @return point relative to base_link in the body frame, Rwb^T * (p - x)
+ */
+vec3 world_to_body(const mat33& Rwb, const vec3& x, const vec3& p);
 }  // namespace quadruped_controller
 #endif
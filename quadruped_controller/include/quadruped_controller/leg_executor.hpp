@@ -0,0 +1,151 @@
+/**
+ * @file leg_executor.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Runs the per leg work of a control tick
+ *
+ * @details Until the balance QP the legs of a tick are independent: forward
+ * kinematics, the swing leg reference, IK, and J^-1, and after the QP J.T*f of the
+ * stance legs. The executor runs this work in one of three ways
+ *
+ *    serial   - one leg after another on the tick thread
+ *    parallel - fanned out to a small worker pool, the tick thread takes legs too,
+ *               and joined before returning
+ *    batched  - FK and J.T*f of all legs at once in structure of arrays loops the
+ *               compiler can vectorize, the sines and cosines of the joint angles
+ *               are shared by both, everything else is serial
+ *
+ * A wake up of the pool costs about as much as the kinematics of a leg, so which one
+ * is fastest depends on the core count and load. Compare BM_LegExecutor* or run
+ * control_pipeline_harness --leg-executor on the target.
+ */
+#ifndef LEG_EXECUTOR_HPP
+#define LEG_EXECUTOR_HPP
+
+// C++
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/kinematics.hpp>
+#include <quadruped_controller/realtime/worker_pool.hpp>
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+/** @brief Ways to run the per leg work of a tick */
+enum LegExecutorType
+{
+  serial = 0,    // legs one after another
+  parallel = 1,  // legs on a worker pool
+  batched = 2,   // FK and J.T*f of all legs in structure of arrays loops
+  num_leg_executors = 3
+};
+
+/** @brief Return the name of a leg executor */
+const char* leg_executor_name(LegExecutorType type);
+
+/**
+ * @brief Return the leg executor of a name
+ * @param name - name from leg_executor_name()
+ * @param type[out] - leg executor
+ * @return false if the name is unknown
+ */
+bool leg_executor_from_name(const std::string& name, LegExecutorType& type);
+
+/** @brief Parameters of the leg executor */
+struct LegExecutorConfig
+{
+  LegExecutorType type = LegExecutorType::serial;
+  unsigned int threads = 3;  // pool threads of the parallel executor
+  std::vector<int> cpus;     // CPUs the pool threads are pinned to, empty to not pin
+};
+
+/** @brief Runs the independent per leg work of a tick */
+class LegExecutor
+{
+public:
+  /**
+   * @brief Constructor
+   * @param config - executor parameters
+   * @param leg_names - legs in the order of the work items
+   * @details The batched executor supports up to four legs, with more legs it runs
+   * serially.
+   */
+  LegExecutor(const LegExecutorConfig& config, const std::vector<std::string>& leg_names);
+
+  /**
+   * @brief Run work(i) for every leg i and wait for all of them
+   * @param work - called once per leg, concurrently with the parallel executor
+   */
+  void forEachLeg(const std::function<void(std::size_t)>& work);
+
+  /**
+   * @brief Compose the foot positions of all legs
+   * @param joint_states_map - joint states of all legs
+   * @param foot_map[out] - foot positions in body frame, existing entries are
+   * overwritten
+   */
+  void forwardKinematics(const JointStatesMap& joint_states_map, FootholdMap& foot_map);
+
+  /**
+   * @brief Compose the joint torques of the legs with a GRF
+   * @param joint_states_map - joint states of all legs
+   * @param force_map - GRFs in body frame
+   * @return joint torques J.T*f of the legs in the force map
+   */
+  TorqueMap jacobianTransposeControl(const JointStatesMap& joint_states_map,
+                                     const ForceMap& force_map);
+
+  /** @brief Return the executor type */
+  LegExecutorType type() const;
+
+private:
+  /** @brief Foot position of a leg */
+  void legForwardKinematics(std::size_t leg);
+
+  /** @brief J.T*f of a leg with a GRF */
+  void legJacobianTranspose(std::size_t leg);
+
+  /**
+   * @brief Load the joint angles and update the sines and cosines of all legs
+   * @param joint_states_map - joint states of all legs
+   * @details The trig terms are kept if the joint angles did not change, so J.T*f
+   * reuses the terms of the FK of the same tick.
+   */
+  void batchTrig(const JointStatesMap& joint_states_map);
+
+private:
+  static constexpr std::size_t BATCH_LEGS = 4;  // legs in the batched arrays
+  using Batch = std::array<double, BATCH_LEGS>;
+
+  LegExecutorType type_;                       // executor type
+  std::vector<std::string> leg_names_;         // leg order
+  const QuadrupedKinematics kinematics_;       // kinematic model
+  std::unique_ptr<realtime::WorkerPool> pool_;  // parallel executor threads
+
+  // Work of the current call, read by the per leg functions
+  const JointStatesMap* joint_states_map_;
+  const ForceMap* force_map_;
+  std::vector<vec3> feet_;     // foot positions
+  std::vector<vec3> torques_;  // joint torques
+  std::vector<uint8_t> has_force_;  // leg has a GRF, not a vector<bool> for concurrency
+
+  const std::function<void(std::size_t)> fk_fn_;
+  const std::function<void(std::size_t)> jacobian_fn_;
+
+  // Structure of arrays of the batched executor
+  Batch l1_, l2_, l3_;        // signed link lengths
+  Batch hx_, hy_, hz_;        // base to hip translation
+  Batch t1_, t2_, t3_;        // joint angles of the trig terms
+  Batch s1_, c1_, s2_, c2_;   // sin and cos of the hip and thigh angles
+  Batch s23_, c23_;           // sin and cos of the thigh plus calf angle
+  bool trig_valid_;           // trig terms computed
+};
+}  // namespace quadruped_controller
+#endif
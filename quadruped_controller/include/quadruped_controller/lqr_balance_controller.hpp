@@ -0,0 +1,124 @@
+/**
+ * @file lqr_balance_controller.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief LQR balance controller for standing and body posing
+ *
+ * @details The single rigid body is linearized about standing with all four feet on
+ * the ground. The discrete LQR gains are computed by the constructor for a grid of
+ * stance configurations (height, roll, pitch). Online the gains are interpolated at
+ * the desired configuration and the GRFs are projected onto the friction pyramids.
+ * There is no QP, so it is much cheaper than BalanceController but only valid while
+ * all legs are in stance.
+ *
+ *    LQRBalanceController lqr(lqr_config, mu, mass, fzmin, fzmax, Ib, stance_feet,
+ *                             leg_names);
+ *    const ForceMap force_map = lqr.control(com_state, desired_state, foot_map);
+ */
+#ifndef LQR_BALANCE_CONTROLLER_HPP
+#define LQR_BALANCE_CONTROLLER_HPP
+
+// C++
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat;
+using arma::mat33;
+using arma::vec3;
+
+/** @brief Parameters for the LQR balance controller */
+struct LQRBalanceConfig
+{
+  // Stance configurations the gains are computed for, roll and pitch are symmetric
+  double height_min = 0.18;          // min COM height above the feet (m)
+  double height_max = 0.32;          // max COM height above the feet (m)
+  unsigned int height_samples = 5;   // grid points in height
+  double angle_max = 0.4;            // max roll and pitch (rad)
+  unsigned int angle_samples = 5;    // grid points in roll and pitch
+
+  // Cost sum e.T*Q*e + r*|f - f_gravity|^2 with e = [p, v, phi, w] in world frame
+  vec12 q = { 300.0, 300.0, 300.0, 20.0, 20.0, 20.0, 200.0, 200.0, 200.0, 2.0, 2.0, 2.0 };
+  double r = 1e-3;  // weight on GRFs minus gravity compensation
+
+  double dt = 0.001;  // control period (s)
+};
+
+/**
+ * @brief Gain scheduled LQR on the single rigid body standing on four feet
+ * @details Errors and GRFs are expressed in the heading frame, the world frame
+ * rotated by the desired yaw, so the gains do not depend on yaw. The feet are
+ * assumed to stay below the hips while the body moves above them.
+ */
+class LQRBalanceController
+{
+public:
+  /**
+   * @brief Constructor
+   * @param config - LQR parameters
+   * @param mu - friction coefficient
+   * @param mass - total mass (kg)
+   * @param fzmin - minimum z-axis ground reaction force (N)
+   * @param fzmax - maximum z-axis ground reaction force (N)
+   * @param Ib - trunk moment of inertia in body frame (3x3)
+   * @param stance_feet - standing foot positions in body frame, only x and y are used
+   * @param leg_names - legs names [RL FL RR FR]
+   */
+  LQRBalanceController(const LQRBalanceConfig& config, double mu, double mass,
+                       double fzmin, double fzmax, const mat& Ib,
+                       const FootholdMap& stance_feet,
+                       const std::vector<std::string>& leg_names);
+
+  /**
+   * @brief Compose ground reaction forces
+   * @param com_state - COM state in world frame
+   * @param desired_state - desired COM state in world frame
+   * @param foot_map - positions of feet relative to the COM in body frame
+   * @return ground reaction forces of all legs in body frame, the forces the feet
+   * apply to the ground like BalanceController::control()
+   */
+  ForceMap control(const RobotStateCoM& com_state, const RobotStateCoM& desired_state,
+                   const FootholdMap& foot_map) const;
+
+  /**
+   * @brief Return the interpolated gains
+   * @param height - COM height above the feet (m)
+   * @param roll - roll angle (rad)
+   * @param pitch - pitch angle (rad)
+   * @return gains mapping the error state to GRFs in the heading frame (12x12)
+   */
+  mat1212 gains(double height, double roll, double pitch) const;
+
+private:
+  /**
+   * @brief Compute the LQR gains for one stance configuration
+   * @param height - COM height above the feet (m)
+   * @param roll - roll angle (rad)
+   * @param pitch - pitch angle (rad)
+   * @return gains (12x12)
+   */
+  mat1212 solveGains(double height, double roll, double pitch) const;
+
+  /** @brief Return the height of grid point i */
+  double height(unsigned int i) const;
+
+  /** @brief Return the roll or pitch of grid point i */
+  double angle(unsigned int i) const;
+
+private:
+  LQRBalanceConfig config_;
+  double mu_;                           // coefficient of friction
+  double mass_;                         // total mass (kg)
+  double fzmin_, fzmax_;                // min and max normal reaction force (N)
+  mat33 Ib_;                            // moment of inertia in body frame
+  std::vector<std::string> leg_names_;  // legs names [RL FL RR FR]
+  std::vector<vec3> stance_feet_;       // standing feet relative to the COM [x, y, 0]
+
+  std::vector<mat1212> gains_;  // gains indexed by [height][roll][pitch]
+};
+}  // namespace quadruped_controller
+#endif
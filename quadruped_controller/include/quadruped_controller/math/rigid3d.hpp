@@ -26,6 +26,7 @@ namespace math
 using std::tuple;
 
 using arma::mat;
+using arma::mat33;
 using arma::vec;
 using arma::vec3;
 
@@ -47,6 +48,20 @@ Eigen::Vector3d arma_translation_to_eigen(const vec3& p);
  */
 mat skew_symmetric(const vec3& x);
 
+/**
+ * @brief Rotation matrix from a rotation vector (Rodrigues' formula)
+ * @param phi - rotation axis scaled by the angle (rad)
+ * @return rotation matrix (3x3)
+ */
+mat33 rotation_exp(const vec3& phi);
+
+/**
+ * @brief Rotation vector from a rotation matrix, inverse of rotation_exp()
+ * @param R - rotation matrix (3x3)
+ * @return rotation axis scaled by the angle [0 PI] (rad)
+ */
+vec3 rotation_log(const mat33& R);
+
 /** @brief Rotation in three-dimensional catesian space */
 class Rotation3d;
 
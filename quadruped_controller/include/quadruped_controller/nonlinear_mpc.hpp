@@ -0,0 +1,271 @@
+/**
+ * @file nonlinear_mpc.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Nonlinear MPC on the single rigid body model solved with iLQR
+ *
+ * @details The balance QP linearizes the dynamics about the current orientation
+ * and drops the horizon. Here the GRFs of every stage of a short horizon are
+ * optimized on the full Newton-Euler single rigid body dynamics, including the
+ * w x (Iw*w) term, with the orientation kept on SO(3). Contact follows the gait
+ * schedule: swing legs must have zero GRFs and stance legs must stay inside the
+ * friction pyramid with bounded normal force. Both are handled with an augmented
+ * Lagrangian around iterative LQR (iLQR).
+ *
+ *    NonlinearMPC mpc(mpc_config, mu, mass, fzmin, fzmax, Ib, t_swing, t_stance,
+ *                     leg_names);
+ *    const ForceMap force_map = mpc.control(com_state, desired_state, foot_map,
+ *                                           foothold_map, gait_map, true);
+ */
+#ifndef NONLINEAR_MPC_HPP
+#define NONLINEAR_MPC_HPP
+
+// C++
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/types.hpp>
+#include <quadruped_controller/realtime/worker_pool.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat;
+using arma::mat33;
+using arma::vec3;
+
+constexpr unsigned int MPC_NUM_LEGS = 4;          // legs [RL FL RR FR]
+constexpr unsigned int MPC_STATE_SIZE = 12;       // tangent space [p, v, phi, w]
+constexpr unsigned int MPC_CONTROL_SIZE = 12;     // GRFs in world frame
+constexpr unsigned int MPC_CONSTRAINT_SIZE = 24;  // 6 per leg
+constexpr unsigned int MPC_LINE_SEARCH_STEPS = 6;  // step lengths tried per iteration
+
+/** @brief Constraint vector of one stage */
+typedef arma::vec::fixed<MPC_CONSTRAINT_SIZE> vec24;
+
+/** @brief Parameters for the nonlinear MPC */
+struct NonlinearMPCConfig
+{
+  unsigned int horizon = 16;  // number of stages
+  double dt = 0.02;           // stage duration (s)
+  double period = 0.001;      // time between calls to control() (s)
+
+  // Stage cost 1/2*dx.T*Q*dx + 1/2*r*|u - u_ref|^2, dx = x - x_ref in the tangent space
+  vec12 q = { 50.0, 50.0, 200.0, 5.0, 5.0, 5.0, 100.0, 100.0, 100.0, 1.0, 1.0, 1.0 };
+  double r = 1e-4;            // weight on GRFs minus gravity compensation
+  double terminal_scale = 10.0;  // terminal cost Q_N = terminal_scale*Q
+
+  // Solver
+  unsigned int max_iterations = 5;        // iLQR iterations per multiplier update
+  unsigned int max_outer_iterations = 3;  // multiplier updates
+  double cost_tolerance = 1e-3;           // relative cost decrease to converge
+  double constraint_tolerance = 1.0;      // max constraint violation (N)
+  double penalty = 1e-2;                  // initial penalty
+  double penalty_scale = 10.0;            // penalty growth per multiplier update
+  double max_penalty = 1e4;               // max penalty
+  double regularization = 1e-6;           // initial regularization of Quu
+
+  unsigned int threads = 0;  // worker threads for linearization and line search
+};
+
+/** @brief Status of the last nonlinear MPC solve */
+struct MPCStatus
+{
+  unsigned int iterations = 0;        // iLQR iterations
+  unsigned int outer_iterations = 0;  // multiplier updates
+  double cost = 0.0;                  // tracking cost of the solution
+  double max_violation = 0.0;         // max constraint violation (N)
+  double solve_time = 0.0;            // wall time (s)
+  bool solved = false;                // finite solution within the constraint tolerance
+};
+
+/**
+ * @brief Receding horizon GRF optimization on the nonlinear single rigid body model
+ * @details The state of each stage is the COM position, linear velocity,
+ * orientation, and angular velocity in world frame. Differences between states are
+ * taken in the tangent space with the orientation error as a rotation vector, so
+ * large rotations over the horizon are exact. The controls are the GRFs the ground
+ * applies to each foot in world frame. Stage Jacobians come from finite differences
+ * of the discrete dynamics.
+ *
+ * Each solve is warm started from the previous solution shifted by the time since
+ * the last call and rolled out from the measured state with its feedback gains. The
+ * Jacobians of all stages and the rollouts for the candidate step lengths of the line
+ * search do not depend on each other and run on a worker pool.
+ * All buffers are allocated by the constructor.
+ */
+class NonlinearMPC
+{
+public:
+  /**
+   * @brief Constructor
+   * @param config - MPC parameters
+   * @param mu - friction coefficient
+   * @param mass - total mass (kg)
+   * @param fzmin - minimum z-axis ground reaction force (N)
+   * @param fzmax - maximum z-axis ground reaction force (N)
+   * @param Ib - trunk moment of inertia in body frame (3x3)
+   * @param t_swing - leg swing time (s)
+   * @param t_stance - leg stance time (s)
+   * @param leg_names - legs names [RL FL RR FR]
+   */
+  NonlinearMPC(const NonlinearMPCConfig& config, double mu, double mass, double fzmin,
+               double fzmax, const mat& Ib, double t_swing, double t_stance,
+               const std::vector<std::string>& leg_names);
+
+  NonlinearMPC(const NonlinearMPC&) = delete;
+  NonlinearMPC& operator=(const NonlinearMPC&) = delete;
+
+  /**
+   * @brief Compose ground reaction forces
+   * @param com_state - COM state in world frame
+   * @param desired_state - desired COM state in world frame, the reference moves with
+   * its velocities over the horizon
+   * @param foot_map - positions of feet relative to the COM in body frame
+   * @param foothold_map - planned footholds in world frame used once a swing leg
+   * touches down, legs without a foothold land where they lifted off shifted by the
+   * reference motion
+   * @param gait_map - gait schedule for this tick
+   * @param gait_running - true if the gait phases advance over the horizon
+   * @return ground reaction forces of the stance legs in body frame, the forces the
+   * feet apply to the ground like BalanceController::control()
+   */
+  ForceMap control(const RobotStateCoM& com_state, const RobotStateCoM& desired_state,
+                   const FootholdMap& foot_map, const FootholdMap& foothold_map,
+                   const GaitMap& gait_map, bool gait_running);
+
+  /** @brief Discard the warm start, the next solve starts from gravity compensation */
+  void reset();
+
+  /** @brief Return the status of the last solve */
+  const MPCStatus& status() const;
+
+  /** @brief Return the predicted COM states of the last solve (horizon + 1) */
+  const std::vector<RobotStateCoM>& predictedStates() const;
+
+private:
+  /** @brief Contact and reference of one stage */
+  struct Stage
+  {
+    std::array<bool, MPC_NUM_LEGS> contact;  // leg in stance
+    std::array<vec3, MPC_NUM_LEGS> feet;     // contact points in world frame
+    RobotStateCoM x_ref;                     // reference state at the stage start
+    vec12 u_ref;                             // gravity compensation GRFs
+  };
+
+  /**
+   * @brief Discrete single rigid body dynamics
+   * @param x - state
+   * @param u - GRFs in world frame
+   * @param stage - contact points
+   * @return state after one stage
+   */
+  RobotStateCoM step(const RobotStateCoM& x, const vec12& u, const Stage& stage) const;
+
+  /**
+   * @brief Set up the contact schedule and reference of every stage
+   * @param com_state - COM state in world frame
+   * @param desired_state - desired COM state in world frame
+   * @param foot_map - positions of feet relative to the COM in body frame
+   * @param foothold_map - planned footholds in world frame
+   * @param gait_map - gait schedule
+   * @param gait_running - true if the gait phases advance
+   */
+  void setupStages(const RobotStateCoM& com_state, const RobotStateCoM& desired_state,
+                   const FootholdMap& foot_map, const FootholdMap& foothold_map,
+                   const GaitMap& gait_map, bool gait_running);
+
+  /**
+   * @brief Shift the previous solution and its feedback gains by the time since the
+   * last call, without one start from the reference and its LQR gains
+   */
+  void warmStart();
+
+  /**
+   * @brief Evaluate the constraints of one stage
+   * @param u - GRFs in world frame
+   * @param stage - contact schedule
+   * @return constraint values, c <= 0 for the inequalities and c = 0 for the equalities
+   */
+  vec24 constraints(const vec12& u, const Stage& stage) const;
+
+  /**
+   * @brief Augmented Lagrangian cost of a trajectory
+   * @param x - states (horizon + 1)
+   * @param u - controls (horizon)
+   * @return cost
+   */
+  double cost(const std::vector<RobotStateCoM>& x, const std::vector<vec12>& u) const;
+
+  /**
+   * @brief Compute the dynamics Jacobians of a stage about the nominal trajectory
+   * @param k - stage
+   */
+  void linearize(std::size_t k);
+
+  /**
+   * @brief Compute the feedback gains
+   * @return true if Quu is positive definite at every stage
+   */
+  bool backwardPass();
+
+  /**
+   * @brief Roll out the dynamics with the feedback gains and a step length
+   * @param i - index of the step length
+   */
+  void rollout(std::size_t i);
+
+  /**
+   * @brief Run one iLQR iteration
+   * @return true if the cost decreased
+   */
+  bool iterate();
+
+  /** @brief Update the multipliers and the penalty */
+  void updateMultipliers();
+
+  /** @brief Return the max constraint violation of the nominal trajectory */
+  double maxViolation() const;
+
+private:
+  NonlinearMPCConfig config_;
+  double mu_;                           // coefficient of friction
+  double mass_;                         // total mass (kg)
+  double fzmin_, fzmax_;                // min and max normal reaction force (N)
+  mat33 Ib_;                            // moment of inertia in body frame
+  mat33 Ib_inv_;                        // inverse moment of inertia in body frame
+  vec3 g_;                              // gravity vector in world frame (m/s^2)
+  double t_swing_, t_stance_;           // gait timing (s)
+  std::vector<std::string> leg_names_;  // legs names [RL FL RR FR]
+
+  std::vector<Stage> stages_;           // contact and reference (horizon + 1)
+  std::vector<RobotStateCoM> x_;        // nominal states (horizon + 1)
+  std::vector<vec12> u_;                // nominal controls (horizon)
+  std::vector<vec24> lambda_;           // multipliers (horizon)
+  double penalty_;                      // augmented Lagrangian penalty
+  double regularization_;               // regularization of Quu
+  double cost_;                         // cost of the nominal trajectory
+
+  std::vector<mat1212> A_, B_;          // dynamics Jacobians
+  std::vector<mat1212> K_;              // feedback gains
+  std::vector<vec12> d_;                // feedforward steps
+  double expected_linear_;              // expected cost change, linear term
+  double expected_quadratic_;           // expected cost change, quadratic term
+
+  std::array<double, MPC_LINE_SEARCH_STEPS> alphas_;  // step lengths
+  std::array<std::vector<RobotStateCoM>, MPC_LINE_SEARCH_STEPS> x_search_;
+  std::array<std::vector<vec12>, MPC_LINE_SEARCH_STEPS> u_search_;
+  std::array<double, MPC_LINE_SEARCH_STEPS> cost_search_;
+
+  bool initialized_;   // previous solution available
+  double shift_time_;  // time since the previous solution not yet shifted out (s)
+  MPCStatus status_;
+
+  realtime::WorkerPool pool_;                        // linearization and line search
+  const std::function<void(std::size_t)> linearize_fn_;
+  const std::function<void(std::size_t)> rollout_fn_;
+};
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file qp_backend.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Interchangeable solvers for the balance QP
+ */
+#ifndef QP_BACKEND_HPP
+#define QP_BACKEND_HPP
+
+// C++
+#include <memory>
+#include <string>
+
+// QP solver
+#include <qpOASES.hpp>
+
+namespace quadruped_controller
+{
+using qpOASES::real_t;
+
+/** @brief Status of the last QP solve */
+struct QPStatus
+{
+  int return_value = qpOASES::SUCCESSFUL_RETURN;  // qpOASES returnValue
+  int iterations = 0;                             // working set recalculations
+  double cpu_time = 0.0;                          // solve time (s)
+  bool solved = false;                            // primal solution available
+  bool explicit_solution = false;                 // from the explicit QP, no QP solve
+  bool sensitivity_update = false;                // linear update of the last solution
+};
+
+/** @brief Solvers available to the balance controller */
+enum QpBackendType
+{
+  qpoases = 0,  // dense active-set, hotstarted from the last working set
+  admm = 1,     // first order ADMM with a cached factorization
+  num_qp_backends = 2
+};
+
+/** @brief Return the name of a QP backend */
+const char* qp_backend_name(QpBackendType type);
+
+/**
+ * @brief Return the QP backend of a name
+ * @param name - name from qp_backend_name()
+ * @param type[out] - QP backend
+ * @return false if the name is unknown
+ */
+bool qp_backend_from_name(const std::string& name, QpBackendType& type);
+
+/** @brief ADMM parameters, see AdmmQpBackend */
+struct AdmmSettings
+{
+  double rho = 0.1;              // penalty on the inequality constraints
+  double rho_eq_scale = 1000.0;  // penalty scale of equality constraints (lb = ub)
+  double sigma = 1e-6;           // regularization of the primal variables
+  double alpha = 1.6;            // over relaxation in (0, 2)
+  double eps_abs = 1e-4;         // absolute residual tolerance
+  double eps_rel = 1e-4;         // relative residual tolerance
+  unsigned int max_iterations = 4000;
+  unsigned int check_interval = 5;  // iterations between termination checks
+  bool adaptive_rho = true;         // balance the residuals by rescaling rho
+  unsigned int adaptive_rho_interval = 25;  // iterations between rho updates
+  double adaptive_rho_tolerance = 5.0;      // min rho change that refactors
+  bool warm_start = true;           // start from the solution of the last solve
+  bool polish = true;               // solve the KKT system of the detected active set
+  double polish_delta = 1e-6;       // regularization of the polishing KKT system
+  unsigned int polish_refine_iterations = 3;  // iterative refinement steps
+};
+
+/**
+ * @brief Solver of min 1/2*x.T*Q*x + x.T*c s.t. lbC <= C*x <= ubC
+ * @details All arrays are row major as in qpOASES. Bounds of magnitude 1e6 or more
+ * are treated as infinite. The dimensions are fixed at construction so a backend
+ * solves a sequence of related problems, reusing work from the last solve.
+ */
+class QpBackend
+{
+public:
+  virtual ~QpBackend() = default;
+
+  /**
+   * @brief Solve the QP
+   * @param Q - Hessian (n x n)
+   * @param c - linear cost (n)
+   * @param C - constraint matrix (m x n)
+   * @param lbC - constraint lower bounds (m)
+   * @param ubC - constraint upper bounds (m)
+   * @param x[out] - primal solution (n), valid if the status is solved
+   * @return status of the solve
+   */
+  virtual QPStatus solve(const real_t* Q, const real_t* c, const real_t* C,
+                         const real_t* lbC, const real_t* ubC, real_t* x) = 0;
+
+  /** @brief Return true once a problem has been solved */
+  virtual bool isInitialised() const = 0;
+
+  /** @brief Return the backend type */
+  virtual QpBackendType type() const = 0;
+};
+
+/**
+ * @brief Construct a QP backend
+ * @param type - backend
+ * @param num_variables - number of variables n
+ * @param num_constraints - number of constraints m
+ * @param cpu_time - max solve time of qpOASES (s)
+ * @param nWSR - max working set recalculations of qpOASES
+ * @param admm_settings - ADMM parameters
+ * @return QP backend
+ */
+std::unique_ptr<QpBackend>
+make_qp_backend(QpBackendType type, unsigned int num_variables,
+                unsigned int num_constraints, double cpu_time, int nWSR,
+                const AdmmSettings& admm_settings = AdmmSettings());
+
+/** @brief qpOASES sequential QP, initialized once and hotstarted every solve */
+class QpOasesBackend : public QpBackend
+{
+public:
+  /**
+   * @brief Constructor
+   * @param num_variables - number of variables n
+   * @param num_constraints - number of constraints m
+   * @param cpu_time - max solve time (s)
+   * @param nWSR - max working set recalculations
+   */
+  QpOasesBackend(unsigned int num_variables, unsigned int num_constraints,
+                 double cpu_time, int nWSR);
+
+  QPStatus solve(const real_t* Q, const real_t* c, const real_t* C, const real_t* lbC,
+                 const real_t* ubC, real_t* x) override;
+
+  bool isInitialised() const override;
+
+  QpBackendType type() const override;
+
+private:
+  qpOASES::SQProblem solver_;  // sequential QP solver
+  double cpu_time_;            // max solve time (s)
+  int nWSR_;                   // max working set recalculations
+};
+}  // namespace quadruped_controller
+#endif
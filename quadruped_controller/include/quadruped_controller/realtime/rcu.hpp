@@ -0,0 +1,148 @@
+/**
+ * @file rcu.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Read-copy-update cell for one reader thread
+ */
+#ifndef RCU_HPP
+#define RCU_HPP
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+/**
+ * @brief Immutable value swapped in by writers and read without locks
+ * @tparam T - value type
+ * @details Writers build a new value, publish it by swapping the pointer, and retire
+ * the old value. Each publish advances an epoch. The reader announces the epoch it
+ * has seen with quiescent() once it no longer holds a value, and retired values from
+ * epochs at or before it are deleted by the next publish. The reader only does
+ * atomic loads and stores, it never locks, allocates, or deletes.
+ *
+ *    // Reader thread, once per tick
+ *    if (const T* value = cell.poll())
+ *    {
+ *      apply(*value);
+ *    }
+ *    cell.quiescent();
+ *
+ *    // Any other thread
+ *    cell.publish(std::make_unique<const T>(value));
+ */
+template <class T>
+class RcuCell
+{
+public:
+  /**
+   * @brief Constructor
+   * @param value - initial value, counts as read by the reader
+   */
+  explicit RcuCell(std::unique_ptr<const T> value)
+    : current_(value.release()), epoch_(0), reader_epoch_(0), poll_epoch_(0)
+  {
+  }
+
+  ~RcuCell()
+  {
+    delete current_.load();
+    for (const auto& retired : retired_)
+    {
+      delete retired.value;
+    }
+  }
+
+  RcuCell(const RcuCell&) = delete;
+  RcuCell& operator=(const RcuCell&) = delete;
+
+  /**
+   * @brief Get the current value, reader thread only
+   * @return value, valid until the next quiescent()
+   */
+  const T* read() const
+  {
+    return current_.load();
+  }
+
+  /**
+   * @brief Get the current value if one was published since the last poll, reader
+   * thread only
+   * @return value valid until the next quiescent(), null if nothing was published
+   * @details A value published during the poll may be returned twice.
+   */
+  const T* poll()
+  {
+    // The epoch advances after the swap, seeing it means the swap is visible
+    const uint64_t epoch = epoch_.load();
+    if (epoch == poll_epoch_)
+    {
+      return nullptr;
+    }
+
+    poll_epoch_ = epoch;
+    return current_.load();
+  }
+
+  /** @brief Announce the reader holds no values, reader thread only */
+  void quiescent()
+  {
+    reader_epoch_.store(epoch_.load());
+  }
+
+  /**
+   * @brief Publish a new value
+   * @param value - new value
+   * @details Thread safe, writers are serialized by a mutex. Retired values the
+   * reader has moved past are deleted.
+   */
+  void publish(std::unique_ptr<const T> value)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const T* old = current_.exchange(value.release());
+    retired_.push_back({ old, epoch_.fetch_add(1) + 1 });
+
+    const uint64_t reader_epoch = reader_epoch_.load();
+    const auto last = std::partition(
+        retired_.begin(), retired_.end(),
+        [reader_epoch](const Retired& retired) { return retired.epoch > reader_epoch; });
+    for (auto it = last; it != retired_.end(); ++it)
+    {
+      delete it->value;
+    }
+    retired_.erase(last, retired_.end());
+  }
+
+  /** @brief Return the number of retired values not yet deleted */
+  std::size_t retired() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+  }
+
+private:
+  /** @brief Value swapped out at an epoch */
+  struct Retired
+  {
+    const T* value;
+    uint64_t epoch;
+  };
+
+  std::atomic<const T*> current_;       // published value
+  std::atomic<uint64_t> epoch_;         // number of publishes
+  std::atomic<uint64_t> reader_epoch_;  // last epoch the reader was quiescent at
+  uint64_t poll_epoch_;                 // last epoch polled, reader only
+
+  mutable std::mutex mutex_;      // serializes writers
+  std::vector<Retired> retired_;  // swapped out values the reader may hold
+};
+}  // namespace realtime
+}  // namespace quadruped_controller
+#endif
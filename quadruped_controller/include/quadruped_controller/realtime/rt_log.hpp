@@ -0,0 +1,413 @@
+/**
+ * @file rt_log.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Logging from the control thread without formatting or I/O
+ *
+ * @details The RT_LOG_* macros copy a pointer to a static call site and up to
+ * RT_LOG_MAX_ARGS arguments into a fixed size record and push it into a per
+ * thread wait-free SPSC queue. A background thread formats the records and
+ * forwards them to rosconsole under the same named logger as ROS_*_NAMED. Each
+ * call site is rate limited before anything is queued. If the queue is full the
+ * record is dropped and counted. The control thread never blocks, formats, or
+ * allocates, except for the first message from a thread which allocates that
+ * thread's queue (see RTLogger::registerThread()).
+ *
+ * Usage matches ROS_*_NAMED with printf style formatting:
+ *
+ *    RT_LOG_ERROR_NAMED(LOGNAME, "Failed to plan leg: %s", leg_name);
+ *
+ * Supported arguments are integers, floating point numbers, bools, and
+ * strings. Strings are copied and truncated to RT_LOG_MAX_STRING - 1 characters.
+ *
+ * A call site is shared by every object running the code, e.g. all robots of a
+ * commander, so one object logging at the rate limit suppresses the others. Code
+ * run once per object passes the object's index to the *_INSTANCE_NAMED macros to
+ * rate limit each object separately:
+ *
+ *    RT_LOG_WARN_INSTANCE_NAMED(robot_index, LOGNAME, "%s: missed a deadline", label);
+ */
+#ifndef RT_LOG_HPP
+#define RT_LOG_HPP
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/spsc_queue.hpp>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+constexpr unsigned int RT_LOG_MAX_ARGS = 6;     // arguments per message
+constexpr unsigned int RT_LOG_MAX_STRING = 32;  // bytes per string argument
+constexpr std::size_t RT_LOG_QUEUE_SIZE = 1024;  // records per thread
+constexpr double RT_LOG_DEFAULT_RATE = 10.0;     // messages/s per call site
+constexpr double RT_LOG_DEFAULT_BURST = 10.0;    // messages per call site burst
+constexpr unsigned int RT_LOG_MAX_INSTANCES = 16;  // rate limits per call site
+
+/** @brief Log severity, matches ros::console::levels */
+enum RTLogLevel
+{
+  debug = 0,
+  info = 1,
+  warn = 2,
+  error = 3,
+  fatal = 4
+};
+
+/**
+ * @brief A logging statement, one static instance per macro expansion
+ * @details Rate limiting uses the generic cell rate algorithm: a message is
+ * allowed if it is no earlier than burst messages ahead of the theoretical
+ * arrival time. Each instance has its own limit, instances beyond
+ * RT_LOG_MAX_INSTANCES share one modulo RT_LOG_MAX_INSTANCES. Lock-free so call
+ * sites can be shared by threads.
+ */
+struct RTLogSite
+{
+  /**
+   * @brief Constructor
+   * @param name - named logger (same as ROS_*_NAMED)
+   * @param level - severity
+   * @param format - printf style format string
+   * @param file - source file
+   * @param line - source line
+   * @param function - function name
+   * @param rate - max sustained messages per second, 0 for no limit
+   * @param burst - max messages in a burst
+   */
+  RTLogSite(const char* name, RTLogLevel level, const char* format, const char* file,
+            int line, const char* function, double rate = RT_LOG_DEFAULT_RATE,
+            double burst = RT_LOG_DEFAULT_BURST);
+
+  /**
+   * @brief Check the rate limit and consume a message if allowed
+   * @param now_ns - current time (ns)
+   * @param instance - index of the rate limit
+   * @return true if the message may be logged
+   */
+  bool allow(int64_t now_ns, unsigned int instance = 0);
+
+  /**
+   * @brief Take the count of messages suppressed since the last allowed one
+   * @param instance - index of the rate limit
+   * @return messages suppressed
+   */
+  uint64_t takeSuppressed(unsigned int instance = 0);
+
+  const char* name;      // named logger
+  RTLogLevel level;      // severity
+  const char* format;    // printf style format
+  const char* file;      // source file
+  int line;              // source line
+  const char* function;  // function name
+
+  int64_t interval_ns;   // time per message (ns)
+  int64_t tolerance_ns;  // burst tolerance (ns)
+
+  // Per instance theoretical arrival time (ns) and messages dropped by the limit
+  std::atomic<int64_t> tat_ns[RT_LOG_MAX_INSTANCES];
+  std::atomic<uint64_t> suppressed[RT_LOG_MAX_INSTANCES];
+};
+
+/** @brief Type of a captured argument */
+enum RTLogArgType : uint8_t
+{
+  signed_integer = 0,
+  unsigned_integer = 1,
+  floating_point = 2,
+  string = 3
+};
+
+/** @brief A captured argument */
+struct RTLogArg
+{
+  RTLogArgType type;
+  union
+  {
+    int64_t i;
+    uint64_t u;
+    double d;
+    char s[RT_LOG_MAX_STRING];
+  };
+};
+
+/** @brief A queued message */
+struct RTLogRecord
+{
+  RTLogSite* site;       // call site
+  int64_t stamp_ns;      // time the message was logged (ns)
+  uint64_t suppressed;   // messages rate limited at this site since the last one
+  uint32_t num_args;     // captured arguments
+  RTLogArg args[RT_LOG_MAX_ARGS];
+};
+
+/** @brief Per thread queue of log records */
+typedef SPSCQueue<RTLogRecord, RT_LOG_QUEUE_SIZE> RTLogQueue;
+
+/**
+ * @brief Formats and emits queued log records on a background thread
+ */
+class RTLogger
+{
+public:
+  /** @brief Return the process wide logger */
+  static RTLogger& instance();
+
+  ~RTLogger();
+
+  RTLogger(const RTLogger&) = delete;
+  RTLogger& operator=(const RTLogger&) = delete;
+
+  /**
+   * @brief Allocate the calling thread's queue
+   * @details Call before entering a real-time loop so the first log message
+   * does not allocate.
+   */
+  void registerThread();
+
+  /**
+   * @brief Set the minimum severity queued
+   * @param level - messages below this level are discarded at the call site
+   */
+  void setLevel(RTLogLevel level);
+
+  /** @brief Return true if messages at this level are queued */
+  bool enabled(RTLogLevel level) const;
+
+  /**
+   * @brief Queue a record from the calling thread
+   * @param record - log record
+   * @details Never blocks. The record is dropped if the queue is full.
+   */
+  void push(const RTLogRecord& record);
+
+  /** @brief Emit all queued records now, blocks until done */
+  void flush();
+
+  /** @brief Return the number of records dropped because a queue was full */
+  uint64_t dropped() const;
+
+  /** @brief Return a monotonic clock in nanoseconds */
+  static int64_t now();
+
+private:
+  /** @brief Producer queue */
+  struct ThreadQueue
+  {
+    RTLogQueue queue;                    // records
+    std::atomic<uint64_t> dropped{ 0 };  // records dropped, queue full
+    uint64_t reported = 0;               // dropped records already reported
+  };
+
+  RTLogger();
+
+  /** @brief Return the calling thread's queue, allocating it on first use */
+  ThreadQueue& threadQueue();
+
+  /** @brief Background thread */
+  void run();
+
+  /**
+   * @brief Pop and emit all records
+   * @return number of records emitted
+   */
+  std::size_t drain();
+
+  /** @brief Format and emit a record */
+  void emit(const RTLogRecord& record);
+
+private:
+  std::atomic<int> level_;    // min queued level
+  mutable std::mutex mutex_;  // guards queues_ and the consumer
+  std::condition_variable cv_;
+  std::vector<std::unique_ptr<ThreadQueue>> queues_;  // one per producer thread
+  std::atomic<bool> running_;
+  std::thread worker_;
+};
+
+/////////////////////////////////////////////////////////
+// Argument capture
+
+/** @brief Capture an integer argument */
+template <class T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+inline void rt_log_capture(RTLogArg& arg, T value)
+{
+  if (std::is_signed<T>::value)
+  {
+    arg.type = RTLogArgType::signed_integer;
+    arg.i = static_cast<int64_t>(value);
+  }
+  else
+  {
+    arg.type = RTLogArgType::unsigned_integer;
+    arg.u = static_cast<uint64_t>(value);
+  }
+}
+
+/** @brief Capture a floating point argument */
+template <class T,
+          typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+inline void rt_log_capture(RTLogArg& arg, T value)
+{
+  arg.type = RTLogArgType::floating_point;
+  arg.d = static_cast<double>(value);
+}
+
+/** @brief Capture an enum argument as an integer */
+template <class T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+inline void rt_log_capture(RTLogArg& arg, T value)
+{
+  arg.type = RTLogArgType::signed_integer;
+  arg.i = static_cast<int64_t>(value);
+}
+
+/** @brief Capture a string argument, truncated to fit */
+inline void rt_log_capture(RTLogArg& arg, const char* value)
+{
+  arg.type = RTLogArgType::string;
+  std::strncpy(arg.s, value ? value : "(null)", RT_LOG_MAX_STRING - 1);
+  arg.s[RT_LOG_MAX_STRING - 1] = '\0';
+}
+
+/** @brief Capture a string argument, truncated to fit */
+inline void rt_log_capture(RTLogArg& arg, const std::string& value)
+{
+  rt_log_capture(arg, value.c_str());
+}
+
+/** @brief Return a logger name as a C string */
+inline const char* rt_log_name(const char* name)
+{
+  return name;
+}
+
+/** @brief Return a logger name as a C string */
+inline const char* rt_log_name(const std::string& name)
+{
+  return name.c_str();
+}
+
+/**
+ * @brief Rate limit, capture, and queue a message
+ * @param site - call site
+ * @param instance - index of the rate limit of the site
+ * @param args - format arguments
+ */
+template <class... Args>
+inline void rt_log_instance(RTLogSite& site, unsigned int instance, const Args&... args)
+{
+  static_assert(sizeof...(Args) <= RT_LOG_MAX_ARGS, "Too many RT_LOG arguments");
+
+  RTLogger& logger = RTLogger::instance();
+  if (!logger.enabled(site.level))
+  {
+    return;
+  }
+
+  const int64_t now = RTLogger::now();
+  if (!site.allow(now, instance))
+  {
+    return;
+  }
+
+  RTLogRecord record;
+  record.site = &site;
+  record.stamp_ns = now;
+  record.suppressed = site.takeSuppressed(instance);
+  record.num_args = sizeof...(Args);
+
+  unsigned int i = 0;
+  (rt_log_capture(record.args[i++], args), ...);
+  (void)i;
+
+  logger.push(record);
+}
+
+/**
+ * @brief Rate limit, capture, and queue a message
+ * @param site - call site
+ * @param args - format arguments
+ */
+template <class... Args>
+inline void rt_log(RTLogSite& site, const Args&... args)
+{
+  rt_log_instance(site, 0, args...);
+}
+}  // namespace realtime
+}  // namespace quadruped_controller
+
+#define RT_LOG_THROTTLE_IMPL(level, rate, burst, name, ...)                            \
+  do                                                                                   \
+  {                                                                                    \
+    static ::quadruped_controller::realtime::RTLogSite rt_log_site__(                  \
+        ::quadruped_controller::realtime::rt_log_name(name), level,                    \
+        RT_LOG_FIRST_ARG(__VA_ARGS__, 0), __FILE__, __LINE__, __func__, rate, burst);  \
+    RT_LOG_CALL(rt_log_site__, __VA_ARGS__);                                           \
+  } while (0)
+
+#define RT_LOG_INSTANCE_IMPL(level, instance, name, ...)                               \
+  do                                                                                   \
+  {                                                                                    \
+    static ::quadruped_controller::realtime::RTLogSite rt_log_site__(                  \
+        ::quadruped_controller::realtime::rt_log_name(name), level,                    \
+        RT_LOG_FIRST_ARG(__VA_ARGS__, 0), __FILE__, __LINE__, __func__);               \
+    RT_LOG_INSTANCE_CALL(rt_log_site__, instance, __VA_ARGS__);                        \
+  } while (0)
+
+// Split the format string from the arguments
+#define RT_LOG_FIRST_ARG(first, ...) first
+#define RT_LOG_CALL(site, format, ...)                                                 \
+  ::quadruped_controller::realtime::rt_log(site __VA_OPT__(, ) __VA_ARGS__)
+#define RT_LOG_INSTANCE_CALL(site, instance, format, ...)                              \
+  ::quadruped_controller::realtime::rt_log_instance(site, instance __VA_OPT__(, )      \
+                                                        __VA_ARGS__)
+
+#define RT_LOG_IMPL(level, name, ...)                                                  \
+  RT_LOG_THROTTLE_IMPL(level, ::quadruped_controller::realtime::RT_LOG_DEFAULT_RATE,   \
+                       ::quadruped_controller::realtime::RT_LOG_DEFAULT_BURST, name,   \
+                       __VA_ARGS__)
+
+#define RT_LOG_DEBUG_NAMED(name, ...)                                                  \
+  RT_LOG_IMPL(::quadruped_controller::realtime::RTLogLevel::debug, name, __VA_ARGS__)
+#define RT_LOG_INFO_NAMED(name, ...)                                                   \
+  RT_LOG_IMPL(::quadruped_controller::realtime::RTLogLevel::info, name, __VA_ARGS__)
+#define RT_LOG_WARN_NAMED(name, ...)                                                   \
+  RT_LOG_IMPL(::quadruped_controller::realtime::RTLogLevel::warn, name, __VA_ARGS__)
+#define RT_LOG_ERROR_NAMED(name, ...)                                                  \
+  RT_LOG_IMPL(::quadruped_controller::realtime::RTLogLevel::error, name, __VA_ARGS__)
+
+// Rate limited separately for each instance index
+#define RT_LOG_DEBUG_INSTANCE_NAMED(instance, name, ...)                               \
+  RT_LOG_INSTANCE_IMPL(::quadruped_controller::realtime::RTLogLevel::debug, instance,  \
+                       name, __VA_ARGS__)
+#define RT_LOG_INFO_INSTANCE_NAMED(instance, name, ...)                                \
+  RT_LOG_INSTANCE_IMPL(::quadruped_controller::realtime::RTLogLevel::info, instance,   \
+                       name, __VA_ARGS__)
+#define RT_LOG_WARN_INSTANCE_NAMED(instance, name, ...)                                \
+  RT_LOG_INSTANCE_IMPL(::quadruped_controller::realtime::RTLogLevel::warn, instance,   \
+                       name, __VA_ARGS__)
+#define RT_LOG_ERROR_INSTANCE_NAMED(instance, name, ...)                               \
+  RT_LOG_INSTANCE_IMPL(::quadruped_controller::realtime::RTLogLevel::error, instance,  \
+                       name, __VA_ARGS__)
+
+// Rate limited to one message per period (s)
+#define RT_LOG_WARN_THROTTLE_NAMED(period, name, ...)                                  \
+  RT_LOG_THROTTLE_IMPL(::quadruped_controller::realtime::RTLogLevel::warn,             \
+                       1.0 / (period), 1.0, name, __VA_ARGS__)
+#define RT_LOG_ERROR_THROTTLE_NAMED(period, name, ...)                                 \
+  RT_LOG_THROTTLE_IMPL(::quadruped_controller::realtime::RTLogLevel::error,            \
+                       1.0 / (period), 1.0, name, __VA_ARGS__)
+
+#endif
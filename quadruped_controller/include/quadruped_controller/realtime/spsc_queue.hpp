@@ -0,0 +1,101 @@
+/**
+ * @file spsc_queue.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Wait-free single producer single consumer queue
+ */
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+// C++
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+/** @brief Size of a cache line, used to keep producer and consumer indices apart */
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Bounded wait-free queue for one producer thread and one consumer thread
+ * @tparam T - trivially copyable element type
+ * @tparam Capacity - number of elements, must be a power of two
+ * @details Storage is inline so the queue never allocates. push() and pop() are
+ * a copy plus one acquire load and one release store.
+ */
+template <class T, std::size_t Capacity>
+class SPSCQueue
+{
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SPSCQueue capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SPSCQueue elements must be trivially copyable");
+
+public:
+  SPSCQueue() : head_(0), tail_(0)
+  {
+  }
+
+  SPSCQueue(const SPSCQueue&) = delete;
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+  /**
+   * @brief Add an element, producer thread only
+   * @param value - element to add
+   * @return false if the queue is full
+   */
+  bool push(const T& value)
+  {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity)
+    {
+      return false;
+    }
+
+    buffer_[tail & (Capacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element, consumer thread only
+   * @param value[out] - removed element
+   * @return false if the queue is empty
+   */
+  bool pop(T& value)
+  {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+
+    value = buffer_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @brief Return true if the queue is empty */
+  bool empty() const
+  {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  /** @brief Return the number of elements the queue holds */
+  static constexpr std::size_t capacity()
+  {
+    return Capacity;
+  }
+
+private:
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_;  // next element to pop
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_;  // next slot to push
+  alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer_;
+};
+}  // namespace realtime
+}  // namespace quadruped_controller
+#endif
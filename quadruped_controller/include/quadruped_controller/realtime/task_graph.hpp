@@ -0,0 +1,183 @@
+/**
+ * @file task_graph.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Static task graph run by a small work-stealing scheduler
+ *
+ * @details The tasks and their dependencies are added once, then run() executes
+ * the whole graph and returns when every task is done. Each thread, the calling
+ * thread included, has its own queue. A finished task pushes the successors it
+ * made ready onto the queue of its thread and that thread continues with the last
+ * of them, idle threads steal the oldest task from the other queues. Critical
+ * tasks are taken before all other tasks, so mark the longest chain of the graph.
+ *
+ *    realtime::TaskGraph graph(1);
+ *    const auto fk = graph.addTask("fk", [&] { ... }, true);
+ *    const auto plan = graph.addTask("plan", [&] { ... });
+ *    const auto qp = graph.addTask("qp", [&] { ... }, true);
+ *    graph.addDependency(fk, plan);
+ *    graph.addDependency(fk, qp);
+ *    graph.run();
+ *
+ * The start, end, and thread of every task of the last run are kept for profiling,
+ * and each task is a span in the timeline trace (see trace.hpp).
+ */
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+/** @brief When and where a task ran */
+struct TaskRecord
+{
+  int64_t start_ns = 0;     // start time (ns, steady clock)
+  int64_t end_ns = 0;       // end time (ns, steady clock)
+  unsigned int thread = 0;  // 0 is the thread calling run(), then the workers
+};
+
+/**
+ * @brief Runs a fixed graph of dependent tasks on a fixed set of threads
+ * @details The threads are created once and sleep between runs. A run does not
+ * allocate. The graph must not change while it runs and only one thread may call
+ * run() at a time.
+ */
+class TaskGraph
+{
+public:
+  using TaskId = unsigned int;
+
+  /**
+   * @brief Constructor
+   * @param num_threads - worker threads, the calling thread is an additional worker
+   * @param cpus - CPU each worker thread is pinned to, cycled if there are fewer CPUs
+   * than threads, empty to let the scheduler place the threads
+   */
+  explicit TaskGraph(unsigned int num_threads, const std::vector<int>& cpus = {});
+
+  ~TaskGraph();
+
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  /**
+   * @brief Add a task
+   * @param name - name, string literal
+   * @param work - called once per run after all tasks it depends on
+   * @param critical - task is on the critical path and is taken first
+   * @return task id
+   */
+  TaskId addTask(const char* name, std::function<void()> work, bool critical = false);
+
+  /**
+   * @brief Run a task after another
+   * @param before - task that runs first
+   * @param after - task that waits for it
+   * @details The graph must remain acyclic.
+   */
+  void addDependency(TaskId before, TaskId after);
+
+  /** @brief Run every task once and wait for all of them */
+  void run();
+
+  /** @brief Return the number of tasks */
+  unsigned int size() const;
+
+  /** @brief Return the number of threads including the calling thread */
+  unsigned int threads() const;
+
+  /** @brief Return the name of a task */
+  const char* name(TaskId id) const;
+
+  /** @brief Return true if a task is on the critical path */
+  bool critical(TaskId id) const;
+
+  /** @brief Return when and where each task ran during the last run */
+  const std::vector<TaskRecord>& timeline() const;
+
+private:
+  /** @brief Task node */
+  struct Task
+  {
+    const char* name;                // name
+    std::function<void()> work;      // work
+    bool critical;                   // taken before other tasks
+    unsigned int num_predecessors;   // tasks it waits for
+    std::vector<TaskId> successors;  // tasks waiting for it
+  };
+
+  /**
+   * @brief Ready tasks of one thread
+   * @details Holds every task at most once per run so it never wraps. The owner
+   * pushes and pops at the back, thieves take from the front.
+   */
+  struct WorkQueue
+  {
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;  // guards the queues
+    std::vector<TaskId> tasks[2];               // normal and critical tasks
+    std::size_t head[2] = { 0, 0 };             // next task to steal
+    std::size_t tail[2] = { 0, 0 };             // one past the newest task
+  };
+
+  /**
+   * @brief Worker thread
+   * @param thread - index of the thread
+   * @param cpu - CPU to pin the thread to, negative to not pin
+   */
+  void runWorker(unsigned int thread, int cpu);
+
+  /**
+   * @brief Take and execute tasks until the graph is done
+   * @param thread - index of the calling thread
+   */
+  void work(unsigned int thread);
+
+  /**
+   * @brief Take the next task, critical first, own queue before stealing
+   * @param thread - index of the calling thread
+   * @param id[out] - task
+   * @return false if no task is ready
+   */
+  bool take(unsigned int thread, TaskId& id);
+
+  /**
+   * @brief Run a task and release its successors
+   * @param thread - index of the calling thread
+   * @param id - task
+   */
+  void execute(unsigned int thread, TaskId id);
+
+  /** @brief Push a ready task onto the queue of a thread */
+  void push(unsigned int thread, TaskId id);
+
+private:
+  const unsigned int num_threads_;                   // threads including the caller
+  std::vector<Task> tasks_;                          // task nodes
+  std::vector<std::atomic<unsigned int>> pending_;   // unfinished predecessors per task
+  std::vector<TaskRecord> timeline_;                 // last run
+  std::unique_ptr<WorkQueue[]> queues_;              // ready tasks per thread
+  std::atomic<unsigned int> remaining_;              // unfinished tasks of the run
+
+  std::vector<std::thread> workers_;  // worker threads
+  uint64_t generation_;               // run count, wakes the workers
+  unsigned int active_;               // workers taking part in the current run
+  bool running_;                      // workers running
+  std::mutex mutex_;                  // guards the run state and the fields above
+  std::condition_variable start_cv_;  // new run or shutdown
+  std::condition_variable done_cv_;   // a worker left the run
+};
+}  // namespace realtime
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,381 @@
+/**
+ * @file trace.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Timeline tracing of the control loop in Chrome trace format
+ *
+ * @details Tracing is compiled in with -DQUADRUPED_TRACE=ON. Without it the TRACE_*
+ * macros expand to nothing and their arguments are not evaluated.
+ *
+ * Each thread pushes fixed size events into its own wait-free SPSC queue. A
+ * background thread drains the queues and streams the events to a Chrome trace
+ * JSON file, which opens in the Perfetto UI (https://ui.perfetto.dev, "Open trace
+ * file") or chrome://tracing. Names and categories must be string literals. The
+ * first event from a thread allocates that thread's queue (see TRACE_THREAD()).
+ *
+ *    TRACE_START("/tmp/commander.trace.json", "commander");
+ *    TRACE_THREAD("control");
+ *    {
+ *      TRACE_SCOPE("commander", "tick");
+ *      ...
+ *    }
+ *    TRACE_INSTANT("commander", "joint_states");
+ *    TRACE_STOP();
+ *
+ * Timestamps are from the monotonic clock so traces written by different
+ * processes line up and can be merged, e.g. jq -s add a.json b.json > ab.json
+ *
+ * This file is header only so nodes outside of this package can be traced
+ * without linking the controller library.
+ */
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Linux
+#include <unistd.h>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/spsc_queue.hpp>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+constexpr std::size_t TRACE_QUEUE_SIZE = 8192;  // events per thread
+
+/** @brief Chrome trace event types */
+enum TracePhase : char
+{
+  complete = 'X',  // span with a duration
+  instant = 'i'    // point in time
+};
+
+/** @brief A queued trace event */
+struct TraceEvent
+{
+  const char* category;  // category, string literal
+  const char* name;      // name, string literal
+  int64_t start_ns;      // start time (ns)
+  int64_t duration_ns;   // duration (ns), complete events only
+  TracePhase phase;      // event type
+};
+
+/**
+ * @brief Streams trace events from all threads to a Chrome trace JSON file
+ */
+class Tracer
+{
+public:
+  /** @brief Return the process wide tracer */
+  static Tracer& instance()
+  {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  ~Tracer()
+  {
+    stop();
+  }
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /**
+   * @brief Open the trace file and start recording
+   * @param path - trace file
+   * @param process_name - name shown for this process
+   * @return true if recording started
+   */
+  bool start(const std::string& path, const std::string& process_name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_)
+    {
+      return false;
+    }
+
+    file_ = std::fopen(path.c_str(), "w");
+    if (!file_)
+    {
+      return false;
+    }
+
+    std::fprintf(file_,
+                 "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+                 "\"args\":{\"name\":\"%s\"}}",
+                 pid_, process_name.c_str());
+
+    // Threads named before the trace started
+    for (auto& buffer : buffers_)
+    {
+      buffer->named = false;
+    }
+
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&Tracer::run, this);
+    return true;
+  }
+
+  /** @brief Write all queued events and close the trace file */
+  void stop()
+  {
+    if (!running_.exchange(false, std::memory_order_acq_rel))
+    {
+      return;
+    }
+
+    writer_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain();
+    std::fprintf(file_, "\n]\n");
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+
+  /**
+   * @brief Name the calling thread and allocate its queue
+   * @param name - name shown for this thread
+   * @details Call before entering a real-time loop so the first event does not
+   * allocate.
+   */
+  void registerThread(const char* name)
+  {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer.name = name;
+    buffer.named = false;
+  }
+
+  /** @brief Return true if events are being recorded */
+  bool enabled() const
+  {
+    return running_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Queue an event from the calling thread
+   * @param event - trace event
+   * @details Never blocks. The event is dropped if the queue is full.
+   */
+  void record(const TraceEvent& event)
+  {
+    if (!enabled())
+    {
+      return;
+    }
+
+    ThreadBuffer& buffer = threadBuffer();
+    if (!buffer.queue.push(event))
+    {
+      buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /** @brief Return the number of events dropped because a queue was full */
+  uint64_t dropped() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t total = 0;
+    for (const auto& buffer : buffers_)
+    {
+      total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    return total;
+  }
+
+  /** @brief Return a monotonic clock in nanoseconds */
+  static int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+private:
+  /** @brief Producer queue */
+  struct ThreadBuffer
+  {
+    SPSCQueue<TraceEvent, TRACE_QUEUE_SIZE> queue;  // events
+    std::atomic<uint64_t> dropped{ 0 };            // events dropped, queue full
+    unsigned int tid = 0;                          // thread id in the trace
+    std::string name;                              // thread name
+    bool named = false;                            // thread name written
+  };
+
+  Tracer() : pid_(static_cast<int>(getpid())), file_(nullptr), running_(false)
+  {
+  }
+
+  /** @brief Return the calling thread's queue, allocating it on first use */
+  ThreadBuffer& threadBuffer()
+  {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer)
+    {
+      // Owned by the tracer so events are written after the thread exits
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers_.emplace_back(new ThreadBuffer());
+      buffer = buffers_.back().get();
+      buffer->tid = static_cast<unsigned int>(buffers_.size());
+      buffer->name = "thread " + std::to_string(buffer->tid);
+    }
+
+    return *buffer;
+  }
+
+  /** @brief Background thread */
+  void run()
+  {
+    while (running_.load(std::memory_order_acquire))
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain();
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  /** @brief Pop all events and write them to the file, requires the mutex */
+  void drain()
+  {
+    TraceEvent event;
+    for (auto& buffer : buffers_)
+    {
+      if (!buffer->named)
+      {
+        std::fprintf(file_,
+                     ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,"
+                     "\"args\":{\"name\":\"%s\"}}",
+                     pid_, buffer->tid, buffer->name.c_str());
+        buffer->named = true;
+      }
+
+      while (buffer->queue.pop(event))
+      {
+        if (event.phase == TracePhase::complete)
+        {
+          std::fprintf(file_,
+                       ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+                       "\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                       event.name, event.category, event.start_ns * 1e-3,
+                       event.duration_ns * 1e-3, pid_, buffer->tid);
+        }
+        else
+        {
+          std::fprintf(file_,
+                       ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                       "\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                       event.name, event.category, event.start_ns * 1e-3, pid_,
+                       buffer->tid);
+        }
+      }
+    }
+
+    std::fflush(file_);
+  }
+
+private:
+  int pid_;                                             // process id
+  std::FILE* file_;                                     // trace file
+  std::atomic<bool> running_;                           // recording events
+  mutable std::mutex mutex_;                            // guards buffers_ and file_
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;  // one per producer thread
+  std::thread writer_;                                  // drains the queues
+};
+
+/** @brief Records a complete event for the lifetime of the scope */
+class TraceScope
+{
+public:
+  /**
+   * @brief Constructor
+   * @param category - category, string literal
+   * @param name - name, string literal
+   */
+  TraceScope(const char* category, const char* name)
+    : category_(category)
+    , name_(name)
+    , start_ns_(Tracer::instance().enabled() ? Tracer::now() : 0)
+  {
+  }
+
+  ~TraceScope()
+  {
+    if (start_ns_ != 0)
+    {
+      const int64_t duration_ns = Tracer::now() - start_ns_;
+      Tracer::instance().record(
+          { category_, name_, start_ns_, duration_ns, TracePhase::complete });
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* category_;  // category
+  const char* name_;      // name
+  int64_t start_ns_;      // start time (ns), 0 if not recording
+};
+}  // namespace realtime
+}  // namespace quadruped_controller
+
+#ifdef QUADRUPED_TRACE
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+// Open the trace file, recording stops at TRACE_STOP() or on exit
+#define TRACE_START(path, process_name)                                                \
+  ::quadruped_controller::realtime::Tracer::instance().start(path, process_name)
+#define TRACE_STOP() ::quadruped_controller::realtime::Tracer::instance().stop()
+
+// Name the calling thread
+#define TRACE_THREAD(name)                                                             \
+  ::quadruped_controller::realtime::Tracer::instance().registerThread(name)
+
+// Span from here to the end of the enclosing scope
+#define TRACE_SCOPE(category, name)                                                    \
+  ::quadruped_controller::realtime::TraceScope TRACE_CONCAT(trace_scope_,              \
+                                                            __LINE__)(category, name)
+
+// Point in time, e.g. a message arrival
+#define TRACE_INSTANT(category, name)                                                  \
+  ::quadruped_controller::realtime::Tracer::instance().record(                         \
+      { category, name, ::quadruped_controller::realtime::Tracer::now(), 0,            \
+        ::quadruped_controller::realtime::TracePhase::instant })
+
+// Span measured by the caller (ns from Tracer::now() or steady_clock)
+#define TRACE_COMPLETE(category, name, start_ns, end_ns)                               \
+  ::quadruped_controller::realtime::Tracer::instance().record(                         \
+      { category, name, start_ns, (end_ns) - (start_ns),                               \
+        ::quadruped_controller::realtime::TracePhase::complete })
+
+#else
+
+#define TRACE_START(path, process_name) static_cast<void>(0)
+#define TRACE_STOP() static_cast<void>(0)
+#define TRACE_THREAD(name) static_cast<void>(0)
+#define TRACE_SCOPE(category, name) static_cast<void>(0)
+#define TRACE_INSTANT(category, name) static_cast<void>(0)
+#define TRACE_COMPLETE(category, name, start_ns, end_ns) static_cast<void>(0)
+
+#endif
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file watchdog.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Deadline monitoring of the control loop
+ *
+ * @details Every tick is timed against its deadline. A miss raises the degradation
+ * level by one and a run of ticks on time lowers it again by one. The owner maps
+ * the level to a cheaper mode of operation, see DegradationMode. A background
+ * thread watches the tick in progress so a tick that never finishes is reported
+ * while it is stalled rather than when it returns. The next tick after a stall
+ * starts at the highest level.
+ *
+ *    DeadlineWatchdog watchdog(0.001, 4);
+ *    while (running)
+ *    {
+ *      watchdog.tickStart();
+ *      pipeline.setDegradationMode(static_cast<DegradationMode>(watchdog.level()));
+ *      ...
+ *      watchdog.tickEnd();
+ *    }
+ */
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+// C++
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+constexpr unsigned int WATCHDOG_MAX_LEVELS = 8;  // degradation levels
+
+/** @brief Deadline events counted by the watchdog */
+struct WatchdogStats
+{
+  /** @brief Reset all statistics */
+  void reset();
+
+  uint64_t ticks = 0;        // completed ticks
+  uint64_t misses = 0;       // ticks longer than the deadline
+  uint64_t stalls = 0;       // ticks longer than the stall timeout
+  uint64_t escalations = 0;  // level increases
+  uint64_t recoveries = 0;   // level decreases
+  double last_time = 0.0;    // last tick time (s)
+  double max_time = 0.0;     // max tick time (s)
+  std::array<uint64_t, WATCHDOG_MAX_LEVELS> level_ticks{};  // ticks run at each level
+};
+
+/**
+ * @brief Measures each tick against its deadline and selects a degradation level
+ * @details tickStart() and tickEnd() are called from the control thread and do not
+ * block or allocate. The monitor thread only reads the start time of the tick in
+ * progress.
+ */
+class DeadlineWatchdog
+{
+public:
+  /**
+   * @brief Constructor
+   * @param deadline - max tick time (s)
+   * @param num_levels - number of degradation levels including nominal (level 0)
+   * @param escalate_after - consecutive misses before the level is raised
+   * @param recover_after - consecutive ticks on time before the level is lowered
+   * @param stall_timeout - tick time at which the monitor reports a stall (s)
+   */
+  DeadlineWatchdog(double deadline, unsigned int num_levels,
+                   unsigned int escalate_after = 1, unsigned int recover_after = 1000,
+                   double stall_timeout = 0.1);
+
+  ~DeadlineWatchdog();
+
+  DeadlineWatchdog(const DeadlineWatchdog&) = delete;
+  DeadlineWatchdog& operator=(const DeadlineWatchdog&) = delete;
+
+  /** @brief Mark the start of a tick */
+  void tickStart();
+
+  /**
+   * @brief Mark the end of a tick and update the degradation level
+   * @return true if the tick missed its deadline
+   */
+  bool tickEnd();
+
+  /** @brief Return the degradation level for the next tick */
+  unsigned int level() const;
+
+  /** @brief Return the watchdog statistics */
+  const WatchdogStats& stats() const;
+
+  /** @brief Reset the watchdog statistics, the level is kept */
+  void resetStats();
+
+private:
+  /** @brief Monitor thread */
+  void run();
+
+  /**
+   * @brief Move to a new level
+   * @param level - degradation level
+   * @param reason - cause of the change, string literal
+   */
+  void setLevel(unsigned int level, const char* reason);
+
+private:
+  int64_t deadline_ns_;          // max tick time (ns)
+  int64_t stall_timeout_ns_;     // stall time (ns)
+  unsigned int num_levels_;      // number of levels
+  unsigned int escalate_after_;  // misses before escalating
+  unsigned int recover_after_;   // ticks on time before recovering
+
+  unsigned int level_;               // current level
+  unsigned int consecutive_misses_;  // misses in a row
+  unsigned int consecutive_hits_;    // ticks on time in a row
+  WatchdogStats stats_;              // deadline events
+
+  std::atomic<int64_t> tick_start_ns_;  // start of the tick in progress, 0 if idle
+  std::atomic<bool> stalled_;           // monitor saw the tick in progress stall
+  std::atomic<bool> running_;           // monitor is running
+  std::mutex mutex_;                    // monitor wake up
+  std::condition_variable cv_;
+  std::thread monitor_;
+};
+}  // namespace realtime
+}  // namespace quadruped_controller
+#endif
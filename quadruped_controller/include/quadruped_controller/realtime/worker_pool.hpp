@@ -0,0 +1,88 @@
+/**
+ * @file worker_pool.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Fixed pool of threads for running independent control work in parallel
+ *
+ * @details The pool runs one batch at a time. parallelFor() hands out indices
+ * through an atomic counter so items are balanced across the workers and the
+ * calling thread, which also takes items, and it returns once every item is done.
+ *
+ *    realtime::WorkerPool pool(3);
+ *    pool.parallelFor(robots.size(), [&](std::size_t i) { robots[i]->tick(); });
+ */
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+// C++
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+/**
+ * @brief Runs batches of independent items on a fixed set of threads
+ * @details The threads are created once and sleep between batches. A batch does
+ * not allocate. Only one thread may call parallelFor() at a time.
+ */
+class WorkerPool
+{
+public:
+  /**
+   * @brief Constructor
+   * @param num_threads - worker threads, the calling thread is an additional worker
+   * @param cpus - CPU each worker thread is pinned to, cycled if there are fewer CPUs
+   * than threads, empty to let the scheduler place the threads
+   */
+  explicit WorkerPool(unsigned int num_threads, const std::vector<int>& cpus = {});
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /**
+   * @brief Run work(i) for every i in [0, n) and wait for all of them
+   * @param n - number of items
+   * @param work - called once per item, possibly concurrently
+   */
+  void parallelFor(std::size_t n, const std::function<void(std::size_t)>& work);
+
+  /** @brief Return the number of worker threads */
+  unsigned int size() const;
+
+private:
+  /**
+   * @brief Worker thread
+   * @param cpu - CPU to pin the thread to, negative to not pin
+   */
+  void run(int cpu);
+
+  /** @brief Take and run items of the current batch until none are left */
+  void drain();
+
+private:
+  std::vector<std::thread> workers_;  // worker threads
+
+  const std::function<void(std::size_t)>* work_;  // current batch, null between batches
+  std::size_t num_items_;                         // items in the current batch
+  std::atomic<std::size_t> next_;                 // next item to take
+
+  uint64_t generation_;   // batch count, wakes the workers
+  unsigned int active_;   // workers taking items from the current batch
+  bool running_;          // workers running
+  std::mutex mutex_;      // guards everything except next_
+  std::condition_variable start_cv_;  // new batch or shutdown
+  std::condition_variable done_cv_;   // a worker left the batch
+};
+}  // namespace realtime
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file robot_config.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Robot configuration compiled from the robot config YAML
+ *
+ * @details scripts/generate_robot_config.py turns the robot config YAML into
+ * robot_config_generated.hpp at build time, which defines the constexpr
+ * ROBOT_CONFIG below. The generator checks the joint and actuator counts, the
+ * actuator order, the joint names, and the sizes of the gains, so a bad config fails
+ * the build.
+ * The structure (legs, joints, actuators) is fixed at build time. The gains,
+ * limits, and dynamics can still be overridden by ROS parameters for tuning with
+ * load_robot_config().
+ *
+ *    constexpr std::size_t i = actuator_index(1, 2);  // FL calf
+ *    const char* name = ROBOT_CONFIG.actuator_names[i];
+ *    const double q = msg->position[ROBOT_CONFIG.joint_state_index[i]];
+ */
+#ifndef ROBOT_CONFIG_HPP
+#define ROBOT_CONFIG_HPP
+
+// C++
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+// ROS
+#include <ros/ros.h>
+
+namespace quadruped_controller
+{
+constexpr std::size_t NUM_LEGS = 4;                            // legs [RL FL RR FR]
+constexpr std::size_t JOINTS_PER_LEG = 3;                      // hip, thigh, calf
+constexpr std::size_t NUM_JOINTS = NUM_LEGS * JOINTS_PER_LEG;  // actuated joints
+
+/** @brief Robot structure, gains, limits, and dynamics */
+struct RobotConfig
+{
+  // Structure, fixed at build time
+  std::array<const char*, NUM_LEGS> leg_names;            // leg order
+  std::array<const char*, NUM_JOINTS> actuator_names;     // leg major, hip to calf
+  std::array<const char*, NUM_JOINTS> joint_names;        // joint state order
+  std::array<std::size_t, NUM_JOINTS> joint_state_index;  // joint state of each actuator
+  const char* base_link;                                  // body COM frame
+
+  // Gait
+  double frequency;                           // control frequency (Hz)
+  double t_stance;                            // stance time (s)
+  double t_swing;                             // swing time (s)
+  double height;                              // max swing foot height (m)
+  std::array<double, NUM_LEGS> phase_offset;  // gait phase offsets [0 1)
+
+  // Swing leg joint control
+  std::array<double, JOINTS_PER_LEG> jc_kff;  // feed forward gains
+  std::array<double, JOINTS_PER_LEG> jc_kp;   // kp gains
+  std::array<double, JOINTS_PER_LEG> jc_kd;   // kd gains
+
+  // Balance control
+  double tau_min;                    // min joint torque (N*m)
+  double tau_max;                    // max joint torque (N*m)
+  std::array<double, 6> s_diagonal;  // weights on the least squares
+  double w_diagonal;                 // weight on the forces
+  std::array<double, 6> kff;         // feed forward gains
+  std::array<double, 3> kp_p;        // COM position Kp
+  std::array<double, 3> kp_w;        // COM orientation Kp
+  std::array<double, 3> kd_p;        // COM linear velocity Kd
+  std::array<double, 3> kd_w;        // COM angular velocity Kd
+
+  // Dynamics
+  std::array<double, 3> Ib;  // diagonal of the body inertia (kg*m^2)
+  double mass;               // total mass (kg)
+  double mu;                 // friction coefficient
+  double fzmin;              // min normal GRF (N)
+  double fzmax;              // max normal GRF (N)
+};
+
+/**
+ * @brief Index of a joint in the actuator order
+ * @param leg - leg index
+ * @param joint - joint of the leg, 0 hip, 1 thigh, 2 calf
+ * @return actuator index
+ */
+constexpr std::size_t actuator_index(std::size_t leg, std::size_t joint)
+{
+  return leg * JOINTS_PER_LEG + joint;
+}
+
+/**
+ * @brief Check the joint state index of a configuration
+ * @param config - robot configuration
+ * @return true if every joint state is used by exactly one actuator and is a joint
+ * of the actuator's leg
+ */
+constexpr bool valid_joint_state_index(const RobotConfig& config)
+{
+  for (std::size_t i = 0; i < NUM_JOINTS; i++)
+  {
+    const std::size_t index = config.joint_state_index[i];
+    if (index >= NUM_JOINTS ||
+        !std::string_view(config.joint_names[index])
+             .starts_with(config.leg_names[i / JOINTS_PER_LEG]))
+    {
+      return false;
+    }
+
+    for (std::size_t j = 0; j < i; j++)
+    {
+      if (config.joint_state_index[j] == index)
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+}  // namespace quadruped_controller
+
+// Defines ROBOT_CONFIG
+#include <quadruped_controller/robot_config_generated.hpp>
+
+namespace quadruped_controller
+{
+/**
+ * @brief Override the tunable values of a configuration
+ * @param pnh - private node handle, the parameters use the YAML names
+ * @param config - configuration to override, the compiled one by default
+ * @return configuration with every parameter set on the server applied
+ * @details Parameters of the wrong size or type are reported and ignored. Overridden
+ * limits and dynamics are checked like the compiled ones, values that fail a check are
+ * reported and the ones in config kept. Structural parameters differing from the
+ * compiled ones are reported, changing them requires a rebuild.
+ */
+RobotConfig load_robot_config(const ros::NodeHandle& pnh,
+                              const RobotConfig& config = ROBOT_CONFIG);
+
+/**
+ * @brief Override the tunable values of a configuration
+ * @param pnh - private node handle, the parameters use the YAML names
+ * @param config - configuration to override
+ * @param rejected - number of parameters reported and ignored (output)
+ * @return configuration with every accepted parameter applied
+ */
+RobotConfig load_robot_config(const ros::NodeHandle& pnh, const RobotConfig& config,
+                              unsigned int& rejected);
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file solve_rate_controller.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Skips balance QP solves when the problem barely changes
+ *
+ * @details While standing or walking slowly the feet, orientation, and desired wrench
+ * change little between ticks. After every full solve the solution is stored as an
+ * anchor together with its active set and its sensitivity to the desired wrench b and
+ * to the feet relative to the COM in world frame r = Rwb*ft_p. Differentiating the
+ * KKT conditions of the active set Q*x + c + Ca.T*y = 0, Ca*x = ba gives
+ *
+ *    [Q   Ca.T] [dx]   [2*A.T*S*db - 2*dA.T*S*(A*x - b) - 2*A.T*S*dA*x]
+ *    [Ca  0   ] [dy] = [0                                             ]
+ *
+ * where dA holds the skew symmetric matrices of dr in the moment rows. While the
+ * stance legs are the same and the feet, orientation, and wrench are within
+ * tolerances of the anchor, the solution is updated to first order instead of solving
+ * the QP. The update is only accepted if it stays primal feasible and the active
+ * multipliers keep their sign.
+ *
+ * Running the QP at a lower rate than the controller, for example every 4th tick,
+ * is max_updates = 3 with tolerances that are not reached between solves.
+ */
+#ifndef SOLVE_RATE_CONTROLLER_HPP
+#define SOLVE_RATE_CONTROLLER_HPP
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat;
+using arma::vec;
+
+/** @brief Change tolerances of the solve-rate controller */
+struct SolveRateSettings
+{
+  bool enabled = false;              // update the last solution instead of solving
+  double foot_tolerance = 0.002;     // max foot displacement in body frame (m)
+  double rotation_tolerance = 0.01;  // max rotation of the body (rad)
+  double force_tolerance = 20.0;     // max change of the desired net force (N)
+  double moment_tolerance = 3.0;     // max change of the desired net moment (N*m)
+  unsigned int max_updates = 20;     // consecutive updates before a full solve
+};
+
+/** @brief Reuses the balance QP solution through its sensitivity */
+class SolveRateController
+{
+public:
+  /**
+   * @brief Constructor
+   * @param settings - change tolerances
+   */
+  SolveRateController(const SolveRateSettings& settings);
+
+  /**
+   * @brief Update the anchor solution to first order
+   * @param stance_mask - bit i is set if leg i is in stance
+   * @param ft_p - positions of feet in body frame (3x4)
+   * @param Rwb - rotation from world to base_link (3x3)
+   * @param b - desired wrench in world frame (6x1)
+   * @param lb - constraint lower bounds
+   * @param ub - constraint upper bounds
+   * @param fw[out] - GRFs in world frame (12x1)
+   * @return true if fw is valid, false if the QP must be solved
+   */
+  bool update(uint32_t stance_mask, const mat& ft_p, const mat& Rwb, const vec& b,
+              const vec& lb, const vec& ub, vec& fw);
+
+  /**
+   * @brief Store a full solution as the anchor
+   * @param stance_mask - bit i is set if leg i is in stance
+   * @param ft_p - positions of feet in body frame (3x4)
+   * @param Rwb - rotation from world to base_link (3x3)
+   * @param b - desired wrench in world frame (6x1)
+   * @param A - wrench map of the GRFs (6x12)
+   * @param S - weight on least squares (6x6)
+   * @param Q - Hessian (12x12)
+   * @param c - linear cost (12x1)
+   * @param C - constraint matrix, starting with the 5 friction rows of each leg
+   * @param lb - constraint lower bounds
+   * @param ub - constraint upper bounds
+   * @param fw - GRFs in world frame (12x1)
+   * @details The anchor is dropped if its KKT system is singular.
+   */
+  void anchor(uint32_t stance_mask, const mat& ft_p, const mat& Rwb, const vec& b,
+              const mat& A, const mat& S, const mat& Q, const vec& c, const mat& C,
+              const vec& lb, const vec& ub, const vec& fw);
+
+  /** @brief Drop the anchor so the next tick solves the QP */
+  void reset();
+
+  /** @brief Return true if enabled */
+  bool enabled() const;
+
+private:
+  SolveRateSettings settings_;  // tolerances
+
+  bool valid_;                // anchor available
+  unsigned int updates_;      // updates since the anchor
+  uint32_t stance_mask_;      // stance legs of the anchor
+  mat ft_p_;                  // feet of the anchor (3x4)
+  mat Rwb_;                   // orientation of the anchor (3x3)
+  vec b_;                     // desired wrench of the anchor (6x1)
+  vec fw_;                    // GRFs of the anchor (12x1)
+  mat r_;                     // feet relative to the COM in world frame (3x4)
+  mat dfw_db_;                // GRF sensitivity to the wrench (12x6)
+  mat dfw_dr_;                // GRF sensitivity to the feet (12x12)
+
+  mat C_;                           // friction rows of the stance legs
+  std::vector<unsigned int> rows_;  // constraint row of each row of C_
+  std::vector<int> active_;         // -1 lower, 1 upper, 0 inactive, per row of C_
+  vec y_;                           // multipliers of the active rows
+  mat dy_db_;                       // multiplier sensitivity to the wrench
+  mat dy_dr_;                       // multiplier sensitivity to the feet
+};
+}  // namespace quadruped_controller
+#endif
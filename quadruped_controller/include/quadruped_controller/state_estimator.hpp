@@ -0,0 +1,171 @@
+/**
+ * @file state_estimator.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Body state estimation from an IMU and leg kinematics
+ *
+ * @details Linear Kalman filter in the style of the MIT Cheetah 3 estimator.
+ * Orientation and angular velocity are taken directly from the IMU. The filter
+ * estimates the body position, linear velocity, and the four foot positions in
+ * the world frame. The IMU acceleration drives the prediction and leg kinematics
+ * correct it. Feet in stance are assumed to be stationary on the ground and feet
+ * in swing are distrusted by scaling their noise.
+ */
+#ifndef STATE_ESTIMATOR_HPP
+#define STATE_ESTIMATOR_HPP
+
+// C++
+#include <array>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/kinematics.hpp>
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat33;
+using arma::vec3;
+
+/** @brief Number of estimated states [p, v, p_RL, p_FL, p_RR, p_FR] */
+constexpr unsigned int NUM_ESTIMATOR_STATES = 18;
+
+/** @brief Filter state vector */
+typedef arma::vec::fixed<NUM_ESTIMATOR_STATES> EstimatorVector;
+
+/** @brief Filter covariance */
+typedef arma::mat::fixed<NUM_ESTIMATOR_STATES, NUM_ESTIMATOR_STATES> EstimatorMatrix;
+
+/** @brief IMU measurement */
+struct ImuMeasurement
+{
+  ImuMeasurement()
+    : Rwb(arma::fill::eye), omega(arma::fill::zeros), accel(arma::fill::zeros)
+  {
+  }
+
+  mat33 Rwb;   // orientation, rotation from world to body (3x3)
+  vec3 omega;  // angular velocity in body frame [wx, wy, wz]
+  vec3 accel;  // specific force in body frame [ax, ay, az] (m/s^2)
+};
+
+/** @brief Parameters for the state estimator, noise values are standard deviations */
+struct StateEstimatorConfig
+{
+  double dt = 0.001;  // time step (s)
+
+  // Process noise per sqrt(s)
+  double process_noise_p = 0.03;     // body position (m)
+  double process_noise_v = 0.1;      // body velocity (m/s)
+  double process_noise_foot = 0.05;  // foot position (m)
+
+  // Sensor noise
+  double sensor_noise_p_rel = 0.03;   // foot position relative to body (m)
+  double sensor_noise_v_rel = 0.3;    // foot velocity relative to body (m/s)
+  double sensor_noise_height = 0.03;  // foot height (m)
+
+  // Scaling on the foot process noise variance and the contact measurement
+  // variances of legs in swing
+  double swing_noise_scale = 100.0;
+
+  // Initial variance of every state
+  double initial_covariance = 1e-2;
+
+  // Height of the ground in world (m)
+  double ground_height = 0.0;
+
+  // Leg names [RL FL RR FR]
+  std::vector<std::string> leg_names = { "RL", "FL", "RR", "FR" };
+};
+
+/**
+ * @brief Estimates the body state for the controller
+ * @details The state and covariance are fixed size so an update does not allocate.
+ * The filter is sparse: the state transition only couples position to velocity and
+ * every measurement row has one or two nonzero entries. The prediction only
+ * updates the rows and columns of the position block and the measurements are
+ * applied as a sequence of scalar updates, which is equivalent to the batch update
+ * because the measurement noise is diagonal. No matrix inverse is required.
+ */
+class StateEstimator
+{
+public:
+  /**
+   * @brief Constructor
+   * @param config - estimator parameters
+   */
+  StateEstimator(const StateEstimatorConfig& config = StateEstimatorConfig());
+
+  /**
+   * @brief Reset the filter, it is initialized again on the next update
+   * @param x - body position in world [x, y, z]
+   * @details The height is replaced by the height computed from the legs assuming
+   * all feet are on the ground.
+   */
+  void reset(const vec3& x = vec3(arma::fill::zeros));
+
+  /**
+   * @brief Advance the filter one time step
+   * @param imu - IMU measurement
+   * @param joint_states_map - map leg names to joint states
+   * @param gait_map - map leg names to gait state, stance legs are assumed in contact
+   * @return estimated body state
+   */
+  const RobotStateCoM& update(const ImuMeasurement& imu,
+                              const JointStatesMap& joint_states_map,
+                              const GaitMap& gait_map);
+
+  /** @brief Return the estimated body state */
+  const RobotStateCoM& state() const;
+
+  /**
+   * @brief Return an estimated foot position
+   * @param leg - leg index [RL FL RR FR]
+   * @return foot position in world [x, y, z]
+   */
+  vec3 footPosition(unsigned int leg) const;
+
+  /** @brief Return the filter covariance */
+  const EstimatorMatrix& covariance() const;
+
+  /** @brief Return true once the filter has been initialized */
+  bool initialized() const;
+
+private:
+  /**
+   * @brief Initialize the state from the first measurement
+   * @param imu - IMU measurement
+   * @param joint_states_map - map leg names to joint states
+   */
+  void initialize(const ImuMeasurement& imu, const JointStatesMap& joint_states_map);
+
+  /**
+   * @brief Propagate the state and covariance
+   * @param accel - body acceleration in world frame [ax, ay, az]
+   * @param foot_noise_scale - process noise scaling for each foot
+   */
+  void predict(const vec3& accel, const std::array<double, 4>& foot_noise_scale);
+
+  /**
+   * @brief Apply a scalar measurement y = x(i) - x(j)
+   * @param i - index of state with coefficient 1
+   * @param j - index of state with coefficient -1, NUM_ESTIMATOR_STATES if unused
+   * @param y - measurement
+   * @param r - measurement variance
+   */
+  void correct(unsigned int i, unsigned int j, double y, double r);
+
+private:
+  StateEstimatorConfig config_;     // parameters
+  QuadrupedKinematics kinematics_;  // leg kinematics
+  EstimatorVector x_;               // [p, v, p_RL, p_FL, p_RR, p_FR]
+  EstimatorMatrix P_;               // covariance
+  EstimatorVector PHt_;             // scratch for P*H^T
+  RobotStateCoM state_;             // estimated body state
+  vec3 g_;                          // gravity vector in world frame (m/s^2)
+  vec3 x_init_;                     // initial body position
+  bool initialized_;                // filter has been initialized
+};
+}  // namespace quadruped_controller
+#endif
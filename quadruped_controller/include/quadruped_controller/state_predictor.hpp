@@ -0,0 +1,95 @@
+/**
+ * @file state_predictor.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Forward prediction of the COM state to compensate for latency
+ */
+#ifndef STATE_PREDICTOR_HPP
+#define STATE_PREDICTOR_HPP
+
+// C++
+#include <cstdint>
+
+// Quadruped Control
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+using arma::mat33;
+using arma::vec3;
+
+/** @brief Compensation applied by the state predictor */
+struct LatencyStats
+{
+  /** @brief Clear all statistics */
+  void reset()
+  {
+    predictions = 0;
+    last_latency = 0.0;
+    total_latency = 0.0;
+    max_latency = 0.0;
+    last_position_correction = 0.0;
+    max_position_correction = 0.0;
+    last_angle_correction = 0.0;
+    max_angle_correction = 0.0;
+  }
+
+  uint64_t predictions = 0;               // number of predictions
+  double last_latency = 0.0;              // last prediction horizon (s)
+  double total_latency = 0.0;             // sum of prediction horizons (s)
+  double max_latency = 0.0;               // max prediction horizon (s)
+  double last_position_correction = 0.0;  // last change in COM position (m)
+  double max_position_correction = 0.0;   // max change in COM position (m)
+  double last_angle_correction = 0.0;     // last change in COM orientation (rad)
+  double max_angle_correction = 0.0;      // max change in COM orientation (rad)
+};
+
+/**
+ * @brief Predicts the COM state forward in time with the single rigid body model
+ * @details The state is integrated over the latency between the measurement and
+ * the time the torques are applied. The GRFs from the last control tick act at the
+ * stance feet, which are assumed fixed in the world. Without GRFs the COM
+ * is assumed to hold its velocities because gravity is then balanced by contacts
+ * the controller does not know about.
+ */
+class StatePredictor
+{
+public:
+  /**
+   * @brief Constructor
+   * @param mass - total mass (kg)
+   * @param Ib - moment of inertia in body frame (3x3)
+   * @param max_horizon - longest prediction, latency is clamped to this (s)
+   * @param step - integration step (s)
+   */
+  StatePredictor(double mass, const mat33& Ib, double max_horizon = 0.05,
+                 double step = 0.001);
+
+  /**
+   * @brief Predict the COM state
+   * @param com_state - measured COM state
+   * @param foot_map - foot positions relative to the COM in body frame
+   * @param force_map - forces the stance feet apply to the ground in body frame
+   * @param latency - time from the measurement to actuation (s)
+   * @return COM state at the time of actuation
+   */
+  RobotStateCoM predict(const RobotStateCoM& com_state, const FootholdMap& foot_map,
+                        const ForceMap& force_map, double latency);
+
+  /** @brief Return the compensation applied since the last reset */
+  const LatencyStats& stats() const;
+
+  /** @brief Clear the compensation statistics */
+  void resetStats();
+
+private:
+  double mass_;         // total mass (kg)
+  mat33 Ib_;            // moment of inertia in body frame
+  mat33 Ib_inv_;        // inverse moment of inertia in body frame
+  vec3 g_;              // gravity vector in world frame (m/s^2)
+  double max_horizon_;  // max prediction (s)
+  double step_;         // integration step (s)
+  LatencyStats stats_;  // compensation applied
+};
+}  // namespace quadruped_controller
+#endif
@@ -112,13 +112,19 @@ public:
    */
   FootState trackTrajectory(double t) const;
 
+  /**
+   * @brief Retrieve the polynomial coefficients
+   * @return coefficients (7x3), row k multiplies t^k and the columns are [x y z]
+   */
+  const mat& coefficients() const;
+
 private:
   /**
    * @brief Construct system of equations
    * @return system (7x7)
    * @details In a linear system AX = B, this constructs A
    */
-  mat initSystem() const;
+  static mat initSystem();
 
   /**
    * @brief Construct constant terms
@@ -131,7 +137,7 @@ private:
   mat constantTerms(const vec3& p_start, const vec3& p_center, const vec3& p_final) const;
 
 private:
-  mat A_;                     // system (7x7)
+  static const mat A_inv_;    // inverse of the system (7x7)
   mutable mat coefficients_;  // polynomial coefficients (7x3)
 };
 
@@ -178,6 +184,14 @@ public:
    */
   FootState referenceState(const std::string& leg_name, double phase) const;
 
+  /**
+   * @brief Get the trajectory of a leg
+   * @param leg_name - leg name
+   * @return trajectory planned by the last call to referenceStates(GaitMap,
+   * FootTrajBoundsMap), null if the leg has none
+   */
+  const FootTrajectory* trajectory(const std::string& leg_name) const;
+
 private:
   double height_;        // max height in foot trajectory
   double stance_phase_;  // when stance phase ends [0 1)
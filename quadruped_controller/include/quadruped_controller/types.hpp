@@ -121,6 +121,15 @@ typedef std::map<std::string, vec3> ForceMap;
 /** @brief map leg name to joint toques [hip, thigh, calf] */
 typedef std::map<std::string, vec3> TorqueMap;
 
+/** @brief map leg name to foot Jacobian in body frame (3x3) */
+typedef std::map<std::string, mat33> JacobianMap;
+
+/** @brief COM error state [p, v, phi, w] or GRFs of all legs */
+typedef arma::vec::fixed<12> vec12;
+
+/** @brief Gain or Jacobian mapping between COM error states and GRFs */
+typedef arma::mat::fixed<12, 12> mat1212;
+
 //////////////////////////////////////////
 // Joint Types
 /** @brief map leg name to joint angular positions and velocities */
@@ -0,0 +1,114 @@
+/**
+ * @file foot_trajectory_visualizer.hpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Publishes the swing leg trajectories as markers off the control thread
+ *
+ * @details The control thread only copies the polynomial coefficients of newly
+ * planned trajectories into a wait-free queue. A low priority thread samples them
+ * into one SPHERE_LIST marker per leg, whose points are allocated once, and
+ * publishes at most at the configured rate. Trajectories planned faster than the
+ * rate are decimated, the newest trajectory of each leg is published.
+ *
+ *    FootTrajectoryVisualizer visualizer(publisher, leg_names, config);
+ *    if (pipeline.newFootholds())
+ *    {
+ *      visualizer.update(pipeline.footTrajectoryManager(), pipeline.footholds());
+ *    }
+ */
+#ifndef FOOT_TRAJECTORY_VISUALIZER_HPP
+#define FOOT_TRAJECTORY_VISUALIZER_HPP
+
+// C++
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ROS
+#include <ros/ros.h>
+#include <visualization_msgs/MarkerArray.h>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/spsc_queue.hpp>
+#include <quadruped_controller/trajectory.hpp>
+#include <quadruped_controller/types.hpp>
+
+namespace quadruped_controller
+{
+/** @brief Parameters of the foot trajectory visualizer */
+struct FootTrajectoryVisualizerConfig
+{
+  double rate = 10.0;                 // max publish rate (Hz)
+  unsigned int points = 30;           // points per trajectory
+  double lifetime = 0.0;              // marker lifetime (s), 0 to keep the markers
+  double scale = 0.01;                // point diameter (m)
+  std::string frame_id = "world";     // frame of the trajectories
+};
+
+/** @brief Publishes the swing leg trajectories from a low priority thread */
+class FootTrajectoryVisualizer
+{
+public:
+  /**
+   * @brief Constructor
+   * @param publisher - visualization_msgs/MarkerArray publisher
+   * @param leg_names - legs that may have trajectories
+   * @param config - visualizer parameters
+   * @details Legs FL and RR are red and the others blue, so the trot pairs match.
+   */
+  FootTrajectoryVisualizer(const ros::Publisher& publisher,
+                           const std::vector<std::string>& leg_names,
+                           const FootTrajectoryVisualizerConfig& config);
+
+  ~FootTrajectoryVisualizer();
+
+  FootTrajectoryVisualizer(const FootTrajectoryVisualizer&) = delete;
+  FootTrajectoryVisualizer& operator=(const FootTrajectoryVisualizer&) = delete;
+
+  /**
+   * @brief Queue the trajectories of the legs with new footholds
+   * @param foot_traj_manager - planned trajectories
+   * @param footholds - legs with new footholds
+   * @return false if the queue was full and trajectories were dropped
+   * @details Does not block or allocate, one thread at a time.
+   */
+  bool update(const FootTrajectoryManager& foot_traj_manager,
+              const FootholdMap& footholds);
+
+private:
+  /** @brief Polynomial of a newly planned trajectory */
+  struct TrajectoryUpdate
+  {
+    uint32_t leg;                      // index into the leg names
+    std::array<double, 21> coefficients;  // 7x3 coefficients, column major
+  };
+
+  /** @brief Publishing thread */
+  void run();
+
+  /** @brief Sample the queued trajectories and publish the legs that changed */
+  void publish();
+
+private:
+  static constexpr std::size_t QUEUE_SIZE = 16;  // queued trajectories
+
+  ros::Publisher publisher_;
+  FootTrajectoryVisualizerConfig config_;
+  std::vector<std::string> leg_names_;
+
+  realtime::SPSCQueue<TrajectoryUpdate, QUEUE_SIZE> queue_;  // control to publisher
+  visualization_msgs::MarkerArray markers_;  // one marker per leg, filled once
+  visualization_msgs::MarkerArray changed_;  // markers of the next message
+  std::vector<uint8_t> leg_changed_;         // leg has a new trajectory
+
+  std::thread thread_;                // publishing thread
+  bool running_;                      // publishing thread running
+  std::mutex mutex_;                  // guards running_
+  std::condition_variable stop_cv_;   // wakes the thread on shutdown
+};
+}  // namespace quadruped_controller
+#endif
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""Generate robot_config_generated.hpp from the robot config YAML.
+
+The header defines the constexpr ROBOT_CONFIG declared by robot_config.hpp.
+The configuration is checked here, so a bad joint count, actuator order, joint
+name, or gain size fails the build with a message naming the YAML key. The joint
+states are published in the order of joints/joint_names, the header maps each
+actuator to its index in that order.
+
+usage: generate_robot_config.py <config.yaml> <robot_config_generated.hpp>
+"""
+
+import os
+import sys
+
+import yaml
+
+NUM_LEGS = 4
+JOINTS_PER_LEG = 3
+NUM_JOINTS = NUM_LEGS * JOINTS_PER_LEG
+LEG_NAMES = ["RL", "FL", "RR", "FR"]
+JOINT_TYPES = ["hip", "thigh", "calf"]
+
+
+class ConfigError(Exception):
+    pass
+
+
+def lookup(config, key, default=None):
+    """Value of a slash separated key, the default if it is missing."""
+    value = config
+    for name in key.split("/"):
+        if not isinstance(value, dict) or name not in value:
+            if default is None:
+                raise ConfigError("missing %s" % key)
+            return default
+        value = value[name]
+    return value
+
+
+def number(config, key, default=None):
+    value = lookup(config, key, default)
+    # A single element list is accepted for scalars, e.g. w_diagonal: [1e-5]
+    if isinstance(value, list) and len(value) == 1:
+        value = value[0]
+    if isinstance(value, bool) or not isinstance(value, (int, float)):
+        raise ConfigError("%s must be a number, got %r" % (key, value))
+    return float(value)
+
+
+def numbers(config, key, size, default=None):
+    value = lookup(config, key, default)
+    if not isinstance(value, list) or len(value) != size:
+        raise ConfigError("%s must be a list of %d numbers, got %r" % (key, size, value))
+    return [number({"value": v}, "value") for v in value]
+
+
+def strings(config, key, size, default=None):
+    value = lookup(config, key, default)
+    if not isinstance(value, list) or len(value) != size:
+        raise ConfigError("%s must be a list of %d names, got %r" % (key, size, value))
+    if not all(isinstance(v, str) for v in value):
+        raise ConfigError("%s must contain names, got %r" % (key, value))
+    return value
+
+
+def load(path):
+    with open(path) as config_file:
+        config = yaml.safe_load(config_file)
+
+    num_joints = int(number(config, "joints/num_joints"))
+    if num_joints != NUM_JOINTS:
+        raise ConfigError("joints/num_joints is %d, the controller has %d legs with %d "
+                          "joints" % (num_joints, NUM_LEGS, JOINTS_PER_LEG))
+
+    leg_names = strings(config, "legs/leg_names", NUM_LEGS, LEG_NAMES)
+    actuator_names = strings(config, "joints/joint_actuator_names", NUM_JOINTS)
+
+    # Actuators are leg major in the leg order
+    for leg, leg_name in enumerate(leg_names):
+        for joint, joint_type in enumerate(JOINT_TYPES):
+            name = actuator_names[leg * JOINTS_PER_LEG + joint]
+            if not name.startswith(leg_name) or joint_type not in name:
+                raise ConfigError("joints/joint_actuator_names: %s is not the %s of "
+                                  "leg %s, actuators must be ordered %s with joints %s "
+                                  "each" % (name, joint_type, leg_name, leg_names,
+                                            JOINT_TYPES))
+
+    # Joint states may be in any order, find the joint of each actuator by name
+    joint_names = strings(config, "joints/joint_names", NUM_JOINTS)
+    joint_state_index = []
+    for leg_name in leg_names:
+        for joint_type in JOINT_TYPES:
+            matches = [i for i, name in enumerate(joint_names)
+                       if name.startswith(leg_name) and joint_type in name]
+            if len(matches) != 1:
+                raise ConfigError("joints/joint_names: expected one %s joint of leg %s, "
+                                  "found %s" % (joint_type, leg_name,
+                                                [joint_names[i] for i in matches]))
+            joint_state_index.append(matches[0])
+
+    values = {
+        "leg_names": leg_names,
+        "actuator_names": actuator_names,
+        "joint_names": joint_names,
+        "joint_state_index": joint_state_index,
+        "base_link": lookup(config, "links/base_link", "trunk"),
+        "frequency": number(config, "frequency", 100.0),
+        "t_stance": number(config, "gait/t_stance"),
+        "t_swing": number(config, "gait/t_swing"),
+        "height": number(config, "gait/height"),
+        "phase_offset": numbers(config, "gait/gait_offset_phases", NUM_LEGS),
+        "jc_kff": numbers(config, "joint_control/kff", JOINTS_PER_LEG),
+        "jc_kp": numbers(config, "joint_control/kp", JOINTS_PER_LEG),
+        "jc_kd": numbers(config, "joint_control/kd", JOINTS_PER_LEG),
+        "tau_min": number(config, "balance_control/torque_min"),
+        "tau_max": number(config, "balance_control/torque_max"),
+        "s_diagonal": numbers(config, "balance_control/s_diagonal", 6),
+        "w_diagonal": number(config, "balance_control/w_diagonal"),
+        "kff": numbers(config, "balance_control/kff", 6),
+        "kp_p": numbers(config, "balance_control/kp_p", 3),
+        "kp_w": numbers(config, "balance_control/kp_w", 3),
+        "kd_p": numbers(config, "balance_control/kd_p", 3),
+        "kd_w": numbers(config, "balance_control/kd_w", 3),
+        "Ib": numbers(config, "dynamics/Ib", 3),
+        "mass": number(config, "dynamics/mass"),
+        "mu": number(config, "dynamics/mu"),
+        "fzmin": number(config, "dynamics/fzmin"),
+        "fzmax": number(config, "dynamics/fzmax"),
+    }
+
+    if not all(0.0 <= phase < 1.0 for phase in values["phase_offset"]):
+        raise ConfigError("gait/gait_offset_phases must be on [0 1)")
+    if values["t_stance"] <= 0.0 or values["t_swing"] <= 0.0:
+        raise ConfigError("gait/t_stance and gait/t_swing must be positive")
+    if values["frequency"] <= 0.0:
+        raise ConfigError("frequency must be positive")
+
+    return values
+
+
+def cpp_value(value):
+    if isinstance(value, str):
+        return '"%s"' % value
+    if isinstance(value, list):
+        return "{ " + ", ".join(cpp_value(v) for v in value) + " }"
+    return repr(value)
+
+
+def header(config_path, values):
+    fields = "\n".join("  .%s = %s," % (k, cpp_value(v)) for k, v in values.items())
+    return """/**
+ * @file robot_config_generated.hpp
+ * @brief Generated by generate_robot_config.py from %s, do not edit
+ */
+#ifndef ROBOT_CONFIG_GENERATED_HPP
+#define ROBOT_CONFIG_GENERATED_HPP
+
+namespace quadruped_controller
+{
+constexpr RobotConfig ROBOT_CONFIG = {
+%s
+};
+
+static_assert(valid_joint_state_index(ROBOT_CONFIG),
+              "joints/joint_names must name each joint of each leg once");
+static_assert(ROBOT_CONFIG.tau_min < ROBOT_CONFIG.tau_max,
+              "balance_control/torque_min must be below torque_max");
+static_assert(ROBOT_CONFIG.fzmin >= 0.0 && ROBOT_CONFIG.fzmin < ROBOT_CONFIG.fzmax,
+              "dynamics/fzmin must be on [0 fzmax)");
+static_assert(ROBOT_CONFIG.mass > 0.0, "dynamics/mass must be positive");
+static_assert(ROBOT_CONFIG.mu > 0.0, "dynamics/mu must be positive");
+}  // namespace quadruped_controller
+#endif
+""" % (os.path.basename(config_path), fields)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+
+    try:
+        values = load(argv[1])
+    except (ConfigError, OSError, yaml.YAMLError) as error:
+        sys.stderr.write("%s: %s\n" % (argv[1], error))
+        return 1
+
+    os.makedirs(os.path.dirname(os.path.abspath(argv[2])), exist_ok=True)
+    with open(argv[2], "w") as output:
+        output.write(header(argv[1], values))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -4,26 +4,132 @@
  * @date 2021-02-21
  * @brief Main Quadruped command scheduler
  *
+ * @details Controls one or more robots from a single process. Each robot has its own
+ * state, planners, and solvers in a RobotContext and its topics and services in its
+ * namespace. Every period the callbacks of all robots are handled on the main
+ * thread and then the control ticks of all robots run in parallel on a shared
+ * worker pool.
+ *
  * @PARAMETERS:
+ *    frequency, gait/*, joint_control/*, balance_control/* gains and torque limits,
+ *    dynamics/* - override the robot configuration compiled from the robot config
+ *                 YAML (robot_config.hpp), the joints and links cannot be overridden
+ *    robots (string[]) - robot namespaces, empty for one robot in the node namespace
+ *    gait/enabled (bool) - start the gait once standing, false to stand in place and
+ *                          pose the body with cmd_vel [-, -, z, roll, pitch, yaw]
+ *    worker_threads (int) - pool threads running control ticks alongside the main
+ *                           thread, defaults to one per robot after the first
+ *    <robot>/initial_pose/position (double[]) - initial position of a robot, defaults
+ *                                               to initial_pose/position
+ *    record_path (string) - if set, record every control tick to this binary tick log,
+ *                           ".<robot>" is appended for each named robot
+ *    flight_recorder/duration (double) - seconds of ticks held by the flight recorder
+ *    flight_recorder/directory (string) - directory flight recorder dumps are written to
+ *    telemetry/path (string) - if set, write every control tick to this columnar
+ *                              telemetry log, ".<robot>" is appended for each named
+ *                              robot
+ *    telemetry/chunk_rows (int) - ticks per telemetry chunk
+ *    telemetry/compress (bool) - LZ4 compress the telemetry columns
+ *    state_estimation/enabled (bool) - estimate the body state from the IMU and leg
+ *                                      kinematics instead of subscribing to com_state
+ *    latency_compensation/enabled (bool) - predict the COM state to the actuation time
+ *    latency_compensation/actuation_delay (double) - time from publishing the torques
+ *                                                    to the simulator applying them (s)
+ *    latency_compensation/max_horizon (double) - longest prediction (s)
+ *    latency_compensation/report_period (double) - time between compensation reports (s)
+ *    balance_control/torque_limited_qp (bool) - keep the stance leg joint torques
+ *                                               within the limits in the balance QP
+ *    balance_control/explicit_qp_path (string) - explicit balance QP solutions from
+ *                                                explicit_qp_generator, empty to always
+ *                                                solve the QP
+ *    balance_control/qp_backend (string) - balance QP solver, qpoases or admm
+ *    balance_control/admm/rho (double) - initial ADMM constraint penalty
+ *    balance_control/admm/eps_abs (double) - ADMM absolute residual tolerance
+ *    balance_control/admm/eps_rel (double) - ADMM relative residual tolerance
+ *    balance_control/admm/max_iterations (int) - ADMM iterations per solve
+ *    balance_control/admm/warm_start (bool) - start ADMM from the last solution
+ *    balance_control/admm/polish (bool) - polish the ADMM solution
+ *    balance_control/solve_rate/enabled (bool) - update the last QP solution through
+ *                                                its sensitivity while the problem is
+ *                                                within the tolerances
+ *    balance_control/solve_rate/foot_tolerance (double) - max foot displacement (m)
+ *    balance_control/solve_rate/rotation_tolerance (double) - max body rotation (rad)
+ *    balance_control/solve_rate/force_tolerance (double) - max change of the desired
+ *                                                          net force (N)
+ *    balance_control/solve_rate/moment_tolerance (double) - max change of the desired
+ *                                                           net moment (N*m)
+ *    balance_control/solve_rate/max_updates (int) - consecutive updates before a solve
+ *    lqr_stance/enabled (bool) - GRFs from the LQR instead of the balance QP while
+ *                                standing with the gait stopped
+ *    lqr_stance/height_min (double) - lowest COM height of the gain grid (m)
+ *    lqr_stance/height_max (double) - highest COM height of the gain grid (m)
+ *    lqr_stance/height_samples (int) - gain grid points in height
+ *    lqr_stance/angle_max (double) - largest roll and pitch of the gain grid (rad)
+ *    lqr_stance/angle_samples (int) - gain grid points in roll and pitch
+ *    lqr_stance/q (double[]) - error weights [p, v, phi, w] (12)
+ *    lqr_stance/r (double) - weight on GRFs minus gravity compensation
+ *    nonlinear_mpc/enabled (bool) - GRFs from the nonlinear MPC instead of the
+ *                                   balance QP, which remains the fallback
+ *    nonlinear_mpc/horizon (int) - number of stages
+ *    nonlinear_mpc/dt (double) - stage duration (s)
+ *    nonlinear_mpc/q (double[]) - tracking weights [p, v, phi, w] (12)
+ *    nonlinear_mpc/r (double) - weight on GRFs minus gravity compensation
+ *    nonlinear_mpc/max_iterations (int) - iLQR iterations per multiplier update
+ *    nonlinear_mpc/max_outer_iterations (int) - augmented Lagrangian updates
+ *    nonlinear_mpc/threads (int) - threads for linearization and line search
+ *    leg_executor/type (string) - per leg work of a tick, serial, parallel, or batched
+ *    leg_executor/threads (int) - pool threads of the parallel leg executor
+ *    leg_executor/cpus (int[]) - CPUs the leg executor threads are pinned to
+ *    task_graph/enabled (bool) - run the stages of a tick as a task graph with the
+ *                                balance control alongside the swing legs
+ *    task_graph/threads (int) - task graph threads in addition to the tick thread
+ *    task_graph/cpus (int[]) - CPUs the task graph threads are pinned to
+ *    trace_path (string) - Chrome trace output, only with -DQUADRUPED_TRACE=ON
+ *    watchdog/degrade (bool) - fall back to cheaper control modes on deadline misses
+ *    watchdog/deadline (double) - max tick time, defaults to the control period (s)
+ *    watchdog/escalate_after (int) - consecutive misses before degrading further
+ *    watchdog/recover_time (double) - time on deadline before stepping back (s)
+ *    watchdog/stall_timeout (double) - tick time reported as a stall (s)
+ *    watchdog/report_period (double) - time between deadline miss reports (s)
+ *    visualization/enabled (bool) - publish the swing leg trajectories
+ *    visualization/rate (double) - max rate the trajectories are published at (Hz)
+ *    visualization/points (int) - points per trajectory
+ *
+ * Topics and services are relative to each robot's namespace.
  *
  * @PUBLISHES:
  *    joint_torque_cmd (quadruped_msgs/JointTorqueCmd) - joint torques
  * @SUBSCRIBES:
- *    joint_states (sensor_msgs/JointState) - joint names, positions, and velocities
+ *    joint_states (sensor_msgs/JointState) - joint names, positions, and velocities,
+ *                                            unnamed states in joints/joint_names order
  *    com_state (quadruped_msgs/CoMState) - COM pose and velocity twist in world frame
+ *    imu (sensor_msgs/Imu) - body orientation, angular velocity, and specific force
+ *                            (only when state_estimation/enabled is set)
  *    cmd_vel (geometry_msgs/Twist) - user commanded body twist
  * @SERVICES:
  *    stand_up (std_srvs/Empty) - triggers robot to stand up
+ *    dump_flight_recorder (std_srvs/Trigger) - write the flight recorder to disk
+ *    update_gains (std_srvs/Trigger) - reload the joint_control/* and balance_control/*
+ *                                      gains and weights, used from the next tick
  */
 
 // C++
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <map>
+#include <memory>
 #include <utility>
 #include <iomanip>
 
 // ROS
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <std_srvs/Empty.h>
+#include <std_srvs/Trigger.h>
+#include <sensor_msgs/Imu.h>
 #include <sensor_msgs/JointState.h>
 #include <geometry_msgs/Twist.h>
 #include <geometry_msgs/TransformStamped.h>
@@ -31,13 +137,19 @@
 #include <tf2_ros/transform_broadcaster.h>
 
 // Quadruped Control
-#include <quadruped_controller/balance_controller.hpp>
-#include <quadruped_controller/gait.hpp>
-#include <quadruped_controller/foot_planner.hpp>
-#include <quadruped_controller/joint_controller.hpp>
-#include <quadruped_controller/kinematics.hpp>
-#include <quadruped_controller/trajectory.hpp>
+#include <quadruped_controller/control_pipeline.hpp>
+#include <quadruped_controller/io/flight_recorder.hpp>
+#include <quadruped_controller/io/telemetry.hpp>
+#include <quadruped_controller/io/tick_log.hpp>
 #include <quadruped_controller/math/numerics.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+#include <quadruped_controller/realtime/watchdog.hpp>
+#include <quadruped_controller/realtime/worker_pool.hpp>
+#include <quadruped_controller/robot_config.hpp>
+#include <quadruped_controller/state_estimator.hpp>
+#include <quadruped_controller/state_predictor.hpp>
+#include <quadruped_controller/visualization/foot_trajectory_visualizer.hpp>
 #include <quadruped_msgs/CoMState.h>
 #include <quadruped_msgs/JointTorqueCmd.h>
 
@@ -51,512 +163,1051 @@ using namespace math;
 
 const static std::string LOGNAME = "commander";
 
-static bool joint_states_received = false;
-static bool com_state_received = false;
-static bool stand_cmd_received = false;
-static bool cmd_vel_received = false;
-
 // IMPORTANT: Most of the software has been configured to run
 //            with these joint names and in this order
-static std::vector<std::string> leg_names = { "RL", "FL", "RR", "FR" };
+static const std::vector<std::string> leg_names(ROBOT_CONFIG.leg_names.begin(),
+                                                ROBOT_CONFIG.leg_names.end());
+
+/** @brief Configuration shared by all robots, read only once loaded */
+struct CommanderConfig
+{
+  RobotConfig robot;           // compiled configuration with the overrides applied
+  double frequency;            // control frequency (Hz)
+  std::string base_link_name;  // body COM frame
 
-// Actual State
-static JointStatesMap joint_states_map;  // q and qdot
+  // Gait
+  bool gait_enabled;    // start the gait once standing, otherwise pose in place
+  double t_swing;       // swing time (s)
+  vec phase_offset;     // gait phase offsets [RL FL RR FR]
 
-static mat Rwb = eye(3, 3);           // COM orientation
-static vec3 x(arma::fill::zeros);     // COM position
-static vec3 xdot(arma::fill::zeros);  // COM linear velocity
-static vec3 w(arma::fill::zeros);     // COM angular velocity
+  // Map leg name to actuator names
+  std::map<std::string, std::vector<std::string>> actuator_map;
 
-// Cmd
-// body twist [vy, vy, vz, wx, wy, wz]
-static vec Vb(6, arma::fill::zeros);
+  // Control pipeline
+  ControlPipelineConfig pipeline;
+
+  // State estimation
+  bool use_estimator;
+  StateEstimatorConfig estimator;
+  std::vector<double> initial_position;  // height is found from the legs
+
+  // Latency compensation
+  bool compensate_latency;
+  double actuation_delay;  // (s)
+  double max_horizon;      // (s)
+  double report_period;    // (s)
+
+  // Deadline watchdog
+  bool degrade;
+  double deadline;                // (s)
+  unsigned int escalate_after;    // misses
+  unsigned int recover_ticks;     // ticks
+  double stall_timeout;           // (s)
+  double watchdog_report_period;  // (s)
+
+  // Swing leg trajectory markers
+  bool visualize;
+  FootTrajectoryVisualizerConfig visualization;
+
+  // Recording
+  std::string record_path;
+  double recorder_duration;  // (s)
+  std::string recorder_directory;
+  std::string telemetry_path;
+  io::TelemetrySettings telemetry;
+};
 
-visualization_msgs::MarkerArray
-footTrajViz(const FootTrajectoryManager& foot_traj_manager, const std::string& leg_name,
-            double stance_phase, double t_swing)
+/**
+ * @brief Compose the gains of the control pipeline
+ * @param robot - robot configuration
+ * @return balance and joint control gains
+ */
+ControlGains control_gains(const RobotConfig& robot)
 {
-  const auto steps = 30;  // steps in trajectory for visualization
-  const auto dt = (1.0 - stance_phase) / steps;
-
-  visualization_msgs::MarkerArray marker_array;
-  marker_array.markers.resize(steps);
-
-  auto phase = stance_phase;
-  for (unsigned int i = 0; i < steps; i++)
-  {
-    const FootState foot_state = foot_traj_manager.referenceState(leg_name, phase);
-
-    marker_array.markers.at(i).header.frame_id = "world";
-    marker_array.markers.at(i).header.stamp = ros::Time::now();
-    marker_array.markers.at(i).ns = leg_name;
-    marker_array.markers.at(i).id = i;
-    marker_array.markers.at(i).action = visualization_msgs::Marker::ADD;
-    marker_array.markers.at(i).lifetime = ros::Duration(t_swing);
-
-    // Foot positions as points
-    marker_array.markers.at(i).type = visualization_msgs::Marker::SPHERE;
-    marker_array.markers.at(i).pose.position.x = foot_state.position(0);
-    marker_array.markers.at(i).pose.position.y = foot_state.position(1);
-    marker_array.markers.at(i).pose.position.z = foot_state.position(2);
-    marker_array.markers.at(i).pose.orientation.w = 1.0;
-    marker_array.markers.at(i).scale.x = 0.01;
-    marker_array.markers.at(i).scale.y = 0.01;
-    marker_array.markers.at(i).scale.z = 0.01;
-
-    if (leg_name == "FL" || leg_name == "RR")
+  ControlGains gains;
+
+  // Weight on forces in f.T*W*f
+  gains.W = eye(12, 12) * robot.w_diagonal;
+  // Weight on least squares (Ax-b)*S*(Ax-b)
+  gains.S = arma::diagmat(vec(robot.s_diagonal.data(), robot.s_diagonal.size()));
+  gains.kff = vec(robot.kff.data(), robot.kff.size());     // feed forward gains
+  gains.kp_p = vec(robot.kp_p.data(), robot.kp_p.size());  // COM position Kp
+  gains.kp_w = vec(robot.kp_w.data(), robot.kp_w.size());  // COM orientation Kp
+  gains.kd_p = vec(robot.kd_p.data(), robot.kd_p.size());  // COM linear velocity Kd
+  gains.kd_w = vec(robot.kd_w.data(), robot.kd_w.size());  // COM angular velocity Kd
+
+  gains.jc_kff = vec3(robot.jc_kff.data());
+  gains.jc_kp = vec3(robot.jc_kp.data());
+  gains.jc_kd = vec3(robot.jc_kd.data());
+
+  return gains;
+}
+
+/**
+ * @brief Load the configuration shared by all robots
+ * @param pnh - private node handle
+ * @return configuration
+ */
+CommanderConfig loadConfig(const ros::NodeHandle& pnh)
+{
+  CommanderConfig commander_config;
+
+  // Robot structure compiled in, gains and dynamics may be overridden for tuning
+  commander_config.robot = load_robot_config(pnh);
+  const RobotConfig& robot = commander_config.robot;
+
+  const auto frequency = robot.frequency;
+  commander_config.frequency = frequency;
+
+  // Body COM frame
+  commander_config.base_link_name = robot.base_link;
+
+  // Gait and swing leg trajectory
+  const auto t_stance = robot.t_stance;  // (s)
+  const auto t_swing = robot.t_swing;    // (s)
+  const auto height = robot.height;      // max foot height (m)
+  commander_config.gait_enabled = pnh.param<bool>("gait/enabled", true);
+  commander_config.t_swing = t_swing;
+  commander_config.phase_offset = vec(robot.phase_offset.data(), NUM_LEGS);
+
+  // map leg name to actuator names
+  auto& actuator_map = commander_config.actuator_map;
+  for (std::size_t i = 0; i < NUM_LEGS; i++)
+  {
+    actuator_map.emplace(leg_names.at(i),
+                         std::vector<std::string>(
+                             robot.actuator_names.begin() + actuator_index(i, 0),
+                             robot.actuator_names.begin() + actuator_index(i + 1, 0)));
+  }
+
+  const ControlGains gains = control_gains(robot);
+
+  const auto tau_min = robot.tau_min;
+  const auto tau_max = robot.tau_max;
+  const auto torque_limited_qp =
+      pnh.param<bool>("balance_control/torque_limited_qp", false);
+
+  // Dynamic properties
+  const mat Ib = arma::diagmat(vec(robot.Ib.data(), robot.Ib.size()));
+  const auto mu = robot.mu;
+  const auto mass = robot.mass;
+  const auto fzmin = robot.fzmin;
+  const auto fzmax = robot.fzmax;
+
+  // Control pipeline
+  ControlPipelineConfig& config = commander_config.pipeline;
+  config.t_stance = t_stance;
+  config.t_swing = t_swing;
+  config.height = height;
+  config.mu = mu;
+  config.mass = mass;
+  config.fzmin = fzmin;
+  config.fzmax = fzmax;
+  config.Ib = Ib;
+  config.S = gains.S;
+  config.W = gains.W;
+  config.kff = gains.kff;
+  config.kp_p = gains.kp_p;
+  config.kd_p = gains.kd_p;
+  config.kp_w = gains.kp_w;
+  config.kd_w = gains.kd_w;
+  config.jc_kff = gains.jc_kff;
+  config.jc_kp = gains.jc_kp;
+  config.jc_kd = gains.jc_kd;
+  config.tau_min = tau_min;
+  config.tau_max = tau_max;
+  config.torque_limited_qp = torque_limited_qp;
+  config.leg_names = leg_names;
+
+  // Balance QP solver
+  const auto qp_backend = pnh.param<std::string>("balance_control/qp_backend", "qpoases");
+  if (!qp_backend_from_name(qp_backend, config.qp_backend))
+  {
+    ROS_WARN_NAMED(LOGNAME, "Unknown balance QP backend %s, using qpoases",
+                   qp_backend.c_str());
+  }
+
+  AdmmSettings& admm = config.admm;
+  admm.rho = pnh.param<double>("balance_control/admm/rho", admm.rho);
+  admm.eps_abs = pnh.param<double>("balance_control/admm/eps_abs", admm.eps_abs);
+  admm.eps_rel = pnh.param<double>("balance_control/admm/eps_rel", admm.eps_rel);
+  admm.max_iterations = pnh.param<int>("balance_control/admm/max_iterations",
+                                       static_cast<int>(admm.max_iterations));
+  admm.warm_start = pnh.param<bool>("balance_control/admm/warm_start", admm.warm_start);
+  admm.polish = pnh.param<bool>("balance_control/admm/polish", admm.polish);
+
+  // Skip solves of similar balance QPs
+  SolveRateSettings& solve_rate = config.solve_rate;
+  solve_rate.enabled =
+      pnh.param<bool>("balance_control/solve_rate/enabled", solve_rate.enabled);
+  solve_rate.foot_tolerance = pnh.param<double>(
+      "balance_control/solve_rate/foot_tolerance", solve_rate.foot_tolerance);
+  solve_rate.rotation_tolerance = pnh.param<double>(
+      "balance_control/solve_rate/rotation_tolerance", solve_rate.rotation_tolerance);
+  solve_rate.force_tolerance = pnh.param<double>(
+      "balance_control/solve_rate/force_tolerance", solve_rate.force_tolerance);
+  solve_rate.moment_tolerance = pnh.param<double>(
+      "balance_control/solve_rate/moment_tolerance", solve_rate.moment_tolerance);
+  solve_rate.max_updates = pnh.param<int>("balance_control/solve_rate/max_updates",
+                                          static_cast<int>(solve_rate.max_updates));
+
+  // Explicit balance QP, shared by all robots
+  const auto explicit_qp_path =
+      pnh.param<std::string>("balance_control/explicit_qp_path", "");
+  if (!explicit_qp_path.empty())
+  {
+    auto explicit_qp =
+        std::make_shared<ExplicitBalanceQP>(mu, fzmin, fzmax, gains.S, gains.W);
+    if (explicit_qp->load(explicit_qp_path))
     {
-      marker_array.markers.at(i).color.r = 1.0;
-      marker_array.markers.at(i).color.g = 0.0;
-      marker_array.markers.at(i).color.b = 0.0;
-      marker_array.markers.at(i).color.a = 1.0;
+      config.explicit_qp = explicit_qp;
     }
     else
     {
-      marker_array.markers.at(i).color.r = 0.0;
-      marker_array.markers.at(i).color.g = 0.0;
-      marker_array.markers.at(i).color.b = 1.0;
-      marker_array.markers.at(i).color.a = 1.0;
+      ROS_WARN_NAMED(LOGNAME, "Failed to load the explicit balance QP %s, solving the QP",
+                     explicit_qp_path.c_str());
     }
-
-    phase += dt;
   }
 
-  return marker_array;
-}
+  // Default standing state
+  config.x_stand = { 0., 0., 0.26 };
 
-void jointCallback(const sensor_msgs::JointState::ConstPtr& msg)
-{
-  joint_states_received = true;
-
-  // RL
-  joint_states_map.at("RL").q(0) = msg->position.at(0);  // RL_hip_joint
-  joint_states_map.at("RL").q(1) = msg->position.at(4);  // RL_thigh_joint
-  joint_states_map.at("RL").q(2) = msg->position.at(8);  // RL_calf_joint
-
-  joint_states_map.at("RL").qdot(0) = msg->velocity.at(0);  // FL_hip_joint
-  joint_states_map.at("RL").qdot(1) = msg->velocity.at(4);  // FL_thigh_joint
-  joint_states_map.at("RL").qdot(2) = msg->velocity.at(8);  // FL_calf_joint
-
-  // FL
-  joint_states_map.at("FL").q(0) = msg->position.at(1);
-  joint_states_map.at("FL").q(1) = msg->position.at(5);
-  joint_states_map.at("FL").q(2) = msg->position.at(9);
-
-  joint_states_map.at("FL").qdot(0) = msg->velocity.at(1);
-  joint_states_map.at("FL").qdot(1) = msg->velocity.at(5);
-  joint_states_map.at("FL").qdot(2) = msg->velocity.at(9);
-
-  // RR
-  joint_states_map.at("RR").q(0) = msg->position.at(2);
-  joint_states_map.at("RR").q(1) = msg->position.at(6);
-  joint_states_map.at("RR").q(2) = msg->position.at(10);
-
-  joint_states_map.at("RR").qdot(0) = msg->velocity.at(2);
-  joint_states_map.at("RR").qdot(1) = msg->velocity.at(6);
-  joint_states_map.at("RR").qdot(2) = msg->velocity.at(10);
-
-  // FR
-  joint_states_map.at("FR").q(0) = msg->position.at(3);
-  joint_states_map.at("FR").q(1) = msg->position.at(7);
-  joint_states_map.at("FR").q(2) = msg->position.at(11);
-
-  joint_states_map.at("FR").qdot(0) = msg->velocity.at(3);
-  joint_states_map.at("FR").qdot(1) = msg->velocity.at(7);
-  joint_states_map.at("FR").qdot(2) = msg->velocity.at(11);
+  // User cmd integration step
+  config.dt = 0.001;
+
+  // LQR stance balance
+  config.use_lqr_stance = pnh.param<bool>("lqr_stance/enabled", false);
+  LQRBalanceConfig& lqr_config = config.lqr_stance;
+  lqr_config.height_min = pnh.param<double>("lqr_stance/height_min", 0.18);
+  lqr_config.height_max = pnh.param<double>("lqr_stance/height_max", 0.32);
+  lqr_config.height_samples =
+      static_cast<unsigned int>(pnh.param<int>("lqr_stance/height_samples", 5));
+  lqr_config.angle_max = pnh.param<double>("lqr_stance/angle_max", 0.4);
+  lqr_config.angle_samples =
+      static_cast<unsigned int>(pnh.param<int>("lqr_stance/angle_samples", 5));
+  std::vector<double> lqr_q;
+  if (pnh.getParam("lqr_stance/q", lqr_q) && lqr_q.size() == lqr_config.q.n_elem)
+  {
+    lqr_config.q = vec(lqr_q);
+  }
+  lqr_config.r = pnh.param<double>("lqr_stance/r", 1e-3);
+  lqr_config.dt = 1.0 / frequency;
+
+  // Nonlinear MPC
+  config.use_nonlinear_mpc = pnh.param<bool>("nonlinear_mpc/enabled", false);
+  NonlinearMPCConfig& mpc_config = config.nonlinear_mpc;
+  mpc_config.horizon =
+      static_cast<unsigned int>(std::max(pnh.param<int>("nonlinear_mpc/horizon", 16), 1));
+  mpc_config.dt = pnh.param<double>("nonlinear_mpc/dt", 0.02);
+  mpc_config.period = 1.0 / frequency;
+  std::vector<double> mpc_q;
+  if (pnh.getParam("nonlinear_mpc/q", mpc_q) && mpc_q.size() == MPC_STATE_SIZE)
+  {
+    mpc_config.q = vec(mpc_q);
+  }
+  mpc_config.r = pnh.param<double>("nonlinear_mpc/r", 1e-4);
+  mpc_config.max_iterations =
+      static_cast<unsigned int>(pnh.param<int>("nonlinear_mpc/max_iterations", 5));
+  mpc_config.max_outer_iterations =
+      static_cast<unsigned int>(pnh.param<int>("nonlinear_mpc/max_outer_iterations", 3));
+  mpc_config.threads =
+      static_cast<unsigned int>(pnh.param<int>("nonlinear_mpc/threads", 0));
+
+  // Per leg work of a tick
+  LegExecutorConfig& leg_config = config.leg_executor;
+  const auto leg_executor = pnh.param<std::string>("leg_executor/type", "serial");
+  if (!leg_executor_from_name(leg_executor, leg_config.type))
+  {
+    ROS_WARN_NAMED(LOGNAME, "Unknown leg executor %s, using serial",
+                   leg_executor.c_str());
+  }
+  leg_config.threads = static_cast<unsigned int>(
+      std::max(pnh.param<int>("leg_executor/threads", leg_config.threads), 1));
+  pnh.getParam("leg_executor/cpus", leg_config.cpus);
+
+  // Stages of a tick as a task graph
+  config.use_task_graph = pnh.param<bool>("task_graph/enabled", false);
+  config.task_graph_threads = static_cast<unsigned int>(
+      std::max(pnh.param<int>("task_graph/threads", config.task_graph_threads), 1));
+  pnh.getParam("task_graph/cpus", config.task_graph_cpus);
+
+  // State estimation
+  commander_config.use_estimator = pnh.param<bool>("state_estimation/enabled", false);
+  StateEstimatorConfig& estimator_config = commander_config.estimator;
+  pnh.getParam("state_estimation/process_noise_p", estimator_config.process_noise_p);
+  pnh.getParam("state_estimation/process_noise_v", estimator_config.process_noise_v);
+  pnh.getParam("state_estimation/process_noise_foot",
+               estimator_config.process_noise_foot);
+  pnh.getParam("state_estimation/sensor_noise_p_rel",
+               estimator_config.sensor_noise_p_rel);
+  pnh.getParam("state_estimation/sensor_noise_v_rel",
+               estimator_config.sensor_noise_v_rel);
+  pnh.getParam("state_estimation/sensor_noise_height",
+               estimator_config.sensor_noise_height);
+  pnh.getParam("state_estimation/swing_noise_scale", estimator_config.swing_noise_scale);
+  estimator_config.dt = 1.0 / frequency;
+  estimator_config.leg_names = leg_names;
+
+  commander_config.initial_position = { 0.0, 0.0, 0.0 };
+  pnh.getParam("initial_pose/position", commander_config.initial_position);
+
+  // Latency compensation
+  commander_config.compensate_latency =
+      pnh.param<bool>("latency_compensation/enabled", true);
+  commander_config.actuation_delay =
+      pnh.param<double>("latency_compensation/actuation_delay", 0.001);
+  commander_config.max_horizon =
+      pnh.param<double>("latency_compensation/max_horizon", 0.05);
+  commander_config.report_period =
+      pnh.param<double>("latency_compensation/report_period", 5.0);
+
+  // Deadline watchdog
+  const auto escalate_after = pnh.param<int>("watchdog/escalate_after", 1);
+  const auto recover_time = pnh.param<double>("watchdog/recover_time", 1.0);
+  commander_config.degrade = pnh.param<bool>("watchdog/degrade", true);
+  commander_config.deadline = pnh.param<double>("watchdog/deadline", 1.0 / frequency);
+  commander_config.escalate_after =
+      static_cast<unsigned int>(std::max(escalate_after, 1));
+  commander_config.recover_ticks =
+      static_cast<unsigned int>(std::max(std::ceil(recover_time * frequency), 1.0));
+  commander_config.stall_timeout = pnh.param<double>("watchdog/stall_timeout", 0.1);
+  commander_config.watchdog_report_period =
+      pnh.param<double>("watchdog/report_period", 5.0);
+
+  // Swing leg trajectory markers, sampled and published off the control tick
+  commander_config.visualize = pnh.param<bool>("visualization/enabled", true);
+  FootTrajectoryVisualizerConfig& visualization_config = commander_config.visualization;
+  visualization_config.rate = pnh.param<double>("visualization/rate", 10.0);
+  visualization_config.points = static_cast<unsigned int>(
+      std::max(pnh.param<int>("visualization/points", 30), 2));
+  visualization_config.lifetime = t_swing;
+
+  // Recording
+  commander_config.record_path = pnh.param<std::string>("record_path", "");
+  commander_config.recorder_duration =
+      pnh.param<double>("flight_recorder/duration", 5.0);
+  commander_config.recorder_directory =
+      pnh.param<std::string>("flight_recorder/directory", "/tmp");
+  commander_config.telemetry_path = pnh.param<std::string>("telemetry/path", "");
+  commander_config.telemetry.chunk_rows =
+      static_cast<uint32_t>(std::max(pnh.param<int>("telemetry/chunk_rows", 4096), 1));
+  commander_config.telemetry.compress = pnh.param<bool>("telemetry/compress", false);
+
+  return commander_config;
 }
 
-void stateCallback(const quadruped_msgs::CoMState::ConstPtr& msg)
+/**
+ * @brief State, planners, and solvers of one robot
+ * @details Callbacks run on the main thread in ros::spinOnce() and tick() runs on a
+ * worker pool thread afterwards, never at the same time.
+ */
+class RobotContext
+{
+public:
+  /**
+   * @brief Constructor
+   * @param name - robot namespace, empty for the node namespace
+   * @param index - robot index, rate limits the robot's log messages separately
+   * @param config - shared configuration, must outlive the robot
+   * @param nh - node handle
+   * @param pnh - private node handle
+   */
+  RobotContext(const std::string& name, unsigned int index, const CommanderConfig& config,
+               const ros::NodeHandle& nh, const ros::NodeHandle& pnh);
+
+  RobotContext(const RobotContext&) = delete;
+  RobotContext& operator=(const RobotContext&) = delete;
+
+  /** @brief Estimate the state and run one control tick */
+  void tick();
+
+  /**
+   * @brief Compose the transform from world to the body
+   * @param T_world_base[out] - transform
+   * @return true if the body state is known
+   */
+  bool transform(geometry_msgs::TransformStamped& T_world_base) const;
+
+private:
+  void jointCallback(const sensor_msgs::JointState::ConstPtr& msg);
+
+  /**
+   * @brief Find the joint state of each actuator in a message
+   * @param names - joint names of the message, empty for the compiled order
+   * @return false if a joint is missing, the previous mapping is kept
+   */
+  bool mapJointStates(const std::vector<std::string>& names);
+
+  void stateCallback(const quadruped_msgs::CoMState::ConstPtr& msg);
+
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  void cmdCallback(const geometry_msgs::Twist::ConstPtr& msg);
+
+  bool standConfigCallback(std_srvs::Empty::Request&, std_srvs::Empty::Response&);
+
+  bool dumpFlightRecorderCallback(std_srvs::Trigger::Request&,
+                                  std_srvs::Trigger::Response& res);
+
+  bool updateGainsCallback(std_srvs::Trigger::Request&,
+                           std_srvs::Trigger::Response& res);
+
+private:
+  std::string name_;               // robot namespace
+  std::string label_;              // robot name in log messages
+  unsigned int index_;             // robot index, rate limit of its log messages
+  const CommanderConfig& config_;  // shared configuration
+  ros::NodeHandle pnh_;            // shared parameters
+  ros::NodeHandle robot_pnh_;      // parameters of this robot, override the shared ones
+  RobotConfig robot_config_;       // configuration of the current gains
+
+  ros::Publisher joint_cmd_pub_;
+  ros::Publisher foot_traj_position_pub_;
+  ros::Subscriber joint_sub_;
+  ros::Subscriber cmd_sub_;
+  ros::Subscriber com_state_sub_;
+  ros::Subscriber imu_sub_;
+  ros::ServiceServer start_server_;
+  ros::ServiceServer dump_server_;
+
+  bool joint_states_received_;
+  bool com_state_received_;
+  bool imu_received_;
+  bool stand_cmd_received_;
+  bool cmd_vel_received_;
+
+  // Joint states message
+  std::vector<std::string> joint_state_names_;             // names the index is for
+  std::array<std::size_t, NUM_JOINTS> joint_state_index_;  // message index of actuators
+
+  // Actual State
+  JointStatesMap joint_states_map_;  // q and qdot
+  mat Rwb_;                          // COM orientation
+  vec3 x_;                           // COM position
+  vec3 xdot_;                        // COM linear velocity
+  vec3 w_;                           // COM angular velocity
+  ImuMeasurement imu_;               // IMU for state estimation
+  ros::Time state_stamp_;            // time the COM state or IMU was measured
+
+  // Cmd
+  // body twist [vy, vy, vz, wx, wy, wz]
+  vec Vb_;
+
+  ControlPipeline pipeline_;
+  StateEstimator estimator_;
+  StatePredictor predictor_;
+  realtime::DeadlineWatchdog watchdog_;
+  std::unique_ptr<FootTrajectoryVisualizer> visualizer_;  // null if disabled
+
+  const GaitScheduler gait_scheduler_;  // gait schedule
+  bool gait_running_;
+  bool posing_;  // standing in place with the gait disabled
+  std::chrono::steady_clock::time_point gait_start_;
+  GaitMap gait_map_;
+
+  io::TickLogWriter tick_log_;  // controller inputs and outputs for replay
+  ros::Time record_start_;
+  uint64_t logged_gain_updates_;   // pipeline gain updates written to the tick log
+  io::FlightRecorder recorder_;    // last N seconds of control ticks
+  io::TelemetryWriter telemetry_;  // every control tick for offline analysis
+  bool telemetry_dropping_;        // the last tick was dropped from the telemetry
+
+  double tick_time_filtered_;  // filtered control tick time (s)
+  ros::Time last_report_;
+  ros::Time last_watchdog_report_;
+
+  // Gain updates are loaded from the parameter server on their own thread
+  ros::CallbackQueue gains_queue_;
+  ros::ServiceServer gains_server_;
+  ros::AsyncSpinner gains_spinner_;
+};
+
+RobotContext::RobotContext(const std::string& name, unsigned int index,
+                           const CommanderConfig& config, const ros::NodeHandle& nh,
+                           const ros::NodeHandle& pnh)
+  : name_(name)
+  , label_(name.empty() ? "robot" : name)
+  , index_(index)
+  , config_(config)
+  , pnh_(pnh)
+  , robot_pnh_(pnh, name)
+  , robot_config_(config.robot)
+  , joint_states_received_(false)
+  , com_state_received_(false)
+  , imu_received_(false)
+  , stand_cmd_received_(false)
+  , cmd_vel_received_(false)
+  , joint_state_index_(ROBOT_CONFIG.joint_state_index)
+  , Rwb_(eye(3, 3))
+  , x_(arma::fill::zeros)
+  , xdot_(arma::fill::zeros)
+  , w_(arma::fill::zeros)
+  , Vb_(6, arma::fill::zeros)
+  , pipeline_(config.pipeline)
+  , estimator_(config.estimator)
+  , predictor_(config.pipeline.mass, config.pipeline.Ib, config.max_horizon)
+  , watchdog_(config.deadline, DegradationMode::num_degradation_modes,
+              config.escalate_after, config.recover_ticks, config.stall_timeout)
+  , gait_scheduler_(config.t_swing, config.pipeline.t_stance, config.phase_offset)
+  , gait_running_(false)
+  , posing_(false)
+  , gait_map_(make_stance_gait())
+  , logged_gain_updates_(0)
+  , recorder_(static_cast<std::size_t>(
+                  std::ceil(config.recorder_duration * config.frequency)),
+              config.frequency, config.recorder_directory,
+              name.empty() ? "flight_recorder" : "flight_recorder_" + name)
+  , telemetry_dropping_(false)
+  , tick_time_filtered_(0.0)
+  , gains_spinner_(1, &gains_queue_)
 {
-  com_state_received = true;
+  ros::NodeHandle robot_nh(nh, name_);
 
-  Quaternion quat(msg->pose.orientation.w, msg->pose.orientation.x,
-                  msg->pose.orientation.y, msg->pose.orientation.z);
+  joint_cmd_pub_ =
+      robot_nh.advertise<quadruped_msgs::JointTorqueCmd>("joint_torque_cmd", 1);
+  if (config_.visualize)
+  {
+    foot_traj_position_pub_ =
+        robot_nh.advertise<visualization_msgs::MarkerArray>("foot_trajectory_markers", 1);
+    visualizer_ = std::make_unique<FootTrajectoryVisualizer>(
+        foot_traj_position_pub_, leg_names, config_.visualization);
+  }
 
-  Rwb = quat.rotation().matrix();
+  joint_sub_ = robot_nh.subscribe("joint_states", 1, &RobotContext::jointCallback, this);
+  cmd_sub_ = robot_nh.subscribe("cmd_vel", 1, &RobotContext::cmdCallback, this);
 
-  x(0) = msg->pose.position.x;
-  x(1) = msg->pose.position.y;
-  x(2) = msg->pose.position.z;
+  // Body state from the simulator or estimated from the IMU and leg kinematics
+  if (config_.use_estimator)
+  {
+    imu_sub_ = robot_nh.subscribe("imu", 1, &RobotContext::imuCallback, this);
+  }
+  else
+  {
+    com_state_sub_ =
+        robot_nh.subscribe("com_state", 1, &RobotContext::stateCallback, this);
+  }
 
-  xdot(0) = msg->twist.linear.x;
-  xdot(1) = msg->twist.linear.y;
-  xdot(2) = msg->twist.linear.z;
+  start_server_ =
+      robot_nh.advertiseService("stand_up", &RobotContext::standConfigCallback, this);
+  dump_server_ = robot_nh.advertiseService(
+      "dump_flight_recorder", &RobotContext::dumpFlightRecorderCallback, this);
+
+  // Not served by the control loop, which only spins the global queue
+  gains_server_ = robot_nh.advertiseService(
+      ros::AdvertiseServiceOptions::create<std_srvs::Trigger>(
+          "update_gains",
+          [this](std_srvs::Trigger::Request& req, std_srvs::Trigger::Response& res) {
+            return updateGainsCallback(req, res);
+          },
+          ros::VoidConstPtr(), &gains_queue_));
+  gains_spinner_.start();
 
-  w(0) = msg->twist.angular.x;
-  w(1) = msg->twist.angular.y;
-  w(2) = msg->twist.angular.z;
+  // Configure initial joint states to zeros
+  for (const auto& leg_name : leg_names)
+  {
+    joint_states_map_.emplace(leg_name, LegJointStates());
+  }
+
+  // Height is found from the legs
+  std::vector<double> init_position = config_.initial_position;
+  robot_pnh_.getParam("initial_pose/position", init_position);
+  estimator_.reset({ init_position.at(0), init_position.at(1), init_position.at(2) });
+
+  // Record controller inputs and outputs for replay
+  if (!config_.record_path.empty())
+  {
+    const std::string record_path =
+        name_.empty() ? config_.record_path : config_.record_path + "." + name_;
+    tick_log_.open(record_path, config_.pipeline, config_.frequency);
+  }
+  record_start_ = ros::Time::now();
+
+  // Always-on flight recorder
+  recorder_.installCrashHandler();
+
+  // Columnar telemetry of the flight records
+  if (!config_.telemetry_path.empty())
+  {
+    const std::string telemetry_path =
+        name_.empty() ? config_.telemetry_path : config_.telemetry_path + "." + name_;
+    telemetry_.open(telemetry_path, io::flight_record_signals(), sizeof(io::FlightRecord),
+                    config_.frequency, config_.telemetry);
+  }
+
+  last_report_ = ros::Time::now();
+  last_watchdog_report_ = ros::Time::now();
 }
 
-void cmdCallback(const geometry_msgs::Twist::ConstPtr& msg)
+void RobotContext::tick()
 {
-  cmd_vel_received = true;
+  // Contact is taken from the gait used on the previous tick
+  if (config_.use_estimator && imu_received_ && joint_states_received_)
+  {
+    TRACE_SCOPE("commander", "estimate");
+    const RobotStateCoM& estimate = estimator_.update(imu_, joint_states_map_, gait_map_);
+    x_ = estimate.x;
+    xdot_ = estimate.xdot;
+    w_ = estimate.w;
+    Rwb_ = estimate.Rwb;
+    com_state_received_ = true;
+  }
+
+  // Signaled to stand and robot state is known
+  if (!stand_cmd_received_ || !joint_states_received_ || !com_state_received_)
+  {
+    return;
+  }
+
+  TRACE_SCOPE("commander", "tick");
+
+  const bool cmd_received = cmd_vel_received_;
+  if (cmd_vel_received_)
+  {
+    pipeline_.setCommand(Vb_);
+    cmd_vel_received_ = false;
+  }
+
+  // Gait schedule
+  if (pipeline_.standing() && gait_running_)
+  {
+    gait_map_ = gait_scheduler_.schedule(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - gait_start_)
+            .count());
+  }
+
+  const auto tick_start = std::chrono::steady_clock::now();
+  watchdog_.tickStart();
+
+  // Cheaper modes after deadline misses
+  if (config_.degrade)
+  {
+    pipeline_.setDegradationMode(static_cast<DegradationMode>(watchdog_.level()));
+  }
+
+  RobotStateCoM com_state = { x_, xdot_, w_, Rwb_ };
+
+  // The state is stale by the transport and the wait for this tick. The torques
+  // are applied after this tick and the command transport.
+  if (config_.compensate_latency && !state_stamp_.isZero())
+  {
+    TRACE_SCOPE("commander", "predict");
+    const auto latency = (ros::Time::now() - state_stamp_).toSec() + tick_time_filtered_ +
+                         config_.actuation_delay;
+
+    com_state = predictor_.predict(com_state, pipeline_.footPositions(),
+                                   pipeline_.forces(), latency);
+  }
+
+  const TorqueMap& torque_map =
+      pipeline_.update(com_state, joint_states_map_, gait_map_, gait_running_);
+
+  if (tick_log_.isOpen())
+  {
+    TRACE_SCOPE("commander", "tick_log");
+    const auto stamp = (ros::Time::now() - record_start_).toSec();
+
+    // Gains the pipeline took up this tick, the record counts them
+    if (logged_gain_updates_ != pipeline_.gainUpdates())
+    {
+      tick_log_.appendGains(pipeline_.gains());
+      logged_gain_updates_ = pipeline_.gainUpdates();
+    }
+
+    io::TickRecord record = io::pack_inputs(stamp, com_state, joint_states_map_, Vb_,
+                                            cmd_received, gait_map_, gait_running_);
+    io::pack_torques(torque_map, record);
+    record.degradation_mode = static_cast<uint8_t>(pipeline_.degradationMode());
+    tick_log_.append(record);
+  }
+
+  if (pipeline_.standing() && !gait_running_ && config_.gait_enabled)
+  {
+    RT_LOG_INFO_INSTANCE_NAMED(index_, LOGNAME, "%s: starting gait", label_);
+    gait_start_ = std::chrono::steady_clock::now();
+    gait_running_ = true;
+  }
+  else if (pipeline_.standing() && !gait_running_ && !posing_)
+  {
+    RT_LOG_INFO_INSTANCE_NAMED(index_, LOGNAME,
+                               "%s: gait disabled, posing, balance solver %s", label_,
+                               balance_solver_name(pipeline_.balanceSolver()));
+    posing_ = true;
+  }
+
+  // Visualize foot trajectories for swing legs
+  if (visualizer_ && pipeline_.newFootholds())
+  {
+    if (!visualizer_->update(pipeline_.footTrajectoryManager(), pipeline_.footholds()))
+    {
+      RT_LOG_WARN_INSTANCE_NAMED(index_, LOGNAME, "%s: foot trajectory markers dropped",
+                                 label_);
+    }
+  }
+
+  // control signal
+  quadruped_msgs::JointTorqueCmd joint_cmd;
+  for (const auto& [leg_name, torque] : torque_map)
+  {
+    const std::vector<std::string>& actuator_names = config_.actuator_map.at(leg_name);
+    joint_cmd.actuator_name.insert(joint_cmd.actuator_name.end(), actuator_names.begin(),
+                                   actuator_names.end());
+
+    const std::vector<double> tau_vec = arma::conv_to<std::vector<double>>::from(torque);
+
+    joint_cmd.torque.insert(joint_cmd.torque.end(), tau_vec.begin(), tau_vec.end());
+  }
+
+  joint_cmd_pub_.publish(joint_cmd);
+
+  const auto tick_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - tick_start)
+          .count();
+  const bool deadline_missed = watchdog_.tickEnd();
 
-  Vb(0) = msg->linear.x;
-  Vb(1) = msg->linear.y;
-  Vb(2) = msg->linear.z;
+  const io::FlightRecord& record =
+      recorder_.record((ros::Time::now() - record_start_).toSec(), tick_time, com_state,
+                       joint_states_map_, gait_map_, pipeline_);
 
-  Vb(3) = msg->angular.x;
-  Vb(4) = msg->angular.y;
-  Vb(5) = msg->angular.z;
+  if (telemetry_.isOpen())
+  {
+    const bool dropped = !telemetry_.append(record);
+    if (dropped && !telemetry_dropping_)
+    {
+      RT_LOG_WARN_INSTANCE_NAMED(index_, LOGNAME,
+                                 "%s: telemetry writer fell behind, dropping ticks",
+                                 label_);
+    }
+    telemetry_dropping_ = dropped;
+  }
+
+  tick_time_filtered_ = 0.9 * tick_time_filtered_ + 0.1 * tick_time;
+
+  if (config_.compensate_latency &&
+      (ros::Time::now() - last_report_).toSec() > config_.report_period)
+  {
+    const LatencyStats& latency_stats = predictor_.stats();
+    if (latency_stats.predictions > 0)
+    {
+      RT_LOG_INFO_INSTANCE_NAMED(
+          index_, LOGNAME,
+          "%s: latency compensation: mean %.2f ms, max %.2f ms, max correction %.2f mm "
+          "%.3f deg",
+          label_, 1e3 * latency_stats.total_latency / latency_stats.predictions,
+          1e3 * latency_stats.max_latency, 1e3 * latency_stats.max_position_correction,
+          latency_stats.max_angle_correction * 180.0 / PI);
+    }
+
+    predictor_.resetStats();
+    last_report_ = ros::Time::now();
+  }
+
+  if ((ros::Time::now() - last_watchdog_report_).toSec() > config_.watchdog_report_period)
+  {
+    const realtime::WatchdogStats& watchdog_stats = watchdog_.stats();
+    if (watchdog_stats.misses > 0)
+    {
+      RT_LOG_WARN_INSTANCE_NAMED(
+          index_, LOGNAME, "%s: missed %lu of %lu deadlines, max tick %.3f ms, %s",
+          label_, watchdog_stats.misses, watchdog_stats.ticks,
+          1e3 * watchdog_stats.max_time,
+          degradation_mode_name(pipeline_.degradationMode()));
+    }
+
+    watchdog_.resetStats();
+    last_watchdog_report_ = ros::Time::now();
+  }
+
+  // The balance QP is the last fallback, a failed solve means the QP failed
+  if (pipeline_.balanceSolver() != BalanceSolver::no_solve && !pipeline_.balanceSolved())
+  {
+    recorder_.dump(io::DumpReason::qp_failure);
+  }
+  else if (deadline_missed)
+  {
+    recorder_.dump(io::DumpReason::deadline_miss);
+  }
 }
 
-bool standConfigCallback(std_srvs::Empty::Request&, std_srvs::Empty::Response&)
+bool RobotContext::transform(geometry_msgs::TransformStamped& T_world_base) const
 {
-  ROS_INFO_STREAM_NAMED(LOGNAME, "Commading robot to standing configuration");
-  stand_cmd_received = true;
+  if (!com_state_received_)
+  {
+    return false;
+  }
+
+  T_world_base.header.frame_id = "world";
+  T_world_base.child_frame_id =
+      name_.empty() ? config_.base_link_name : name_ + "/" + config_.base_link_name;
+  T_world_base.header.stamp = ros::Time::now();
+  T_world_base.transform.translation.x = x_(0);
+  T_world_base.transform.translation.y = x_(1);
+  T_world_base.transform.translation.z = x_(2);
+
+  const Quaternion quat_wb(Rwb_);
+  T_world_base.transform.rotation.x = quat_wb.x();
+  T_world_base.transform.rotation.y = quat_wb.y();
+  T_world_base.transform.rotation.z = quat_wb.z();
+  T_world_base.transform.rotation.w = quat_wb.w();
+
   return true;
 }
 
-int main(int argc, char** argv)
+void RobotContext::jointCallback(const sensor_msgs::JointState::ConstPtr& msg)
 {
-  ROS_INFO_STREAM_NAMED(LOGNAME, "Starting commander node");
-  ros::init(argc, argv, "commander");
-  ros::NodeHandle nh;
-  ros::NodeHandle pnh("~");
+  TRACE_INSTANT("commander", "joint_states");
 
-  ros::Publisher joint_cmd_pub =
-      nh.advertise<quadruped_msgs::JointTorqueCmd>("joint_torque_cmd", 1);
+  // The names rarely change, the mapping is only rebuilt when they do
+  if (msg->name != joint_state_names_ && !mapJointStates(msg->name))
+  {
+    return;
+  }
 
-  ros::Publisher foot_traj_position_pub =
-      nh.advertise<visualization_msgs::MarkerArray>("foot_trajectory_markers", 1);
+  const std::size_t size = msg->name.empty() ? NUM_JOINTS : msg->name.size();
+  if (msg->position.size() != size || msg->velocity.size() != size)
+  {
+    ROS_ERROR_THROTTLE_NAMED(1.0, LOGNAME,
+                             "%s: joint states with %zu positions and %zu velocities "
+                             "for %zu joints ignored",
+                             label_.c_str(), msg->position.size(), msg->velocity.size(),
+                             size);
+    return;
+  }
 
-  ros::Subscriber joint_sub = nh.subscribe("joint_states", 1, jointCallback);
-  ros::Subscriber com_state_sub = nh.subscribe("com_state", 1, stateCallback);
-  ros::Subscriber cmd_sub = nh.subscribe("cmd_vel", 1, cmdCallback);
+  for (std::size_t leg = 0; leg < NUM_LEGS; leg++)
+  {
+    LegJointStates& joint_states = joint_states_map_.at(leg_names[leg]);
+    for (std::size_t joint = 0; joint < JOINTS_PER_LEG; joint++)
+    {
+      const std::size_t i = joint_state_index_[actuator_index(leg, joint)];
+      joint_states.q(joint) = msg->position[i];
+      joint_states.qdot(joint) = msg->velocity[i];
+    }
+  }
 
-  ros::ServiceServer start_server = nh.advertiseService("stand_up", standConfigCallback);
+  joint_states_received_ = true;
+}
 
-  // Broadcast post of robot in world frame
-  tf2_ros::TransformBroadcaster tf_broadcaster;
+bool RobotContext::mapJointStates(const std::vector<std::string>& names)
+{
+  if (names.empty())
+  {
+    joint_state_index_ = ROBOT_CONFIG.joint_state_index;
+    joint_state_names_.clear();
+    return true;
+  }
 
-  // Configure initial joint states to zeros
-  for (const auto& leg_name : leg_names)
+  std::array<std::size_t, NUM_JOINTS> joint_state_index;
+  for (std::size_t i = 0; i < NUM_JOINTS; i++)
   {
-    joint_states_map.emplace(leg_name, LegJointStates());
+    const char* joint_name = ROBOT_CONFIG.joint_names[ROBOT_CONFIG.joint_state_index[i]];
+    const auto it = std::find(names.begin(), names.end(), joint_name);
+    if (it == names.end())
+    {
+      ROS_ERROR_THROTTLE_NAMED(1.0, LOGNAME, "%s: joint states without %s ignored",
+                               label_.c_str(), joint_name);
+      return false;
+    }
+
+    joint_state_index[i] = static_cast<std::size_t>(it - names.begin());
   }
 
-  const auto frequency = pnh.param<double>("frequency", 100.0);
+  joint_state_index_ = joint_state_index;
+  joint_state_names_ = names;
+  return true;
+}
+
+void RobotContext::stateCallback(const quadruped_msgs::CoMState::ConstPtr& msg)
+{
+  TRACE_INSTANT("commander", "com_state");
+  com_state_received_ = true;
+  state_stamp_ = msg->header.stamp;
 
-  // Body COM frame
-  const auto base_link_name = pnh.param<std::string>("links/base_link", "trunk");
+  Quaternion quat(msg->pose.orientation.w, msg->pose.orientation.x,
+                  msg->pose.orientation.y, msg->pose.orientation.z);
 
-  // Gait and swing leg trajectory
-  const auto t_stance = pnh.param<double>("gait/t_stance", 0.3);  // (s)
-  const auto t_swing = pnh.param<double>("gait/t_swing", 0.3);    // (s)
-  const auto height = pnh.param<double>("gait/height", 0.08);     // max foot height (m)
-  const auto stance_phase = t_stance / (t_swing + t_stance);
+  Rwb_ = quat.rotation().matrix();
 
-  std::vector<double> gait_offset_phases = { 0.0, 0.5, 0.5, 0.0 };
-  pnh.getParam("gait/gait_offset_phases", gait_offset_phases);  // [RL FL RR FR]
-  const vec phase_offset(gait_offset_phases);
+  x_(0) = msg->pose.position.x;
+  x_(1) = msg->pose.position.y;
+  x_(2) = msg->pose.position.z;
 
-  // Robot joint configuration
-  const auto num_joints =
-      static_cast<unsigned int>(pnh.param<int>("joints/num_joints", 12));
-  std::vector<std::string> joint_actuator_names;
-  pnh.getParam("joints/joint_actuator_names", joint_actuator_names);
+  xdot_(0) = msg->twist.linear.x;
+  xdot_(1) = msg->twist.linear.y;
+  xdot_(2) = msg->twist.linear.z;
 
-  if (num_joints != joint_actuator_names.size())
+  w_(0) = msg->twist.angular.x;
+  w_(1) = msg->twist.angular.y;
+  w_(2) = msg->twist.angular.z;
+}
+
+void RobotContext::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  TRACE_INSTANT("commander", "imu");
+  imu_received_ = true;
+  state_stamp_ = msg->header.stamp;
+
+  Quaternion quat(msg->orientation.w, msg->orientation.x, msg->orientation.y,
+                  msg->orientation.z);
+
+  imu_.Rwb = quat.rotation().matrix();
+
+  imu_.omega(0) = msg->angular_velocity.x;
+  imu_.omega(1) = msg->angular_velocity.y;
+  imu_.omega(2) = msg->angular_velocity.z;
+
+  imu_.accel(0) = msg->linear_acceleration.x;
+  imu_.accel(1) = msg->linear_acceleration.y;
+  imu_.accel(2) = msg->linear_acceleration.z;
+}
+
+void RobotContext::cmdCallback(const geometry_msgs::Twist::ConstPtr& msg)
+{
+  TRACE_INSTANT("commander", "cmd_vel");
+  cmd_vel_received_ = true;
+
+  Vb_(0) = msg->linear.x;
+  Vb_(1) = msg->linear.y;
+  Vb_(2) = msg->linear.z;
+
+  Vb_(3) = msg->angular.x;
+  Vb_(4) = msg->angular.y;
+  Vb_(5) = msg->angular.z;
+}
+
+bool RobotContext::standConfigCallback(std_srvs::Empty::Request&,
+                                       std_srvs::Empty::Response&)
+{
+  ROS_INFO_STREAM_NAMED(LOGNAME, "Commading " << label_ << " to standing configuration");
+  stand_cmd_received_ = true;
+  return true;
+}
+
+bool RobotContext::dumpFlightRecorderCallback(std_srvs::Trigger::Request&,
+                                              std_srvs::Trigger::Response& res)
+{
+  res.success = recorder_.dump(io::DumpReason::dump_request, true);
+  res.message = res.success
+                    ? "Dumping the flight recorder to " + config_.recorder_directory
+                    : "A flight recorder dump is already in progress";
+  return true;
+}
+
+bool RobotContext::updateGainsCallback(std_srvs::Trigger::Request&,
+                                       std_srvs::Trigger::Response& res)
+{
+  // Nothing is applied unless every parameter is accepted. The tick picks up the new
+  // gains without locking.
+  unsigned int rejected = 0;
+  RobotConfig robot_config = load_robot_config(pnh_, robot_config_, rejected);
+  if (!name_.empty())
   {
-    ROS_ERROR_STREAM_NAMED(
-        LOGNAME, "Invalid joint configuration. Num(joints) != Num(joint_actuator_names)");
+    unsigned int robot_rejected = 0;
+    robot_config = load_robot_config(robot_pnh_, robot_config, robot_rejected);
+    rejected += robot_rejected;
+  }
 
-    ROS_ERROR_NAMED(LOGNAME, "Num(joints): %u, Num(joint_actuator_names names): %lu",
-                    num_joints, joint_actuator_names.size());
+  if (rejected > 0)
+  {
+    res.success = false;
+    res.message =
+        "Parameters rejected: " + std::to_string(rejected) + ", gains unchanged";
+  }
+  else if (!pipeline_.updateGains(control_gains(robot_config)))
+  {
+    res.success = false;
+    res.message = "A gain is not finite, a weight is not positive, or a kp or kd gain "
+                  "is negative, gains unchanged";
+  }
+  else
+  {
+    robot_config_ = robot_config;
+    res.success = true;
+    res.message = "Gains updated";
   }
 
-  // map leg name to actuator names
-  std::map<std::string, std::vector<std::string>> actuator_map;
-  actuator_map.emplace(leg_names.at(0),
-                       std::vector<std::string>{ joint_actuator_names.at(0),
-                                                 joint_actuator_names.at(1),
-                                                 joint_actuator_names.at(2) });
-  actuator_map.emplace(leg_names.at(1),
-                       std::vector<std::string>{ joint_actuator_names.at(3),
-                                                 joint_actuator_names.at(4),
-                                                 joint_actuator_names.at(5) });
-  actuator_map.emplace(leg_names.at(2),
-                       std::vector<std::string>{ joint_actuator_names.at(6),
-                                                 joint_actuator_names.at(7),
-                                                 joint_actuator_names.at(8) });
-  actuator_map.emplace(leg_names.at(3),
-                       std::vector<std::string>{ joint_actuator_names.at(9),
-                                                 joint_actuator_names.at(10),
-                                                 joint_actuator_names.at(11) });
-
-  // Robot controller
-  double w_diagonal = 1e-5;
-  std::vector<double> s_diagonal;
-  std::vector<double> kff_gains;
-  std::vector<double> kp_com_p;
-  std::vector<double> kp_com_w;
-  std::vector<double> kd_com_p;
-  std::vector<double> kd_com_w;
-  pnh.getParam("balance_control/w_diagonal", w_diagonal);
-  pnh.getParam("balance_control/s_diagonal", s_diagonal);
-  pnh.getParam("balance_control/kff", kff_gains);
-  pnh.getParam("balance_control/kp_p", kp_com_p);
-  pnh.getParam("balance_control/kp_w", kp_com_w);
-  pnh.getParam("balance_control/kd_p", kd_com_p);
-  pnh.getParam("balance_control/kd_w", kd_com_w);
+  ROS_INFO_STREAM_NAMED(LOGNAME, "Update of the " << label_ << " gains: " << res.message);
+  return true;
+}
 
-  // Weight on forces in f.T*W*f
-  const mat W = eye(12, 12) * w_diagonal;
-  // Weight on least squares (Ax-b)*S*(Ax-b)
-  const mat S = arma::diagmat(vec(s_diagonal));
-  const vec kff(kff_gains);  // feed forward gains
-  const vec kp_p(kp_com_p);  // COM position Kp
-  const vec kp_w(kp_com_w);  // COM orientation Kp
-  const vec kd_p(kd_com_p);  // COM linear velocity Kd
-  const vec kd_w(kd_com_w);  // COM angular velocity Kd
-
-  std::vector<double> joint_controller_kff;
-  std::vector<double> joint_controller_kp;
-  std::vector<double> joint_controller_kd;
-  pnh.getParam("joint_control/kff", joint_controller_kff);
-  pnh.getParam("joint_control/kp", joint_controller_kp);
-  pnh.getParam("joint_control/kd", joint_controller_kd);
-  const vec jc_kff(joint_controller_kff);
-  const vec jc_kp(joint_controller_kp);
-  const vec jc_kd(joint_controller_kd);
-
-  const auto tau_min = pnh.param<double>("balance_control/torque_min", -20.0);
-  const auto tau_max = pnh.param<double>("balance_control/torque_max", 20.0);
+int main(int argc, char** argv)
+{
+  ROS_INFO_STREAM_NAMED(LOGNAME, "Starting commander node");
+  ros::init(argc, argv, "commander");
+  ros::NodeHandle nh;
+  ros::NodeHandle pnh("~");
 
-  // Dynamic properties
-  std::vector<double> inertia_body;
-  pnh.getParam("dynamics/Ib", inertia_body);
-  const mat Ib = arma::diagmat(vec(inertia_body));
-  const auto mu = pnh.param<double>("dynamics/mu", 0.8);
-  const auto mass = pnh.param<double>("dynamics/mass", 11.0);
-  const auto fzmin = pnh.param<double>("dynamics/fzmin", 10.0);
-  const auto fzmax = pnh.param<double>("dynamics/fzmax", 160.0);
+  tf2_ros::TransformBroadcaster tf_broadcaster;
 
-  // GRF Control
-  const BalanceController balance_controller(mu, mass, fzmin, fzmax, Ib, S, W, kff, kp_p,
-                                             kd_p, kp_w, kd_w, leg_names);
+  const CommanderConfig config = loadConfig(pnh);
 
-  // Joint PD control for swing legs
-  const JointController joint_controller(jc_kff, jc_kp, jc_kd);
+  // One robot in the node namespace unless robots are listed
+  std::vector<std::string> robot_names;
+  pnh.getParam("robots", robot_names);
+  if (robot_names.empty())
+  {
+    robot_names.emplace_back("");
+  }
 
-  // User cmd integration step
-  const auto dt = 0.001;
+  std::vector<std::unique_ptr<RobotContext>> robots;
+  robots.reserve(robot_names.size());
+  for (const auto& name : robot_names)
+  {
+    ROS_INFO_STREAM_NAMED(LOGNAME, "Controlling robot '" << name << "'");
+    robots.emplace_back(std::make_unique<RobotContext>(
+        name, static_cast<unsigned int>(robots.size()), config, nh, pnh));
+  }
 
-  // Hard code the desired COM state to standing configuration
-  mat Rwb_d = eye(3, 3);           // base orientation in world
-  vec3 x_d(arma::fill::zeros);     // position in world
-  vec3 xdot_d(arma::fill::zeros);  // linear velocity
-  vec3 w_d(arma::fill::zeros);     // angular velocity
+  // The main thread also runs ticks
+  const auto worker_threads =
+      pnh.param<int>("worker_threads", static_cast<int>(robots.size()) - 1);
+  realtime::WorkerPool pool(static_cast<unsigned int>(std::max(worker_threads, 0)));
 
-  // Default standing state
-  const mat Rwb_stand = eye(3, 3);
-  const vec3 x_stand = { 0., 0., 0.26 };
-  const vec3 xdot_stand(arma::fill::zeros);
-  const vec3 w_stand(arma::fill::zeros);
+  const std::function<void(std::size_t)> tick = [&robots](std::size_t i) {
+    robots[i]->tick();
+  };
 
-  const QuadrupedKinematics kinematics;  // Kinematic Model
-  const FootPlanner foothold_planner;    // foothold planner
-  const FootTrajectoryManager foot_traj_manager(height, t_swing,
-                                                t_stance);  // foot trajectories
-  const GaitScheduler gait_scheduler(t_swing, t_stance, phase_offset);  // gait schedule
+  std::vector<geometry_msgs::TransformStamped> transforms;
+  transforms.reserve(robots.size());
 
-  x_d = x_stand;
-  bool standing = false;
-  bool gait_running = false;
+  // Allocate this thread's log queue before entering the control loop
+  realtime::RTLogger::instance().registerThread();
 
-  // Use stance gait to get robot into standing configuration
-  GaitMap gait_map = make_stance_gait();
+  // Timeline of the control loop
+  TRACE_START(pnh.param<std::string>("trace_path", "/tmp/commander.trace.json"),
+              "commander");
+  TRACE_THREAD("control");
 
-  ros::Rate rate(frequency);
+  ros::Rate rate(config.frequency);
   while (nh.ok())
   {
-    ros::spinOnce();
+    {
+      TRACE_SCOPE("commander", "spin");
+      ros::spinOnce();
+    }
+
+    pool.parallelFor(robots.size(), tick);
 
-    // Signaled to stand
-    if (stand_cmd_received)
+    // Broadcast TF world to body
+    transforms.clear();
+    for (const auto& robot : robots)
     {
-      // Robot state is known
-      if (joint_states_received && com_state_received)
+      geometry_msgs::TransformStamped T_world_base;
+      if (robot->transform(T_world_base))
       {
-        // FK (body frame)
-        const FootholdMap foot_actual_map =
-            kinematics.forwardKinematics(joint_states_map);
-
-        // Robot is standing
-        if (quadruped_controller::math::almost_equal(x(2), x_stand(2), 0.005) && !standing)
-        {
-          ROS_INFO_STREAM_NAMED(LOGNAME, "Standing height achieved");
-          standing = true;
-        }
-
-        if (standing)
-        {
-          if (gait_running)
-          {
-            if (cmd_vel_received)
-            {
-              const Pose pose(Rwb, x);
-              const Pose pose_desired = integrate_twist_yaw(pose, Vb, dt);
-
-              // Desired pose
-              Rwb_d = pose_desired.orientation.matrix();
-              x_d = pose_desired.position;
-
-              // TODO: height drifts
-              x_d(2) = x_stand(2);
-
-              // Desired velocities
-              const vec Vw = pose.transform().adjoint() * Vb;
-              xdot_d = Vw.rows(0, 2);
-              w_d = Vw.rows(3, 5);
-
-              // std::cout << "height: " << x(2) << std::endl;
-              // std::cout << "desited height: " << x_d(2) << std::endl;
-
-              // std::cout << "yaw rate actual: " << w(2) << std::endl;
-              // std::cout << "yaw rate desired: " << w_d(2) << std::endl;
-
-              // std::cout << "forward velocity: " << xdot(0) << std::endl;
-              // std::cout << "forward velocity desired: " << xdot_d(0) << std::endl;
-
-              // xdot_d.print("Desired xdot:");
-              // xdot.print("Actual xdot:");
-
-              cmd_vel_received = false;
-            }
-
-            // Foot reference states (world frame)
-            FootStateMap foot_states_map;
-
-            // Gait schedule
-            gait_map = gait_scheduler.schedule();
-
-            // Plan footholds (world frame)
-            const auto foothold_plan = foothold_planner.positions(
-                t_stance, Rwb, x, xdot, w, xdot_d, foot_actual_map, gait_map);
-
-            const bool new_footholds = std::get<bool>(foothold_plan);
-            const FootholdMap foothold_final_map = std::get<FootholdMap>(foothold_plan);
-
-            if (!new_footholds)
-            {
-              // No planning just update reference foot states
-              foot_states_map = foot_traj_manager.referenceStates(gait_map);
-            }
-
-            else
-            {
-              // Foot trajectory position only boundary conditions
-              FootTrajBoundsMap foot_traj_bounds_map;
-              for (const auto& [leg_name, p_final] : foothold_final_map)
-              {
-                // Transform feet from body into world frame
-                const vec3 p_start = Rwb * foot_actual_map.at(leg_name) + x;
-                foot_traj_bounds_map.emplace(leg_name, FootTrajBounds(p_start, p_final));
-              }
-
-              // Plan foot trajectories (world frame) and get reference states
-              foot_states_map =
-                  foot_traj_manager.referenceStates(gait_map, foot_traj_bounds_map);
-
-              // Visualize foot trajectories for swing legs
-              for (const auto& leg : foothold_final_map)
-              {
-                const visualization_msgs::MarkerArray traj_marker_msg =
-                    footTrajViz(foot_traj_manager, leg.first, stance_phase, t_swing);
-
-                foot_traj_position_pub.publish(traj_marker_msg);
-              }
-            }
-          }
-
-          else
-          {
-            gait_scheduler.start();
-            gait_running = true;
-          }
-        }
-
-        // Leg swing reference joint states
-        JointStatesMap swing_leg_js_map;
-        for (const auto& [leg_name, leg_state] : gait_map)
-        {
-          if (leg_state.first == LegState::swing)
-          {
-            FootState foot_state =
-                foot_traj_manager.referenceState(leg_name, gait_map.at(leg_name).second);
-
-            // Transform foot state into body frame for IK and J^-1
-            foot_state.position = Rwb.t() * foot_state.position - x;
-            foot_state.velocity = Rwb.t() * foot_state.velocity;
-
-            const vec3 q = kinematics.legInverseKinematics(leg_name, foot_state.position);
-            const vec3 qdot =
-                kinematics.legJacobianInverse(leg_name, q) * foot_state.velocity;
-
-            swing_leg_js_map.emplace(leg_name, LegJointStates(q, qdot));
-          }
-        }
-
-        // Leg swing control
-        const TorqueMap swing_torque_map =
-            joint_controller.control(swing_leg_js_map, joint_states_map);
-
-        // Optimize GRF for stance legs
-        const ForceMap force_map = balance_controller.control(
-            Rwb, Rwb_d, x, xdot, w, x_d, xdot_d, w_d, foot_actual_map, gait_map);
-
-        // Only use for stance legs
-        TorqueMap torque_map =
-            kinematics.jacobianTransposeControl(joint_states_map, force_map);
-
-        // Merge torque maps
-        torque_map.insert(swing_torque_map.begin(), swing_torque_map.end());
-
-        // control signal
-        quadruped_msgs::JointTorqueCmd joint_cmd;
-        for (const auto& [leg_name, torque] : torque_map)
-        {
-          joint_cmd.actuator_name.insert(joint_cmd.actuator_name.end(),
-                                         actuator_map.at(leg_name).begin(),
-                                         actuator_map.at(leg_name).end());
-
-          // Torque limits
-          const vec3 tau = arma::clamp(torque, tau_min, tau_max);
-          const std::vector<double> tau_vec =
-              arma::conv_to<std::vector<double>>::from(tau);
-
-          joint_cmd.torque.insert(joint_cmd.torque.end(), tau_vec.begin(), tau_vec.end());
-        }
-
-        joint_cmd_pub.publish(joint_cmd);
+        transforms.push_back(T_world_base);
       }
     }
 
-    // Broadcast TF world to body
-    if (com_state_received)
+    if (!transforms.empty())
     {
-      geometry_msgs::TransformStamped T_world_base;
-      T_world_base.header.frame_id = "world";
-      T_world_base.child_frame_id = base_link_name;
-      T_world_base.header.stamp = ros::Time::now();
-      T_world_base.transform.translation.x = x(0);
-      T_world_base.transform.translation.y = x(1);
-      T_world_base.transform.translation.z = x(2);
-
-      const Quaternion quat_wb(Rwb);
-      T_world_base.transform.rotation.x = quat_wb.x();
-      T_world_base.transform.rotation.y = quat_wb.y();
-      T_world_base.transform.rotation.z = quat_wb.z();
-      T_world_base.transform.rotation.w = quat_wb.w();
-
-      tf_broadcaster.sendTransform(T_world_base);
+      tf_broadcaster.sendTransform(transforms);
     }
 
     rate.sleep();
   }
 
+  TRACE_STOP();
+
   ros::shutdown();
   return 0;
 }
@@ -4,14 +4,30 @@
  * @date 2021-04-7
  * @brief visualize gait
  *
+ * @details A full gait cycle is computed once at startup into a GaitTable. The
+ * playback loop only looks up the sample at the playback time and publishes it, so
+ * the playback speed can be changed and the cycle scrubbed while it runs.
+ *
  * @PARAMETERS:
+ *    table/dt (double) - time between samples of the gait table (s)
+ *    playback/rate (double) - publish rate (Hz)
+ *    playback/speed (double) - initial playback speed, 1 is real time
  *
  * @PUBLISHES:
+ *    joint_states (sensor_msgs/JointState) - joint positions of the sample
+ *    foot_trajectory_markers (visualization_msgs/MarkerArray) - swing trajectories,
+ *                                                               latched
+ *    support_polygon_marker (visualization_msgs/Marker) - support polygon of the sample
  * @SUBSCRIBES:
+ *    gait_playback/speed (std_msgs/Float64) - playback speed, 0 pauses and negative
+ *                                             plays backwards
+ *    gait_playback/phase (std_msgs/Float64) - jump to a phase of the cycle [0 1)
  * @SERVICES:
  */
 
 // C++
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <utility>
 #include <iomanip>
@@ -19,23 +35,16 @@
 
 // ROS
 #include <ros/ros.h>
-#include <std_srvs/Empty.h>
+#include <std_msgs/Float64.h>
 #include <sensor_msgs/JointState.h>
-#include <geometry_msgs/Twist.h>
-#include <tf2_ros/transform_listener.h>
 #include <geometry_msgs/TransformStamped.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <tf2_ros/transform_broadcaster.h>
 
 // Quadruped Control
-#include <quadruped_controller/balance_controller.hpp>
-#include <quadruped_controller/gait.hpp>
-#include <quadruped_controller/foot_planner.hpp>
-#include <quadruped_controller/kinematics.hpp>
+#include <quadruped_controller/gait_table.hpp>
 #include <quadruped_controller/trajectory.hpp>
 #include <quadruped_controller/math/numerics.hpp>
-#include <quadruped_msgs/CoMState.h>
-#include <quadruped_msgs/JointTorqueCmd.h>
 
 using arma::eye;
 using arma::mat;
@@ -48,58 +57,6 @@ using namespace quadruped_controller;
 
 static const std::string LOGNAME = "gait_visualizer";
 
-visualization_msgs::MarkerArray
-footTrajViz(const FootTrajectoryManager& foot_traj_manager, const std::string& leg_name,
-            double stance_phase, double t_swing)
-{
-  const auto steps = 30;  // steps in trajectory for visualization
-  const auto dt = (1.0 - stance_phase) / steps;
-
-  visualization_msgs::MarkerArray position_marker_array;
-  position_marker_array.markers.resize(steps);
-
-  auto phase = stance_phase;
-  for (unsigned int i = 0; i < steps; i++)
-  {
-    const FootState foot_state = foot_traj_manager.referenceState(leg_name, phase);
-    position_marker_array.markers.at(i).header.frame_id = "world";
-    position_marker_array.markers.at(i).header.stamp = ros::Time::now();
-    position_marker_array.markers.at(i).ns = leg_name;
-    position_marker_array.markers.at(i).id = i;
-    position_marker_array.markers.at(i).action = visualization_msgs::Marker::ADD;
-    position_marker_array.markers.at(i).lifetime = ros::Duration(t_swing);
-
-    // Foot positions as points
-    position_marker_array.markers.at(i).type = visualization_msgs::Marker::SPHERE;
-    position_marker_array.markers.at(i).pose.position.x = foot_state.position(0);
-    position_marker_array.markers.at(i).pose.position.y = foot_state.position(1);
-    position_marker_array.markers.at(i).pose.position.z = foot_state.position(2);
-    position_marker_array.markers.at(i).pose.orientation.w = 1.0;
-    position_marker_array.markers.at(i).scale.x = 0.01;
-    position_marker_array.markers.at(i).scale.y = 0.01;
-    position_marker_array.markers.at(i).scale.z = 0.01;
-
-    if (leg_name == "FL" || leg_name == "RR")
-    {
-      position_marker_array.markers.at(i).color.r = 1.0;
-      position_marker_array.markers.at(i).color.g = 0.0;
-      position_marker_array.markers.at(i).color.b = 0.0;
-      position_marker_array.markers.at(i).color.a = 1.0;
-    }
-    else
-    {
-      position_marker_array.markers.at(i).color.r = 0.0;
-      position_marker_array.markers.at(i).color.g = 0.0;
-      position_marker_array.markers.at(i).color.b = 1.0;
-      position_marker_array.markers.at(i).color.a = 1.0;
-    }
-
-    phase += dt;
-  }
-
-  return position_marker_array;
-}
-
 int main(int argc, char** argv)
 {
   ros::init(argc, argv, "gait_visualizer");
@@ -107,15 +64,14 @@ int main(int argc, char** argv)
   ros::NodeHandle pnh("~");
 
   ros::Publisher foot_traj_position_pub =
-      nh.advertise<visualization_msgs::MarkerArray>("foot_trajectory_markers", 1);
+      nh.advertise<visualization_msgs::MarkerArray>("foot_trajectory_markers", 1, true);
+
+  ros::Publisher support_polygon_pub =
+      nh.advertise<visualization_msgs::Marker>("support_polygon_marker", 1);
 
   ros::Publisher joint_state_pub =
       nh.advertise<sensor_msgs::JointState>("joint_states", 1);
 
-  // Lookup TF from base to foot when leg is in stance phase
-  tf2_ros::Buffer tfBuffer;
-  tf2_ros::TransformListener tfListener(tfBuffer);
-
   // Broadcast post of robot in world frame
   tf2_ros::TransformBroadcaster tf_broadcaster;
 
@@ -147,45 +103,10 @@ int main(int argc, char** argv)
         num_joints, joint_names.size(), init_joint_positions.size());
   }
 
-  // Map leg name to joint names
-  std::map<std::string, std::vector<std::string>> leg_joints_name_map;
-  leg_joints_name_map.emplace(
-      leg_names.at(0), std::vector<std::string>{ joint_names.at(0), joint_names.at(1),
-                                                 joint_names.at(2) });
-  leg_joints_name_map.emplace(
-      leg_names.at(1), std::vector<std::string>{ joint_names.at(3), joint_names.at(4),
-                                                 joint_names.at(5) });
-  leg_joints_name_map.emplace(
-      leg_names.at(2), std::vector<std::string>{ joint_names.at(6), joint_names.at(7),
-                                                 joint_names.at(8) });
-  leg_joints_name_map.emplace(
-      leg_names.at(3), std::vector<std::string>{ joint_names.at(9), joint_names.at(10),
-                                                 joint_names.at(11) });
-
-  // Map leg name to initial joint positions
-  std::map<std::string, std::vector<double>> leg_joints_init_positions_map;
-  leg_joints_init_positions_map.emplace(
-      leg_names.at(0),
-      std::vector<double>{ init_joint_positions.at(0), init_joint_positions.at(1),
-                           init_joint_positions.at(2) });
-  leg_joints_init_positions_map.emplace(
-      leg_names.at(1),
-      std::vector<double>{ init_joint_positions.at(3), init_joint_positions.at(4),
-                           init_joint_positions.at(5) });
-  leg_joints_init_positions_map.emplace(
-      leg_names.at(2),
-      std::vector<double>{ init_joint_positions.at(6), init_joint_positions.at(7),
-                           init_joint_positions.at(8) });
-  leg_joints_init_positions_map.emplace(
-      leg_names.at(3),
-      std::vector<double>{ init_joint_positions.at(9), init_joint_positions.at(10),
-                           init_joint_positions.at(11) });
-
   // Gait and swing leg trajectory
   const auto t_stance = pnh.param<double>("gait/t_stance", 1.0);  // (s)
   const auto t_swing = pnh.param<double>("gait/t_swing", 1.0);    // (s)
   const auto height = pnh.param<double>("gait/height", 0.08);     // max foot height (m)
-  const auto stance_phase = t_stance / (t_swing + t_stance);
 
   std::vector<double> gait_offset_phases = { 0.0, 0.5, 0.5, 0.0 };
   pnh.getParam("gait/gait_offset_phases", gait_offset_phases);  // [RL FL RR FR]
@@ -228,133 +149,132 @@ int main(int argc, char** argv)
   const vec xdot_d(linear_velocity_desired);
   const vec w_d(angular_velocity_desired);
 
-  // TODO: fix const in QuadrupedKinematics
-  const QuadrupedKinematics kinematics;  // FK and IK
-
-  // Foot start positions in world frame
-  mat ft_p_init = kinematics.forwardKinematics(q_init);
-  ft_p_init.col(0) = Rwb * ft_p_init.col(0) + x;
-  ft_p_init.col(1) = Rwb * ft_p_init.col(1) + x;
-  ft_p_init.col(2) = Rwb * ft_p_init.col(2) + x;
-  ft_p_init.col(3) = Rwb * ft_p_init.col(3) + x;
-
-  FootholdMap foothold_start_map;
-  foothold_start_map.emplace("RL", ft_p_init.col(0));
-  foothold_start_map.emplace("FL", ft_p_init.col(1));
-  foothold_start_map.emplace("RR", ft_p_init.col(2));
-  foothold_start_map.emplace("FR", ft_p_init.col(3));
-  // ft_p_init.print("ft_p_init");
-
-  const FootPlanner foothold_planner;  // foothold planner
-  const FootTrajectoryManager foot_traj_manager(height, t_swing,
-                                                t_stance);  // foot trajectories
-
-  const GaitScheduler gait_scheduler(t_swing, t_stance, phase_offset);  // gait schedule
-  gait_scheduler.start();
-
-  ros::Rate rate(5.0);
-  while (nh.ok())
+  // One gait cycle computed up front
+  GaitTableConfig table_config;
+  table_config.t_swing = t_swing;
+  table_config.t_stance = t_stance;
+  table_config.height = height;
+  table_config.offset = phase_offset;
+  table_config.dt = pnh.param<double>("table/dt", 0.001);
+  table_config.Rwb = Rwb;
+  table_config.x = x;
+  table_config.xdot = xdot;
+  table_config.w = w;
+  table_config.xdot_d = xdot_d;
+  table_config.q_stance = q_init;
+
+  const auto table_start = ros::WallTime::now();
+  const GaitTable gait_table(table_config, leg_names);
+  ROS_INFO_NAMED(LOGNAME, "Computed %u gait samples in %.1f ms", gait_table.size(),
+                 (ros::WallTime::now() - table_start).toSec() * 1e3);
+
+  // Swing trajectories do not change between cycles, publish them once
+  const auto points = 30u;  // points per trajectory
+  const auto swing_samples =
+      static_cast<unsigned int>(gait_table.size() * t_swing / gait_table.period());
+  const auto stride = std::max(swing_samples / points, 1u);
+
+  visualization_msgs::MarkerArray traj_marker_msg;
+  for (unsigned int j = 0; j < leg_names.size(); j++)
   {
-    ros::spinOnce();
-
-    // Start planning leg swing trajectories
-    const GaitMap gait_map = gait_scheduler.schedule();
-
-    // std::cout << "New loop \n";
-    // for (const auto& [key, value] : gait_map)
-    // {
-    //   std::cout << key << " = " << value.first << " " << value.second << "\n";
-    // }
-
-    // Foot positions of all the feet
-    FootholdMap foot_map;
-
-    // Publish joint states
-    for (const auto& [leg_name, leg_state] : gait_map)
+    visualization_msgs::Marker marker;
+    marker.header.frame_id = "world";
+    marker.header.stamp = ros::Time::now();
+    marker.ns = leg_names.at(j);
+    marker.type = visualization_msgs::Marker::SPHERE_LIST;
+    marker.action = visualization_msgs::Marker::ADD;
+    marker.pose.orientation.w = 1.0;
+    marker.scale.x = 0.01;
+    marker.scale.y = 0.01;
+    marker.scale.z = 0.01;
+
+    const bool red = leg_names.at(j) == "FL" || leg_names.at(j) == "RR";
+    marker.color.r = red ? 1.0 : 0.0;
+    marker.color.b = red ? 0.0 : 1.0;
+    marker.color.a = 1.0;
+
+    for (unsigned int i = 0; i < gait_table.size(); i += stride)
     {
-      sensor_msgs::JointState joint_states_msg;
-
-      if (leg_state.first == LegState::swing)
+      if (gait_table.swing(i, j))
       {
-        FootState foot_state =
-            foot_traj_manager.referenceState(leg_name, gait_map.at(leg_name).second);
-
-        foot_map.emplace(leg_name, foot_state.position);
-
-        // transform foot position into body frame for IK
-        foot_state.position = inv(Rwb) * foot_state.position - x;
-
-        const vec3 q = kinematics.legInverseKinematics(leg_name, foot_state.position);
-
-        joint_states_msg.header.stamp = ros::Time::now();
-        joint_states_msg.name = leg_joints_name_map.at(leg_name);
-        joint_states_msg.position = arma::conv_to<std::vector<double>>::from(q);
-        joint_state_pub.publish(joint_states_msg);
-      }
-
-      else
-      {
-        // Move leg back to initial joints position when in stance
-        joint_states_msg.header.stamp = ros::Time::now();
-        joint_states_msg.name = leg_joints_name_map.at(leg_name);
-        joint_states_msg.position = leg_joints_init_positions_map.at(leg_name);
-        joint_state_pub.publish(joint_states_msg);
-
-        const vec q(leg_joints_init_positions_map.at(leg_name));
-        vec3 ft_p = kinematics.forwardKinematics(leg_name, q);
-
-        // transform foot position into world
-        ft_p = Rwb * ft_p + x;
-
-        foot_map.emplace(leg_name, ft_p);
+        const vec3 foot = gait_table.footPosition(i, j);
+        geometry_msgs::Point point;
+        point.x = foot(0);
+        point.y = foot(1);
+        point.z = foot(2);
+        marker.points.push_back(point);
       }
     }
 
-    // Plan footholds
-    const auto foothold_plan =
-        foothold_planner.positions(t_stance, Rwb, x, xdot, w, xdot_d, foot_map, gait_map);
+    traj_marker_msg.markers.push_back(marker);
+  }
+  foot_traj_position_pub.publish(traj_marker_msg);
+
+  // Messages are filled in place each sample
+  sensor_msgs::JointState joint_states_msg;
+  joint_states_msg.name = joint_names;
+  joint_states_msg.position.resize(3 * leg_names.size());
+
+  visualization_msgs::Marker polygon_marker;
+  polygon_marker.header.frame_id = "world";
+  polygon_marker.ns = "support_polygon";
+  polygon_marker.type = visualization_msgs::Marker::LINE_STRIP;
+  polygon_marker.action = visualization_msgs::Marker::ADD;
+  polygon_marker.pose.orientation.w = 1.0;
+  polygon_marker.scale.x = 0.005;
+  polygon_marker.color.g = 1.0;
+  polygon_marker.color.a = 1.0;
+  polygon_marker.points.reserve(leg_names.size() + 1);
+
+  // Playback time advances by the speed, scrubbing moves it to a phase
+  double speed = pnh.param<double>("playback/speed", 1.0);
+  double t_playback = 0.0;
+  const ros::Subscriber speed_sub = nh.subscribe<std_msgs::Float64>(
+      "gait_playback/speed", 1,
+      [&speed](const std_msgs::Float64::ConstPtr& msg) { speed = msg->data; });
+  const ros::Subscriber phase_sub = nh.subscribe<std_msgs::Float64>(
+      "gait_playback/phase", 1, [&](const std_msgs::Float64::ConstPtr& msg) {
+        t_playback = msg->data * gait_table.period();
+      });
+
+  ros::Rate rate(pnh.param<double>("playback/rate", 30.0));
+  ros::Time last_publish = ros::Time::now();
+  while (nh.ok())
+  {
+    ros::spinOnce();
 
-    const bool new_footholds = std::get<bool>(foothold_plan);
-    const FootholdMap foothold_final_map = std::get<FootholdMap>(foothold_plan);
+    const ros::Time now = ros::Time::now();
+    t_playback += speed * (now - last_publish).toSec();
+    last_publish = now;
 
-    // Foot reference states
-    FootStateMap foot_states_map;
+    const unsigned int sample = gait_table.index(t_playback);
 
-    // Check if foothold planning happened
-    if (!new_footholds)
-    {
-      // No planning just update reference foot states
-      foot_states_map = foot_traj_manager.referenceStates(gait_map);
-    }
+    // Joint positions
+    const double* q = gait_table.jointPositions(sample);
+    std::copy_n(q, joint_states_msg.position.size(), joint_states_msg.position.begin());
+    joint_states_msg.header.stamp = now;
+    joint_state_pub.publish(joint_states_msg);
 
-    else
+    // Closed outline of the stance feet
+    const SupportLegs& support = gait_table.supportLegs(sample);
+    polygon_marker.points.clear();
+    for (unsigned int k = 0; support.size >= 3 && k <= support.size; k++)
     {
-      // Foot trajectory position only boundary conditions
-      FootTrajBoundsMap foot_traj_map;
-      for (const auto& [leg_name, p_final] : foothold_final_map)
-      {
-        foot_traj_map.emplace(leg_name,
-                              FootTrajBounds(foothold_start_map.at(leg_name), p_final));
-      }
-
-      // Will generate foot trajectories
-      foot_states_map = foot_traj_manager.referenceStates(gait_map, foot_traj_map);
-
-      // Visualize foot trajectories
-      for (const auto& leg : foothold_final_map)
-      {
-        const auto traj_marker_message =
-            footTrajViz(foot_traj_manager, leg.first, stance_phase, t_swing);
-
-        foot_traj_position_pub.publish(traj_marker_message);
-      }
+      const vec3 foot = gait_table.footPosition(sample, support.legs[k % support.size]);
+      geometry_msgs::Point point;
+      point.x = foot(0);
+      point.y = foot(1);
+      point.z = foot(2);
+      polygon_marker.points.push_back(point);
     }
+    polygon_marker.header.stamp = now;
+    support_polygon_pub.publish(polygon_marker);
 
     // Broadcast robot pose
-    T_world_base.header.stamp = ros::Time::now();
+    T_world_base.header.stamp = now;
     tf_broadcaster.sendTransform(T_world_base);
 
-    // rate.sleep();
+    rate.sleep();
   }
 
   ros::shutdown();
@@ -0,0 +1,622 @@
+/**
+ * @file admm_qp_backend.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief First order QP solver based on ADMM
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <quadruped_controller/admm_qp_backend.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "ADMM QP";
+
+// Bounds at or beyond this magnitude are infinite, as in the balance controller
+static constexpr double INFINITE_BOUND = 1000000.0;
+
+// Bounds closer than this are an equality constraint
+static constexpr double EQUALITY_TOLERANCE = 1e-9;
+
+// Penalty on constraints without bounds [R1] Sec 5.2
+static constexpr double RHO_MIN = 1e-6;
+
+/**
+ * @brief In place Cholesky factorization A = L*L.T
+ * @param A[in,out] - symmetric matrix, row major (n x n), the lower triangle is
+ * replaced by L
+ * @param n - dimension
+ * @return false if A is not positive definite
+ */
+static bool cholesky(double* A, unsigned int n)
+{
+  for (unsigned int j = 0; j < n; j++)
+  {
+    double s = A[j * n + j];
+    for (unsigned int k = 0; k < j; k++)
+    {
+      s -= A[j * n + k] * A[j * n + k];
+    }
+
+    if (s <= 0.0 || !std::isfinite(s))
+    {
+      return false;
+    }
+
+    A[j * n + j] = std::sqrt(s);
+    for (unsigned int i = j + 1; i < n; i++)
+    {
+      double t = A[i * n + j];
+      for (unsigned int k = 0; k < j; k++)
+      {
+        t -= A[i * n + k] * A[j * n + k];
+      }
+
+      A[i * n + j] = t / A[j * n + j];
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Solve L*L.T*x = b in place
+ * @param L - Cholesky factor from cholesky()
+ * @param n - dimension
+ * @param b[in,out] - right hand side (n), replaced by x
+ */
+static void cholesky_solve(const double* L, unsigned int n, double* b)
+{
+  // L*y = b
+  for (unsigned int i = 0; i < n; i++)
+  {
+    for (unsigned int k = 0; k < i; k++)
+    {
+      b[i] -= L[i * n + k] * b[k];
+    }
+    b[i] /= L[i * n + i];
+  }
+
+  // L.T*x = y
+  for (int i = n - 1; i >= 0; i--)
+  {
+    for (unsigned int k = i + 1; k < n; k++)
+    {
+      b[i] -= L[k * n + i] * b[k];
+    }
+    b[i] /= L[i * n + i];
+  }
+}
+
+/** @brief Return the infinity norm of an array */
+static double inf_norm(const std::vector<double>& v)
+{
+  double norm = 0.0;
+  for (const auto value : v)
+  {
+    norm = std::max(norm, std::abs(value));
+  }
+
+  return norm;
+}
+
+AdmmQpBackend::AdmmQpBackend(unsigned int num_variables, unsigned int num_constraints,
+                             const AdmmSettings& settings)
+  : n_(num_variables)
+  , m_(num_constraints)
+  , settings_(settings)
+  , initialised_(false)
+  , polished_(false)
+  , factorizations_(0)
+  , rho_scalar_(settings.rho)
+  , Q_(n_ * n_, 0.0)
+  , C_(m_ * n_, 0.0)
+  , rho_(m_, 0.0)
+  , L_(n_ * n_, 0.0)
+  , x_(n_, 0.0)
+  , z_(m_, 0.0)
+  , y_(m_, 0.0)
+  , xt_(n_, 0.0)
+  , zt_(m_, 0.0)
+  , Cx_(m_, 0.0)
+  , Qx_(n_, 0.0)
+  , Cty_(n_, 0.0)
+  , lb_(m_, 0.0)
+  , ub_(m_, 0.0)
+  , Lp_(n_ * n_, 0.0)
+  , xp_(n_, 0.0)
+  , yp_(m_, 0.0)
+  , dx_(n_, 0.0)
+  , rp_(n_, 0.0)
+  , bp_(m_, 0.0)
+  , active_(m_, 0)
+  , eps_primal_(0.0)
+  , eps_dual_(0.0)
+  , res_primal_(0.0)
+  , res_dual_(0.0)
+  , primal_scale_(0.0)
+  , dual_scale_(0.0)
+{
+  settings_.check_interval = std::max(settings_.check_interval, 1u);
+  settings_.adaptive_rho_interval =
+      std::max(settings_.adaptive_rho_interval, settings_.check_interval);
+}
+
+QPStatus AdmmQpBackend::solve(const real_t* Q, const real_t* c, const real_t* C,
+                              const real_t* lbC, const real_t* ubC, real_t* x)
+{
+  TRACE_SCOPE("qp", "admm");
+  const auto start = std::chrono::steady_clock::now();
+
+  QPStatus status;
+  polished_ = false;
+
+  const auto inf = std::numeric_limits<double>::infinity();
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    lb_[i] = lbC[i] <= -INFINITE_BOUND ? -inf : lbC[i];
+    ub_[i] = ubC[i] >= INFINITE_BOUND ? inf : ubC[i];
+  }
+
+  // The linear system only depends on Q, C, and the penalties
+  const bool penalties_changed = updatePenalties(lbC, ubC);
+  if (!initialised_ || penalties_changed || !std::equal(Q, Q + n_ * n_, Q_.begin()) ||
+      !std::equal(C, C + m_ * n_, C_.begin()))
+  {
+    std::copy(Q, Q + n_ * n_, Q_.begin());
+    std::copy(C, C + m_ * n_, C_.begin());
+    if (!factorize())
+    {
+      RT_LOG_ERROR_NAMED(LOGNAME, "ADMM linear system is not positive definite");
+      initialised_ = false;
+      status.return_value = qpOASES::RET_INIT_FAILED;
+      status.cpu_time =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return status;
+    }
+  }
+
+  if (!initialised_ || !settings_.warm_start)
+  {
+    std::fill(x_.begin(), x_.end(), 0.0);
+    std::fill(z_.begin(), z_.end(), 0.0);
+    std::fill(y_.begin(), y_.end(), 0.0);
+  }
+  initialised_ = true;
+
+  const double sigma = settings_.sigma;
+  const double alpha = settings_.alpha;
+
+  bool done = false;
+  unsigned int iterations = 0;
+  while (!done && iterations < settings_.max_iterations)
+  {
+    iterations++;
+
+    // [R1] Eq(20) x_tilde = (Q + sigma*I + C.T*rho*C)^-1 (sigma*x - c + C.T*(rho*z - y))
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      xt_[j] = sigma * x_[j] - c[j];
+    }
+
+    for (unsigned int i = 0; i < m_; i++)
+    {
+      const double w = rho_[i] * z_[i] - y_[i];
+      const double* Ci = C + i * n_;
+      for (unsigned int j = 0; j < n_; j++)
+      {
+        xt_[j] += Ci[j] * w;
+      }
+    }
+
+    cholesky_solve(L_.data(), n_, xt_.data());
+
+    // Relaxed primal, projected splitting variable, and dual updates
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      x_[j] = alpha * xt_[j] + (1.0 - alpha) * x_[j];
+    }
+
+    for (unsigned int i = 0; i < m_; i++)
+    {
+      const double* Ci = C + i * n_;
+      double zt = 0.0;
+      for (unsigned int j = 0; j < n_; j++)
+      {
+        zt += Ci[j] * xt_[j];
+      }
+
+      const double zr = alpha * zt + (1.0 - alpha) * z_[i];
+      const double z = std::min(std::max(zr + y_[i] / rho_[i], lb_[i]), ub_[i]);
+      y_[i] += rho_[i] * (zr - z);
+      z_[i] = z;
+    }
+
+    if (iterations % settings_.check_interval == 0 ||
+        iterations == settings_.max_iterations)
+    {
+      done = converged(c);
+
+      if (!done && settings_.adaptive_rho &&
+          iterations % settings_.adaptive_rho_interval == 0 && adaptRho())
+      {
+        updatePenalties(lbC, ubC);
+        if (!factorize())
+        {
+          RT_LOG_ERROR_NAMED(LOGNAME, "ADMM linear system is not positive definite");
+          initialised_ = false;
+          status.return_value = qpOASES::RET_INIT_FAILED;
+          status.iterations = iterations;
+          status.cpu_time =
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                  .count();
+          return status;
+        }
+      }
+    }
+  }
+
+  if (settings_.polish && iterations > 0 && polish(c, lbC, ubC))
+  {
+    done = true;
+  }
+
+  std::copy(x_.begin(), x_.end(), x);
+
+  status.return_value = done ? qpOASES::SUCCESSFUL_RETURN : qpOASES::RET_MAX_NWSR_REACHED;
+  status.iterations = iterations;
+  status.solved = done;
+  status.cpu_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  return status;
+}
+
+bool AdmmQpBackend::isInitialised() const
+{
+  return initialised_;
+}
+
+QpBackendType AdmmQpBackend::type() const
+{
+  return QpBackendType::admm;
+}
+
+uint64_t AdmmQpBackend::factorizations() const
+{
+  return factorizations_;
+}
+
+bool AdmmQpBackend::polished() const
+{
+  return polished_;
+}
+
+bool AdmmQpBackend::updatePenalties(const real_t* lbC, const real_t* ubC)
+{
+  bool changed = false;
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    double rho = rho_scalar_;
+    if (lbC[i] <= -INFINITE_BOUND && ubC[i] >= INFINITE_BOUND)
+    {
+      rho = RHO_MIN;
+    }
+    else if (ubC[i] - lbC[i] < EQUALITY_TOLERANCE)
+    {
+      rho = settings_.rho_eq_scale * rho_scalar_;
+    }
+
+    if (rho != rho_[i])
+    {
+      rho_[i] = rho;
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+bool AdmmQpBackend::adaptRho()
+{
+  // [R1] Eq(30)
+  const double tiny = 1e-10;
+  const double ratio = (res_primal_ / (primal_scale_ + tiny)) /
+                       (res_dual_ / (dual_scale_ + tiny) + tiny);
+  const double rho = std::min(std::max(rho_scalar_ * std::sqrt(ratio), RHO_MIN), 1e6);
+
+  if (rho > settings_.adaptive_rho_tolerance * rho_scalar_ ||
+      rho < rho_scalar_ / settings_.adaptive_rho_tolerance)
+  {
+    rho_scalar_ = rho;
+    return true;
+  }
+
+  return false;
+}
+
+bool AdmmQpBackend::factorize()
+{
+  // Q + sigma*I + C.T*diag(rho)*C
+  for (unsigned int r = 0; r < n_; r++)
+  {
+    for (unsigned int s = 0; s <= r; s++)
+    {
+      double sum = Q_[r * n_ + s];
+      for (unsigned int i = 0; i < m_; i++)
+      {
+        sum += rho_[i] * C_[i * n_ + r] * C_[i * n_ + s];
+      }
+
+      L_[r * n_ + s] = sum;
+    }
+
+    L_[r * n_ + r] += settings_.sigma;
+  }
+
+  factorizations_++;
+  return cholesky(L_.data(), n_);
+}
+
+bool AdmmQpBackend::converged(const real_t* c)
+{
+  // [R1] Sec 3.4
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    double sum = 0.0;
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      sum += C_[i * n_ + j] * x_[j];
+    }
+    Cx_[i] = sum;
+  }
+
+  std::fill(Cty_.begin(), Cty_.end(), 0.0);
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      Cty_[j] += C_[i * n_ + j] * y_[i];
+    }
+  }
+
+  double c_norm = 0.0;
+  res_primal_ = 0.0;
+  res_dual_ = 0.0;
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    res_primal_ = std::max(res_primal_, std::abs(Cx_[i] - z_[i]));
+  }
+
+  for (unsigned int r = 0; r < n_; r++)
+  {
+    double sum = 0.0;
+    for (unsigned int s = 0; s < n_; s++)
+    {
+      sum += Q_[r * n_ + s] * x_[s];
+    }
+    Qx_[r] = sum;
+
+    res_dual_ = std::max(res_dual_, std::abs(sum + c[r] + Cty_[r]));
+    c_norm = std::max(c_norm, std::abs(c[r]));
+  }
+
+  primal_scale_ = std::max(inf_norm(Cx_), inf_norm(z_));
+  dual_scale_ = std::max({ inf_norm(Qx_), inf_norm(Cty_), c_norm });
+  eps_primal_ = settings_.eps_abs + settings_.eps_rel * primal_scale_;
+  eps_dual_ = settings_.eps_abs + settings_.eps_rel * dual_scale_;
+
+  return res_primal_ <= eps_primal_ && res_dual_ <= eps_dual_;
+}
+
+bool AdmmQpBackend::polish(const real_t* c, const real_t* lbC, const real_t* ubC)
+{
+  // [R1] Sec 4, guess the active set from the dual variables
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    active_[i] = 0;
+    if (ubC[i] - lbC[i] < EQUALITY_TOLERANCE)
+    {
+      active_[i] = -1;
+      bp_[i] = lbC[i];
+    }
+    else if (std::isfinite(lb_[i]) && z_[i] - lb_[i] < -y_[i])
+    {
+      active_[i] = -1;
+      bp_[i] = lb_[i];
+    }
+    else if (std::isfinite(ub_[i]) && ub_[i] - z_[i] < y_[i])
+    {
+      active_[i] = 1;
+      bp_[i] = ub_[i];
+    }
+  }
+
+  // The regularized KKT system
+  // [Q + delta*I, CA.T; CA, -delta*I] [x; yA] = [-c; bA]
+  // is quasi-definite, eliminating yA = (CA*x - bA)/delta gives
+  // (Q + delta*I + CA.T*CA/delta)*x = -c + CA.T*bA/delta
+  const double delta = settings_.polish_delta;
+  for (unsigned int r = 0; r < n_; r++)
+  {
+    for (unsigned int s = 0; s <= r; s++)
+    {
+      double sum = 0.0;
+      for (unsigned int i = 0; i < m_; i++)
+      {
+        if (active_[i] != 0)
+        {
+          sum += C_[i * n_ + r] * C_[i * n_ + s];
+        }
+      }
+
+      Lp_[r * n_ + s] = Q_[r * n_ + s] + sum / delta;
+    }
+
+    Lp_[r * n_ + r] += delta;
+  }
+
+  if (!cholesky(Lp_.data(), n_))
+  {
+    return false;
+  }
+
+  for (unsigned int j = 0; j < n_; j++)
+  {
+    xp_[j] = -c[j];
+  }
+
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    if (active_[i] != 0)
+    {
+      for (unsigned int j = 0; j < n_; j++)
+      {
+        xp_[j] += C_[i * n_ + j] * bp_[i] / delta;
+      }
+    }
+  }
+
+  cholesky_solve(Lp_.data(), n_, xp_.data());
+
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    yp_[i] = 0.0;
+    if (active_[i] != 0)
+    {
+      double sum = 0.0;
+      for (unsigned int j = 0; j < n_; j++)
+      {
+        sum += C_[i * n_ + j] * xp_[j];
+      }
+      yp_[i] = (sum - bp_[i]) / delta;
+    }
+  }
+
+  // Iterative refinement against the unregularized KKT system
+  for (unsigned int k = 0; k < settings_.polish_refine_iterations; k++)
+  {
+    // r1 = -c - Q*x - CA.T*yA and r2 = bA - CA*x
+    for (unsigned int r = 0; r < n_; r++)
+    {
+      double sum = -c[r];
+      for (unsigned int s = 0; s < n_; s++)
+      {
+        sum -= Q_[r * n_ + s] * xp_[s];
+      }
+      rp_[r] = sum;
+    }
+
+    for (unsigned int i = 0; i < m_; i++)
+    {
+      zt_[i] = 0.0;
+      if (active_[i] != 0)
+      {
+        double sum = bp_[i];
+        for (unsigned int j = 0; j < n_; j++)
+        {
+          rp_[j] -= C_[i * n_ + j] * yp_[i];
+          sum -= C_[i * n_ + j] * xp_[j];
+        }
+        zt_[i] = sum;
+      }
+    }
+
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      dx_[j] = rp_[j];
+    }
+
+    for (unsigned int i = 0; i < m_; i++)
+    {
+      if (active_[i] != 0)
+      {
+        for (unsigned int j = 0; j < n_; j++)
+        {
+          dx_[j] += C_[i * n_ + j] * zt_[i] / delta;
+        }
+      }
+    }
+
+    cholesky_solve(Lp_.data(), n_, dx_.data());
+
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      xp_[j] += dx_[j];
+    }
+
+    for (unsigned int i = 0; i < m_; i++)
+    {
+      if (active_[i] != 0)
+      {
+        double sum = 0.0;
+        for (unsigned int j = 0; j < n_; j++)
+        {
+          sum += C_[i * n_ + j] * dx_[j];
+        }
+        yp_[i] += (sum - zt_[i]) / delta;
+      }
+    }
+  }
+
+  // Accept the polished solution if it is primal and dual feasible
+  std::fill(Cty_.begin(), Cty_.end(), 0.0);
+  double res_primal = 0.0;
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    double sum = 0.0;
+    for (unsigned int j = 0; j < n_; j++)
+    {
+      sum += C_[i * n_ + j] * xp_[j];
+      Cty_[j] += C_[i * n_ + j] * yp_[i];
+    }
+
+    Cx_[i] = sum;
+    res_primal = std::max({ res_primal, lb_[i] - sum, sum - ub_[i] });
+
+    // A multiplier with the wrong sign means the active set guess is wrong, the
+    // residuals of the refined KKT solution are small either way
+    const bool equality = ubC[i] - lbC[i] < EQUALITY_TOLERANCE;
+    if (!equality && active_[i] * yp_[i] < -settings_.eps_abs)
+    {
+      return false;
+    }
+  }
+
+  double res_dual = 0.0;
+  for (unsigned int r = 0; r < n_; r++)
+  {
+    double sum = c[r] + Cty_[r];
+    for (unsigned int s = 0; s < n_; s++)
+    {
+      sum += Q_[r * n_ + s] * xp_[s];
+    }
+    res_dual = std::max(res_dual, std::abs(sum));
+  }
+
+  if (res_primal > eps_primal_ || res_dual > eps_dual_)
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < m_; i++)
+  {
+    z_[i] = std::min(std::max(Cx_[i], lb_[i]), ub_[i]);
+    y_[i] = yp_[i];
+  }
+  std::copy(xp_.begin(), xp_.end(), x_.begin());
+
+  res_primal_ = res_primal;
+  res_dual_ = res_dual;
+  polished_ = true;
+
+  return true;
+}
+}  // namespace quadruped_controller
@@ -5,8 +5,9 @@
  * @brief Force balance controller
  */
 
-#include <ros/console.h>
 #include <quadruped_controller/balance_controller.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
 
 /*
 References:
@@ -71,7 +72,12 @@ BalanceController::BalanceController(double mu, double mass, double fzmin, doubl
                                      const mat& Ib, const mat& S, const mat& W,
                                      const vec& kff, const vec& kp_p, const vec& kd_p,
                                      const vec& kp_w, const vec& kd_w,
-                                     const std::vector<std::string>& leg_names)
+                                     const std::vector<std::string>& leg_names,
+                                     bool torque_limits, double tau_min, double tau_max,
+                                     std::shared_ptr<const ExplicitBalanceQP> explicit_qp,
+                                     QpBackendType qp_backend,
+                                     const AdmmSettings& admm_settings,
+                                     const SolveRateSettings& solve_rate)
   : mu_(mu)
   , mass_(mass)
   , Ib_(Ib)
@@ -81,7 +87,15 @@ BalanceController::BalanceController(double mu, double mass, double fzmin, doubl
   , kd_p_(kd_p)
   , kp_w_(kp_w)
   , kd_w_(kd_w)
-  , QPSolver_(num_variables_qp_, num_constraints_qp_)
+  , torque_limits_(torque_limits)
+  , tau_min_(tau_min)
+  , tau_max_(tau_max)
+  , num_constraints_qp_(num_friction_constraints_qp_ +
+                        (torque_limits ? num_torque_constraints_qp_ : 0))
+  , explicit_qp_(std::move(explicit_qp))
+  , explicit_weights_(true)
+  , explicit_region_(-1)
+  , solve_rate_(solve_rate)
   , nWSR_(200)
   , fzmin_(fzmin)
   , fzmax_(fzmax)
@@ -91,15 +105,16 @@ BalanceController::BalanceController(double mu, double mass, double fzmin, doubl
   , cpu_time_(0.01)  // run QP at 100 Hz
   , leg_names_(leg_names)
 {
-  // Disable printing
-  QPSolver_.setPrintLevel(qpOASES::PL_NONE);
+  qp_backend_ = make_qp_backend(qp_backend, num_variables_qp_, num_constraints_qp_,
+                                cpu_time_, nWSR_, admm_settings);
 }
 
 ForceMap BalanceController::control(const mat& Rwb, const mat& Rwb_d, const vec& x,
                                     const vec& xdot, const vec& w, const vec& x_d,
                                     const vec& xdot_d, const vec& w_d,
                                     const FootholdMap& foot_map,
-                                    const GaitMap& gait_map) const
+                                    const GaitMap& gait_map,
+                                    const JacobianMap& jacobian_map) const
 {
   // TODO: return previouse solution if there is a failure
 
@@ -118,6 +133,12 @@ ForceMap BalanceController::control(const mat& Rwb, const mat& Rwb_d, const vec&
   // compose friction cone constraint bounds
   frictionConeBounds(gait_map);
 
+  // Forces the motors can deliver
+  if (torque_limits_)
+  {
+    torqueLimitConstraints(Rwb, jacobian_map);
+  }
+
   // IMPORTANT: Ground reaction forces from QP solver are in world frame
   vec fw(num_variables_qp_, arma::fill::zeros);
 
@@ -145,6 +166,24 @@ ForceMap BalanceController::control(const mat& Rwb, const mat& Rwb_d, const vec&
   const mat A_dyn = std::get<mat>(srb_dyn);
   const vec b_dyn = std::get<vec>(srb_dyn);
 
+  // Close to the last solved problem the solution is updated linearly, the joint
+  // torque constraints change with the Jacobians and always require a solve
+  const uint32_t mask = stance_mask(gait_map, leg_names_);
+  const vec lbC = copy_from_real_t(qp_lbC_, num_constraints_qp_);
+  const vec ubC = copy_from_real_t(qp_ubC_, num_constraints_qp_);
+  if (solve_rate_.enabled() && !torque_limits_)
+  {
+    TRACE_SCOPE("qp", "sensitivity");
+    if (solve_rate_.update(mask, ft_p, Rwb, b_dyn, lbC, ubC, fw))
+    {
+      status_ = QPStatus();
+      status_.solved = true;
+      status_.sensitivity_update = true;
+
+      return stanceForces(fw, Rwb, gait_map);
+    }
+  }
+
   // TODO: Add regularization term Eq(6)
   // [R1] Convert Eq(6) to QP standard form 1/2*x.T*Q*x + x.T*c
   // Q = 2*(A.T*S*A + W) (12x12)
@@ -154,84 +193,109 @@ ForceMap BalanceController::control(const mat& Rwb, const mat& Rwb_d, const vec&
 
   if (!Q.is_sympd())
   {
-    ROS_ERROR_STREAM_NAMED(LOGNAME, "Q is NOT semipositive definite");
+    RT_LOG_ERROR_NAMED(LOGNAME, "Q is NOT semipositive definite");
+  }
+
+  // The explicit solution is exact within its regions, the joint torque constraints
+  // are not part of it. Once the solver is initialized a miss hotstarts the QP.
+  if (explicit_qp_ && explicit_weights_ && !torque_limits_ &&
+      qp_backend_->isInitialised())
+  {
+    TRACE_SCOPE("qp", "explicit");
+    if (explicit_qp_->hasPattern(mask) &&
+        explicit_qp_->solve(mask, explicit_qp_->parameters(mask, Rwb, ft_p, b_dyn), Q, c,
+                            fw, explicit_region_))
+    {
+      status_.return_value = qpOASES::SUCCESSFUL_RETURN;
+      status_.iterations = 0;
+      status_.cpu_time = 0.0;
+      status_.solved = true;
+      status_.explicit_solution = true;
+      status_.sensitivity_update = false;
+
+      if (solve_rate_.enabled())
+      {
+        solve_rate_.anchor(mask, ft_p, Rwb, b_dyn, A_dyn, S_, Q, c, C_, lbC, ubC, fw);
+      }
+
+      return stanceForces(fw, Rwb, gait_map);
+    }
   }
 
   copy_to_real_t(Q, qp_Q_);
   copy_to_real_t(c, qp_c_);
 
-  // No lower/upper bound constraints on GRFs because
-  // the constraint matrix, C, takes care of this.
-  real_t* qp_lb = nullptr;
-  real_t* qp_ub = nullptr;
-
   // Primal solution
   real_t qp_xOpt[num_variables_qp_];
 
-  // Will update based on actual
-  int nWSR_acutal = nWSR_;
-  real_t cpu_time_actual = cpu_time_;
-
-  // TODO: See Init Homotopy pg 31
-  // TODO: Add initial guess to hotstart
-  if (!QPSolver_.isInitialised())
+  status_ = qp_backend_->solve(qp_Q_, qp_c_, qp_C_, qp_lbC_, qp_ubC_, qp_xOpt);
+  if (!status_.solved)
   {
-    const returnValue ret_val = QPSolver_.init(qp_Q_, qp_c_, qp_C_, qp_lb, qp_ub, qp_lbC_,
-                                               qp_ubC_, nWSR_acutal, &cpu_time_actual);
-
-    if (ret_val != qpOASES::SUCCESSFUL_RETURN)
-    {
-      ROS_ERROR_STREAM_NAMED(LOGNAME,
-                             "Failed to initialize Balance Controller QP Solver");
-
-      return force_map;
-    }
+    RT_LOG_ERROR_NAMED(LOGNAME, "Balance Controller QP Solver (%s) Failed: %d",
+                       qp_backend_name(qp_backend_->type()), status_.return_value);
+    solve_rate_.reset();
+    return force_map;
   }
 
-  else
-  {
-    const returnValue ret_val =
-        QPSolver_.hotstart(qp_Q_, qp_c_, qp_C_, qp_lb, qp_ub, qp_lbC_, qp_ubC_,
-                           nWSR_acutal, &cpu_time_actual);
+  fw = copy_from_real_t(qp_xOpt, num_variables_qp_);
 
-    if (ret_val != qpOASES::SUCCESSFUL_RETURN)
-    {
-      ROS_ERROR_STREAM_NAMED(LOGNAME, "Failed to hotstart Balance Controller QP Solver");
-      return force_map;
-    }
+  if (solve_rate_.enabled() && !torque_limits_)
+  {
+    solve_rate_.anchor(mask, ft_p, Rwb, b_dyn, A_dyn, S_, Q, c, C_, lbC, ubC, fw);
   }
 
-  // std::cout << "CPU time: " << cpu_time_actual << " (s)" << std::endl;
+  return stanceForces(fw, Rwb, gait_map);
+}
 
-  if (QPSolver_.isSolved())
-  {
-    QPSolver_.getPrimalSolution(qp_xOpt);
-    fw = copy_from_real_t(qp_xOpt, num_variables_qp_);
-  }
+bool BalanceController::warmStart(const FootholdMap& foot_map, const vec& x_stand) const
+{
+  // At rest at the standing height
+  const mat I = eye(3, 3);
+  const vec zeros(3, arma::fill::zeros);
+  control(I, I, x_stand, zeros, zeros, x_stand, zeros, zeros, foot_map);
 
-  else
-  {
-    ROS_ERROR_STREAM_NAMED(LOGNAME, "Balance Controller QP Solver Failed");
-    return force_map;
-  }
+  RT_LOG_DEBUG_NAMED(LOGNAME, "Standing QP solved in %d working set recalculations",
+                     status_.iterations);
 
-  const mat Rbw = Rwb.t();
-  unsigned int row = 0;
-  unsigned int col = 2;
-  for (const auto& leg_name : leg_names_)
+  return status_.solved;
+}
+
+void BalanceController::setGains(const mat& S, const mat& W, const vec& kff,
+                                 const vec& kp_p, const vec& kd_p, const vec& kp_w,
+                                 const vec& kd_w)
+{
+  S_ = S;
+  W_ = W;
+  kff_ = kff;
+  kp_p_ = kp_p;
+  kd_p_ = kd_p;
+  kp_w_ = kp_w;
+  kd_w_ = kd_w;
+
+  // The sensitivity of the last solution depends on S and the desired wrench on the
+  // gains
+  solve_rate_.reset();
+
+  if (explicit_qp_)
   {
-    if (gait_map.at(leg_name).first == LegState::stance)
+    const bool explicit_weights = explicit_qp_->hasWeights(S_, W_);
+    if (explicit_weights != explicit_weights_)
     {
-      // Negate force directions and transform into body frame
-      const vec3 fb = -1.0 * Rbw * fw.rows(row, col);
-      force_map.emplace(leg_name, fb);
+      RT_LOG_WARN_NAMED(LOGNAME, "%s the explicit QP solutions",
+                        explicit_weights ? "Using" : "S and W changed, not using");
     }
-
-    row += 3;
-    col += 3;
+    explicit_weights_ = explicit_weights;
   }
+}
 
-  return force_map;
+const QPStatus& BalanceController::status() const
+{
+  return status_;
+}
+
+QpBackendType BalanceController::qpBackend() const
+{
+  return qp_backend_->type();
 }
 
 tuple<mat, vec> BalanceController::dynamics(const mat& ft_p, const mat& Rwb, const vec& x,
@@ -271,6 +335,30 @@ tuple<mat, vec> BalanceController::dynamics(const mat& ft_p, const mat& Rwb, con
   return std::make_tuple(A, b);
 }
 
+ForceMap BalanceController::stanceForces(const vec& fw, const mat& Rwb,
+                                         const GaitMap& gait_map) const
+{
+  ForceMap force_map;
+
+  const mat Rbw = Rwb.t();
+  unsigned int row = 0;
+  unsigned int col = 2;
+  for (const auto& leg_name : leg_names_)
+  {
+    if (gait_map.at(leg_name).first == LegState::stance)
+    {
+      // Negate force directions and transform into body frame
+      const vec3 fb = -1.0 * Rbw * fw.rows(row, col);
+      force_map.emplace(leg_name, fb);
+    }
+
+    row += 3;
+    col += 3;
+  }
+
+  return force_map;
+}
+
 mat BalanceController::frictionConeConstraint() const
 {
   // [R1] Eq(7) and Eq(8)
@@ -281,7 +369,7 @@ mat BalanceController::frictionConeConstraint() const
                    { 1.0, 0.0, mu_ },
                    { 0.0, 0.0, 1.0 } };
 
-  // Constraint matrix
+  // Constraint matrix, the torque rows are filled in every tick
   mat C(num_constraints_qp_, num_variables_qp_, arma::fill::zeros);
   C.submat(0, 0, 4, 2) = Cf;
   C.submat(5, 3, 9, 5) = Cf;
@@ -301,8 +389,8 @@ void BalanceController::frictionConeBounds(const GaitMap& gait_map) const
   const vec ubf = { 0.0, 0.0, upper, upper, fzmax_ };
 
   // Lower and upper bounds on constraint matrix
-  vec lbC(num_constraints_qp_);
-  vec ubC(num_constraints_qp_);
+  vec lbC(num_friction_constraints_qp_);
+  vec ubC(num_friction_constraints_qp_);
 
   unsigned int row_start = 0;
   unsigned int row_end = 4;
@@ -328,4 +416,42 @@ void BalanceController::frictionConeBounds(const GaitMap& gait_map) const
   copy_to_real_t(lbC, qp_lbC_);
   copy_to_real_t(ubC, qp_ubC_);
 }
+
+void BalanceController::torqueLimitConstraints(const mat& Rwb,
+                                               const JacobianMap& jacobian_map) const
+{
+  const auto upper = 1000000.0;
+  const auto lower = -1000000.0;
+
+  // The QP solves for the world frame forces the ground applies to the feet,
+  // tau = J.T*fb with fb = -Rbw*fw
+  const mat33 Rbw = Rwb.t();
+  for (unsigned int i = 0; i < leg_names_.size(); i++)
+  {
+    const uint64_t row = num_friction_constraints_qp_ + 3 * i;
+    const auto jacobian = jacobian_map.find(leg_names_.at(i));
+    if (jacobian == jacobian_map.end())
+    {
+      for (unsigned int j = 0; j < 3; j++)
+      {
+        qp_lbC_[row + j] = lower;
+        qp_ubC_[row + j] = upper;
+      }
+
+      continue;
+    }
+
+    const mat33 M = -1.0 * jacobian->second.t() * Rbw;
+    for (unsigned int j = 0; j < 3; j++)
+    {
+      for (unsigned int k = 0; k < 3; k++)
+      {
+        qp_C_[(row + j) * num_variables_qp_ + 3 * i + k] = M(j, k);
+      }
+
+      qp_lbC_[row + j] = tau_min_;
+      qp_ubC_[row + j] = tau_max_;
+    }
+  }
+}
 }  // namespace quadruped_controller
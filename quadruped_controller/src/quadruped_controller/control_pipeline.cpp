@@ -0,0 +1,730 @@
+/**
+ * @file control_pipeline.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Per tick control pipeline
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+
+// Quadruped Control
+#include <quadruped_controller/control_pipeline.hpp>
+#include <quadruped_controller/math/numerics.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "control_pipeline";
+
+using math::almost_equal;
+using math::Pose;
+
+static int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+const char* pipeline_stage_name(PipelineStage stage)
+{
+  switch (stage)
+  {
+    case PipelineStage::forward_kinematics:
+      return "forward_kinematics";
+    case PipelineStage::foothold_planning:
+      return "foothold_planning";
+    case PipelineStage::swing_trajectory:
+      return "swing_trajectory";
+    case PipelineStage::joint_control:
+      return "joint_control";
+    case PipelineStage::balance_control:
+      return "balance_control";
+    case PipelineStage::torque_merge:
+      return "torque_merge";
+    default:
+      return "unknown";
+  }
+}
+
+const char* degradation_mode_name(DegradationMode mode)
+{
+  switch (mode)
+  {
+    case DegradationMode::nominal:
+      return "nominal";
+    case DegradationMode::reuse_forces:
+      return "reuse_forces";
+    case DegradationMode::skip_replanning:
+      return "skip_replanning";
+    case DegradationMode::joint_pd_stand:
+      return "joint_pd_stand";
+    default:
+      return "unknown";
+  }
+}
+
+const char* balance_solver_name(BalanceSolver solver)
+{
+  switch (solver)
+  {
+    case BalanceSolver::no_solve:
+      return "none";
+    case BalanceSolver::balance_qp:
+      return "balance_qp";
+    case BalanceSolver::lqr_balance:
+      return "lqr";
+    case BalanceSolver::mpc_balance:
+      return "nonlinear_mpc";
+    default:
+      return "unknown";
+  }
+}
+
+void PipelineStats::reset()
+{
+  ticks = 0;
+  last_time.fill(0.0);
+  total_time.fill(0.0);
+  allocations.fill(0);
+}
+
+/**
+ * @brief Standing foot positions below the hips
+ * @param config - pipeline parameters
+ * @return foot positions in body frame
+ */
+static FootholdMap stance_feet(const ControlPipelineConfig& config)
+{
+  const QuadrupedKinematics kinematics;
+
+  FootholdMap foot_map;
+  for (const auto& leg_name : config.leg_names)
+  {
+    vec3 foot = kinematics.forwardKinematics(leg_name, vec3(arma::fill::zeros));
+    foot(2) = -config.x_stand(2);
+    foot_map.emplace(leg_name, foot);
+  }
+
+  return foot_map;
+}
+
+/** @brief Gains of the pipeline parameters */
+static ControlGains control_gains(const ControlPipelineConfig& config)
+{
+  ControlGains gains;
+  gains.S = config.S;
+  gains.W = config.W;
+  gains.kff = config.kff;
+  gains.kp_p = config.kp_p;
+  gains.kd_p = config.kd_p;
+  gains.kp_w = config.kp_w;
+  gains.kd_w = config.kd_w;
+  gains.jc_kff = config.jc_kff;
+  gains.jc_kp = config.jc_kp;
+  gains.jc_kd = config.jc_kd;
+  return gains;
+}
+
+/**
+ * @brief Check gains before they reach the controllers
+ * @return true if the sizes match, every value is finite, the S and W diagonals are
+ * positive, and the kp and kd gains are non-negative
+ */
+static bool valid_gains(const ControlGains& gains)
+{
+  if (gains.S.n_rows != 6 || gains.S.n_cols != 6 || gains.W.n_rows != 12 ||
+      gains.W.n_cols != 12 || gains.kff.n_elem != 6 || gains.kp_p.n_elem != 3 ||
+      gains.kd_p.n_elem != 3 || gains.kp_w.n_elem != 3 || gains.kd_w.n_elem != 3)
+  {
+    return false;
+  }
+
+  if (!gains.S.is_finite() || !gains.W.is_finite() || !gains.kff.is_finite() ||
+      !gains.kp_p.is_finite() || !gains.kd_p.is_finite() || !gains.kp_w.is_finite() ||
+      !gains.kd_w.is_finite() || !gains.jc_kff.is_finite() || !gains.jc_kp.is_finite() ||
+      !gains.jc_kd.is_finite())
+  {
+    return false;
+  }
+
+  // The QP Hessian needs positive weights
+  if (gains.S.diag().min() <= 0.0 || gains.W.diag().min() <= 0.0)
+  {
+    return false;
+  }
+
+  return gains.kp_p.min() >= 0.0 && gains.kd_p.min() >= 0.0 && gains.kp_w.min() >= 0.0 &&
+         gains.kd_w.min() >= 0.0 && gains.jc_kp.min() >= 0.0 && gains.jc_kd.min() >= 0.0;
+}
+
+ControlPipeline::ControlPipeline(const ControlPipelineConfig& config)
+  : config_(config)
+  , balance_controller_(config.mu, config.mass, config.fzmin, config.fzmax, config.Ib,
+                        config.S, config.W, config.kff, config.kp_p, config.kd_p,
+                        config.kp_w, config.kd_w, config.leg_names,
+                        config.torque_limited_qp, config.tau_min, config.tau_max,
+                        config.explicit_qp, config.qp_backend, config.admm,
+                        config.solve_rate)
+  , nonlinear_mpc_(config.nonlinear_mpc, config.mu, config.mass, config.fzmin,
+                   config.fzmax, config.Ib, config.t_swing, config.t_stance,
+                   config.leg_names)
+  , joint_controller_(config.jc_kff, config.jc_kp, config.jc_kd)
+  , foot_traj_manager_(config.height, config.t_swing, config.t_stance)
+  , leg_executor_(config.leg_executor, config.leg_names)
+  , gains_(std::make_unique<const ControlGains>(control_gains(config)))
+  , tick_gains_(control_gains(config))
+  , gain_updates_(0)
+  , Rwb_d_(arma::eye(3, 3))
+  , x_d_(config.x_stand)
+  , xdot_d_(arma::fill::zeros)
+  , w_d_(arma::fill::zeros)
+  , Vb_(6, arma::fill::zeros)
+  , cmd_received_(false)
+  , standing_(false)
+  , new_footholds_(false)
+  , mode_(DegradationMode::nominal)
+  , balance_solver_(BalanceSolver::no_solve)
+  , balance_solved_(false)
+  , tick_com_state_(nullptr)
+  , tick_joint_states_map_(nullptr)
+  , tick_gait_map_(nullptr)
+  , tick_gait_running_(false)
+  , replanning_(false)
+  , swing_js_(config.leg_names.size())
+  , swing_legs_(config.leg_names.size(), 0)
+  , swing_fn_([this](std::size_t leg) { swingReference(leg); })
+  , allocation_counter_(nullptr)
+{
+  // Feet below the hips at the standing height
+  for (const auto& [leg_name, foot] : stance_feet(config_))
+  {
+    const vec3 q = kinematics_.legInverseKinematics(leg_name, foot);
+    stand_js_map_.emplace(leg_name, LegJointStates(q, vec3(arma::fill::zeros)));
+  }
+
+  // The gain schedule solves a DARE per grid point, only pay for it when it is used
+  if (config_.use_lqr_stance)
+  {
+    lqr_controller_ = std::make_unique<const LQRBalanceController>(
+        config_.lqr_stance, config_.mu, config_.mass, config_.fzmin, config_.fzmax,
+        config_.Ib, stance_feet(config_), config_.leg_names);
+  }
+
+  // Solve the standing QP and run the rigid body math once so the first tick after
+  // the stand command costs the same as any other. With a zero command the desired
+  // state is unchanged.
+  const RobotStateCoM stand_state = { config_.x_stand, xdot_d_, w_d_, Rwb_d_ };
+  if (!balance_controller_.warmStart(kinematics_.forwardKinematics(stand_js_map_),
+                                     config_.x_stand))
+  {
+    RT_LOG_WARN_NAMED(LOGNAME, "Failed to warm start the balance controller");
+  }
+  integrateCommand(stand_state);
+
+  if (config_.use_task_graph)
+  {
+    task_graph_ = std::make_unique<realtime::TaskGraph>(config_.task_graph_threads,
+                                                        config_.task_graph_cpus);
+    realtime::TaskGraph& graph = *task_graph_;
+
+    // Critical path FK -> balance control -> torque merge
+    const auto fk = graph.addTask(pipeline_stage_name(PipelineStage::forward_kinematics),
+                                  [this] { forwardKinematicsStage(); }, true);
+    const auto footholds =
+        graph.addTask(pipeline_stage_name(PipelineStage::foothold_planning),
+                      [this] { footholdStage(); });
+    const auto swing = graph.addTask(pipeline_stage_name(PipelineStage::swing_trajectory),
+                                     [this] { swingStage(); });
+    const auto joint = graph.addTask(pipeline_stage_name(PipelineStage::joint_control),
+                                     [this] { jointControlStage(); });
+    const auto balance =
+        graph.addTask(pipeline_stage_name(PipelineStage::balance_control),
+                      [this] { balanceStage(); }, true);
+    const auto merge = graph.addTask(pipeline_stage_name(PipelineStage::torque_merge),
+                                     [this] { torqueMergeStage(); }, true);
+
+    graph.addDependency(fk, footholds);
+    graph.addDependency(footholds, swing);
+    graph.addDependency(swing, joint);
+    graph.addDependency(joint, merge);
+    graph.addDependency(fk, balance);
+    graph.addDependency(balance, merge);
+
+    // The nonlinear MPC reads the footholds
+    if (config_.use_nonlinear_mpc)
+    {
+      graph.addDependency(footholds, balance);
+    }
+  }
+}
+
+void ControlPipeline::setCommand(const vec& Vb)
+{
+  Vb_ = Vb;
+  cmd_received_ = true;
+}
+
+const TorqueMap& ControlPipeline::update(const RobotStateCoM& com_state,
+                                         const JointStatesMap& joint_states_map,
+                                         const GaitMap& gait_map, bool gait_running)
+{
+  stats_.last_time.fill(0.0);
+  tick_com_state_ = &com_state;
+  tick_joint_states_map_ = &joint_states_map;
+  tick_gait_map_ = &gait_map;
+  tick_gait_running_ = gait_running;
+
+  // Gains published since the last tick take effect at the tick boundary
+  if (const ControlGains* gains = gains_.poll())
+  {
+    balance_controller_.setGains(gains->S, gains->W, gains->kff, gains->kp_p,
+                                 gains->kd_p, gains->kp_w, gains->kd_w);
+    joint_controller_.setGains(gains->jc_kff, gains->jc_kp, gains->jc_kd);
+
+    // Same sizes as the gains in use, the copy does not allocate
+    tick_gains_ = *gains;
+    gain_updates_++;
+    RT_LOG_INFO_NAMED(LOGNAME, "Updated the gains");
+  }
+  gains_.quiescent();
+
+  // Robot is standing
+  if (!standing_ && almost_equal(com_state.x(2), config_.x_stand(2), 0.005))
+  {
+    RT_LOG_INFO_NAMED(LOGNAME, "Standing height achieved");
+    standing_ = true;
+  }
+
+  new_footholds_ = false;
+  balance_solver_ = BalanceSolver::no_solve;
+  balance_solved_ = false;
+  replanning_ = standing_ && gait_running && mode_ < DegradationMode::skip_replanning;
+  if (mode_ == DegradationMode::joint_pd_stand)
+  {
+    forwardKinematicsStage();
+
+    // Hold the standing configuration, no GRFs
+    stageStart(PipelineStage::joint_control);
+    torque_map_ = joint_controller_.control(stand_js_map_, joint_states_map);
+    force_map_.clear();
+    stageEnd(PipelineStage::joint_control);
+
+    stageStart(PipelineStage::torque_merge);
+    for (auto& [leg_name, torque] : torque_map_)
+    {
+      torque = arma::clamp(torque, config_.tau_min, config_.tau_max);
+    }
+    stageEnd(PipelineStage::torque_merge);
+  }
+  else
+  {
+    // Balance control reads the desired state, so it is updated before the stages
+    if (replanning_ && cmd_received_)
+    {
+      stageStart(PipelineStage::foothold_planning);
+      integrateCommand(com_state);
+      cmd_received_ = false;
+      stageEnd(PipelineStage::foothold_planning);
+    }
+    else if (standing_ && !gait_running && cmd_received_ &&
+             mode_ < DegradationMode::skip_replanning)
+    {
+      stageStart(PipelineStage::foothold_planning);
+      poseCommand();
+      cmd_received_ = false;
+      stageEnd(PipelineStage::foothold_planning);
+    }
+
+    if (task_graph_)
+    {
+      task_graph_->run();
+    }
+    else
+    {
+      forwardKinematicsStage();
+      footholdStage();
+      swingStage();
+      jointControlStage();
+      balanceStage();
+      torqueMergeStage();
+    }
+  }
+
+  tick_com_state_ = nullptr;
+  tick_joint_states_map_ = nullptr;
+  tick_gait_map_ = nullptr;
+
+  stats_.ticks++;
+  return torque_map_;
+}
+
+bool ControlPipeline::updateGains(const ControlGains& gains)
+{
+  if (!valid_gains(gains))
+  {
+    return false;
+  }
+
+  gains_.publish(std::make_unique<const ControlGains>(gains));
+  return true;
+}
+
+void ControlPipeline::setDegradationMode(DegradationMode mode)
+{
+  // The warm start goes stale while the MPC is not running
+  if (mode != DegradationMode::nominal && mode_ == DegradationMode::nominal)
+  {
+    nonlinear_mpc_.reset();
+  }
+
+  mode_ = mode;
+}
+
+DegradationMode ControlPipeline::degradationMode() const
+{
+  return mode_;
+}
+
+bool ControlPipeline::standing() const
+{
+  return standing_;
+}
+
+bool ControlPipeline::newFootholds() const
+{
+  return new_footholds_;
+}
+
+const FootholdMap& ControlPipeline::footholds() const
+{
+  return foothold_final_map_;
+}
+
+const FootholdMap& ControlPipeline::footPositions() const
+{
+  return foot_actual_map_;
+}
+
+const ForceMap& ControlPipeline::forces() const
+{
+  return force_map_;
+}
+
+const TorqueMap& ControlPipeline::torques() const
+{
+  return torque_map_;
+}
+
+RobotStateCoM ControlPipeline::desiredState() const
+{
+  RobotStateCoM desired_state;
+  desired_state.x = x_d_;
+  desired_state.xdot = xdot_d_;
+  desired_state.w = w_d_;
+  desired_state.Rwb = Rwb_d_;
+
+  return desired_state;
+}
+
+const QPStatus& ControlPipeline::balanceStatus() const
+{
+  return balance_controller_.status();
+}
+
+BalanceSolver ControlPipeline::balanceSolver() const
+{
+  return balance_solver_;
+}
+
+bool ControlPipeline::balanceSolved() const
+{
+  return balance_solved_;
+}
+
+const ControlGains& ControlPipeline::gains() const
+{
+  return tick_gains_;
+}
+
+uint64_t ControlPipeline::gainUpdates() const
+{
+  return gain_updates_;
+}
+
+const MPCStatus& ControlPipeline::mpcStatus() const
+{
+  return nonlinear_mpc_.status();
+}
+
+const FootTrajectoryManager& ControlPipeline::footTrajectoryManager() const
+{
+  return foot_traj_manager_;
+}
+
+const realtime::TaskGraph* ControlPipeline::taskGraph() const
+{
+  return task_graph_.get();
+}
+
+const PipelineStats& ControlPipeline::stats() const
+{
+  return stats_;
+}
+
+void ControlPipeline::resetStats()
+{
+  stats_.reset();
+}
+
+void ControlPipeline::setAllocationCounter(uint64_t (*counter)())
+{
+  allocation_counter_ = counter;
+}
+
+void ControlPipeline::integrateCommand(const RobotStateCoM& com_state)
+{
+  const Pose pose(com_state.Rwb, com_state.x);
+  const Pose pose_desired = integrate_twist_yaw(pose, Vb_, config_.dt);
+
+  // Desired pose
+  Rwb_d_ = pose_desired.orientation.matrix();
+  x_d_ = pose_desired.position;
+
+  // TODO: height drifts
+  x_d_(2) = config_.x_stand(2);
+
+  // Desired velocities
+  const vec Vw = pose.transform().adjoint() * Vb_;
+  xdot_d_ = Vw.rows(0, 2);
+  w_d_ = Vw.rows(3, 5);
+}
+
+void ControlPipeline::poseCommand()
+{
+  const LQRBalanceConfig& grid = config_.lqr_stance;
+  const double roll = std::clamp(Vb_(3), -grid.angle_max, grid.angle_max);
+  const double pitch = std::clamp(Vb_(4), -grid.angle_max, grid.angle_max);
+
+  // The feet stay put, so the body keeps its place over them
+  Rwb_d_ = math::Rotation3d(roll, pitch, Vb_(5)).matrix();
+  x_d_(2) = std::clamp(config_.x_stand(2) + Vb_(2), grid.height_min, grid.height_max);
+
+  xdot_d_.zeros();
+  w_d_.zeros();
+}
+
+FootStateMap ControlPipeline::planFootholds(const RobotStateCoM& com_state,
+                                            const GaitMap& gait_map)
+{
+  // Plan footholds (world frame)
+  const auto foothold_plan = foothold_planner_.positions(
+      config_.t_stance, com_state.Rwb, com_state.x, com_state.xdot, com_state.w, xdot_d_,
+      foot_actual_map_, gait_map);
+
+  new_footholds_ = std::get<bool>(foothold_plan);
+  if (!new_footholds_)
+  {
+    // No planning just update reference foot states
+    return foot_traj_manager_.referenceStates(gait_map);
+  }
+
+  foothold_final_map_ = std::get<FootholdMap>(foothold_plan);
+
+  // Foot trajectory position only boundary conditions
+  FootTrajBoundsMap foot_traj_bounds_map;
+  for (const auto& [leg_name, p_final] : foothold_final_map_)
+  {
+    // Transform feet from body into world frame
+    const vec3 p_start = com_state.Rwb * foot_actual_map_.at(leg_name) + com_state.x;
+    foot_traj_bounds_map.emplace(leg_name, FootTrajBounds(p_start, p_final));
+  }
+
+  // Plan foot trajectories (world frame) and get reference states
+  return foot_traj_manager_.referenceStates(gait_map, foot_traj_bounds_map);
+}
+
+void ControlPipeline::forwardKinematicsStage()
+{
+  // FK (body frame)
+  stageStart(PipelineStage::forward_kinematics);
+  leg_executor_.forwardKinematics(*tick_joint_states_map_, foot_actual_map_);
+  stageEnd(PipelineStage::forward_kinematics);
+}
+
+void ControlPipeline::footholdStage()
+{
+  if (!replanning_)
+  {
+    return;
+  }
+
+  stageStart(PipelineStage::foothold_planning);
+  planFootholds(*tick_com_state_, *tick_gait_map_);
+  stageEnd(PipelineStage::foothold_planning);
+}
+
+void ControlPipeline::swingStage()
+{
+  // Leg swing reference joint states
+  stageStart(PipelineStage::swing_trajectory);
+  leg_executor_.forEachLeg(swing_fn_);
+  stageEnd(PipelineStage::swing_trajectory);
+}
+
+void ControlPipeline::jointControlStage()
+{
+  // Leg swing control
+  stageStart(PipelineStage::joint_control);
+  JointStatesMap swing_leg_js_map;
+  for (std::size_t i = 0; i < config_.leg_names.size(); i++)
+  {
+    if (swing_legs_[i])
+    {
+      swing_leg_js_map.emplace(config_.leg_names[i], swing_js_[i]);
+    }
+  }
+
+  swing_torque_map_ =
+      joint_controller_.control(swing_leg_js_map, *tick_joint_states_map_);
+  stageEnd(PipelineStage::joint_control);
+}
+
+void ControlPipeline::balanceStage()
+{
+  const RobotStateCoM& com_state = *tick_com_state_;
+  const JointStatesMap& joint_states_map = *tick_joint_states_map_;
+  const GaitMap& gait_map = *tick_gait_map_;
+  const bool gait_running = tick_gait_running_;
+
+  // Optimize GRF for stance legs, also when there are no previous GRFs to reuse
+  stageStart(PipelineStage::balance_control);
+  if (mode_ == DegradationMode::nominal || force_map_.empty())
+  {
+    bool solved = false;
+    if (config_.use_lqr_stance && standing_ && !gait_running)
+    {
+      force_map_ = lqr_controller_->control(com_state, desiredState(), foot_actual_map_);
+      balance_solver_ = BalanceSolver::lqr_balance;
+      solved = true;
+    }
+    else if (config_.use_nonlinear_mpc && mode_ == DegradationMode::nominal)
+    {
+      force_map_ = nonlinear_mpc_.control(com_state, desiredState(), foot_actual_map_,
+                                          foothold_final_map_, gait_map,
+                                          standing_ && gait_running);
+      balance_solver_ = BalanceSolver::mpc_balance;
+      solved = nonlinear_mpc_.status().solved;
+    }
+
+    // Balance QP by default and when the nonlinear MPC fails
+    if (!solved)
+    {
+      // Swing legs have zero GRFs so their torque rows are never active
+      if (config_.torque_limited_qp)
+      {
+        for (const auto& [leg_name, joint_states] : joint_states_map)
+        {
+          jacobian_map_[leg_name] = kinematics_.legJacobian(leg_name, joint_states.q);
+        }
+      }
+
+      force_map_ = balance_controller_.control(
+          com_state.Rwb, Rwb_d_, com_state.x, com_state.xdot, com_state.w, x_d_, xdot_d_,
+          w_d_, foot_actual_map_, gait_map, jacobian_map_);
+      balance_solver_ = BalanceSolver::balance_qp;
+      solved = balance_controller_.status().solved;
+    }
+
+    balance_solved_ = solved;
+  }
+  else
+  {
+    // Last GRFs, only for legs still in stance
+    for (auto it = force_map_.begin(); it != force_map_.end();)
+    {
+      const auto leg_state = gait_map.find(it->first);
+      if (leg_state == gait_map.end() || leg_state->second.first != LegState::stance)
+      {
+        it = force_map_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+  stageEnd(PipelineStage::balance_control);
+}
+
+void ControlPipeline::torqueMergeStage()
+{
+  // Only use for stance legs
+  stageStart(PipelineStage::torque_merge);
+  torque_map_ =
+      leg_executor_.jacobianTransposeControl(*tick_joint_states_map_, force_map_);
+
+  // Merge torque maps
+  torque_map_.insert(swing_torque_map_.begin(), swing_torque_map_.end());
+
+  // Torque limits
+  for (auto& [leg_name, torque] : torque_map_)
+  {
+    torque = arma::clamp(torque, config_.tau_min, config_.tau_max);
+  }
+  stageEnd(PipelineStage::torque_merge);
+}
+
+void ControlPipeline::swingReference(std::size_t leg)
+{
+  const std::string& leg_name = config_.leg_names[leg];
+  const auto leg_state = tick_gait_map_->find(leg_name);
+  swing_legs_[leg] =
+      leg_state != tick_gait_map_->end() && leg_state->second.first == LegState::swing;
+  if (!swing_legs_[leg])
+  {
+    return;
+  }
+
+  FootState foot_state =
+      foot_traj_manager_.referenceState(leg_name, leg_state->second.second);
+
+  // Transform foot state into body frame for IK and J^-1
+  const RobotStateCoM& com_state = *tick_com_state_;
+  foot_state.position = world_to_body(com_state.Rwb, com_state.x, foot_state.position);
+  foot_state.velocity = com_state.Rwb.t() * foot_state.velocity;
+
+  const vec3 q = kinematics_.legInverseKinematics(leg_name, foot_state.position);
+  const vec3 qdot = kinematics_.legJacobianInverse(leg_name, q) * foot_state.velocity;
+  swing_js_[leg] = LegJointStates(q, qdot);
+}
+
+void ControlPipeline::stageStart(PipelineStage stage)
+{
+  stage_start_ns_[stage] = now_ns();
+  if (allocation_counter_)
+  {
+    stage_start_allocations_[stage] = allocation_counter_();
+  }
+}
+
+void ControlPipeline::stageEnd(PipelineStage stage)
+{
+  const int64_t end_ns = now_ns();
+  TRACE_COMPLETE("pipeline", pipeline_stage_name(stage), stage_start_ns_[stage], end_ns);
+
+  // A stage may be timed more than once per tick
+  const auto elapsed = static_cast<double>(end_ns - stage_start_ns_[stage]) * 1.0e-9;
+  stats_.last_time.at(stage) += elapsed;
+  stats_.total_time.at(stage) += elapsed;
+
+  if (allocation_counter_)
+  {
+    stats_.allocations.at(stage) +=
+        allocation_counter_() - stage_start_allocations_[stage];
+  }
+}
+}  // namespace quadruped_controller
@@ -0,0 +1,936 @@
+/**
+ * @file explicit_balance_qp.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Explicit solution of the balance QP for common contact patterns
+ */
+
+// C++
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+
+// ROS
+#include <ros/console.h>
+
+// QP solver
+#include <qpOASES.hpp>
+
+// Quadruped Control
+#include <quadruped_controller/explicit_balance_qp.hpp>
+#include <quadruped_controller/math/rigid3d.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "explicit_balance_qp";
+
+static const char EXPLICIT_QP_MAGIC[8] = { 'Q', 'P', 'E', 'X', 'P', 'L', 'C', '\0' };
+
+static constexpr unsigned int LEAF_SIZE = 8;        // max samples in a k-d tree leaf
+static constexpr unsigned int NEIGHBORS = 16;       // samples searched for regions
+static constexpr unsigned int MAX_LEAVES = 8;       // leaves searched for neighbors
+static constexpr unsigned int MAX_CANDIDATES = 8;   // regions tried before the QP
+static constexpr unsigned int MAX_TREE_DEPTH = 64;  // k-d tree search stack size
+static constexpr double PRIMAL_TOLERANCE = 1e-6;    // inequality violation (N)
+static constexpr double DUAL_TOLERANCE = 1e-8;      // negative multiplier
+
+/** @brief File header */
+struct ExplicitQPFileHeader
+{
+  char magic[8];          // "QPEXPLC\0"
+  uint32_t version;       // EXPLICIT_QP_VERSION
+  uint32_t num_patterns;  // patterns that follow the header
+  double mu;
+  double fzmin;
+  double fzmax;
+  double S[36];   // column major (6x6)
+  double W[144];  // column major (12x12)
+};
+
+/**
+ * @brief Pattern header
+ * @details Followed by the regions, the samples (column major), the sample regions,
+ * and the k-d tree nodes.
+ */
+struct ExplicitQPFilePattern
+{
+  uint32_t stance_mask;
+  uint32_t dim;
+  uint32_t num_regions;
+  uint32_t num_samples;
+  uint32_t num_nodes;
+  uint32_t reserved;
+  double center[EXPLICIT_QP_MAX_DIM];
+  double scale[EXPLICIT_QP_MAX_DIM];
+};
+
+/** @brief Balance QP of the stance GRFs prepared for active set solves */
+struct ReducedQP
+{
+  std::array<unsigned int, 3 * EXPLICIT_QP_NUM_LEGS> indices;  // stance GRFs in fw
+  unsigned int n;  // stance GRFs
+  mat G;           // inequalities G*f <= h
+  vec h;
+  vec Hc;          // Q^-1*c
+  mat HG;          // Q^-1*G.T
+  vec GHc;         // G*Q^-1*c
+  mat GHG;         // G*Q^-1*G.T
+};
+
+/** @brief FNV-1a hash of a file, identifies the table a tick log was recorded with */
+static uint64_t file_fingerprint(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  uint64_t hash = 14695981039346656037ull;
+  std::array<char, 1 << 16> buffer;
+  while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+  {
+    for (std::streamsize i = 0; i < file.gcount(); i++)
+    {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 1099511628211ull;
+    }
+  }
+
+  return hash;
+}
+
+/** @brief Return the number of stance legs */
+static unsigned int num_stance_legs(uint32_t stance_mask)
+{
+  return static_cast<unsigned int>(std::bitset<32>(stance_mask).count());
+}
+
+/** @brief Return true if two parameters are equal up to round off */
+static bool same_parameter(double a, double b)
+{
+  return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(a));
+}
+
+/**
+ * @brief Prepare the QP of the stance GRFs for active set solves
+ * @param stance_mask - stance legs
+ * @param Q - Hessian (12x12)
+ * @param c - linear cost (12x1)
+ * @param G - inequality matrix of the stance GRFs
+ * @param h - inequality bounds
+ * @param qp[out] - reduced QP
+ * @return true if the Hessian of the stance GRFs is invertible
+ * @details Swing leg GRFs are zero so their rows and columns are removed.
+ */
+static bool reduce(uint32_t stance_mask, const mat& Q, const vec& c, const mat& G,
+                   const vec& h, ReducedQP& qp)
+{
+  qp.n = 0;
+  for (unsigned int i = 0; i < EXPLICIT_QP_NUM_LEGS; i++)
+  {
+    if (stance_mask & (1u << i))
+    {
+      for (unsigned int j = 0; j < 3; j++)
+      {
+        qp.indices.at(qp.n++) = 3 * i + j;
+      }
+    }
+  }
+
+  mat H(qp.n, qp.n);
+  mat rhs(qp.n, 1 + G.n_rows);
+  for (unsigned int i = 0; i < qp.n; i++)
+  {
+    for (unsigned int j = 0; j < qp.n; j++)
+    {
+      H(i, j) = Q(qp.indices[i], qp.indices[j]);
+    }
+
+    rhs(i, 0) = c(qp.indices[i]);
+  }
+  rhs.cols(1, G.n_rows) = G.t();
+
+  mat Y;
+  if (!arma::solve(Y, H, rhs, arma::solve_opts::no_approx))
+  {
+    return false;
+  }
+
+  qp.G = G;
+  qp.h = h;
+  qp.Hc = Y.col(0);
+  qp.HG = Y.cols(1, G.n_rows);
+  qp.GHc = G * qp.Hc;
+  qp.GHG = G * qp.HG;
+
+  return true;
+}
+
+/**
+ * @brief Solve the reduced QP with an active set and verify it is optimal
+ * @param qp - reduced QP
+ * @param active_set - bit j is set if inequality j is active
+ * @param fw[out] - GRFs in world frame, zero for swing legs (12x1)
+ * @return true if the solution is primal and dual feasible
+ */
+static bool certify(const ReducedQP& qp, uint32_t active_set, vec& fw)
+{
+  std::array<unsigned int, EXPLICIT_QP_INEQUALITIES * EXPLICIT_QP_NUM_LEGS> active;
+  unsigned int m = 0;
+  for (unsigned int j = 0; j < qp.G.n_rows; j++)
+  {
+    if (active_set & (1u << j))
+    {
+      active.at(m++) = j;
+    }
+  }
+
+  // More active inequalities than GRFs are linearly dependent
+  if (m > qp.n || (active_set >> qp.G.n_rows) != 0)
+  {
+    return false;
+  }
+
+  // Stationarity Q*f + c + Ga.T*lambda = 0 with Ga*f = ha, so
+  // f = -Q^-1*(c + Ga.T*lambda) and G*f - h = -(G*Q^-1*c + h) - G*Q^-1*Ga.T*lambda
+  vec slack = -(qp.GHc + qp.h);
+  vec lambda;
+  if (m > 0)
+  {
+    mat M(m, m);
+    vec rhs(m);
+    for (unsigned int i = 0; i < m; i++)
+    {
+      for (unsigned int j = 0; j < m; j++)
+      {
+        M(i, j) = qp.GHG(active[i], active[j]);
+      }
+
+      rhs(i) = slack(active[i]);
+    }
+
+    if (!arma::solve(lambda, M, rhs, arma::solve_opts::no_approx) ||
+        lambda.min() < -DUAL_TOLERANCE)
+    {
+      return false;
+    }
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+      slack -= lambda(i) * qp.GHG.col(active[i]);
+    }
+  }
+
+  // Inactive inequalities
+  if (slack.max() > PRIMAL_TOLERANCE)
+  {
+    return false;
+  }
+
+  vec f = -qp.Hc;
+  for (unsigned int i = 0; i < m; i++)
+  {
+    f -= lambda(i) * qp.HG.col(active[i]);
+  }
+
+  fw.zeros(3 * EXPLICIT_QP_NUM_LEGS);
+  for (unsigned int i = 0; i < qp.n; i++)
+  {
+    fw(qp.indices[i]) = f(i);
+  }
+
+  return true;
+}
+
+uint32_t stance_mask(const GaitMap& gait_map, const std::vector<std::string>& leg_names)
+{
+  uint32_t mask = 0;
+  for (unsigned int i = 0; i < leg_names.size(); i++)
+  {
+    if (gait_map.at(leg_names.at(i)).first == LegState::stance)
+    {
+      mask |= 1u << i;
+    }
+  }
+
+  return mask;
+}
+
+std::vector<uint32_t> contact_pattern_masks(const std::string& name)
+{
+  // Leg order [RL FL RR FR]
+  if (name == "stand")
+  {
+    return { 0b1111 };
+  }
+  else if (name == "trot")
+  {
+    return { 0b1001, 0b0110 };
+  }
+  else if (name == "pace")
+  {
+    return { 0b0011, 0b1100 };
+  }
+  else if (name == "bound")
+  {
+    return { 0b0101, 0b1010 };
+  }
+
+  return {};
+}
+
+ExplicitBalanceQP::ExplicitBalanceQP(double mu, double fzmin, double fzmax, const mat& S,
+                                     const mat& W)
+  : mu_(mu), fzmin_(fzmin), fzmax_(fzmax), S_(S), W_(W), fingerprint_(0)
+{
+}
+
+bool ExplicitBalanceQP::load(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to open explicit QP %s", path.c_str());
+    return false;
+  }
+
+  ExplicitQPFileHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, EXPLICIT_QP_MAGIC, sizeof(EXPLICIT_QP_MAGIC)) != 0 ||
+      header.version != EXPLICIT_QP_VERSION)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "%s is not a version %u explicit QP", path.c_str(),
+                    EXPLICIT_QP_VERSION);
+    return false;
+  }
+
+  // The regions are only valid for the QP they were computed for
+  bool same = same_parameter(header.mu, mu_) && same_parameter(header.fzmin, fzmin_) &&
+              same_parameter(header.fzmax, fzmax_) && S_.n_elem == 36 &&
+              W_.n_elem == 144;
+  for (unsigned int i = 0; same && i < 36; i++)
+  {
+    same = same_parameter(header.S[i], S_(i));
+  }
+  for (unsigned int i = 0; same && i < 144; i++)
+  {
+    same = same_parameter(header.W[i], W_(i));
+  }
+
+  if (!same)
+  {
+    ROS_ERROR_NAMED(LOGNAME,
+                    "Explicit QP %s was computed for different balance control "
+                    "parameters (mu, fzmin, fzmax, S, or W)",
+                    path.c_str());
+    return false;
+  }
+
+  std::vector<ExplicitQPPattern> patterns(header.num_patterns);
+  for (auto& pattern : patterns)
+  {
+    ExplicitQPFilePattern file_pattern;
+    if (!file.read(reinterpret_cast<char*>(&file_pattern), sizeof(file_pattern)) ||
+        file_pattern.stance_mask == 0 ||
+        (file_pattern.stance_mask >> EXPLICIT_QP_NUM_LEGS) != 0 ||
+        file_pattern.dim != 6 + 3 * num_stance_legs(file_pattern.stance_mask) ||
+        file_pattern.num_nodes == 0)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Explicit QP %s has an invalid pattern", path.c_str());
+      return false;
+    }
+
+    pattern.stance_mask = file_pattern.stance_mask;
+    pattern.dim = file_pattern.dim;
+    pattern.center = vec(file_pattern.center, pattern.dim);
+    pattern.scale = vec(file_pattern.scale, pattern.dim);
+    pattern.regions.resize(file_pattern.num_regions);
+    pattern.samples.set_size(pattern.dim, file_pattern.num_samples);
+    pattern.sample_regions.resize(file_pattern.num_samples);
+    pattern.nodes.resize(file_pattern.num_nodes);
+
+    file.read(reinterpret_cast<char*>(pattern.regions.data()),
+              pattern.regions.size() * sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(pattern.samples.memptr()),
+              pattern.samples.n_elem * sizeof(double));
+    file.read(reinterpret_cast<char*>(pattern.sample_regions.data()),
+              pattern.sample_regions.size() * sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(pattern.nodes.data()),
+              pattern.nodes.size() * sizeof(ExplicitQPNode));
+    if (!file)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Explicit QP %s is truncated", path.c_str());
+      return false;
+    }
+
+    // Indices are used without checks online
+    bool valid = std::all_of(
+        pattern.sample_regions.begin(), pattern.sample_regions.end(),
+        [&pattern](uint32_t region) { return region < pattern.regions.size(); });
+    for (const auto& node : pattern.nodes)
+    {
+      if (node.split_dim < 0)
+      {
+        valid = valid && node.first <= node.second &&
+                node.second <= pattern.sample_regions.size();
+      }
+      else
+      {
+        valid = valid && static_cast<unsigned int>(node.split_dim) < pattern.dim &&
+                node.first < pattern.nodes.size() && node.second < pattern.nodes.size();
+      }
+    }
+
+    if (!valid)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Explicit QP %s has an invalid k-d tree", path.c_str());
+      return false;
+    }
+  }
+
+  patterns_ = std::move(patterns);
+  path_ = path;
+  fingerprint_ = file_fingerprint(path);
+
+  for (const auto& pattern : patterns_)
+  {
+    ROS_INFO_NAMED(LOGNAME, "Loaded explicit QP for stance legs 0x%x: %zu regions, %zu "
+                   "samples",
+                   pattern.stance_mask, pattern.regions.size(),
+                   pattern.sample_regions.size());
+  }
+
+  return true;
+}
+
+bool ExplicitBalanceQP::save(const std::string& path) const
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to create explicit QP %s", path.c_str());
+    return false;
+  }
+
+  ExplicitQPFileHeader header = {};
+  std::copy(EXPLICIT_QP_MAGIC, EXPLICIT_QP_MAGIC + sizeof(EXPLICIT_QP_MAGIC),
+            header.magic);
+  header.version = EXPLICIT_QP_VERSION;
+  header.num_patterns = patterns_.size();
+  header.mu = mu_;
+  header.fzmin = fzmin_;
+  header.fzmax = fzmax_;
+  std::copy(S_.memptr(), S_.memptr() + std::min<arma::uword>(S_.n_elem, 36), header.S);
+  std::copy(W_.memptr(), W_.memptr() + std::min<arma::uword>(W_.n_elem, 144), header.W);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  for (const auto& pattern : patterns_)
+  {
+    ExplicitQPFilePattern file_pattern = {};
+    file_pattern.stance_mask = pattern.stance_mask;
+    file_pattern.dim = pattern.dim;
+    file_pattern.num_regions = pattern.regions.size();
+    file_pattern.num_samples = pattern.sample_regions.size();
+    file_pattern.num_nodes = pattern.nodes.size();
+    std::copy(pattern.center.begin(), pattern.center.end(), file_pattern.center);
+    std::copy(pattern.scale.begin(), pattern.scale.end(), file_pattern.scale);
+
+    file.write(reinterpret_cast<const char*>(&file_pattern), sizeof(file_pattern));
+    file.write(reinterpret_cast<const char*>(pattern.regions.data()),
+               pattern.regions.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(pattern.samples.memptr()),
+               pattern.samples.n_elem * sizeof(double));
+    file.write(reinterpret_cast<const char*>(pattern.sample_regions.data()),
+               pattern.sample_regions.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(pattern.nodes.data()),
+               pattern.nodes.size() * sizeof(ExplicitQPNode));
+  }
+
+  if (!file)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to write explicit QP %s", path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+ExplicitQPSamplingStats ExplicitBalanceQP::generate(const ExplicitQPSampling& sampling)
+{
+  const uint32_t mask = sampling.stance_mask;
+  const unsigned int dim = 6 + 3 * num_stance_legs(mask);
+
+  // Parameter box
+  vec center(dim);
+  vec half_width(dim);
+  center.rows(0, 2) = 0.5 * (sampling.force_max + sampling.force_min);
+  half_width.rows(0, 2) = 0.5 * (sampling.force_max - sampling.force_min);
+  center.rows(3, 5).zeros();
+  half_width.rows(3, 5) = sampling.moment_max;
+
+  unsigned int row = 6;
+  for (unsigned int i = 0; i < EXPLICIT_QP_NUM_LEGS; i++)
+  {
+    if (mask & (1u << i))
+    {
+      center.rows(row, row + 2) = sampling.feet.col(i);
+      half_width.rows(row, row + 2) =
+          vec3({ sampling.foot_range, sampling.foot_range, sampling.foot_height_range });
+      row += 3;
+    }
+  }
+
+  mat G;
+  vec h;
+  inequalities(mask, G, h);
+  const unsigned int n = G.n_cols;
+  const unsigned int m = G.n_rows;
+
+  // qpOASES uses row major arrays
+  std::vector<qpOASES::real_t> qp_H(n * n), qp_g(n), qp_A(m * n), qp_lbA(m, -1000000.0),
+      qp_ubA(h.begin(), h.end()), qp_x(n), qp_working_set(n + m);
+  for (unsigned int i = 0; i < m; i++)
+  {
+    for (unsigned int j = 0; j < n; j++)
+    {
+      qp_A[i * n + j] = G(i, j);
+    }
+  }
+
+  std::mt19937 generator(sampling.seed);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+  ExplicitQPSamplingStats stats;
+  mat parameters(dim, sampling.samples);
+  std::vector<uint32_t> active_sets;
+  active_sets.reserve(sampling.samples);
+
+  mat Q;
+  vec c;
+  vec fw;
+  vec theta(dim);
+  ReducedQP reduced;
+  for (unsigned int k = 0; k < sampling.samples; k++)
+  {
+    for (unsigned int i = 0; i < dim; i++)
+    {
+      theta(i) = center(i) + half_width(i) * uniform(generator);
+    }
+
+    problem(mask, theta, Q, c);
+    if (!reduce(mask, Q, c, G, h, reduced))
+    {
+      stats.failed++;
+      continue;
+    }
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+      for (unsigned int j = 0; j < n; j++)
+      {
+        qp_H[i * n + j] = Q(reduced.indices[i], reduced.indices[j]);
+      }
+      qp_g[i] = c(reduced.indices[i]);
+    }
+
+    qpOASES::QProblem qp(n, m);
+    qp.setPrintLevel(qpOASES::PL_NONE);
+    int nWSR = 200;
+    if (qp.init(qp_H.data(), qp_g.data(), qp_A.data(), nullptr, nullptr, qp_lbA.data(),
+                qp_ubA.data(), nWSR) != qpOASES::SUCCESSFUL_RETURN ||
+        !qp.isSolved())
+    {
+      stats.failed++;
+      continue;
+    }
+
+    qp.getWorkingSetConstraints(qp_working_set.data());
+    uint32_t active_set = 0;
+    for (unsigned int j = 0; j < m; j++)
+    {
+      if (qp_working_set[j] > 0.5)
+      {
+        active_set |= 1u << j;
+      }
+    }
+
+    if (!certify(reduced, active_set, fw))
+    {
+      stats.degenerate++;
+      continue;
+    }
+
+    parameters.col(stats.solved) = theta;
+    active_sets.push_back(active_set);
+    stats.solved++;
+  }
+
+  if (stats.solved > 0)
+  {
+    addPattern(mask, center, half_width, parameters.cols(0, stats.solved - 1),
+               active_sets);
+  }
+
+  return stats;
+}
+
+void ExplicitBalanceQP::addPattern(uint32_t stance_mask, const vec& center,
+                                   const vec& half_width, const mat& parameters,
+                                   const std::vector<uint32_t>& active_sets)
+{
+  ExplicitQPPattern pattern;
+  pattern.stance_mask = stance_mask;
+  pattern.dim = center.n_elem;
+  pattern.center = center;
+  pattern.scale = 1.0 / half_width;
+
+  // One region per active set
+  std::map<uint32_t, uint32_t> region_ids;
+  std::vector<uint32_t> sample_regions(active_sets.size());
+  for (unsigned int k = 0; k < active_sets.size(); k++)
+  {
+    const auto [it, inserted] =
+        region_ids.emplace(active_sets.at(k), pattern.regions.size());
+    if (inserted)
+    {
+      pattern.regions.push_back(active_sets.at(k));
+    }
+
+    sample_regions.at(k) = it->second;
+  }
+
+  pattern.samples = parameters.each_col() - center;
+  pattern.samples.each_col() %= pattern.scale;
+
+  std::vector<uint32_t> order(active_sets.size());
+  for (unsigned int k = 0; k < order.size(); k++)
+  {
+    order.at(k) = k;
+  }
+  buildTree(pattern, order, 0, order.size());
+
+  // Leaves index the samples in tree order
+  const mat samples = pattern.samples;
+  pattern.sample_regions.resize(order.size());
+  for (unsigned int k = 0; k < order.size(); k++)
+  {
+    pattern.samples.col(k) = samples.col(order.at(k));
+    pattern.sample_regions.at(k) = sample_regions.at(order.at(k));
+  }
+
+  const auto it = std::find_if(
+      patterns_.begin(), patterns_.end(),
+      [stance_mask](const ExplicitQPPattern& p) { return p.stance_mask == stance_mask; });
+  if (it != patterns_.end())
+  {
+    *it = std::move(pattern);
+  }
+  else
+  {
+    patterns_.push_back(std::move(pattern));
+  }
+}
+
+vec ExplicitBalanceQP::parameters(uint32_t stance_mask, const mat& Rwb, const mat& ft_p,
+                                  const vec& b) const
+{
+  // Rotation from the world to the heading frame
+  const double yaw = std::atan2(Rwb(1, 0), Rwb(0, 0));
+  const double cy = std::cos(yaw);
+  const double sy = std::sin(yaw);
+  const mat33 Rhw = { { cy, sy, 0.0 }, { -sy, cy, 0.0 }, { 0.0, 0.0, 1.0 } };
+  const mat33 Rhb = Rhw * Rwb;
+
+  vec theta(6 + 3 * num_stance_legs(stance_mask));
+  theta.rows(0, 2) = Rhw * b.rows(0, 2);
+  theta.rows(3, 5) = Rhw * b.rows(3, 5);
+
+  unsigned int row = 6;
+  for (unsigned int i = 0; i < EXPLICIT_QP_NUM_LEGS; i++)
+  {
+    if (stance_mask & (1u << i))
+    {
+      theta.rows(row, row + 2) = Rhb * ft_p.col(i);
+      row += 3;
+    }
+  }
+
+  return theta;
+}
+
+void ExplicitBalanceQP::problem(uint32_t stance_mask, const vec& theta, mat& Q,
+                                vec& c) const
+{
+  // Same as BalanceController::dynamics() with the feet relative to the COM
+  mat A(6, 3 * EXPLICIT_QP_NUM_LEGS, arma::fill::zeros);
+  unsigned int row = 6;
+  for (unsigned int i = 0; i < EXPLICIT_QP_NUM_LEGS; i++)
+  {
+    if (stance_mask & (1u << i))
+    {
+      A.submat(0, 3 * i, 2, 3 * i + 2) = arma::eye(3, 3);
+      A.submat(3, 3 * i, 5, 3 * i + 2) = math::skew_symmetric(theta.rows(row, row + 2));
+      row += 3;
+    }
+  }
+
+  const vec b = theta.rows(0, 5);
+  Q = 2.0 * (A.t() * S_ * A + W_);
+  c = -2.0 * A.t() * S_ * b;
+}
+
+bool ExplicitBalanceQP::solveActiveSet(uint32_t stance_mask, uint32_t active_set,
+                                       const mat& Q, const vec& c, vec& fw) const
+{
+  mat G;
+  vec h;
+  inequalities(stance_mask, G, h);
+
+  ReducedQP reduced;
+  return reduce(stance_mask, Q, c, G, h, reduced) && certify(reduced, active_set, fw);
+}
+
+bool ExplicitBalanceQP::solve(uint32_t stance_mask, const vec& theta, const mat& Q,
+                              const vec& c, vec& fw, int& region) const
+{
+  const ExplicitQPPattern* pattern = findPattern(stance_mask);
+  if (!pattern || theta.n_elem != pattern->dim || pattern->regions.empty())
+  {
+    return false;
+  }
+
+  // Nearest samples, closest first. Subtrees farther than the current farthest
+  // neighbor from their splitting plane are skipped. The search is approximate
+  // because it stops after a fixed number of leaves.
+  const vec z = (theta - pattern->center) % pattern->scale;
+  const unsigned int dim = pattern->dim;
+  std::array<std::pair<double, uint32_t>, NEIGHBORS> nearest;
+  unsigned int num_nearest = 0;
+
+  std::array<std::pair<uint32_t, double>, MAX_TREE_DEPTH> stack;
+  unsigned int stack_size = 0;
+  unsigned int leaves = 0;
+  stack[stack_size++] = { 0, 0.0 };
+  while (stack_size > 0 && leaves < MAX_LEAVES)
+  {
+    const auto [index, bound] = stack[--stack_size];
+    if (num_nearest == NEIGHBORS && bound >= nearest[NEIGHBORS - 1].first)
+    {
+      continue;
+    }
+
+    const ExplicitQPNode& node = pattern->nodes[index];
+    if (node.split_dim < 0)
+    {
+      leaves++;
+      for (uint32_t k = node.first; k < node.second; k++)
+      {
+        const double* sample = pattern->samples.colptr(k);
+        double distance = 0.0;
+        for (unsigned int d = 0; d < dim; d++)
+        {
+          distance += (sample[d] - z(d)) * (sample[d] - z(d));
+        }
+        if (num_nearest == NEIGHBORS && distance >= nearest[NEIGHBORS - 1].first)
+        {
+          continue;
+        }
+
+        // Insertion into the sorted neighbors
+        unsigned int i = num_nearest < NEIGHBORS ? num_nearest++ : NEIGHBORS - 1;
+        for (; i > 0 && nearest[i - 1].first > distance; i--)
+        {
+          nearest[i] = nearest[i - 1];
+        }
+        nearest[i] = { distance, pattern->sample_regions[k] };
+      }
+
+      continue;
+    }
+
+    if (stack_size + 2 > MAX_TREE_DEPTH)
+    {
+      break;
+    }
+
+    // Closer child is searched first
+    const double offset = z(node.split_dim) - node.split_value;
+    const uint32_t near_child = offset < 0.0 ? node.first : node.second;
+    const uint32_t far_child = offset < 0.0 ? node.second : node.first;
+    stack[stack_size++] = { far_child, std::max(bound, offset * offset) };
+    stack[stack_size++] = { near_child, bound };
+  }
+
+  mat G;
+  vec h;
+  inequalities(stance_mask, G, h);
+
+  ReducedQP reduced;
+  if (!reduce(stance_mask, Q, c, G, h, reduced))
+  {
+    return false;
+  }
+
+  // The region of the last solution is the most likely
+  if (region >= 0 && static_cast<unsigned int>(region) < pattern->regions.size() &&
+      certify(reduced, pattern->regions[region], fw))
+  {
+    return true;
+  }
+
+  // Regions of the nearest samples
+  unsigned int tried = 0;
+  for (unsigned int k = 0; k < num_nearest && tried < MAX_CANDIDATES; k++)
+  {
+    const uint32_t candidate = nearest[k].second;
+    const bool duplicate =
+        static_cast<int>(candidate) == region ||
+        std::any_of(nearest.begin(), nearest.begin() + k,
+                    [candidate](const std::pair<double, uint32_t>& other) {
+                      return other.second == candidate;
+                    });
+    if (duplicate)
+    {
+      continue;
+    }
+
+    tried++;
+    if (certify(reduced, pattern->regions[candidate], fw))
+    {
+      region = candidate;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ExplicitBalanceQP::hasPattern(uint32_t stance_mask) const
+{
+  return findPattern(stance_mask) != nullptr;
+}
+
+const std::vector<ExplicitQPPattern>& ExplicitBalanceQP::patterns() const
+{
+  return patterns_;
+}
+
+const std::string& ExplicitBalanceQP::path() const
+{
+  return path_;
+}
+
+uint64_t ExplicitBalanceQP::fingerprint() const
+{
+  return fingerprint_;
+}
+
+bool ExplicitBalanceQP::hasWeights(const mat& S, const mat& W) const
+{
+  if (S.n_elem != S_.n_elem || W.n_elem != W_.n_elem)
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < S_.n_elem; i++)
+  {
+    if (!same_parameter(S_(i), S(i)))
+    {
+      return false;
+    }
+  }
+
+  for (unsigned int i = 0; i < W_.n_elem; i++)
+  {
+    if (!same_parameter(W_(i), W(i)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+const ExplicitQPPattern* ExplicitBalanceQP::findPattern(uint32_t stance_mask) const
+{
+  for (const auto& pattern : patterns_)
+  {
+    if (pattern.stance_mask == stance_mask)
+    {
+      return &pattern;
+    }
+  }
+
+  return nullptr;
+}
+
+void ExplicitBalanceQP::inequalities(uint32_t stance_mask, mat& G, vec& h) const
+{
+  // Friction pyramid and normal force limits per stance foot as in BalanceController
+  const mat Gf = { { 1.0, 0.0, -mu_ },  { 0.0, 1.0, -mu_ }, { 0.0, -1.0, -mu_ },
+                   { -1.0, 0.0, -mu_ }, { 0.0, 0.0, -1.0 }, { 0.0, 0.0, 1.0 } };
+  const vec hf = { 0.0, 0.0, 0.0, 0.0, -fzmin_, fzmax_ };
+
+  const unsigned int legs = num_stance_legs(stance_mask);
+  G.zeros(EXPLICIT_QP_INEQUALITIES * legs, 3 * legs);
+  h.set_size(EXPLICIT_QP_INEQUALITIES * legs);
+  for (unsigned int i = 0; i < legs; i++)
+  {
+    const unsigned int row = EXPLICIT_QP_INEQUALITIES * i;
+    G.submat(row, 3 * i, row + EXPLICIT_QP_INEQUALITIES - 1, 3 * i + 2) = Gf;
+    h.rows(row, row + EXPLICIT_QP_INEQUALITIES - 1) = hf;
+  }
+}
+
+uint32_t ExplicitBalanceQP::buildTree(ExplicitQPPattern& pattern,
+                                      std::vector<uint32_t>& order, uint32_t first,
+                                      uint32_t last) const
+{
+  const uint32_t index = pattern.nodes.size();
+  pattern.nodes.push_back({ -1, first, last, 0, 0.0 });
+  if (last - first <= LEAF_SIZE)
+  {
+    return index;
+  }
+
+  // Split the dimension with the largest spread at the median
+  int split_dim = -1;
+  double spread = 0.0;
+  for (unsigned int d = 0; d < pattern.dim; d++)
+  {
+    double lower = pattern.samples(d, order[first]);
+    double upper = lower;
+    for (uint32_t k = first + 1; k < last; k++)
+    {
+      lower = std::min(lower, pattern.samples(d, order[k]));
+      upper = std::max(upper, pattern.samples(d, order[k]));
+    }
+
+    if (upper - lower > spread)
+    {
+      spread = upper - lower;
+      split_dim = d;
+    }
+  }
+
+  // All samples are the same
+  if (split_dim < 0)
+  {
+    return index;
+  }
+
+  const uint32_t mid = first + (last - first) / 2;
+  std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + last,
+                   [&pattern, split_dim](uint32_t a, uint32_t b) {
+                     return pattern.samples(split_dim, a) < pattern.samples(split_dim, b);
+                   });
+
+  const double split_value = pattern.samples(split_dim, order[mid]);
+  const uint32_t left = buildTree(pattern, order, first, mid);
+  const uint32_t right = buildTree(pattern, order, mid, last);
+  pattern.nodes[index] = { split_dim, left, right, 0, split_value };
+
+  return index;
+}
+}  // namespace quadruped_controller
@@ -8,12 +8,10 @@
 // C++
 #include <cmath>
 
-// ROS
-#include <ros/console.h>
-
 // Quadruped Control
 #include <quadruped_controller/foot_planner.hpp>
 #include <quadruped_controller/math/rigid3d.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
 
 namespace quadruped_controller
 {
@@ -55,7 +53,7 @@ tuple<bool, FootholdMap> FootPlanner::positions(double t_stance, const mat33& Rw
   // No need to replan foot holds
   if (plan_legs.empty())
   {
-    ROS_DEBUG_NAMED(LOGNAME, "No need to replan footholds");
+    RT_LOG_DEBUG_NAMED(LOGNAME, "No need to replan footholds");
     return std::make_tuple(false, FootholdMap());
   }
 
@@ -63,7 +61,7 @@ tuple<bool, FootholdMap> FootPlanner::positions(double t_stance, const mat33& Rw
   FootholdMap foothold_map;
   for (const auto& leg_name : plan_legs)
   {
-    ROS_DEBUG_NAMED(LOGNAME, "Finished foot step planning for leg: %s", leg_name.c_str());
+    RT_LOG_DEBUG_NAMED(LOGNAME, "Finished foot step planning for leg: %s", leg_name);
     const vec foothold_actual = foot_holds.at(leg_name);  // in body frame
     const vec3 foothold =
         singleFoot(t_stance, Rwb, x, xdot, w, xdot_d, foothold_actual, leg_name);
@@ -111,7 +109,7 @@ std::vector<std::string> FootPlanner::updateStates(const GaitMap& gait_map) cons
   // No legs in state_map_
   if (state_map_.empty())
   {
-    ROS_DEBUG_NAMED(LOGNAME, "Populating leg states for foothold planning");
+    RT_LOG_DEBUG_NAMED(LOGNAME, "Populating leg states for foothold planning");
 
     for (const auto& [leg_name, leg_state] : gait_map)
     {
@@ -121,14 +119,14 @@ std::vector<std::string> FootPlanner::updateStates(const GaitMap& gait_map) cons
       // plan footholds for legs in swing phase
       if (leg_state.first == LegState::swing)
       {
-        ROS_DEBUG_NAMED(LOGNAME, "Scheduled to plan foothold for leg: %s",
-                        leg_name.c_str());
+        RT_LOG_DEBUG_NAMED(LOGNAME, "Scheduled to plan foothold for leg: %s",
+                           leg_name);
         plan_legs.emplace_back(leg_name);
       }
 
       else
       {
-        ROS_DEBUG_NAMED(LOGNAME, "leg in stance: %s", leg_name.c_str());
+        RT_LOG_DEBUG_NAMED(LOGNAME, "leg in stance: %s", leg_name);
       }
     }
   }
@@ -141,8 +139,8 @@ std::vector<std::string> FootPlanner::updateStates(const GaitMap& gait_map) cons
       if ((state_map_.at(leg_name) == LegState::stance) &&
           (leg_state.first == LegState::swing))
       {
-        ROS_DEBUG_NAMED(LOGNAME, "Scheduled to plan foothold for leg: %s",
-                        leg_name.c_str());
+        RT_LOG_DEBUG_NAMED(LOGNAME, "Scheduled to plan foothold for leg: %s",
+                           leg_name);
 
         // Replan
         plan_legs.emplace_back(leg_name);
@@ -12,6 +12,7 @@
 
 #include <quadruped_controller/gait.hpp>
 #include <quadruped_controller/math/numerics.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
 
 namespace quadruped_controller
 {
@@ -47,7 +48,11 @@ GaitScheduler::GaitScheduler(double t_swing, double t_stance, const vec& offset)
 
 GaitScheduler::~GaitScheduler()
 {
-  stop();
+  // schedule(t) is used without the thread
+  if (worker_.joinable())
+  {
+    stop();
+  }
 }
 
 void GaitScheduler::start() const
@@ -95,16 +100,41 @@ GaitMap GaitScheduler::schedule() const
   return gait_map;
 }
 
+GaitMap GaitScheduler::schedule(double t) const
+{
+  // wrap phases [0 1)
+  const vec phases = offset_ + 1.0 / (t_swing_ + t_stance_) * t;
+
+  GaitMap gait_map;
+  gait_map.emplace("RL", std::make_pair(phase(std::fmod(phases(0), 1.0)),
+                                        std::fmod(phases(0), 1.0)));
+  gait_map.emplace("FL", std::make_pair(phase(std::fmod(phases(1), 1.0)),
+                                        std::fmod(phases(1), 1.0)));
+  gait_map.emplace("RR", std::make_pair(phase(std::fmod(phases(2), 1.0)),
+                                        std::fmod(phases(2), 1.0)));
+  gait_map.emplace("FR", std::make_pair(phase(std::fmod(phases(3), 1.0)),
+                                        std::fmod(phases(3), 1.0)));
+
+  return gait_map;
+}
+
 void GaitScheduler::execute() const
 {
+  TRACE_THREAD("gait");
+
   auto start = std::chrono::steady_clock::now();
   while (running_)
   {
+    TRACE_INSTANT("gait", "wakeup");
+
     const auto current = std::chrono::steady_clock::now();
     const auto dt = std::chrono::duration<double>(current - start).count();
     start = current;
 
-    update(dt);
+    {
+      TRACE_SCOPE("gait", "update");
+      update(dt);
+    }
 
     std::this_thread::sleep_for(std::chrono::milliseconds(5));  // 200 Hz
   }
@@ -0,0 +1,245 @@
+/**
+ * @file gait_table.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief One gait cycle precomputed for playback
+ */
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Quadruped Control
+#include <quadruped_controller/foot_planner.hpp>
+#include <quadruped_controller/gait.hpp>
+#include <quadruped_controller/gait_table.hpp>
+#include <quadruped_controller/kinematics.hpp>
+#include <quadruped_controller/trajectory.hpp>
+
+namespace quadruped_controller
+{
+GaitTable::GaitTable(const GaitTableConfig& config,
+                     const std::vector<std::string>& leg_names)
+  : leg_names_(leg_names), period_(config.t_swing + config.t_stance)
+{
+  if (leg_names_.empty() || leg_names_.size() > 4)
+  {
+    throw std::invalid_argument("The gait table supports one to four legs");
+  }
+
+  if (config.q_stance.n_elem != 3 * leg_names_.size())
+  {
+    throw std::invalid_argument("The stance joint positions must have 3 per leg");
+  }
+
+  if (config.dt <= 0.0 || period_ <= 0.0)
+  {
+    throw std::invalid_argument("The gait period and time step must be positive");
+  }
+
+  // Whole number of samples so the cycle repeats seamlessly
+  size_ = std::max(static_cast<unsigned int>(std::ceil(period_ / config.dt)), 1u);
+  dt_ = period_ / size_;
+
+  schedulePass(config);
+  footPass(config);
+  inverseKinematicsPass(config);
+  supportPass();
+}
+
+unsigned int GaitTable::size() const
+{
+  return size_;
+}
+
+double GaitTable::period() const
+{
+  return period_;
+}
+
+double GaitTable::dt() const
+{
+  return dt_;
+}
+
+unsigned int GaitTable::index(double t) const
+{
+  double t_cycle = std::fmod(t, period_);
+  if (t_cycle < 0.0)
+  {
+    t_cycle += period_;
+  }
+
+  return std::min(static_cast<unsigned int>(t_cycle / dt_), size_ - 1);
+}
+
+double GaitTable::phase(unsigned int sample, unsigned int leg) const
+{
+  return phases_(leg, sample);
+}
+
+bool GaitTable::swing(unsigned int sample, unsigned int leg) const
+{
+  return swing_[sample * leg_names_.size() + leg];
+}
+
+vec3 GaitTable::footPosition(unsigned int sample, unsigned int leg) const
+{
+  return feet_.submat(3 * leg, sample, 3 * leg + 2, sample);
+}
+
+const double* GaitTable::jointPositions(unsigned int sample) const
+{
+  return joints_.colptr(sample);
+}
+
+const SupportLegs& GaitTable::supportLegs(unsigned int sample) const
+{
+  return support_[sample];
+}
+
+void GaitTable::schedulePass(const GaitTableConfig& config)
+{
+  const GaitScheduler gait_scheduler(config.t_swing, config.t_stance, config.offset);
+  const auto num_legs = leg_names_.size();
+
+  phases_.set_size(num_legs, size_);
+  swing_.resize(num_legs * size_);
+  for (unsigned int i = 0; i < size_; i++)
+  {
+    const GaitMap gait_map = gait_scheduler.schedule(i * dt_);
+    for (unsigned int j = 0; j < num_legs; j++)
+    {
+      const auto& leg_state = gait_map.at(leg_names_[j]);
+      phases_(j, i) = leg_state.second;
+      swing_[i * num_legs + j] = leg_state.first == LegState::swing;
+    }
+  }
+}
+
+void GaitTable::footPass(const GaitTableConfig& config)
+{
+  const QuadrupedKinematics kinematics;
+  const FootPlanner foothold_planner;
+  FootTrajectoryManager foot_traj_manager(config.height, config.t_swing,
+                                          config.t_stance);
+
+  // Stance feet in world frame, the swing trajectories start there
+  const auto num_legs = leg_names_.size();
+  FootholdMap stance_feet;
+  for (unsigned int j = 0; j < num_legs; j++)
+  {
+    const vec3 q = config.q_stance.rows(3 * j, 3 * j + 2);
+    const vec3 foot = kinematics.forwardKinematics(leg_names_[j], q);
+    stance_feet.emplace(leg_names_[j], config.Rwb * foot + config.x);
+  }
+
+  feet_.set_size(3 * num_legs, size_);
+  GaitMap gait_map;
+  for (unsigned int i = 0; i < size_; i++)
+  {
+    gait_map.clear();
+    for (unsigned int j = 0; j < num_legs; j++)
+    {
+      gait_map.emplace(leg_names_[j],
+                       std::make_pair(swing(i, j) ? LegState::swing : LegState::stance,
+                                      phases_(j, i)));
+    }
+
+    // Footholds are planned as legs enter swing
+    const auto foothold_plan =
+        foothold_planner.positions(config.t_stance, config.Rwb, config.x, config.xdot,
+                                   config.w, config.xdot_d, stance_feet, gait_map);
+
+    FootStateMap foot_states_map;
+    if (std::get<bool>(foothold_plan))
+    {
+      FootTrajBoundsMap foot_traj_map;
+      for (const auto& [leg_name, p_final] : std::get<FootholdMap>(foothold_plan))
+      {
+        foot_traj_map.emplace(leg_name,
+                              FootTrajBounds(stance_feet.at(leg_name), p_final));
+      }
+
+      foot_states_map = foot_traj_manager.referenceStates(gait_map, foot_traj_map);
+    }
+    else
+    {
+      foot_states_map = foot_traj_manager.referenceStates(gait_map);
+    }
+
+    for (unsigned int j = 0; j < num_legs; j++)
+    {
+      const auto foot_state = foot_states_map.find(leg_names_[j]);
+      feet_.submat(3 * j, i, 3 * j + 2, i) = foot_state != foot_states_map.end() ?
+                                                 foot_state->second.position :
+                                                 stance_feet.at(leg_names_[j]);
+    }
+  }
+}
+
+void GaitTable::inverseKinematicsPass(const GaitTableConfig& config)
+{
+  const QuadrupedKinematics kinematics;
+  const auto num_legs = leg_names_.size();
+
+  joints_.set_size(3 * num_legs, size_);
+  for (unsigned int i = 0; i < size_; i++)
+  {
+    for (unsigned int j = 0; j < num_legs; j++)
+    {
+      // Stance legs hold their joints
+      if (swing(i, j))
+      {
+        const vec3 foot = world_to_body(config.Rwb, config.x, footPosition(i, j));
+        joints_.submat(3 * j, i, 3 * j + 2, i) =
+            kinematics.legInverseKinematics(leg_names_[j], foot);
+      }
+      else
+      {
+        joints_.submat(3 * j, i, 3 * j + 2, i) = config.q_stance.rows(3 * j, 3 * j + 2);
+      }
+    }
+  }
+}
+
+void GaitTable::supportPass()
+{
+  const auto num_legs = leg_names_.size();
+
+  support_.resize(size_);
+  for (unsigned int i = 0; i < size_; i++)
+  {
+    SupportLegs& polygon = support_[i];
+    polygon.size = 0;
+
+    double cx = 0.0;
+    double cy = 0.0;
+    for (unsigned int j = 0; j < num_legs; j++)
+    {
+      if (!swing(i, j))
+      {
+        polygon.legs[polygon.size++] = static_cast<uint8_t>(j);
+        cx += feet_(3 * j, i);
+        cy += feet_(3 * j + 1, i);
+      }
+    }
+
+    if (polygon.size < 3)
+    {
+      continue;
+    }
+
+    // Counterclockwise about the centroid in the ground plane
+    cx /= polygon.size;
+    cy /= polygon.size;
+    const auto angle = [&](uint8_t leg) {
+      return std::atan2(feet_(3 * leg + 1, i) - cy, feet_(3 * leg, i) - cx);
+    };
+
+    std::sort(polygon.legs.begin(), polygon.legs.begin() + polygon.size,
+              [&](uint8_t a, uint8_t b) { return angle(a) < angle(b); });
+  }
+}
+}  // namespace quadruped_controller
@@ -0,0 +1,449 @@
+/**
+ * @file flight_recorder.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Always-on in-memory ring buffer of recent control ticks
+ */
+
+// C++
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+
+// Linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ROS
+#include <ros/console.h>
+
+// Quadruped Control
+#include <quadruped_controller/io/flight_recorder.hpp>
+
+namespace quadruped_controller
+{
+namespace io
+{
+static const std::string LOGNAME = "flight_recorder";
+
+// Time between checks for dump requests
+static constexpr std::chrono::milliseconds DUMP_POLL_PERIOD(50);
+
+static const char FLIGHT_RECORDER_MAGIC[8] = { 'Q', 'P', 'F', 'L', 'I', 'G', 'H', 'T' };
+
+// Recorders dumped by the crash handler
+static std::atomic<FlightRecorder*> crash_recorders[MAX_CRASH_RECORDERS];
+
+static void crash_handler(int sig)
+{
+  for (auto& crash_recorder : crash_recorders)
+  {
+    FlightRecorder* recorder = crash_recorder.exchange(nullptr);
+    if (recorder)
+    {
+      recorder->dumpCrash();
+    }
+  }
+
+  // Handlers are installed with SA_RESETHAND, re-raise with the default action
+  std::raise(sig);
+}
+
+static FlightRecorderHeader make_header(uint64_t num_records, uint64_t trigger_tick,
+                                        DumpReason reason, double frequency)
+{
+  FlightRecorderHeader header;
+  std::memset(&header, 0, sizeof(FlightRecorderHeader));
+  std::memcpy(header.magic, FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC));
+  header.version = FLIGHT_RECORDER_VERSION;
+  header.record_size = sizeof(FlightRecord);
+  header.num_records = num_records;
+  header.trigger_tick = trigger_tick;
+  header.reason = reason;
+  header.frequency = frequency;
+
+  return header;
+}
+
+const char* dump_reason_name(DumpReason reason)
+{
+  switch (reason)
+  {
+    case DumpReason::dump_request:
+      return "request";
+    case DumpReason::qp_failure:
+      return "qp_failure";
+    case DumpReason::deadline_miss:
+      return "deadline_miss";
+    case DumpReason::crash:
+      return "crash";
+    default:
+      return "unknown";
+  }
+}
+
+FlightRecorder::FlightRecorder(std::size_t capacity, double frequency,
+                               const std::string& directory, const std::string& name)
+  : capacity_(std::max<std::size_t>(capacity, 1))
+  , frequency_(frequency)
+  , directory_(directory)
+  , name_(name)
+  , ring_(new Slot[capacity_])
+  , head_(0)
+  , pending_(new FlightRecord[capacity_])
+  , pending_reason_(DumpReason::dump_request)
+  , pending_tick_(0)
+  , writing_(false)
+  , requested_(false)
+  , last_dump_tick_(0)
+  , dumped_(false)
+  , running_(true)
+  , crash_fd_(-1)
+  , crash_map_(nullptr)
+  , crash_size_(sizeof(FlightRecorderHeader) + capacity_ * sizeof(FlightRecord))
+  , crashed_(false)
+{
+  // Touch every page now so recording never page faults
+  std::memset(static_cast<void*>(pending_.get()), 0, capacity_ * sizeof(FlightRecord));
+  for (std::size_t i = 0; i < capacity_; i++)
+  {
+    std::memset(static_cast<void*>(&ring_[i].record), 0, sizeof(FlightRecord));
+  }
+
+  // Preallocate the crash file, removed on shutdown if unused
+  crash_path_ =
+      directory_ + "/" + name_ + "_" + std::to_string(::getpid()) + "_crash.bin";
+
+  crash_fd_ = ::open(crash_path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (crash_fd_ < 0 || ::ftruncate(crash_fd_, crash_size_) != 0)
+  {
+    ROS_WARN_NAMED(LOGNAME, "Failed to create crash file %s: %s", crash_path_.c_str(),
+                   std::strerror(errno));
+  }
+  else
+  {
+    void* map =
+        ::mmap(nullptr, crash_size_, PROT_READ | PROT_WRITE, MAP_SHARED, crash_fd_, 0);
+    if (map == MAP_FAILED)
+    {
+      ROS_WARN_NAMED(LOGNAME, "Failed to map crash file: %s", std::strerror(errno));
+    }
+    else
+    {
+      crash_map_ = map;
+      std::memset(crash_map_, 0, crash_size_);
+    }
+  }
+
+  writer_ = std::thread(&FlightRecorder::writerThread, this);
+
+  ROS_INFO_NAMED(LOGNAME, "Flight recorder holding %zu ticks (%.1f s), dumps in %s",
+                 capacity_, capacity_ / frequency_, directory_.c_str());
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  for (auto& crash_recorder : crash_recorders)
+  {
+    FlightRecorder* self = this;
+    crash_recorder.compare_exchange_strong(self, nullptr);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_one();
+  writer_.join();
+
+  if (crash_map_)
+  {
+    ::munmap(crash_map_, crash_size_);
+  }
+
+  if (crash_fd_ >= 0)
+  {
+    ::close(crash_fd_);
+    if (!crashed_)
+    {
+      ::unlink(crash_path_.c_str());
+    }
+  }
+}
+
+const FlightRecord& FlightRecorder::record(double stamp, double tick_time,
+                                           const RobotStateCoM& com_state,
+                                           const JointStatesMap& joint_states_map,
+                                           const GaitMap& gait_map,
+                                           const ControlPipeline& pipeline)
+{
+  const uint64_t tick = head_.load(std::memory_order_relaxed);
+  Slot& slot = ring_[tick % capacity_];
+
+  // Mark the slot as being written
+  slot.seq.store(2 * tick + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  FlightRecord& record = slot.record;
+  record.tick = tick;
+  record.stamp = stamp;
+  record.tick_time = tick_time;
+
+  std::copy(com_state.x.begin(), com_state.x.end(), record.x);
+  std::copy(com_state.xdot.begin(), com_state.xdot.end(), record.xdot);
+  std::copy(com_state.w.begin(), com_state.w.end(), record.w);
+  std::copy(com_state.Rwb.begin(), com_state.Rwb.end(), record.Rwb);
+
+  const RobotStateCoM desired_state = pipeline.desiredState();
+  std::copy(desired_state.x.begin(), desired_state.x.end(), record.x_d);
+  std::copy(desired_state.xdot.begin(), desired_state.xdot.end(), record.xdot_d);
+  std::copy(desired_state.w.begin(), desired_state.w.end(), record.w_d);
+  std::copy(desired_state.Rwb.begin(), desired_state.Rwb.end(), record.Rwb_d);
+
+  const ForceMap& force_map = pipeline.forces();
+  const TorqueMap& torque_map = pipeline.torques();
+
+  for (unsigned int i = 0; i < NUM_LEGS; i++)
+  {
+    const std::string& leg_name = tick_log_leg_names().at(i);
+
+    const LegJointStates& joint_states = joint_states_map.at(leg_name);
+    std::copy(joint_states.q.begin(), joint_states.q.end(), record.q + 3 * i);
+    std::copy(joint_states.qdot.begin(), joint_states.qdot.end(), record.qdot + 3 * i);
+
+    const auto& leg_state = gait_map.at(leg_name);
+    record.leg_state[i] = static_cast<uint8_t>(leg_state.first);
+    record.phase[i] = leg_state.second;
+
+    // Swing legs and failed solves have no GRF
+    const auto force = force_map.find(leg_name);
+    if (force != force_map.end())
+    {
+      std::copy(force->second.begin(), force->second.end(), record.force + 3 * i);
+    }
+    else
+    {
+      std::fill(record.force + 3 * i, record.force + 3 * i + 3, 0.0);
+    }
+
+    const auto torque = torque_map.find(leg_name);
+    if (torque != torque_map.end())
+    {
+      std::copy(torque->second.begin(), torque->second.end(), record.torque + 3 * i);
+    }
+    else
+    {
+      std::fill(record.torque + 3 * i, record.torque + 3 * i + 3, 0.0);
+    }
+  }
+
+  // The QP status is from the last solve, stale unless the QP ran this tick
+  record.balance_solver = static_cast<uint8_t>(pipeline.balanceSolver());
+  record.balance_solved = pipeline.balanceSolved();
+  if (pipeline.balanceSolver() == BalanceSolver::balance_qp)
+  {
+    const QPStatus& qp_status = pipeline.balanceStatus();
+    record.qp_cpu_time = qp_status.cpu_time;
+    record.qp_return_value = qp_status.return_value;
+    record.qp_iterations = qp_status.iterations;
+  }
+  else
+  {
+    record.qp_cpu_time = 0.0;
+    record.qp_return_value = 0;
+    record.qp_iterations = 0;
+  }
+  record.degradation_mode = static_cast<uint8_t>(pipeline.degradationMode());
+
+  // Publish the slot
+  slot.seq.store(2 * tick + 2, std::memory_order_release);
+  head_.store(tick + 1, std::memory_order_release);
+
+  return record;
+}
+
+bool FlightRecorder::dump(DumpReason reason, bool force)
+{
+  const uint64_t tick = head_.load(std::memory_order_acquire);
+
+  if (!force && dumped_ && tick - last_dump_tick_ < capacity_)
+  {
+    return false;
+  }
+
+  // Only one dump in flight, the writer owns the pending request until it is done
+  bool expected = false;
+  if (!writing_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+  {
+    return false;
+  }
+
+  if (!force)
+  {
+    dumped_ = true;
+    last_dump_tick_ = tick;
+  }
+
+  // The writer thread polls for the request, the caller never touches the mutex
+  pending_reason_ = reason;
+  pending_tick_ = tick;
+  requested_.store(true, std::memory_order_release);
+
+  return true;
+}
+
+void FlightRecorder::dumpCrash()
+{
+  if (!crash_map_ || crashed_.exchange(true))
+  {
+    return;
+  }
+
+  auto records = reinterpret_cast<FlightRecord*>(static_cast<char*>(crash_map_) +
+                                                 sizeof(FlightRecorderHeader));
+  const std::size_t num_records = snapshot(records);
+
+  // Header last so a partially written crash file reads as empty
+  const FlightRecorderHeader header =
+      make_header(num_records, head_.load(std::memory_order_acquire),
+                  DumpReason::crash, frequency_);
+  std::memcpy(crash_map_, &header, sizeof(FlightRecorderHeader));
+}
+
+void FlightRecorder::installCrashHandler()
+{
+  bool registered = false;
+  for (auto& crash_recorder : crash_recorders)
+  {
+    FlightRecorder* empty = nullptr;
+    if (crash_recorder.compare_exchange_strong(empty, this))
+    {
+      registered = true;
+      break;
+    }
+  }
+
+  if (!registered)
+  {
+    ROS_WARN_NAMED(LOGNAME, "More than %u flight recorders, %s is not dumped on a crash",
+                   MAX_CRASH_RECORDERS, name_.c_str());
+    return;
+  }
+
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = crash_handler;
+  action.sa_flags = SA_RESETHAND;
+  sigemptyset(&action.sa_mask);
+
+  for (const int sig : { SIGSEGV, SIGBUS, SIGFPE, SIGABRT })
+  {
+    sigaction(sig, &action, nullptr);
+  }
+}
+
+uint64_t FlightRecorder::size() const
+{
+  return head_.load(std::memory_order_acquire);
+}
+
+std::size_t FlightRecorder::capacity() const
+{
+  return capacity_;
+}
+
+std::size_t FlightRecorder::snapshot(FlightRecord* records) const
+{
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t start = head > capacity_ ? head - capacity_ : 0;
+
+  std::size_t count = 0;
+  for (uint64_t tick = start; tick < head; tick++)
+  {
+    const Slot& slot = ring_[tick % capacity_];
+
+    const uint64_t seq_before = slot.seq.load(std::memory_order_acquire);
+    std::memcpy(static_cast<void*>(&records[count]), &slot.record, sizeof(FlightRecord));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t seq_after = slot.seq.load(std::memory_order_relaxed);
+
+    // Skip records overwritten or torn during the copy
+    if (seq_before == seq_after && seq_before == 2 * tick + 2)
+    {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+void FlightRecorder::writerThread()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    cv_.wait_for(lock, DUMP_POLL_PERIOD, [this] {
+      return !running_ || requested_.load(std::memory_order_acquire);
+    });
+    if (!requested_.load(std::memory_order_acquire))
+    {
+      if (!running_)
+      {
+        return;
+      }
+      continue;
+    }
+    lock.unlock();
+
+    // The seqlock lets the ring be copied while the control loop keeps recording
+    const std::size_t num_records = snapshot(pending_.get());
+    const FlightRecorderHeader header =
+        make_header(num_records, pending_tick_, pending_reason_, frequency_);
+    const std::string path = directory_ + "/" + name_ + "_" +
+                             std::to_string(::getpid()) + "_" +
+                             std::to_string(pending_tick_) + "_" +
+                             dump_reason_name(pending_reason_) + ".bin";
+
+    const std::size_t size =
+        sizeof(FlightRecorderHeader) + header.num_records * sizeof(FlightRecord);
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    void* map = MAP_FAILED;
+    if (fd >= 0 && ::ftruncate(fd, size) == 0)
+    {
+      map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    if (map != MAP_FAILED)
+    {
+      std::memcpy(map, &header, sizeof(FlightRecorderHeader));
+      std::memcpy(static_cast<char*>(map) + sizeof(FlightRecorderHeader), pending_.get(),
+                  header.num_records * sizeof(FlightRecord));
+      ::munmap(map, size);
+
+      ROS_WARN_NAMED(LOGNAME, "Flight recorder dumped %lu ticks (%s) to %s",
+                     static_cast<unsigned long>(header.num_records),
+                     dump_reason_name(static_cast<DumpReason>(header.reason)),
+                     path.c_str());
+    }
+    else
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Failed to write flight recorder dump %s: %s",
+                      path.c_str(), std::strerror(errno));
+    }
+
+    if (fd >= 0)
+    {
+      ::close(fd);
+    }
+
+    lock.lock();
+    requested_.store(false, std::memory_order_relaxed);
+    writing_.store(false, std::memory_order_release);
+  }
+}
+}  // namespace io
+}  // namespace quadruped_controller
@@ -0,0 +1,691 @@
+/**
+ * @file telemetry.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Columnar binary telemetry log
+ */
+
+// C++
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+// Linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef QUADRUPED_LZ4
+#include <lz4.h>
+#endif
+
+// ROS
+#include <ros/console.h>
+
+// Quadruped Control
+#include <quadruped_controller/io/telemetry.hpp>
+
+namespace quadruped_controller
+{
+namespace io
+{
+static const std::string LOGNAME = "telemetry";
+
+static const char TELEMETRY_MAGIC[8] = { 'Q', 'P', 'T', 'E', 'L', 'E', 'M', '\0' };
+static const char TELEMETRY_CHUNK_MAGIC[4] = { 'C', 'H', 'N', 'K' };
+
+/** @brief Time between checks for full chunks */
+static const std::chrono::milliseconds TELEMETRY_POLL_PERIOD(50);
+
+/** @brief Round a size up to 8 bytes */
+static std::size_t pad8(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+/** @brief Max bytes of a compressed column */
+static std::size_t compress_bound(std::size_t size)
+{
+#ifdef QUADRUPED_LZ4
+  return std::max<std::size_t>(LZ4_compressBound(static_cast<int>(size)), size);
+#else
+  return size;
+#endif
+}
+
+/** @brief Write all bytes, retrying partial writes */
+static bool write_all(int fd, const void* data, std::size_t size)
+{
+  auto bytes = static_cast<const char*>(data);
+  while (size > 0)
+  {
+    const ssize_t written = ::write(fd, bytes, size);
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (written <= 0)
+    {
+      return false;
+    }
+
+    bytes += written;
+    size -= written;
+  }
+
+  return true;
+}
+
+std::size_t telemetry_type_size(TelemetryType type)
+{
+  switch (type)
+  {
+    case TelemetryType::float64:
+      return sizeof(double);
+    case TelemetryType::int32:
+      return sizeof(int32_t);
+    case TelemetryType::uint64:
+      return sizeof(uint64_t);
+    case TelemetryType::uint8:
+      return sizeof(uint8_t);
+    default:
+      return 0;
+  }
+}
+
+const char* telemetry_type_name(TelemetryType type)
+{
+  switch (type)
+  {
+    case TelemetryType::float64:
+      return "float64";
+    case TelemetryType::int32:
+      return "int32";
+    case TelemetryType::uint64:
+      return "uint64";
+    case TelemetryType::uint8:
+      return "uint8";
+    default:
+      return "unknown";
+  }
+}
+
+TelemetrySignal make_telemetry_signal(const std::string& name, TelemetryType type,
+                                      uint32_t width, std::size_t offset)
+{
+  TelemetrySignal signal;
+  std::memset(&signal, 0, sizeof(TelemetrySignal));
+  std::strncpy(signal.name, name.c_str(), sizeof(signal.name) - 1);
+  signal.type = type;
+  signal.width = width;
+  signal.offset = static_cast<uint32_t>(offset);
+  return signal;
+}
+
+const std::vector<TelemetrySignal>& flight_record_signals()
+{
+#define FLIGHT_RECORD_SIGNAL(field, type, width)                                        \
+  make_telemetry_signal(#field, TelemetryType::type, width, offsetof(FlightRecord, field))
+
+  static const std::vector<TelemetrySignal> signals = {
+    FLIGHT_RECORD_SIGNAL(tick, uint64, 1),
+    FLIGHT_RECORD_SIGNAL(stamp, float64, 1),
+    FLIGHT_RECORD_SIGNAL(tick_time, float64, 1),
+    FLIGHT_RECORD_SIGNAL(x, float64, 3),
+    FLIGHT_RECORD_SIGNAL(xdot, float64, 3),
+    FLIGHT_RECORD_SIGNAL(w, float64, 3),
+    FLIGHT_RECORD_SIGNAL(Rwb, float64, 9),
+    FLIGHT_RECORD_SIGNAL(x_d, float64, 3),
+    FLIGHT_RECORD_SIGNAL(xdot_d, float64, 3),
+    FLIGHT_RECORD_SIGNAL(w_d, float64, 3),
+    FLIGHT_RECORD_SIGNAL(Rwb_d, float64, 9),
+    FLIGHT_RECORD_SIGNAL(q, float64, NUM_JOINTS),
+    FLIGHT_RECORD_SIGNAL(qdot, float64, NUM_JOINTS),
+    FLIGHT_RECORD_SIGNAL(phase, float64, NUM_LEGS),
+    FLIGHT_RECORD_SIGNAL(force, float64, NUM_JOINTS),
+    FLIGHT_RECORD_SIGNAL(torque, float64, NUM_JOINTS),
+    FLIGHT_RECORD_SIGNAL(qp_cpu_time, float64, 1),
+    FLIGHT_RECORD_SIGNAL(qp_return_value, int32, 1),
+    FLIGHT_RECORD_SIGNAL(qp_iterations, int32, 1),
+    FLIGHT_RECORD_SIGNAL(leg_state, uint8, NUM_LEGS),
+    FLIGHT_RECORD_SIGNAL(balance_solver, uint8, 1),
+    FLIGHT_RECORD_SIGNAL(balance_solved, uint8, 1),
+    FLIGHT_RECORD_SIGNAL(degradation_mode, uint8, 1),
+  };
+
+#undef FLIGHT_RECORD_SIGNAL
+  return signals;
+}
+
+/////////////////////////////////////////////////////////
+
+TelemetryWriter::TelemetryWriter()
+  : fd_(-1)
+  , row_size_(0)
+  , chunk_size_(0)
+  , chunk_(0)
+  , have_chunk_(false)
+  , appended_(0)
+  , dropped_(0)
+  , running_(false)
+{
+  std::memset(&header_, 0, sizeof(TelemetryFileHeader));
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+  close();
+}
+
+bool TelemetryWriter::open(const std::string& path,
+                           const std::vector<TelemetrySignal>& signals,
+                           std::size_t row_size, double frequency,
+                           const TelemetrySettings& settings)
+{
+  close();
+
+  if (signals.empty() || settings.chunk_rows == 0 || settings.chunks < 2 ||
+      settings.chunks > MAX_TELEMETRY_CHUNKS)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Telemetry needs signals, rows per chunk, and 2 to %zu "
+                             "chunks",
+                    MAX_TELEMETRY_CHUNKS);
+    return false;
+  }
+
+  signals_ = signals;
+  value_sizes_.clear();
+  columns_.clear();
+  chunk_size_ = 0;
+  std::size_t scratch_size = signals_.size() * sizeof(uint64_t);
+  for (const auto& signal : signals_)
+  {
+    const std::size_t value_size =
+        signal.width * telemetry_type_size(static_cast<TelemetryType>(signal.type));
+    if (value_size == 0 || signal.offset + value_size > row_size ||
+        signal.name[sizeof(signal.name) - 1] != '\0')
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Telemetry signal %.*s does not fit the rows",
+                      static_cast<int>(sizeof(signal.name)), signal.name);
+      return false;
+    }
+
+    value_sizes_.push_back(value_size);
+    columns_.push_back(chunk_size_);
+    chunk_size_ += pad8(value_size * settings.chunk_rows);
+    scratch_size += pad8(compress_bound(value_size * settings.chunk_rows));
+  }
+
+  settings_ = settings;
+#ifndef QUADRUPED_LZ4
+  if (settings_.compress)
+  {
+    ROS_WARN_NAMED(LOGNAME, "Built without LZ4, writing uncompressed telemetry");
+    settings_.compress = false;
+  }
+#endif
+
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to create telemetry log %s: %s", path.c_str(),
+                    std::strerror(errno));
+    return false;
+  }
+
+  std::memset(&header_, 0, sizeof(TelemetryFileHeader));
+  std::memcpy(header_.magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+  header_.version = TELEMETRY_VERSION;
+  header_.num_signals = static_cast<uint32_t>(signals_.size());
+  header_.chunk_rows = settings_.chunk_rows;
+  header_.compressed = settings_.compress;
+  header_.frequency = frequency;
+  if (!write_all(fd_, &header_, sizeof(TelemetryFileHeader)) ||
+      !write_all(fd_, signals_.data(), signals_.size() * sizeof(TelemetrySignal)))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to write telemetry log %s: %s", path.c_str(),
+                    std::strerror(errno));
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  // All memory of the appending thread is allocated here
+  row_size_ = row_size;
+  buffers_ = std::make_unique<unsigned char[]>(settings_.chunks * chunk_size_);
+  rows_.assign(settings_.chunks, 0);
+  scratch_.resize(scratch_size);
+  for (uint32_t i = 0; i < settings_.chunks; i++)
+  {
+    free_.push(i);
+  }
+
+  have_chunk_ = false;
+  appended_ = 0;
+  dropped_ = 0;
+  running_ = true;
+  writer_ = std::thread(&TelemetryWriter::writerThread, this);
+
+  ROS_INFO_NAMED(LOGNAME, "Writing telemetry to %s", path.c_str());
+  return true;
+}
+
+bool TelemetryWriter::append(const void* row)
+{
+  if (fd_ < 0)
+  {
+    return false;
+  }
+
+  if (!have_chunk_)
+  {
+    if (!free_.pop(chunk_))
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    rows_[chunk_] = 0;
+    have_chunk_ = true;
+  }
+
+  // Scatter the row into the columns
+  unsigned char* chunk = buffers_.get() + chunk_ * chunk_size_;
+  const uint32_t index = rows_[chunk_];
+  for (std::size_t i = 0; i < signals_.size(); i++)
+  {
+    std::memcpy(chunk + columns_[i] + index * value_sizes_[i],
+                static_cast<const unsigned char*>(row) + signals_[i].offset,
+                value_sizes_[i]);
+  }
+
+  rows_[chunk_] = index + 1;
+  appended_++;
+
+  if (rows_[chunk_] == settings_.chunk_rows)
+  {
+    submit();
+  }
+
+  return true;
+}
+
+void TelemetryWriter::close()
+{
+  if (fd_ < 0)
+  {
+    return;
+  }
+
+  if (have_chunk_ && rows_[chunk_] > 0)
+  {
+    submit();
+  }
+
+  // The writer thread writes the remaining chunks before it stops
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_one();
+  writer_.join();
+
+  // Counts are only known once all chunks are written
+  if (::pwrite(fd_, &header_, sizeof(TelemetryFileHeader), 0) !=
+      static_cast<ssize_t>(sizeof(TelemetryFileHeader)))
+  {
+    ROS_WARN_NAMED(LOGNAME, "Failed to update the telemetry header: %s",
+                   std::strerror(errno));
+  }
+
+  ROS_INFO_NAMED(LOGNAME, "Wrote %lu telemetry rows in %lu chunks, dropped %lu",
+                 static_cast<unsigned long>(header_.num_rows),
+                 static_cast<unsigned long>(header_.num_chunks),
+                 static_cast<unsigned long>(dropped_.load()));
+
+  ::close(fd_);
+  fd_ = -1;
+
+  uint32_t chunk;
+  while (free_.pop(chunk))
+  {
+  }
+  have_chunk_ = false;
+}
+
+bool TelemetryWriter::isOpen() const
+{
+  return fd_ >= 0;
+}
+
+uint64_t TelemetryWriter::size() const
+{
+  return appended_;
+}
+
+uint64_t TelemetryWriter::dropped() const
+{
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void TelemetryWriter::submit()
+{
+  // Never full, there are at most MAX_TELEMETRY_CHUNKS chunks
+  full_.push(chunk_);
+  have_chunk_ = false;
+}
+
+void TelemetryWriter::writerThread()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool running = true;
+  while (running)
+  {
+    // The appending thread does not notify, full chunks are polled
+    cv_.wait_for(lock, TELEMETRY_POLL_PERIOD, [this] { return !running_; });
+    running = running_;
+    lock.unlock();
+
+    uint32_t chunk;
+    while (full_.pop(chunk))
+    {
+      if (!writeChunk(chunk))
+      {
+        ROS_ERROR_NAMED(LOGNAME, "Failed to write telemetry chunk: %s",
+                        std::strerror(errno));
+      }
+      free_.push(chunk);
+    }
+
+    lock.lock();
+  }
+}
+
+bool TelemetryWriter::writeChunk(uint32_t chunk)
+{
+  const unsigned char* buffer = buffers_.get() + chunk * chunk_size_;
+  const uint32_t rows = rows_[chunk];
+
+  // Column sizes followed by the columns
+  auto column_sizes = reinterpret_cast<uint64_t*>(scratch_.data());
+  std::size_t size = signals_.size() * sizeof(uint64_t);
+  for (std::size_t i = 0; i < signals_.size(); i++)
+  {
+    const unsigned char* column = buffer + columns_[i];
+    const std::size_t column_size = rows * value_sizes_[i];
+    unsigned char* output = scratch_.data() + size;
+
+    std::size_t stored_size = column_size;
+#ifdef QUADRUPED_LZ4
+    if (settings_.compress && column_size > 0)
+    {
+      const int compressed_size = LZ4_compress_default(
+          reinterpret_cast<const char*>(column), reinterpret_cast<char*>(output),
+          static_cast<int>(column_size), static_cast<int>(compress_bound(column_size)));
+
+      // Columns that do not shrink are stored as they are
+      if (compressed_size > 0 && static_cast<std::size_t>(compressed_size) < column_size)
+      {
+        stored_size = compressed_size;
+      }
+    }
+#endif
+
+    if (stored_size == column_size)
+    {
+      std::memcpy(output, column, column_size);
+    }
+
+    std::memset(output + stored_size, 0, pad8(stored_size) - stored_size);
+    column_sizes[i] = stored_size;
+    size += pad8(stored_size);
+  }
+
+  TelemetryChunkHeader chunk_header;
+  std::memcpy(chunk_header.magic, TELEMETRY_CHUNK_MAGIC, sizeof(TELEMETRY_CHUNK_MAGIC));
+  chunk_header.rows = rows;
+  chunk_header.payload_size = size;
+  if (!write_all(fd_, &chunk_header, sizeof(TelemetryChunkHeader)) ||
+      !write_all(fd_, scratch_.data(), size))
+  {
+    return false;
+  }
+
+  header_.num_chunks++;
+  header_.num_rows += rows;
+  return true;
+}
+
+/////////////////////////////////////////////////////////
+
+TelemetryReader::TelemetryReader()
+  : fd_(-1)
+  , map_(nullptr)
+  , map_size_(0)
+  , header_(nullptr)
+  , signals_(nullptr)
+  , num_rows_(0)
+{
+}
+
+TelemetryReader::~TelemetryReader()
+{
+  close();
+}
+
+bool TelemetryReader::open(const std::string& path)
+{
+  close();
+
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to open telemetry log %s: %s", path.c_str(),
+                    std::strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(fd_, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(TelemetryFileHeader))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Telemetry log %s is too small", path.c_str());
+    close();
+    return false;
+  }
+
+  map_size_ = st.st_size;
+  void* map = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (map == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to map telemetry log: %s", std::strerror(errno));
+    map_size_ = 0;
+    close();
+    return false;
+  }
+
+  map_ = static_cast<const unsigned char*>(map);
+  header_ = reinterpret_cast<const TelemetryFileHeader*>(map_);
+
+  const std::size_t schema_end =
+      sizeof(TelemetryFileHeader) + header_->num_signals * sizeof(TelemetrySignal);
+  if (std::memcmp(header_->magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC)) != 0 ||
+      header_->version != TELEMETRY_VERSION || header_->num_signals == 0 ||
+      schema_end > map_size_)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "%s is not a version %u telemetry log", path.c_str(),
+                    TELEMETRY_VERSION);
+    close();
+    return false;
+  }
+
+  signals_ = reinterpret_cast<const TelemetrySignal*>(map_ + sizeof(TelemetryFileHeader));
+  const std::size_t num_signals = header_->num_signals;
+  for (std::size_t i = 0; i < num_signals; i++)
+  {
+    if (telemetry_type_size(static_cast<TelemetryType>(signals_[i].type)) == 0)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Telemetry signal %zu has an unknown type", i);
+      close();
+      return false;
+    }
+  }
+
+  // Index the chunks, a log from a killed process ends with a partial chunk
+  std::size_t position = schema_end;
+  while (position + sizeof(TelemetryChunkHeader) <= map_size_)
+  {
+    const auto chunk_header =
+        reinterpret_cast<const TelemetryChunkHeader*>(map_ + position);
+    const std::size_t payload = position + sizeof(TelemetryChunkHeader);
+    const std::size_t end = payload + chunk_header->payload_size;
+    if (std::memcmp(chunk_header->magic, TELEMETRY_CHUNK_MAGIC,
+                    sizeof(TELEMETRY_CHUNK_MAGIC)) != 0 ||
+        chunk_header->payload_size < num_signals * sizeof(uint64_t) || end > map_size_ ||
+        end < payload)
+    {
+      break;
+    }
+
+    Chunk chunk;
+    chunk.rows = chunk_header->rows;
+    chunk.column_sizes = reinterpret_cast<const uint64_t*>(map_ + payload);
+    chunk.offsets.resize(num_signals);
+
+    bool valid = true;
+    std::size_t offset = payload + num_signals * sizeof(uint64_t);
+    for (std::size_t i = 0; valid && i < num_signals; i++)
+    {
+      const std::size_t column_size =
+          static_cast<std::size_t>(chunk.rows) * signals_[i].width *
+          telemetry_type_size(static_cast<TelemetryType>(signals_[i].type));
+      chunk.offsets[i] = offset;
+      offset += pad8(chunk.column_sizes[i]);
+      valid = chunk.column_sizes[i] <= column_size && offset <= end;
+    }
+
+    if (!valid)
+    {
+      break;
+    }
+
+    num_rows_ += chunk.rows;
+    chunks_.push_back(std::move(chunk));
+    position = end;
+  }
+
+  if (position != map_size_)
+  {
+    ROS_WARN_NAMED(LOGNAME, "Telemetry log %s ends with a partial chunk, read %zu chunks",
+                   path.c_str(), chunks_.size());
+  }
+
+  decompressed_.resize(chunks_.size() * num_signals);
+  return true;
+}
+
+void TelemetryReader::close()
+{
+  if (map_)
+  {
+    ::munmap(const_cast<unsigned char*>(map_), map_size_);
+  }
+
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+
+  fd_ = -1;
+  map_ = nullptr;
+  map_size_ = 0;
+  header_ = nullptr;
+  signals_ = nullptr;
+  chunks_.clear();
+  num_rows_ = 0;
+  decompressed_.clear();
+}
+
+const TelemetryFileHeader& TelemetryReader::header() const
+{
+  return *header_;
+}
+
+std::span<const TelemetrySignal> TelemetryReader::signals() const
+{
+  return { signals_, header_ ? header_->num_signals : 0u };
+}
+
+int TelemetryReader::find(const std::string& name) const
+{
+  for (const auto& signal : signals())
+  {
+    if (name == signal.name)
+    {
+      return static_cast<int>(&signal - signals_);
+    }
+  }
+
+  return -1;
+}
+
+std::size_t TelemetryReader::numChunks() const
+{
+  return chunks_.size();
+}
+
+uint32_t TelemetryReader::chunkRows(std::size_t chunk) const
+{
+  return chunks_[chunk].rows;
+}
+
+uint64_t TelemetryReader::size() const
+{
+  return num_rows_;
+}
+
+std::span<const unsigned char> TelemetryReader::columnBytes(std::size_t chunk,
+                                                            std::size_t signal) const
+{
+  const Chunk& index = chunks_[chunk];
+  const std::size_t column_size =
+      static_cast<std::size_t>(index.rows) * signals_[signal].width *
+      telemetry_type_size(static_cast<TelemetryType>(signals_[signal].type));
+  const std::size_t stored_size = index.column_sizes[signal];
+  if (stored_size == column_size)
+  {
+    return { map_ + index.offsets[signal], column_size };
+  }
+
+  auto& column = decompressed_[chunk * header_->num_signals + signal];
+  if (!column)
+  {
+#ifdef QUADRUPED_LZ4
+    auto buffer = std::make_unique<unsigned char[]>(column_size);
+    const int size = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(map_ + index.offsets[signal]),
+        reinterpret_cast<char*>(buffer.get()), static_cast<int>(stored_size),
+        static_cast<int>(column_size));
+    if (size < 0 || static_cast<std::size_t>(size) != column_size)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Failed to decompress column %s of chunk %zu",
+                      signals_[signal].name, chunk);
+      return {};
+    }
+
+    column = std::move(buffer);
+#else
+    ROS_ERROR_NAMED(LOGNAME, "Built without LZ4, cannot read compressed column %s",
+                    signals_[signal].name);
+    return {};
+#endif
+  }
+
+  return { column.get(), column_size };
+}
+}  // namespace io
+}  // namespace quadruped_controller
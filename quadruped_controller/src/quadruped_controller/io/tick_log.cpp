@@ -0,0 +1,635 @@
+/**
+ * @file tick_log.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Binary record and replay of control pipeline ticks
+ */
+
+// C++
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// Linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ROS
+#include <ros/console.h>
+
+// Quadruped Control
+#include <quadruped_controller/io/tick_log.hpp>
+
+namespace quadruped_controller
+{
+namespace io
+{
+static const std::string LOGNAME = "tick_log";
+
+static const char TICK_LOG_MAGIC[8] = { 'Q', 'P', 'T', 'I', 'C', 'K', 'S', '\0' };
+
+const std::array<std::string, NUM_LEGS>& tick_log_leg_names()
+{
+  static const std::array<std::string, NUM_LEGS> leg_names = { "RL", "FL", "RR", "FR" };
+  return leg_names;
+}
+
+/** @brief Copy an armadillo object into a fixed array, checking the size */
+template <std::size_t N>
+static void copy_to(const mat& m, double (&dst)[N], const char* name)
+{
+  if (m.n_elem != N)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Parameter %s has %llu elements, expected %zu", name,
+                    static_cast<unsigned long long>(m.n_elem), N);
+    std::fill(dst, dst + N, 0.0);
+    return;
+  }
+
+  std::copy(m.memptr(), m.memptr() + N, dst);
+}
+
+TickLogConfig pack_config(const ControlPipelineConfig& config)
+{
+  TickLogConfig log_config;
+  log_config.t_stance = config.t_stance;
+  log_config.t_swing = config.t_swing;
+  log_config.height = config.height;
+  log_config.mu = config.mu;
+  log_config.mass = config.mass;
+  log_config.fzmin = config.fzmin;
+  log_config.fzmax = config.fzmax;
+  copy_to(config.Ib, log_config.Ib, "Ib");
+  copy_to(config.S, log_config.S, "S");
+  copy_to(config.W, log_config.W, "W");
+  copy_to(config.kff, log_config.kff, "kff");
+  copy_to(config.kp_p, log_config.kp_p, "kp_p");
+  copy_to(config.kd_p, log_config.kd_p, "kd_p");
+  copy_to(config.kp_w, log_config.kp_w, "kp_w");
+  copy_to(config.kd_w, log_config.kd_w, "kd_w");
+  copy_to(config.jc_kff, log_config.jc_kff, "jc_kff");
+  copy_to(config.jc_kp, log_config.jc_kp, "jc_kp");
+  copy_to(config.jc_kd, log_config.jc_kd, "jc_kd");
+  log_config.tau_min = config.tau_min;
+  log_config.tau_max = config.tau_max;
+  copy_to(config.x_stand, log_config.x_stand, "x_stand");
+  log_config.dt = config.dt;
+  log_config.torque_limited_qp = config.torque_limited_qp ? 1 : 0;
+  log_config.qp_backend = config.qp_backend;
+  log_config.admm_rho = config.admm.rho;
+  log_config.admm_eps_abs = config.admm.eps_abs;
+  log_config.admm_eps_rel = config.admm.eps_rel;
+  log_config.admm_max_iterations = config.admm.max_iterations;
+  log_config.admm_warm_start = config.admm.warm_start ? 1 : 0;
+  log_config.admm_polish = config.admm.polish ? 1 : 0;
+  log_config.solve_rate_enabled = config.solve_rate.enabled ? 1 : 0;
+  log_config.solve_rate_foot_tolerance = config.solve_rate.foot_tolerance;
+  log_config.solve_rate_rotation_tolerance = config.solve_rate.rotation_tolerance;
+  log_config.solve_rate_force_tolerance = config.solve_rate.force_tolerance;
+  log_config.solve_rate_moment_tolerance = config.solve_rate.moment_tolerance;
+  log_config.solve_rate_max_updates = config.solve_rate.max_updates;
+
+  const NonlinearMPCConfig& mpc = config.nonlinear_mpc;
+  log_config.use_nonlinear_mpc = config.use_nonlinear_mpc ? 1 : 0;
+  log_config.mpc_horizon = mpc.horizon;
+  log_config.mpc_dt = mpc.dt;
+  log_config.mpc_period = mpc.period;
+  copy_to(mpc.q, log_config.mpc_q, "nonlinear_mpc.q");
+  log_config.mpc_r = mpc.r;
+  log_config.mpc_terminal_scale = mpc.terminal_scale;
+  log_config.mpc_max_iterations = mpc.max_iterations;
+  log_config.mpc_max_outer_iterations = mpc.max_outer_iterations;
+  log_config.mpc_cost_tolerance = mpc.cost_tolerance;
+  log_config.mpc_constraint_tolerance = mpc.constraint_tolerance;
+  log_config.mpc_penalty = mpc.penalty;
+  log_config.mpc_penalty_scale = mpc.penalty_scale;
+  log_config.mpc_max_penalty = mpc.max_penalty;
+  log_config.mpc_regularization = mpc.regularization;
+  log_config.mpc_threads = mpc.threads;
+
+  const LQRBalanceConfig& lqr = config.lqr_stance;
+  log_config.use_lqr_stance = config.use_lqr_stance ? 1 : 0;
+  log_config.lqr_height_min = lqr.height_min;
+  log_config.lqr_height_max = lqr.height_max;
+  log_config.lqr_height_samples = lqr.height_samples;
+  log_config.lqr_angle_max = lqr.angle_max;
+  log_config.lqr_angle_samples = lqr.angle_samples;
+  copy_to(lqr.q, log_config.lqr_q, "lqr_stance.q");
+  log_config.lqr_r = lqr.r;
+  log_config.lqr_dt = lqr.dt;
+
+  std::memset(log_config.explicit_qp_path, 0, sizeof(log_config.explicit_qp_path));
+  log_config.explicit_qp_fingerprint = 0;
+  if (config.explicit_qp)
+  {
+    const std::string& path = config.explicit_qp->path();
+    if (path.size() >= sizeof(log_config.explicit_qp_path))
+    {
+      ROS_WARN_NAMED(LOGNAME, "Explicit QP path %s is too long for the tick log, pass "
+                     "it to the replay",
+                     path.c_str());
+    }
+    path.copy(log_config.explicit_qp_path, sizeof(log_config.explicit_qp_path) - 1);
+    log_config.explicit_qp_fingerprint = config.explicit_qp->fingerprint();
+  }
+
+  return log_config;
+}
+
+ControlPipelineConfig unpack_config(const TickLogConfig& log_config)
+{
+  ControlPipelineConfig config;
+  config.t_stance = log_config.t_stance;
+  config.t_swing = log_config.t_swing;
+  config.height = log_config.height;
+  config.mu = log_config.mu;
+  config.mass = log_config.mass;
+  config.fzmin = log_config.fzmin;
+  config.fzmax = log_config.fzmax;
+  config.Ib = mat(log_config.Ib, 3, 3);
+  config.S = mat(log_config.S, 6, 6);
+  config.W = mat(log_config.W, 12, 12);
+  config.kff = vec(log_config.kff, 6);
+  config.kp_p = vec(log_config.kp_p, 3);
+  config.kd_p = vec(log_config.kd_p, 3);
+  config.kp_w = vec(log_config.kp_w, 3);
+  config.kd_w = vec(log_config.kd_w, 3);
+  config.jc_kff = vec3(log_config.jc_kff);
+  config.jc_kp = vec3(log_config.jc_kp);
+  config.jc_kd = vec3(log_config.jc_kd);
+  config.tau_min = log_config.tau_min;
+  config.tau_max = log_config.tau_max;
+  config.x_stand = vec3(log_config.x_stand);
+  config.dt = log_config.dt;
+  config.torque_limited_qp = log_config.torque_limited_qp != 0;
+  config.qp_backend = static_cast<QpBackendType>(log_config.qp_backend);
+  config.admm.rho = log_config.admm_rho;
+  config.admm.eps_abs = log_config.admm_eps_abs;
+  config.admm.eps_rel = log_config.admm_eps_rel;
+  config.admm.max_iterations = log_config.admm_max_iterations;
+  config.admm.warm_start = log_config.admm_warm_start != 0;
+  config.admm.polish = log_config.admm_polish != 0;
+  config.solve_rate.enabled = log_config.solve_rate_enabled != 0;
+  config.solve_rate.foot_tolerance = log_config.solve_rate_foot_tolerance;
+  config.solve_rate.rotation_tolerance = log_config.solve_rate_rotation_tolerance;
+  config.solve_rate.force_tolerance = log_config.solve_rate_force_tolerance;
+  config.solve_rate.moment_tolerance = log_config.solve_rate_moment_tolerance;
+  config.solve_rate.max_updates = log_config.solve_rate_max_updates;
+
+  NonlinearMPCConfig& mpc = config.nonlinear_mpc;
+  config.use_nonlinear_mpc = log_config.use_nonlinear_mpc != 0;
+  mpc.horizon = log_config.mpc_horizon;
+  mpc.dt = log_config.mpc_dt;
+  mpc.period = log_config.mpc_period;
+  mpc.q = vec12(log_config.mpc_q);
+  mpc.r = log_config.mpc_r;
+  mpc.terminal_scale = log_config.mpc_terminal_scale;
+  mpc.max_iterations = log_config.mpc_max_iterations;
+  mpc.max_outer_iterations = log_config.mpc_max_outer_iterations;
+  mpc.cost_tolerance = log_config.mpc_cost_tolerance;
+  mpc.constraint_tolerance = log_config.mpc_constraint_tolerance;
+  mpc.penalty = log_config.mpc_penalty;
+  mpc.penalty_scale = log_config.mpc_penalty_scale;
+  mpc.max_penalty = log_config.mpc_max_penalty;
+  mpc.regularization = log_config.mpc_regularization;
+  mpc.threads = log_config.mpc_threads;
+
+  LQRBalanceConfig& lqr = config.lqr_stance;
+  config.use_lqr_stance = log_config.use_lqr_stance != 0;
+  lqr.height_min = log_config.lqr_height_min;
+  lqr.height_max = log_config.lqr_height_max;
+  lqr.height_samples = log_config.lqr_height_samples;
+  lqr.angle_max = log_config.lqr_angle_max;
+  lqr.angle_samples = log_config.lqr_angle_samples;
+  lqr.q = vec12(log_config.lqr_q);
+  lqr.r = log_config.lqr_r;
+  lqr.dt = log_config.lqr_dt;
+  config.leg_names.assign(tick_log_leg_names().begin(), tick_log_leg_names().end());
+
+  return config;
+}
+
+TickLogGains pack_gains(const ControlGains& gains)
+{
+  TickLogGains log_gains;
+  copy_to(gains.S, log_gains.S, "S");
+  copy_to(gains.W, log_gains.W, "W");
+  copy_to(gains.kff, log_gains.kff, "kff");
+  copy_to(gains.kp_p, log_gains.kp_p, "kp_p");
+  copy_to(gains.kd_p, log_gains.kd_p, "kd_p");
+  copy_to(gains.kp_w, log_gains.kp_w, "kp_w");
+  copy_to(gains.kd_w, log_gains.kd_w, "kd_w");
+  copy_to(gains.jc_kff, log_gains.jc_kff, "jc_kff");
+  copy_to(gains.jc_kp, log_gains.jc_kp, "jc_kp");
+  copy_to(gains.jc_kd, log_gains.jc_kd, "jc_kd");
+
+  return log_gains;
+}
+
+ControlGains unpack_gains(const TickLogGains& log_gains)
+{
+  ControlGains gains;
+  gains.S = mat(log_gains.S, 6, 6);
+  gains.W = mat(log_gains.W, 12, 12);
+  gains.kff = vec(log_gains.kff, 6);
+  gains.kp_p = vec(log_gains.kp_p, 3);
+  gains.kd_p = vec(log_gains.kd_p, 3);
+  gains.kp_w = vec(log_gains.kp_w, 3);
+  gains.kd_w = vec(log_gains.kd_w, 3);
+  gains.jc_kff = vec3(log_gains.jc_kff);
+  gains.jc_kp = vec3(log_gains.jc_kp);
+  gains.jc_kd = vec3(log_gains.jc_kd);
+
+  return gains;
+}
+
+TickRecord pack_inputs(double stamp, const RobotStateCoM& com_state,
+                       const JointStatesMap& joint_states_map, const vec& Vb,
+                       bool cmd_received, const GaitMap& gait_map, bool gait_running)
+{
+  TickRecord record;
+  std::memset(&record, 0, sizeof(TickRecord));
+
+  record.stamp = stamp;
+  std::copy(com_state.x.begin(), com_state.x.end(), record.x);
+  std::copy(com_state.xdot.begin(), com_state.xdot.end(), record.xdot);
+  std::copy(com_state.w.begin(), com_state.w.end(), record.w);
+  std::copy(com_state.Rwb.begin(), com_state.Rwb.end(), record.Rwb);
+  std::copy(Vb.begin(), Vb.begin() + 6, record.Vb);
+
+  for (unsigned int i = 0; i < NUM_LEGS; i++)
+  {
+    const std::string& leg_name = tick_log_leg_names().at(i);
+
+    const LegJointStates& joint_states = joint_states_map.at(leg_name);
+    std::copy(joint_states.q.begin(), joint_states.q.end(), record.q + 3 * i);
+    std::copy(joint_states.qdot.begin(), joint_states.qdot.end(), record.qdot + 3 * i);
+
+    const auto& leg_state = gait_map.at(leg_name);
+    record.leg_state[i] = static_cast<uint8_t>(leg_state.first);
+    record.phase[i] = leg_state.second;
+  }
+
+  record.cmd_received = cmd_received;
+  record.gait_running = gait_running;
+
+  return record;
+}
+
+void pack_torques(const TorqueMap& torque_map, TickRecord& record)
+{
+  for (unsigned int i = 0; i < NUM_LEGS; i++)
+  {
+    // Stance legs have no torques when the balance QP fails
+    const auto torque = torque_map.find(tick_log_leg_names().at(i));
+    if (torque != torque_map.end())
+    {
+      std::copy(torque->second.begin(), torque->second.end(), record.torque + 3 * i);
+    }
+    else
+    {
+      std::fill(record.torque + 3 * i, record.torque + 3 * i + 3, 0.0);
+    }
+  }
+}
+
+RobotStateCoM unpack_com_state(const TickRecord& record)
+{
+  RobotStateCoM com_state;
+  com_state.x = vec3(record.x);
+  com_state.xdot = vec3(record.xdot);
+  com_state.w = vec3(record.w);
+  com_state.Rwb = mat33(record.Rwb);
+
+  return com_state;
+}
+
+void unpack_joint_states(const TickRecord& record, JointStatesMap& joint_states_map)
+{
+  for (unsigned int i = 0; i < NUM_LEGS; i++)
+  {
+    LegJointStates& joint_states = joint_states_map[tick_log_leg_names().at(i)];
+    joint_states.q = vec3(record.q + 3 * i);
+    joint_states.qdot = vec3(record.qdot + 3 * i);
+  }
+}
+
+GaitMap unpack_gait(const TickRecord& record)
+{
+  GaitMap gait_map;
+  for (unsigned int i = 0; i < NUM_LEGS; i++)
+  {
+    gait_map.emplace(tick_log_leg_names().at(i),
+                     std::make_pair(static_cast<LegState>(record.leg_state[i]),
+                                    record.phase[i]));
+  }
+
+  return gait_map;
+}
+
+vec unpack_cmd(const TickRecord& record)
+{
+  return vec(record.Vb, 6);
+}
+
+TorqueMap unpack_torques(const TickRecord& record)
+{
+  TorqueMap torque_map;
+  for (unsigned int i = 0; i < NUM_LEGS; i++)
+  {
+    torque_map.emplace(tick_log_leg_names().at(i), vec3(record.torque + 3 * i));
+  }
+
+  return torque_map;
+}
+
+/////////////////////////////////////////////////////////
+
+TickLogWriter::TickLogWriter(std::size_t chunk_records)
+  : chunk_records_(std::max<std::size_t>(chunk_records, 1))
+  , capacity_(0)
+  , fd_(-1)
+  , map_(nullptr)
+  , map_size_(0)
+{
+}
+
+TickLogWriter::~TickLogWriter()
+{
+  close();
+}
+
+bool TickLogWriter::open(const std::string& path, const ControlPipelineConfig& config,
+                         double frequency)
+{
+  close();
+
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to create tick log %s: %s", path.c_str(),
+                    std::strerror(errno));
+    return false;
+  }
+
+  if (!reserve(chunk_records_))
+  {
+    close();
+    return false;
+  }
+
+  TickLogHeader header;
+  std::memset(&header, 0, sizeof(TickLogHeader));
+  std::memcpy(header.magic, TICK_LOG_MAGIC, sizeof(TICK_LOG_MAGIC));
+  header.version = TICK_LOG_VERSION;
+  header.record_size = sizeof(TickRecord);
+  header.num_records = 0;
+  header.frequency = frequency;
+  header.config = pack_config(config);
+  std::memcpy(map_, &header, sizeof(TickLogHeader));
+
+  ROS_INFO_NAMED(LOGNAME, "Recording ticks to %s", path.c_str());
+  return true;
+}
+
+bool TickLogWriter::append(const TickRecord& record)
+{
+  if (!map_)
+  {
+    return false;
+  }
+
+  auto header = static_cast<TickLogHeader*>(map_);
+  const uint64_t num_records = header->num_records;
+
+  if (num_records == capacity_)
+  {
+    if (!reserve(capacity_ + chunk_records_))
+    {
+      return false;
+    }
+
+    header = static_cast<TickLogHeader*>(map_);
+  }
+
+  auto records = reinterpret_cast<TickRecord*>(static_cast<char*>(map_) +
+                                                sizeof(TickLogHeader));
+  std::memcpy(records + num_records, &record, sizeof(TickRecord));
+  records[num_records].gain_updates = static_cast<uint32_t>(header->num_gain_updates);
+  header->num_records = num_records + 1;
+
+  return true;
+}
+
+bool TickLogWriter::appendGains(const ControlGains& gains)
+{
+  if (!map_)
+  {
+    return false;
+  }
+
+  auto header = static_cast<TickLogHeader*>(map_);
+  const uint64_t num_gain_updates = header->num_gain_updates;
+  header->num_gain_updates = num_gain_updates + 1;
+
+  if (num_gain_updates >= TICK_LOG_MAX_GAIN_UPDATES)
+  {
+    if (num_gain_updates == TICK_LOG_MAX_GAIN_UPDATES)
+    {
+      ROS_WARN_NAMED(LOGNAME, "Tick log holds %u gain updates, the ticks after this "
+                     "update can't be replayed",
+                     TICK_LOG_MAX_GAIN_UPDATES);
+    }
+    return false;
+  }
+
+  header->gain_updates[num_gain_updates] = pack_gains(gains);
+  return true;
+}
+
+void TickLogWriter::close()
+{
+  if (map_)
+  {
+    const auto num_records = static_cast<const TickLogHeader*>(map_)->num_records;
+    ::munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+
+    // Drop the unused tail of the last chunk
+    if (::ftruncate(fd_, sizeof(TickLogHeader) + num_records * sizeof(TickRecord)) != 0)
+    {
+      ROS_WARN_NAMED(LOGNAME, "Failed to truncate tick log: %s", std::strerror(errno));
+    }
+  }
+
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  capacity_ = 0;
+}
+
+bool TickLogWriter::isOpen() const
+{
+  return map_ != nullptr;
+}
+
+uint64_t TickLogWriter::size() const
+{
+  return map_ ? static_cast<const TickLogHeader*>(map_)->num_records : 0;
+}
+
+uint64_t TickLogWriter::gainUpdates() const
+{
+  return map_ ? static_cast<const TickLogHeader*>(map_)->num_gain_updates : 0;
+}
+
+bool TickLogWriter::reserve(std::size_t capacity)
+{
+  const std::size_t size = sizeof(TickLogHeader) + capacity * sizeof(TickRecord);
+
+  if (::ftruncate(fd_, size) != 0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to grow tick log: %s", std::strerror(errno));
+    return false;
+  }
+
+  void* map = nullptr;
+  if (map_)
+  {
+    map = ::mremap(map_, map_size_, size, MREMAP_MAYMOVE);
+  }
+  else
+  {
+    map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  }
+
+  if (map == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to map tick log: %s", std::strerror(errno));
+    return false;
+  }
+
+  map_ = map;
+  map_size_ = size;
+  capacity_ = capacity;
+
+  return true;
+}
+
+/////////////////////////////////////////////////////////
+
+TickLogReader::TickLogReader()
+  : fd_(-1)
+  , map_(nullptr)
+  , map_size_(0)
+  , header_(nullptr)
+  , records_(nullptr)
+  , num_records_(0)
+{
+}
+
+TickLogReader::~TickLogReader()
+{
+  close();
+}
+
+bool TickLogReader::open(const std::string& path)
+{
+  close();
+
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to open tick log %s: %s", path.c_str(),
+                    std::strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(fd_, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(TickLogHeader))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Tick log %s is too small", path.c_str());
+    close();
+    return false;
+  }
+
+  map_size_ = st.st_size;
+  void* map = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (map == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Failed to map tick log: %s", std::strerror(errno));
+    map_size_ = 0;
+    close();
+    return false;
+  }
+
+  map_ = map;
+  header_ = static_cast<const TickLogHeader*>(map_);
+
+  if (std::memcmp(header_->magic, TICK_LOG_MAGIC, sizeof(TICK_LOG_MAGIC)) != 0 ||
+      header_->version != TICK_LOG_VERSION || header_->record_size != sizeof(TickRecord))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "%s is not a version %u tick log", path.c_str(),
+                    TICK_LOG_VERSION);
+    close();
+    return false;
+  }
+
+  records_ = reinterpret_cast<const TickRecord*>(static_cast<const char*>(map_) +
+                                                 sizeof(TickLogHeader));
+
+  // A log from a killed process may be longer than its record count
+  const uint64_t available = (map_size_ - sizeof(TickLogHeader)) / sizeof(TickRecord);
+  num_records_ = std::min(header_->num_records, available);
+
+  return true;
+}
+
+void TickLogReader::close()
+{
+  if (map_)
+  {
+    ::munmap(const_cast<void*>(map_), map_size_);
+  }
+
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+
+  fd_ = -1;
+  map_ = nullptr;
+  map_size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+  num_records_ = 0;
+}
+
+const TickLogHeader& TickLogReader::header() const
+{
+  return *header_;
+}
+
+uint64_t TickLogReader::size() const
+{
+  return num_records_;
+}
+
+const TickRecord& TickLogReader::record(uint64_t i) const
+{
+  return records_[i];
+}
+
+const TickLogGains& TickLogReader::gainUpdate(uint64_t i) const
+{
+  return header_->gain_updates[i];
+}
+}  // namespace io
+}  // namespace quadruped_controller
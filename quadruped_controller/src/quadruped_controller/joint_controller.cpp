@@ -18,6 +18,13 @@ JointController::JointController(const vec3& kff, const vec3& kp, const vec3& kd
 {
 }
 
+void JointController::setGains(const vec3& kff, const vec3& kp, const vec3& kd)
+{
+  kff_ = kff;
+  kp_ = kp;
+  kd_ = kd;
+}
+
 TorqueMap JointController::control(const JointStatesMap& joints_ref_map,
                                    const JointStatesMap& joints_map) const
 {
@@ -230,4 +230,19 @@ QuadrupedKinematics::jacobianTransposeControl(const JointStatesMap& joint_states
   return torque_map;
 }
 
+const vec3& QuadrupedKinematics::hipTranslation(const std::string& leg_name) const
+{
+  return link_map_.at(leg_name).first;
+}
+
+const vec3& QuadrupedKinematics::legLinks(const std::string& leg_name) const
+{
+  return link_map_.at(leg_name).second;
+}
+
+vec3 world_to_body(const mat33& Rwb, const vec3& x, const vec3& p)
+{
+  return Rwb.t() * (p - x);
+}
+
 }  // namespace quadruped_controller
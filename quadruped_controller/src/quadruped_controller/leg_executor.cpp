@@ -0,0 +1,267 @@
+/**
+ * @file leg_executor.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Runs the per leg work of a control tick
+ */
+
+// C++
+#include <cmath>
+
+// Quadruped Control
+#include <quadruped_controller/leg_executor.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "leg_executor";
+
+const char* leg_executor_name(LegExecutorType type)
+{
+  switch (type)
+  {
+    case LegExecutorType::serial:
+      return "serial";
+    case LegExecutorType::parallel:
+      return "parallel";
+    case LegExecutorType::batched:
+      return "batched";
+    default:
+      return "unknown";
+  }
+}
+
+bool leg_executor_from_name(const std::string& name, LegExecutorType& type)
+{
+  for (unsigned int i = 0; i < num_leg_executors; i++)
+  {
+    if (name == leg_executor_name(static_cast<LegExecutorType>(i)))
+    {
+      type = static_cast<LegExecutorType>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+LegExecutor::LegExecutor(const LegExecutorConfig& config,
+                         const std::vector<std::string>& leg_names)
+  : type_(config.type)
+  , leg_names_(leg_names)
+  , joint_states_map_(nullptr)
+  , force_map_(nullptr)
+  , feet_(leg_names.size())
+  , torques_(leg_names.size())
+  , has_force_(leg_names.size(), 0)
+  , fk_fn_([this](std::size_t i) { legForwardKinematics(i); })
+  , jacobian_fn_([this](std::size_t i) { legJacobianTranspose(i); })
+  , trig_valid_(false)
+{
+  if (type_ == LegExecutorType::batched && leg_names_.size() > BATCH_LEGS)
+  {
+    RT_LOG_WARN_NAMED(LOGNAME, "The batched executor supports %zu legs, running serially",
+                      BATCH_LEGS);
+    type_ = LegExecutorType::serial;
+  }
+
+  if (type_ == LegExecutorType::parallel)
+  {
+    pool_ = std::make_unique<realtime::WorkerPool>(config.threads, config.cpus);
+  }
+
+  // Unused lanes stay zero
+  for (auto* batch : { &l1_, &l2_, &l3_, &hx_, &hy_, &hz_, &t1_, &t2_, &t3_, &s1_, &c1_,
+                       &s2_, &c2_, &s23_, &c23_ })
+  {
+    batch->fill(0.0);
+  }
+
+  for (std::size_t i = 0; i < leg_names_.size() && i < BATCH_LEGS; i++)
+  {
+    const vec3& links = kinematics_.legLinks(leg_names_.at(i));
+    const vec3& trans_bh = kinematics_.hipTranslation(leg_names_.at(i));
+    l1_[i] = links(0);
+    l2_[i] = links(1);
+    l3_[i] = links(2);
+    hx_[i] = trans_bh(0);
+    hy_[i] = trans_bh(1);
+    hz_[i] = trans_bh(2);
+  }
+}
+
+void LegExecutor::forEachLeg(const std::function<void(std::size_t)>& work)
+{
+  if (pool_)
+  {
+    pool_->parallelFor(leg_names_.size(), work);
+    return;
+  }
+
+  for (std::size_t i = 0; i < leg_names_.size(); i++)
+  {
+    work(i);
+  }
+}
+
+void LegExecutor::forwardKinematics(const JointStatesMap& joint_states_map,
+                                    FootholdMap& foot_map)
+{
+  if (type_ == LegExecutorType::batched)
+  {
+    batchTrig(joint_states_map);
+
+    // Same terms as QuadrupedKinematics::forwardKinematics()
+    Batch x, y, z;
+    for (std::size_t i = 0; i < BATCH_LEGS; i++)
+    {
+      x[i] = l2_[i] * s2_[i] + l3_[i] * s23_[i] + hx_[i];
+      y[i] = l1_[i] * c1_[i] - l2_[i] * s1_[i] * c2_[i] - l3_[i] * s1_[i] * c23_[i] +
+             hy_[i];
+      z[i] = l1_[i] * s1_[i] + l2_[i] * c1_[i] * c2_[i] + l3_[i] * c1_[i] * c23_[i] +
+             hz_[i];
+    }
+
+    for (std::size_t i = 0; i < leg_names_.size(); i++)
+    {
+      feet_[i] = { x[i], y[i], z[i] };
+    }
+  }
+  else
+  {
+    joint_states_map_ = &joint_states_map;
+    forEachLeg(fk_fn_);
+    joint_states_map_ = nullptr;
+  }
+
+  for (std::size_t i = 0; i < leg_names_.size(); i++)
+  {
+    foot_map[leg_names_[i]] = feet_[i];
+  }
+}
+
+TorqueMap LegExecutor::jacobianTransposeControl(const JointStatesMap& joint_states_map,
+                                                const ForceMap& force_map)
+{
+  if (type_ == LegExecutorType::batched)
+  {
+    batchTrig(joint_states_map);
+
+    Batch fx, fy, fz;
+    for (std::size_t i = 0; i < leg_names_.size(); i++)
+    {
+      const auto force = force_map.find(leg_names_[i]);
+      has_force_[i] = force != force_map.end();
+      fx[i] = has_force_[i] ? force->second(0) : 0.0;
+      fy[i] = has_force_[i] ? force->second(1) : 0.0;
+      fz[i] = has_force_[i] ? force->second(2) : 0.0;
+    }
+    for (std::size_t i = leg_names_.size(); i < BATCH_LEGS; i++)
+    {
+      fx[i] = fy[i] = fz[i] = 0.0;
+    }
+
+    // Same Jacobian terms as QuadrupedKinematics::legJacobian(), tau = J.T*f
+    Batch tau0, tau1, tau2;
+    for (std::size_t i = 0; i < BATCH_LEGS; i++)
+    {
+      const double j01 = l2_[i] * c2_[i] + l3_[i] * c23_[i];
+      const double j02 = l3_[i] * c23_[i];
+      const double j10 = -l1_[i] * s1_[i] - l2_[i] * c1_[i] * c2_[i] -
+                         l3_[i] * c1_[i] * c23_[i];
+      const double j11 = (l2_[i] * s2_[i] + l3_[i] * s23_[i]) * s1_[i];
+      const double j12 = l3_[i] * s1_[i] * s23_[i];
+      const double j20 = l1_[i] * c1_[i] - l2_[i] * s1_[i] * c2_[i] -
+                         l3_[i] * s1_[i] * c23_[i];
+      const double j21 = -(l2_[i] * s2_[i] + l3_[i] * s23_[i]) * c1_[i];
+      const double j22 = -l3_[i] * s23_[i] * c1_[i];
+
+      tau0[i] = j10 * fy[i] + j20 * fz[i];
+      tau1[i] = j01 * fx[i] + j11 * fy[i] + j21 * fz[i];
+      tau2[i] = j02 * fx[i] + j12 * fy[i] + j22 * fz[i];
+    }
+
+    for (std::size_t i = 0; i < leg_names_.size(); i++)
+    {
+      torques_[i] = { tau0[i], tau1[i], tau2[i] };
+    }
+  }
+  else
+  {
+    joint_states_map_ = &joint_states_map;
+    force_map_ = &force_map;
+    forEachLeg(jacobian_fn_);
+    joint_states_map_ = nullptr;
+    force_map_ = nullptr;
+  }
+
+  TorqueMap torque_map;
+  for (std::size_t i = 0; i < leg_names_.size(); i++)
+  {
+    if (has_force_[i])
+    {
+      torque_map.emplace(leg_names_[i], torques_[i]);
+    }
+  }
+
+  return torque_map;
+}
+
+LegExecutorType LegExecutor::type() const
+{
+  return type_;
+}
+
+void LegExecutor::legForwardKinematics(std::size_t leg)
+{
+  const std::string& leg_name = leg_names_[leg];
+  feet_[leg] = kinematics_.forwardKinematics(leg_name, joint_states_map_->at(leg_name).q);
+}
+
+void LegExecutor::legJacobianTranspose(std::size_t leg)
+{
+  const std::string& leg_name = leg_names_[leg];
+  const auto force = force_map_->find(leg_name);
+  has_force_[leg] = force != force_map_->end();
+  if (has_force_[leg])
+  {
+    const mat33 J = kinematics_.legJacobian(leg_name, joint_states_map_->at(leg_name).q);
+    torques_[leg] = J.t() * force->second;
+  }
+}
+
+void LegExecutor::batchTrig(const JointStatesMap& joint_states_map)
+{
+  Batch t1, t2, t3;
+  t1.fill(0.0);
+  t2.fill(0.0);
+  t3.fill(0.0);
+  for (std::size_t i = 0; i < leg_names_.size(); i++)
+  {
+    const vec3& q = joint_states_map.at(leg_names_[i]).q;
+    t1[i] = q(0);
+    t2[i] = q(1);
+    t3[i] = q(2);
+  }
+
+  if (trig_valid_ && t1 == t1_ && t2 == t2_ && t3 == t3_)
+  {
+    return;
+  }
+
+  t1_ = t1;
+  t2_ = t2;
+  t3_ = t3;
+  for (std::size_t i = 0; i < BATCH_LEGS; i++)
+  {
+    s1_[i] = std::sin(t1_[i]);
+    c1_[i] = std::cos(t1_[i]);
+    s2_[i] = std::sin(t2_[i]);
+    c2_[i] = std::cos(t2_[i]);
+    s23_[i] = std::sin(t2_[i] + t3_[i]);
+    c23_[i] = std::cos(t2_[i] + t3_[i]);
+  }
+
+  trig_valid_ = true;
+}
+}  // namespace quadruped_controller
@@ -0,0 +1,322 @@
+/**
+ * @file lqr_balance_controller.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief LQR balance controller for standing and body posing
+ */
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+// Quadruped Control
+#include <quadruped_controller/lqr_balance_controller.hpp>
+#include <quadruped_controller/math/rigid3d.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "lqr_balance_controller";
+
+using arma::eye;
+
+/**
+ * @brief Solve the discrete algebraic Riccati equation
+ * @param A - state transition matrix (nxn)
+ * @param B - control matrix (nxm)
+ * @param Q - positive semi-definite state weight (nxn)
+ * @param R - positive definite control weight (mxm)
+ * @param P[out] - solution P = A.T*P*A - A.T*P*B*(R + B.T*P*B)^-1*B.T*P*A + Q
+ * @return true if the iteration converged
+ * @details Structure-preserving doubling converges quadratically, so a few tens of
+ * iterations are enough even for the long time constants of a 1 kHz control period.
+ */
+static bool solve_dare(const mat& A, const mat& B, const mat& Q, const mat& R, mat& P)
+{
+  const mat I = eye(A.n_rows, A.n_rows);
+
+  mat Ak = A;
+  mat Gk = B * arma::solve(R, B.t());
+  P = Q;
+
+  for (unsigned int i = 0; i < 100; i++)
+  {
+    const mat W = arma::inv(I + Gk * P);
+    const mat A_next = Ak * W * Ak;
+    const mat G_next = Gk + Ak * W * Gk * Ak.t();
+    const mat P_next = P + Ak.t() * P * W * Ak;
+
+    const double change = arma::norm(P_next - P, "fro");
+    Ak = A_next;
+    Gk = G_next;
+    P = 0.5 * (P_next + P_next.t());
+
+    if (!P.is_finite())
+    {
+      return false;
+    }
+
+    if (change <= 1e-10 * arma::norm(P, "fro"))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Project a GRF onto the friction pyramid
+ * @param mu - coefficient of friction
+ * @param fzmin - min normal force (N)
+ * @param fzmax - max normal force (N)
+ * @param f[in,out] - GRF [fx, fy, fz], replaced by the closest force in the pyramid
+ * @details For a fixed fz the closest fx and fy are clamped to [-mu*fz, mu*fz], so the
+ * projection reduces to minimizing a convex piecewise quadratic in fz.
+ */
+static void project_friction_pyramid(double mu, double fzmin, double fzmax, vec3& f)
+{
+  const double ax = std::abs(f(0));
+  const double ay = std::abs(f(1));
+  const double a_low = std::min(ax, ay);
+  const double a_high = std::max(ax, ay);
+
+  // Stationary point of (z - fz)^2 + sum_i max(0, a_i - mu*z)^2
+  double fz = f(2);
+  if (mu * fz < a_high)
+  {
+    // Only the larger tangential force outside the pyramid
+    fz = (f(2) + mu * a_high) / (1.0 + mu * mu);
+    if (mu * fz < a_low)
+    {
+      // Both outside
+      fz = (f(2) + mu * (ax + ay)) / (1.0 + 2.0 * mu * mu);
+    }
+  }
+
+  f(2) = std::clamp(fz, fzmin, fzmax);
+  f(0) = std::clamp(f(0), -mu * f(2), mu * f(2));
+  f(1) = std::clamp(f(1), -mu * f(2), mu * f(2));
+}
+
+/**
+ * @brief Grid cell and interpolation weight of a value
+ * @param value - value to look up
+ * @param min - first grid point
+ * @param max - last grid point
+ * @param samples - number of grid points
+ * @param i[out] - lower grid point of the cell
+ * @param s[out] - weight of the upper grid point [0 1]
+ * @details Values outside the grid use the closest edge.
+ */
+static void grid_cell(double value, double min, double max, unsigned int samples,
+                      unsigned int& i, double& s)
+{
+  if (samples < 2)
+  {
+    i = 0;
+    s = 0.0;
+    return;
+  }
+
+  const double t = std::clamp((value - min) / (max - min), 0.0, 1.0) * (samples - 1);
+  i = std::min(static_cast<unsigned int>(t), samples - 2);
+  s = t - i;
+}
+
+LQRBalanceController::LQRBalanceController(const LQRBalanceConfig& config, double mu,
+                                           double mass, double fzmin, double fzmax,
+                                           const mat& Ib, const FootholdMap& stance_feet,
+                                           const std::vector<std::string>& leg_names)
+  : config_(config)
+  , mu_(mu)
+  , mass_(mass)
+  , fzmin_(fzmin)
+  , fzmax_(fzmax)
+  , Ib_(Ib)
+  , leg_names_(leg_names)
+{
+  config_.height_samples = std::max(config_.height_samples, 1u);
+  config_.angle_samples = std::max(config_.angle_samples, 1u);
+
+  for (const auto& leg_name : leg_names_)
+  {
+    const vec3& foot = stance_feet.at(leg_name);
+    stance_feet_.push_back({ foot(0), foot(1), 0.0 });
+  }
+
+  // Gains for every stance configuration
+  const unsigned int angle_samples = config_.angle_samples;
+  gains_.resize(config_.height_samples * angle_samples * angle_samples);
+  for (unsigned int i = 0; i < config_.height_samples; i++)
+  {
+    for (unsigned int j = 0; j < angle_samples; j++)
+    {
+      for (unsigned int k = 0; k < angle_samples; k++)
+      {
+        gains_.at((i * angle_samples + j) * angle_samples + k) =
+            solveGains(height(i), angle(j), angle(k));
+      }
+    }
+  }
+}
+
+ForceMap LQRBalanceController::control(const RobotStateCoM& com_state,
+                                       const RobotStateCoM& desired_state,
+                                       const FootholdMap& foot_map) const
+{
+  TRACE_SCOPE("lqr", "control");
+
+  // Desired yaw, pitch, and roll (Rwb = Rz*Ry*Rx)
+  const mat33& Rwb_d = desired_state.Rwb;
+  const double yaw = std::atan2(Rwb_d(1, 0), Rwb_d(0, 0));
+  const double pitch = std::asin(std::clamp(-Rwb_d(2, 0), -1.0, 1.0));
+  const double roll = std::atan2(Rwb_d(2, 1), Rwb_d(2, 2));
+
+  // Desired height above the feet
+  double foot_height = 0.0;
+  for (const auto& [leg_name, foot] : foot_map)
+  {
+    foot_height += arma::dot(com_state.Rwb.row(2), foot);
+  }
+  foot_height /= static_cast<double>(foot_map.size());
+  const double height = desired_state.x(2) - (com_state.x(2) + foot_height);
+
+  const mat1212 K = gains(height, roll, pitch);
+
+  // Error state in the heading frame
+  const double c = std::cos(yaw);
+  const double s = std::sin(yaw);
+  const mat33 Rh = { { c, -s, 0.0 }, { s, c, 0.0 }, { 0.0, 0.0, 1.0 } };
+  const mat33 Rhw = Rh.t();
+
+  const vec3 p_error = Rhw * (com_state.x - desired_state.x);
+  const vec3 v_error = Rhw * (com_state.xdot - desired_state.xdot);
+  const vec3 phi_error =
+      Rhw * math::rotation_log(com_state.Rwb * desired_state.Rwb.t());
+  const vec3 w_error = Rhw * (com_state.w - desired_state.w);
+
+  vec12 e;
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    e(i) = p_error(i);
+    e(3 + i) = v_error(i);
+    e(6 + i) = phi_error(i);
+    e(9 + i) = w_error(i);
+  }
+
+  // Gravity compensation plus feedback
+  vec12 f = -1.0 * K * e;
+  const double fz_gravity = 9.81 * mass_ / static_cast<double>(leg_names_.size());
+
+  // Forces the feet apply to the ground in body frame
+  const mat33 Rbh = com_state.Rwb.t() * Rh;
+  ForceMap force_map;
+  for (unsigned int i = 0; i < leg_names_.size(); i++)
+  {
+    vec3 fi = { f(3 * i), f(3 * i + 1), f(3 * i + 2) + fz_gravity };
+    project_friction_pyramid(mu_, fzmin_, fzmax_, fi);
+    force_map.emplace(leg_names_.at(i), -1.0 * Rbh * fi);
+  }
+
+  return force_map;
+}
+
+mat1212 LQRBalanceController::gains(double height, double roll, double pitch) const
+{
+  const unsigned int angle_samples = config_.angle_samples;
+
+  unsigned int i, j, k;
+  double si, sj, sk;
+  grid_cell(height, config_.height_min, config_.height_max, config_.height_samples, i,
+            si);
+  grid_cell(roll, -config_.angle_max, config_.angle_max, angle_samples, j, sj);
+  grid_cell(pitch, -config_.angle_max, config_.angle_max, angle_samples, k, sk);
+
+  // Trilinear interpolation over the corners of the cell
+  mat1212 K(arma::fill::zeros);
+  for (unsigned int corner = 0; corner < 8; corner++)
+  {
+    const unsigned int di = corner & 1;
+    const unsigned int dj = (corner >> 1) & 1;
+    const unsigned int dk = (corner >> 2) & 1;
+
+    const double weight = (di ? si : 1.0 - si) * (dj ? sj : 1.0 - sj) *
+                          (dk ? sk : 1.0 - sk);
+    if (weight == 0.0)
+    {
+      continue;
+    }
+
+    K += weight * gains_.at(((i + di) * angle_samples + j + dj) * angle_samples + k + dk);
+  }
+
+  return K;
+}
+
+mat1212 LQRBalanceController::solveGains(double height, double roll, double pitch) const
+{
+  // Inertia in the heading frame
+  const mat33 Rhb = math::rotation_exp({ 0.0, pitch, 0.0 }) *
+                    math::rotation_exp({ roll, 0.0, 0.0 });
+  const mat33 Ih_inv = arma::inv(Rhb * Ib_ * Rhb.t());
+
+  // Continuous time dynamics of the error state [p, v, phi, w]
+  mat Ac(12, 12, arma::fill::zeros);
+  Ac.submat(0, 3, 2, 5) = eye(3, 3);
+  Ac.submat(6, 9, 8, 11) = eye(3, 3);
+
+  mat Bc(12, 12, arma::fill::zeros);
+  for (unsigned int i = 0; i < stance_feet_.size(); i++)
+  {
+    vec3 r = stance_feet_.at(i);
+    r(2) = -height;
+
+    Bc.submat(3, 3 * i, 5, 3 * i + 2) = eye(3, 3) / mass_;
+    Bc.submat(9, 3 * i, 11, 3 * i + 2) = Ih_inv * math::skew_symmetric(r);
+  }
+
+  // Zero order hold, Ac is nilpotent so exp(Ac*dt) = I + Ac*dt
+  const double dt = config_.dt;
+  const mat A = eye(12, 12) + Ac * dt;
+  const mat B = (eye(12, 12) * dt + Ac * (0.5 * dt * dt)) * Bc;
+
+  const mat Q = arma::diagmat(vec(config_.q));
+  const mat R = eye(12, 12) * config_.r;
+
+  mat P;
+  if (!solve_dare(A, B, Q, R, P))
+  {
+    RT_LOG_WARN_NAMED(LOGNAME,
+                      "Riccati equation did not converge at height %.3f, roll %.3f, "
+                      "pitch %.3f",
+                      height, roll, pitch);
+  }
+
+  const mat K = arma::solve(R + B.t() * P * B, B.t() * P * A);
+  return K;
+}
+
+double LQRBalanceController::height(unsigned int i) const
+{
+  if (config_.height_samples < 2)
+  {
+    return 0.5 * (config_.height_min + config_.height_max);
+  }
+
+  return config_.height_min + (config_.height_max - config_.height_min) * i /
+                                  static_cast<double>(config_.height_samples - 1);
+}
+
+double LQRBalanceController::angle(unsigned int i) const
+{
+  if (config_.angle_samples < 2)
+  {
+    return 0.0;
+  }
+
+  return config_.angle_max * (2.0 * i / static_cast<double>(config_.angle_samples - 1) -
+                              1.0);
+}
+}  // namespace quadruped_controller
@@ -6,6 +6,7 @@
  */
 
 // C++
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -73,6 +74,85 @@ mat skew_symmetric(const vec3& x)
   return skew;
 }
 
+mat33 rotation_exp(const vec3& phi)
+{
+  const double angle = arma::norm(phi);
+
+  // First order for small angles
+  if (angle < 1e-9)
+  {
+    const mat33 R = { { 1.0, -phi(2), phi(1) },
+                      { phi(2), 1.0, -phi(0) },
+                      { -phi(1), phi(0), 1.0 } };
+    return R;
+  }
+
+  // R = cos(angle)*I + sin(angle)*[n] + (1 - cos(angle))*n*n.T
+  const vec3 n = phi / angle;
+  const double c = cos(angle);
+  const double s = sin(angle);
+  const double v = 1.0 - c;
+
+  mat33 R;
+  R(0, 0) = c + v * n(0) * n(0);
+  R(0, 1) = v * n(0) * n(1) - s * n(2);
+  R(0, 2) = v * n(0) * n(2) + s * n(1);
+  R(1, 0) = v * n(0) * n(1) + s * n(2);
+  R(1, 1) = c + v * n(1) * n(1);
+  R(1, 2) = v * n(1) * n(2) - s * n(0);
+  R(2, 0) = v * n(0) * n(2) - s * n(1);
+  R(2, 1) = v * n(1) * n(2) + s * n(0);
+  R(2, 2) = c + v * n(2) * n(2);
+
+  return R;
+}
+
+vec3 rotation_log(const mat33& R)
+{
+  const double cos_angle = std::clamp(0.5 * (arma::trace(R) - 1.0), -1.0, 1.0);
+  const double angle = std::acos(cos_angle);
+
+  // sin(angle)*n from the skew symmetric part
+  const vec3 axis_sin = { 0.5 * (R(2, 1) - R(1, 2)), 0.5 * (R(0, 2) - R(2, 0)),
+                          0.5 * (R(1, 0) - R(0, 1)) };
+
+  if (angle < 1e-9)
+  {
+    return axis_sin;
+  }
+
+  if (cos_angle > -0.99)
+  {
+    return angle / sin(angle) * axis_sin;
+  }
+
+  // Close to PI, n*n.T = (sym(R) - cos(angle)*I) / (1 - cos(angle))
+  unsigned int i = 0;
+  for (unsigned int j = 1; j < 3; j++)
+  {
+    if (R(j, j) > R(i, i))
+    {
+      i = j;
+    }
+  }
+
+  vec3 n;
+  for (unsigned int j = 0; j < 3; j++)
+  {
+    const double sym = 0.5 * (R(j, i) + R(i, j)) - (i == j ? cos_angle : 0.0);
+    n(j) = sym / (1.0 - cos_angle);
+  }
+  n /= arma::norm(n);
+
+  // Sign from the skew symmetric part
+  if (arma::dot(n, axis_sin) < 0.0)
+  {
+    n = -n;
+  }
+
+  return angle * n;
+}
+
 /////////////////////////////////////////////////////////
 // Quaternion
 Quaternion::Quaternion() : q_(1., 0., 0., 0.)
@@ -0,0 +1,800 @@
+/**
+ * @file nonlinear_mpc.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Nonlinear MPC on the single rigid body model solved with iLQR
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Quadruped Control
+#include <quadruped_controller/nonlinear_mpc.hpp>
+#include <quadruped_controller/math/rigid3d.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "nonlinear_mpc";
+
+using math::rotation_exp;
+using math::rotation_log;
+
+/**
+ * @brief Difference of two states in the tangent space
+ * @param x - state
+ * @param y - state
+ * @return x - y as [p, v, phi, w] where exp(phi)*Ry = Rx
+ */
+static vec12 state_difference(const RobotStateCoM& x, const RobotStateCoM& y)
+{
+  const vec3 phi = rotation_log(x.Rwb * y.Rwb.t());
+
+  vec12 dx;
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    dx(i) = x.x(i) - y.x(i);
+    dx(3 + i) = x.xdot(i) - y.xdot(i);
+    dx(6 + i) = phi(i);
+    dx(9 + i) = x.w(i) - y.w(i);
+  }
+
+  return dx;
+}
+
+/**
+ * @brief Move a state along the tangent space
+ * @param x - state
+ * @param dx - step [p, v, phi, w]
+ * @return x + dx
+ */
+static RobotStateCoM state_retract(const RobotStateCoM& x, const vec12& dx)
+{
+  RobotStateCoM y = x;
+
+  vec3 phi;
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    y.x(i) += dx(i);
+    y.xdot(i) += dx(3 + i);
+    phi(i) = dx(6 + i);
+    y.w(i) += dx(9 + i);
+  }
+
+  y.Rwb = rotation_exp(phi) * x.Rwb;
+  return y;
+}
+
+/**
+ * @brief Gradient of a GRF constraint with respect to the GRF of its leg
+ * @param contact - leg in stance
+ * @param j - constraint of the leg [0 6)
+ * @param mu - coefficient of friction
+ * @return gradient [dfx, dfy, dfz]
+ * @details Stance legs have four friction pyramid faces and the normal force
+ * bounds. Swing legs have fx = fy = fz = 0.
+ */
+static vec3 constraint_gradient(bool contact, unsigned int j, double mu)
+{
+  if (!contact)
+  {
+    vec3 g(arma::fill::zeros);
+    if (j < 3)
+    {
+      g(j) = 1.0;
+    }
+
+    return g;
+  }
+
+  switch (j)
+  {
+    case 0:
+      return { 1.0, 0.0, -mu };
+    case 1:
+      return { -1.0, 0.0, -mu };
+    case 2:
+      return { 0.0, 1.0, -mu };
+    case 3:
+      return { 0.0, -1.0, -mu };
+    case 4:
+      return { 0.0, 0.0, -1.0 };
+    default:
+      return { 0.0, 0.0, 1.0 };
+  }
+}
+
+/**
+ * @brief In place Cholesky factorization A = L*L.T
+ * @param A[in,out] - symmetric matrix, the lower triangle is replaced by L
+ * @return false if A is not positive definite
+ */
+static bool cholesky(mat1212& A)
+{
+  for (unsigned int j = 0; j < MPC_CONTROL_SIZE; j++)
+  {
+    double s = A(j, j);
+    for (unsigned int k = 0; k < j; k++)
+    {
+      s -= A(j, k) * A(j, k);
+    }
+
+    if (s <= 0.0 || !std::isfinite(s))
+    {
+      return false;
+    }
+
+    A(j, j) = std::sqrt(s);
+    for (unsigned int i = j + 1; i < MPC_CONTROL_SIZE; i++)
+    {
+      double t = A(i, j);
+      for (unsigned int k = 0; k < j; k++)
+      {
+        t -= A(i, k) * A(j, k);
+      }
+
+      A(i, j) = t / A(j, j);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Solve L*L.T*x = b in place
+ * @param L - Cholesky factor from cholesky()
+ * @param b[in,out] - right hand side (12), replaced by x
+ */
+static void cholesky_solve(const mat1212& L, double* b)
+{
+  // L*y = b
+  for (unsigned int i = 0; i < MPC_CONTROL_SIZE; i++)
+  {
+    for (unsigned int k = 0; k < i; k++)
+    {
+      b[i] -= L(i, k) * b[k];
+    }
+    b[i] /= L(i, i);
+  }
+
+  // L.T*x = y
+  for (int i = MPC_CONTROL_SIZE - 1; i >= 0; i--)
+  {
+    for (unsigned int k = i + 1; k < MPC_CONTROL_SIZE; k++)
+    {
+      b[i] -= L(k, i) * b[k];
+    }
+    b[i] /= L(i, i);
+  }
+}
+
+NonlinearMPC::NonlinearMPC(const NonlinearMPCConfig& config, double mu, double mass,
+                           double fzmin, double fzmax, const mat& Ib, double t_swing,
+                           double t_stance, const std::vector<std::string>& leg_names)
+  : config_(config)
+  , mu_(mu)
+  , mass_(mass)
+  , fzmin_(fzmin)
+  , fzmax_(fzmax)
+  , Ib_(Ib)
+  , Ib_inv_(arma::inv(Ib))
+  , g_({ 0.0, 0.0, -9.81 })
+  , t_swing_(t_swing)
+  , t_stance_(t_stance)
+  , leg_names_(leg_names)
+  , stages_(std::max(config.horizon, 1u) + 1)
+  , x_(stages_.size())
+  , u_(stages_.size() - 1)
+  , lambda_(u_.size())
+  , penalty_(config.penalty)
+  , regularization_(config.regularization)
+  , cost_(0.0)
+  , A_(u_.size())
+  , B_(u_.size())
+  , K_(u_.size())
+  , d_(u_.size())
+  , expected_linear_(0.0)
+  , expected_quadratic_(0.0)
+  , initialized_(false)
+  , shift_time_(0.0)
+  , pool_(config.threads)
+  , linearize_fn_([this](std::size_t k) { linearize(k); })
+  , rollout_fn_([this](std::size_t i) { rollout(i); })
+{
+  config_.horizon = static_cast<unsigned int>(u_.size());
+
+  for (unsigned int i = 0; i < MPC_LINE_SEARCH_STEPS; i++)
+  {
+    alphas_.at(i) = std::pow(0.5, i);
+    x_search_.at(i).resize(x_.size());
+    u_search_.at(i).resize(u_.size());
+    cost_search_.at(i) = 0.0;
+  }
+
+  reset();
+}
+
+ForceMap NonlinearMPC::control(const RobotStateCoM& com_state,
+                               const RobotStateCoM& desired_state,
+                               const FootholdMap& foot_map,
+                               const FootholdMap& foothold_map, const GaitMap& gait_map,
+                               bool gait_running)
+{
+  TRACE_SCOPE("mpc", "solve");
+  const auto start = std::chrono::steady_clock::now();
+
+  penalty_ = config_.penalty;
+  regularization_ = config_.regularization;
+
+  setupStages(com_state, desired_state, foot_map, foothold_map, gait_map, gait_running);
+  warmStart();
+
+  // Roll out the warm start from the measured state. The trunk on two legs is
+  // unstable, so the feedback gains keep the rollout near the warm start.
+  std::vector<RobotStateCoM>& x_start = x_search_.front();
+  std::vector<vec12>& u_start = u_search_.front();
+  x_start.front() = com_state;
+  for (unsigned int k = 0; k < config_.horizon; k++)
+  {
+    u_start.at(k) = u_.at(k) + K_.at(k) * state_difference(x_start.at(k), x_.at(k));
+    x_start.at(k + 1) = step(x_start.at(k), u_start.at(k), stages_.at(k));
+  }
+
+  std::swap(x_, x_start);
+  std::swap(u_, u_start);
+  cost_ = cost(x_, u_);
+
+  status_.iterations = 0;
+  status_.outer_iterations = 0;
+  status_.max_violation = maxViolation();
+
+  for (unsigned int outer = 0; outer < config_.max_outer_iterations; outer++)
+  {
+    for (unsigned int inner = 0; inner < config_.max_iterations; inner++)
+    {
+      const double previous_cost = cost_;
+      if (!iterate())
+      {
+        break;
+      }
+
+      status_.iterations++;
+      if (previous_cost - cost_ < config_.cost_tolerance * std::abs(previous_cost))
+      {
+        break;
+      }
+    }
+
+    status_.max_violation = maxViolation();
+    if (status_.max_violation < config_.constraint_tolerance)
+    {
+      break;
+    }
+
+    updateMultipliers();
+    cost_ = cost(x_, u_);
+    status_.outer_iterations++;
+  }
+
+  status_.cost = cost_;
+  status_.solved =
+      std::isfinite(cost_) && status_.max_violation < config_.constraint_tolerance;
+  status_.solve_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  ForceMap force_map;
+  if (!std::isfinite(cost_))
+  {
+    RT_LOG_ERROR_NAMED(LOGNAME, "Nonlinear MPC diverged");
+    reset();
+    return force_map;
+  }
+
+  if (!status_.solved)
+  {
+    RT_LOG_WARN_NAMED(LOGNAME,
+                      "Nonlinear MPC constraint violation %.2f N after %u iterations",
+                      status_.max_violation, status_.iterations);
+  }
+
+  initialized_ = true;
+
+  // Forces the feet apply to the ground in body frame
+  const mat33 Rbw = com_state.Rwb.t();
+  const vec12& u = u_.front();
+  for (unsigned int i = 0; i < MPC_NUM_LEGS; i++)
+  {
+    if (stages_.front().contact.at(i))
+    {
+      const vec3 fw = { u(3 * i), u(3 * i + 1), u(3 * i + 2) };
+      force_map.emplace(leg_names_.at(i), -1.0 * Rbw * fw);
+    }
+  }
+
+  return force_map;
+}
+
+void NonlinearMPC::reset()
+{
+  initialized_ = false;
+  shift_time_ = 0.0;
+  for (auto& lambda : lambda_)
+  {
+    lambda.zeros();
+  }
+}
+
+const MPCStatus& NonlinearMPC::status() const
+{
+  return status_;
+}
+
+const std::vector<RobotStateCoM>& NonlinearMPC::predictedStates() const
+{
+  return x_;
+}
+
+RobotStateCoM NonlinearMPC::step(const RobotStateCoM& x, const vec12& u,
+                                 const Stage& stage) const
+{
+  // Newton-Euler single rigid body dynamics in world frame
+  vec3 f(arma::fill::zeros);
+  vec3 tau(arma::fill::zeros);
+  for (unsigned int i = 0; i < MPC_NUM_LEGS; i++)
+  {
+    const vec3 fi = { u(3 * i), u(3 * i + 1), u(3 * i + 2) };
+    const vec3 ri = stage.feet.at(i) - x.x;
+    f += fi;
+    tau += arma::cross(ri, fi);
+  }
+
+  const mat33 Iw = x.Rwb * Ib_ * x.Rwb.t();
+  const mat33 Iw_inv = x.Rwb * Ib_inv_ * x.Rwb.t();
+  const vec3 wdot = Iw_inv * (tau - arma::cross(x.w, Iw * x.w));
+
+  // Semi-implicit Euler like StatePredictor
+  RobotStateCoM y;
+  y.xdot = x.xdot + (f / mass_ + g_) * config_.dt;
+  y.x = x.x + y.xdot * config_.dt;
+  y.w = x.w + wdot * config_.dt;
+  y.Rwb = rotation_exp(y.w * config_.dt) * x.Rwb;
+
+  return y;
+}
+
+void NonlinearMPC::setupStages(const RobotStateCoM& com_state,
+                               const RobotStateCoM& desired_state,
+                               const FootholdMap& foot_map,
+                               const FootholdMap& foothold_map, const GaitMap& gait_map,
+                               bool gait_running)
+{
+  // Reference moves with the desired velocities
+  for (unsigned int k = 0; k < stages_.size(); k++)
+  {
+    const double t = k * config_.dt;
+    RobotStateCoM& x_ref = stages_.at(k).x_ref;
+    x_ref.x = desired_state.x + desired_state.xdot * t;
+    x_ref.xdot = desired_state.xdot;
+    x_ref.w = desired_state.w;
+    x_ref.Rwb = rotation_exp(desired_state.w * t) * desired_state.Rwb;
+  }
+
+  // Contact schedule from the gait phases
+  const double period = t_swing_ + t_stance_;
+  const double stance_phase = t_stance_ / period;
+  for (unsigned int i = 0; i < MPC_NUM_LEGS; i++)
+  {
+    const std::string& leg_name = leg_names_.at(i);
+    const auto& [leg_state, phase] = gait_map.at(leg_name);
+    const vec3 foot = com_state.x + com_state.Rwb * foot_map.at(leg_name);
+    const auto foothold = foothold_map.find(leg_name);
+
+    bool lifted = false;
+    for (unsigned int k = 0; k < stages_.size(); k++)
+    {
+      Stage& stage = stages_.at(k);
+
+      bool contact = leg_state == LegState::stance;
+      if (gait_running)
+      {
+        const double stage_phase = std::fmod(phase + k * config_.dt / period, 1.0);
+        contact = stage_phase <= stance_phase + 1e-9;
+      }
+
+      lifted = lifted || !contact;
+      stage.contact.at(i) = contact;
+
+      // Stance feet stay where they are, after a swing the foot lands on its foothold
+      if (!lifted)
+      {
+        stage.feet.at(i) = foot;
+      }
+      else if (foothold != foothold_map.end())
+      {
+        stage.feet.at(i) = foothold->second;
+      }
+      else
+      {
+        stage.feet.at(i) = foot + stage.x_ref.x - stages_.front().x_ref.x;
+      }
+    }
+  }
+
+  // Gravity compensation shared by the stance legs
+  for (auto& stage : stages_)
+  {
+    const auto num_contacts =
+        std::count(stage.contact.begin(), stage.contact.end(), true);
+
+    stage.u_ref.zeros();
+    for (unsigned int i = 0; i < MPC_NUM_LEGS && num_contacts > 0; i++)
+    {
+      if (stage.contact.at(i))
+      {
+        stage.u_ref(3 * i + 2) = -mass_ * g_(2) / num_contacts;
+      }
+    }
+  }
+}
+
+void NonlinearMPC::warmStart()
+{
+  const unsigned int horizon = config_.horizon;
+
+  // Without a previous solution track the reference with the LQR gains about it
+  if (!initialized_)
+  {
+    for (unsigned int k = 0; k <= horizon; k++)
+    {
+      x_.at(k) = stages_.at(k).x_ref;
+    }
+
+    for (unsigned int k = 0; k < horizon; k++)
+    {
+      u_.at(k) = stages_.at(k).u_ref;
+      lambda_.at(k).zeros();
+    }
+
+    pool_.parallelFor(horizon, linearize_fn_);
+    if (!backwardPass())
+    {
+      for (auto& K : K_)
+      {
+        K.zeros();
+      }
+    }
+
+    return;
+  }
+
+  // Drop the stages that have passed
+  shift_time_ += config_.period;
+  const auto shift = std::min(
+      static_cast<unsigned int>(std::floor(shift_time_ / config_.dt + 1e-9)), horizon);
+  shift_time_ -= shift * config_.dt;
+
+  for (unsigned int k = 0; k + shift < horizon; k++)
+  {
+    x_.at(k) = x_.at(k + shift);
+    u_.at(k) = u_.at(k + shift);
+    lambda_.at(k) = lambda_.at(k + shift);
+    K_.at(k) = K_.at(k + shift);
+  }
+
+  for (unsigned int k = horizon - shift; k < horizon; k++)
+  {
+    x_.at(k) = stages_.at(k).x_ref;
+    u_.at(k) = stages_.at(k).u_ref;
+    lambda_.at(k).zeros();
+    K_.at(k).zeros();
+  }
+}
+
+vec24 NonlinearMPC::constraints(const vec12& u, const Stage& stage) const
+{
+  vec24 c(arma::fill::zeros);
+  for (unsigned int i = 0; i < MPC_NUM_LEGS; i++)
+  {
+    const double fx = u(3 * i);
+    const double fy = u(3 * i + 1);
+    const double fz = u(3 * i + 2);
+
+    if (stage.contact.at(i))
+    {
+      // Friction pyramid and normal force bounds
+      c(6 * i) = fx - mu_ * fz;
+      c(6 * i + 1) = -fx - mu_ * fz;
+      c(6 * i + 2) = fy - mu_ * fz;
+      c(6 * i + 3) = -fy - mu_ * fz;
+      c(6 * i + 4) = fzmin_ - fz;
+      c(6 * i + 5) = fz - fzmax_;
+    }
+    else
+    {
+      // No GRFs in swing
+      c(6 * i) = fx;
+      c(6 * i + 1) = fy;
+      c(6 * i + 2) = fz;
+    }
+  }
+
+  return c;
+}
+
+double NonlinearMPC::cost(const std::vector<RobotStateCoM>& x,
+                          const std::vector<vec12>& u) const
+{
+  double total = 0.0;
+  for (unsigned int k = 0; k <= config_.horizon; k++)
+  {
+    const Stage& stage = stages_.at(k);
+    const vec12 dx = state_difference(x.at(k), stage.x_ref);
+    const double scale = k == config_.horizon ? config_.terminal_scale : 1.0;
+    total += 0.5 * scale * arma::dot(config_.q % dx, dx);
+
+    if (k == config_.horizon)
+    {
+      break;
+    }
+
+    const vec12 du = u.at(k) - stage.u_ref;
+    total += 0.5 * config_.r * arma::dot(du, du);
+
+    // Augmented Lagrangian
+    const vec24 c = constraints(u.at(k), stage);
+    const vec24& lambda = lambda_.at(k);
+    for (unsigned int j = 0; j < MPC_CONSTRAINT_SIZE; j++)
+    {
+      const bool equality = !stage.contact.at(j / 6) && j % 6 < 3;
+      const bool active = equality || c(j) > 0.0 || lambda(j) > 0.0;
+      total += lambda(j) * c(j) + (active ? 0.5 * penalty_ * c(j) * c(j) : 0.0);
+    }
+  }
+
+  return total;
+}
+
+void NonlinearMPC::linearize(std::size_t k)
+{
+  const RobotStateCoM& x = x_.at(k);
+  const vec12& u = u_.at(k);
+  const Stage& stage = stages_.at(k);
+  mat1212& A = A_.at(k);
+  mat1212& B = B_.at(k);
+
+  // Central differences, the state is perturbed in the tangent space
+  const double eps_x = 1e-6;
+  const double eps_u = 1e-4;
+  for (unsigned int j = 0; j < MPC_STATE_SIZE; j++)
+  {
+    vec12 dx(arma::fill::zeros);
+    dx(j) = eps_x;
+    const RobotStateCoM y_plus = step(state_retract(x, dx), u, stage);
+    dx(j) = -eps_x;
+    const RobotStateCoM y_minus = step(state_retract(x, dx), u, stage);
+
+    const vec12 dy = state_difference(y_plus, y_minus);
+    for (unsigned int i = 0; i < MPC_STATE_SIZE; i++)
+    {
+      A(i, j) = dy(i) / (2.0 * eps_x);
+    }
+  }
+
+  for (unsigned int j = 0; j < MPC_CONTROL_SIZE; j++)
+  {
+    vec12 u_plus = u;
+    u_plus(j) += eps_u;
+    vec12 u_minus = u;
+    u_minus(j) -= eps_u;
+
+    const vec12 dy = state_difference(step(x, u_plus, stage), step(x, u_minus, stage));
+    for (unsigned int i = 0; i < MPC_STATE_SIZE; i++)
+    {
+      B(i, j) = dy(i) / (2.0 * eps_u);
+    }
+  }
+}
+
+bool NonlinearMPC::backwardPass()
+{
+  TRACE_SCOPE("mpc", "backward_pass");
+  const unsigned int horizon = config_.horizon;
+
+  // Terminal cost
+  const vec12 dx_final = state_difference(x_.at(horizon), stages_.at(horizon).x_ref);
+  vec12 Vx = config_.terminal_scale * (config_.q % dx_final);
+  mat1212 Vxx = arma::diagmat(config_.terminal_scale * config_.q);
+
+  expected_linear_ = 0.0;
+  expected_quadratic_ = 0.0;
+
+  mat1212 VxxA, VxxB;
+  mat1212 Qxx, Quu, Qux, L;
+  vec12 Qx, Qu;
+  for (int k = horizon - 1; k >= 0; k--)
+  {
+    const Stage& stage = stages_.at(k);
+    const mat1212& A = A_.at(k);
+    const mat1212& B = B_.at(k);
+    const vec12& u = u_.at(k);
+
+    // Stage cost, Gauss-Newton on the tracking error
+    const vec12 dx = state_difference(x_.at(k), stage.x_ref);
+    vec12 lu = config_.r * (u - stage.u_ref);
+    mat1212 luu(arma::fill::zeros);
+    for (unsigned int i = 0; i < MPC_CONTROL_SIZE; i++)
+    {
+      luu(i, i) = config_.r + regularization_;
+    }
+
+    // Active constraints
+    const vec24 c = constraints(u, stage);
+    const vec24& lambda = lambda_.at(k);
+    for (unsigned int j = 0; j < MPC_CONSTRAINT_SIZE; j++)
+    {
+      const unsigned int leg = j / 6;
+      const bool contact = stage.contact.at(leg);
+      const bool equality = !contact && j % 6 < 3;
+      if (!equality && c(j) <= 0.0 && lambda(j) <= 0.0)
+      {
+        continue;
+      }
+
+      const vec3 g = constraint_gradient(contact, j % 6, mu_);
+      const double multiplier = lambda(j) + penalty_ * c(j);
+      for (unsigned int a = 0; a < 3; a++)
+      {
+        lu(3 * leg + a) += multiplier * g(a);
+        for (unsigned int b = 0; b < 3; b++)
+        {
+          luu(3 * leg + a, 3 * leg + b) += penalty_ * g(a) * g(b);
+        }
+      }
+    }
+
+    // Q function
+    VxxA = Vxx * A;
+    VxxB = Vxx * B;
+    Qx = config_.q % dx + A.t() * Vx;
+    Qu = lu + B.t() * Vx;
+    Qxx = A.t() * VxxA;
+    for (unsigned int i = 0; i < MPC_STATE_SIZE; i++)
+    {
+      Qxx(i, i) += config_.q(i);
+    }
+    Quu = luu + B.t() * VxxB;
+    Qux = B.t() * VxxA;
+
+    L = Quu;
+    if (!cholesky(L))
+    {
+      return false;
+    }
+
+    // d = -Quu^-1 * Qu, K = -Quu^-1 * Qux
+    vec12& d = d_.at(k);
+    mat1212& K = K_.at(k);
+    d = -Qu;
+    cholesky_solve(L, d.memptr());
+    K = -Qux;
+    for (unsigned int j = 0; j < MPC_STATE_SIZE; j++)
+    {
+      cholesky_solve(L, K.memptr() + j * MPC_CONTROL_SIZE);
+    }
+
+    expected_linear_ += arma::dot(d, Qu);
+    expected_quadratic_ += 0.5 * arma::dot(d, Quu * d);
+
+    // Value function
+    Vx = Qx + K.t() * (Quu * d + Qu) + Qux.t() * d;
+    Vxx = Qxx + K.t() * (Quu * K + Qux) + Qux.t() * K;
+    Vxx = 0.5 * (Vxx + Vxx.t());
+  }
+
+  return true;
+}
+
+void NonlinearMPC::rollout(std::size_t i)
+{
+  const double alpha = alphas_.at(i);
+  std::vector<RobotStateCoM>& x = x_search_.at(i);
+  std::vector<vec12>& u = u_search_.at(i);
+
+  x.front() = x_.front();
+  for (unsigned int k = 0; k < config_.horizon; k++)
+  {
+    const vec12 dx = state_difference(x.at(k), x_.at(k));
+    u.at(k) = u_.at(k) + alpha * d_.at(k) + K_.at(k) * dx;
+    x.at(k + 1) = step(x.at(k), u.at(k), stages_.at(k));
+  }
+
+  cost_search_.at(i) = cost(x, u);
+}
+
+bool NonlinearMPC::iterate()
+{
+  {
+    TRACE_SCOPE("mpc", "linearize");
+    pool_.parallelFor(config_.horizon, linearize_fn_);
+  }
+
+  while (!backwardPass())
+  {
+    regularization_ *= 10.0;
+    if (regularization_ > 1e6)
+    {
+      return false;
+    }
+  }
+
+  TRACE_SCOPE("mpc", "line_search");
+
+  // All step lengths at once with workers, otherwise backtrack
+  if (pool_.size() > 0)
+  {
+    pool_.parallelFor(MPC_LINE_SEARCH_STEPS, rollout_fn_);
+  }
+
+  for (unsigned int i = 0; i < MPC_LINE_SEARCH_STEPS; i++)
+  {
+    if (pool_.size() == 0)
+    {
+      rollout(i);
+    }
+
+    const double alpha = alphas_.at(i);
+    const double expected =
+        -(alpha * expected_linear_ + alpha * alpha * expected_quadratic_);
+    const double actual = cost_ - cost_search_.at(i);
+    if (std::isfinite(cost_search_.at(i)) && actual > 0.0 && actual >= 1e-4 * expected)
+    {
+      std::swap(x_, x_search_.at(i));
+      std::swap(u_, u_search_.at(i));
+      cost_ = cost_search_.at(i);
+      regularization_ = std::max(0.1 * regularization_, config_.regularization);
+      return true;
+    }
+  }
+
+  regularization_ *= 10.0;
+  return false;
+}
+
+void NonlinearMPC::updateMultipliers()
+{
+  for (unsigned int k = 0; k < config_.horizon; k++)
+  {
+    const Stage& stage = stages_.at(k);
+    const vec24 c = constraints(u_.at(k), stage);
+    vec24& lambda = lambda_.at(k);
+    for (unsigned int j = 0; j < MPC_CONSTRAINT_SIZE; j++)
+    {
+      const bool equality = !stage.contact.at(j / 6) && j % 6 < 3;
+      lambda(j) = equality ? lambda(j) + penalty_ * c(j) :
+                             std::max(0.0, lambda(j) + penalty_ * c(j));
+    }
+  }
+
+  penalty_ = std::min(penalty_ * config_.penalty_scale, config_.max_penalty);
+}
+
+double NonlinearMPC::maxViolation() const
+{
+  double violation = 0.0;
+  for (unsigned int k = 0; k < config_.horizon; k++)
+  {
+    const Stage& stage = stages_.at(k);
+    const vec24 c = constraints(u_.at(k), stage);
+    for (unsigned int j = 0; j < MPC_CONSTRAINT_SIZE; j++)
+    {
+      const bool equality = !stage.contact.at(j / 6) && j % 6 < 3;
+      violation = std::max(violation, equality ? std::abs(c(j)) : c(j));
+    }
+  }
+
+  return violation;
+}
+}  // namespace quadruped_controller
@@ -0,0 +1,112 @@
+/**
+ * @file qp_backend.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Interchangeable solvers for the balance QP
+ */
+
+#include <quadruped_controller/admm_qp_backend.hpp>
+#include <quadruped_controller/qp_backend.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+
+namespace quadruped_controller
+{
+const char* qp_backend_name(QpBackendType type)
+{
+  switch (type)
+  {
+    case QpBackendType::qpoases:
+      return "qpoases";
+    case QpBackendType::admm:
+      return "admm";
+    default:
+      return "unknown";
+  }
+}
+
+bool qp_backend_from_name(const std::string& name, QpBackendType& type)
+{
+  for (unsigned int i = 0; i < num_qp_backends; i++)
+  {
+    if (name == qp_backend_name(static_cast<QpBackendType>(i)))
+    {
+      type = static_cast<QpBackendType>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::unique_ptr<QpBackend> make_qp_backend(QpBackendType type, unsigned int num_variables,
+                                           unsigned int num_constraints, double cpu_time,
+                                           int nWSR, const AdmmSettings& admm_settings)
+{
+  if (type == QpBackendType::admm)
+  {
+    return std::make_unique<AdmmQpBackend>(num_variables, num_constraints,
+                                           admm_settings);
+  }
+
+  return std::make_unique<QpOasesBackend>(num_variables, num_constraints, cpu_time,
+                                          nWSR);
+}
+
+QpOasesBackend::QpOasesBackend(unsigned int num_variables, unsigned int num_constraints,
+                               double cpu_time, int nWSR)
+  : solver_(num_variables, num_constraints), cpu_time_(cpu_time), nWSR_(nWSR)
+{
+  // Disable printing
+  solver_.setPrintLevel(qpOASES::PL_NONE);
+}
+
+QPStatus QpOasesBackend::solve(const real_t* Q, const real_t* c, const real_t* C,
+                               const real_t* lbC, const real_t* ubC, real_t* x)
+{
+  // No lower/upper bound constraints on the variables because
+  // the constraint matrix, C, takes care of this.
+  real_t* lb = nullptr;
+  real_t* ub = nullptr;
+
+  // Will update based on actual
+  int nWSR_actual = nWSR_;
+  real_t cpu_time_actual = cpu_time_;
+
+  qpOASES::returnValue ret_val;
+  if (!solver_.isInitialised())
+  {
+    TRACE_SCOPE("qp", "init");
+    ret_val =
+        solver_.init(Q, c, C, lb, ub, lbC, ubC, nWSR_actual, &cpu_time_actual);
+  }
+  else
+  {
+    TRACE_SCOPE("qp", "hotstart");
+    ret_val =
+        solver_.hotstart(Q, c, C, lb, ub, lbC, ubC, nWSR_actual, &cpu_time_actual);
+  }
+
+  QPStatus status;
+  status.return_value = ret_val;
+  status.iterations = nWSR_actual;
+  status.cpu_time = cpu_time_actual;
+  status.solved = ret_val == qpOASES::SUCCESSFUL_RETURN && solver_.isSolved();
+
+  if (status.solved)
+  {
+    solver_.getPrimalSolution(x);
+  }
+
+  return status;
+}
+
+bool QpOasesBackend::isInitialised() const
+{
+  return solver_.isInitialised();
+}
+
+QpBackendType QpOasesBackend::type() const
+{
+  return QpBackendType::qpoases;
+}
+}  // namespace quadruped_controller
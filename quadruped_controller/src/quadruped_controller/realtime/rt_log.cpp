@@ -0,0 +1,363 @@
+/**
+ * @file rt_log.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Logging from the control thread without formatting or I/O
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+
+// ROS
+#include <ros/console.h>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/rt_log.hpp>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+// Time between polls of the producer queues
+static const auto POLL_PERIOD = std::chrono::milliseconds(5);
+
+RTLogSite::RTLogSite(const char* name, RTLogLevel level, const char* format,
+                     const char* file, int line, const char* function, double rate,
+                     double burst)
+  : name(name)
+  , level(level)
+  , format(format)
+  , file(file)
+  , line(line)
+  , function(function)
+  , interval_ns(rate > 0.0 ? static_cast<int64_t>(1.0e9 / rate) : 0)
+  , tolerance_ns(static_cast<int64_t>(std::max(burst - 1.0, 0.0) * interval_ns))
+{
+  for (unsigned int i = 0; i < RT_LOG_MAX_INSTANCES; i++)
+  {
+    tat_ns[i].store(0, std::memory_order_relaxed);
+    suppressed[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+bool RTLogSite::allow(int64_t now_ns, unsigned int instance)
+{
+  if (interval_ns == 0)
+  {
+    return true;
+  }
+
+  const unsigned int i = instance % RT_LOG_MAX_INSTANCES;
+  int64_t tat = tat_ns[i].load(std::memory_order_relaxed);
+  while (true)
+  {
+    if (now_ns < tat - tolerance_ns)
+    {
+      suppressed[i].fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    const int64_t next = std::max(tat, now_ns) + interval_ns;
+    if (tat_ns[i].compare_exchange_weak(tat, next, std::memory_order_relaxed))
+    {
+      return true;
+    }
+  }
+}
+
+uint64_t RTLogSite::takeSuppressed(unsigned int instance)
+{
+  const unsigned int i = instance % RT_LOG_MAX_INSTANCES;
+  return suppressed[i].exchange(0, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////
+
+/**
+ * @brief Format a message from a printf style format and captured arguments
+ * @param format - format string
+ * @param args - captured arguments
+ * @param num_args - number of captured arguments
+ * @return formatted message
+ * @details Each conversion is formatted on its own with the length modifier
+ * replaced to match the captured type, so a "%d" given a uint64_t or a "%f"
+ * given an int is still well defined.
+ */
+static std::string format_message(const char* format, const RTLogArg* args,
+                                  unsigned int num_args)
+{
+  std::string message;
+  unsigned int arg_index = 0;
+  char buffer[128];
+
+  for (const char* c = format; *c != '\0'; c++)
+  {
+    if (*c != '%')
+    {
+      message.push_back(*c);
+      continue;
+    }
+
+    if (*(c + 1) == '%')
+    {
+      message.push_back('%');
+      c++;
+      continue;
+    }
+
+    // Flags, width, and precision
+    std::string spec = "%";
+    const char* p = c + 1;
+    while (*p != '\0' && std::strchr("-+ #0123456789.", *p))
+    {
+      spec.push_back(*p++);
+    }
+
+    // Length modifiers are replaced below
+    while (*p != '\0' && std::strchr("hlLqjzt", *p))
+    {
+      p++;
+    }
+
+    if (*p == '\0')
+    {
+      message.append(c);
+      break;
+    }
+
+    const char conversion = *p;
+    c = p;
+
+    if (arg_index >= num_args)
+    {
+      message.append("<missing>");
+      continue;
+    }
+
+    const RTLogArg& arg = args[arg_index++];
+    const bool float_conversion = std::strchr("fFeEgGaA", conversion) != nullptr;
+    const bool int_conversion = std::strchr("diouxXc", conversion) != nullptr;
+
+    switch (arg.type)
+    {
+      case RTLogArgType::signed_integer:
+        if (float_conversion)
+        {
+          std::snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(),
+                        static_cast<double>(arg.i));
+        }
+        else
+        {
+          std::snprintf(buffer, sizeof(buffer), (spec + "lld").c_str(),
+                        static_cast<long long>(arg.i));
+        }
+        break;
+
+      case RTLogArgType::unsigned_integer:
+        if (float_conversion)
+        {
+          std::snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(),
+                        static_cast<double>(arg.u));
+        }
+        else
+        {
+          const char unsigned_conversion =
+              std::strchr("oxX", conversion) ? conversion : 'u';
+          std::snprintf(buffer, sizeof(buffer),
+                        (spec + "ll" + unsigned_conversion).c_str(),
+                        static_cast<unsigned long long>(arg.u));
+        }
+        break;
+
+      case RTLogArgType::floating_point:
+        std::snprintf(buffer, sizeof(buffer),
+                      (spec + (int_conversion ? 'g' : conversion)).c_str(), arg.d);
+        break;
+
+      case RTLogArgType::string:
+        std::snprintf(buffer, sizeof(buffer), (spec + 's').c_str(), arg.s);
+        break;
+    }
+
+    message.append(buffer);
+  }
+
+  return message;
+}
+
+static ros::console::Level ros_level(RTLogLevel level)
+{
+  switch (level)
+  {
+    case RTLogLevel::debug:
+      return ros::console::levels::Debug;
+    case RTLogLevel::info:
+      return ros::console::levels::Info;
+    case RTLogLevel::warn:
+      return ros::console::levels::Warn;
+    case RTLogLevel::error:
+      return ros::console::levels::Error;
+    default:
+      return ros::console::levels::Fatal;
+  }
+}
+
+// rosconsole logger state per call site, only used by the logger thread
+static std::unordered_map<const RTLogSite*, ros::console::LogLocation> log_locations;
+
+/////////////////////////////////////////////////////////
+
+RTLogger& RTLogger::instance()
+{
+  static RTLogger logger;
+  return logger;
+}
+
+RTLogger::RTLogger() : level_(RTLogLevel::debug), running_(true)
+{
+  worker_ = std::thread(&RTLogger::run, this);
+}
+
+RTLogger::~RTLogger()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+void RTLogger::registerThread()
+{
+  threadQueue();
+}
+
+void RTLogger::setLevel(RTLogLevel level)
+{
+  level_.store(level, std::memory_order_relaxed);
+}
+
+bool RTLogger::enabled(RTLogLevel level) const
+{
+  return level >= level_.load(std::memory_order_relaxed);
+}
+
+void RTLogger::push(const RTLogRecord& record)
+{
+  ThreadQueue& thread_queue = threadQueue();
+  if (!thread_queue.queue.push(record))
+  {
+    thread_queue.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void RTLogger::flush()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  drain();
+}
+
+uint64_t RTLogger::dropped() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  uint64_t total = 0;
+  for (const auto& thread_queue : queues_)
+  {
+    total += thread_queue->dropped.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+int64_t RTLogger::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+RTLogger::ThreadQueue& RTLogger::threadQueue()
+{
+  thread_local ThreadQueue* thread_queue = nullptr;
+  if (!thread_queue)
+  {
+    // Owned by the logger so records are emitted after the thread exits
+    std::lock_guard<std::mutex> lock(mutex_);
+    queues_.emplace_back(new ThreadQueue());
+    thread_queue = queues_.back().get();
+  }
+
+  return *thread_queue;
+}
+
+void RTLogger::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_)
+  {
+    cv_.wait_for(lock, POLL_PERIOD);
+    drain();
+  }
+
+  // Emit everything logged before shutdown
+  drain();
+}
+
+std::size_t RTLogger::drain()
+{
+  std::size_t count = 0;
+  RTLogRecord record;
+
+  for (auto& thread_queue : queues_)
+  {
+    while (thread_queue->queue.pop(record))
+    {
+      emit(record);
+      count++;
+    }
+
+    const uint64_t dropped = thread_queue->dropped.load(std::memory_order_relaxed);
+    if (dropped != thread_queue->reported)
+    {
+      ROS_WARN_NAMED("rt_log", "Real-time log queue full, dropped %llu messages",
+                     static_cast<unsigned long long>(dropped - thread_queue->reported));
+      thread_queue->reported = dropped;
+    }
+  }
+
+  return count;
+}
+
+void RTLogger::emit(const RTLogRecord& record)
+{
+  const RTLogSite& site = *record.site;
+
+  ros::console::LogLocation& location = log_locations[&site];
+  if (!location.initialized_)
+  {
+    ros::console::initializeLogLocation(
+        &location, std::string(ROSCONSOLE_NAME_PREFIX) + "." + site.name,
+        ros_level(site.level));
+  }
+
+  if (!location.logger_enabled_)
+  {
+    return;
+  }
+
+  std::string message = format_message(site.format, record.args, record.num_args);
+  if (record.suppressed > 0)
+  {
+    message += " (" + std::to_string(record.suppressed) + " similar messages suppressed)";
+  }
+
+  ros::console::print(nullptr, location.logger_, location.level_, site.file, site.line,
+                      site.function, "%s", message.c_str());
+}
+}  // namespace realtime
+}  // namespace quadruped_controller
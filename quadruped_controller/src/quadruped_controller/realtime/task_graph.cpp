@@ -0,0 +1,284 @@
+/**
+ * @file task_graph.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Static task graph run by a small work-stealing scheduler
+ */
+
+// C++
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/task_graph.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+static const std::string LOGNAME = "task_graph";
+
+static int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+TaskGraph::TaskGraph(unsigned int num_threads, const std::vector<int>& cpus)
+  : num_threads_(num_threads + 1)
+  , queues_(new WorkQueue[num_threads + 1])
+  , remaining_(0)
+  , generation_(0)
+  , active_(0)
+  , running_(true)
+{
+  workers_.reserve(num_threads);
+  for (unsigned int i = 0; i < num_threads; i++)
+  {
+    const int cpu = cpus.empty() ? -1 : cpus.at(i % cpus.size());
+    workers_.emplace_back(&TaskGraph::runWorker, this, i + 1, cpu);
+  }
+}
+
+TaskGraph::~TaskGraph()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  start_cv_.notify_all();
+
+  for (auto& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+TaskGraph::TaskId TaskGraph::addTask(const char* name, std::function<void()> work,
+                                     bool critical)
+{
+  const auto id = static_cast<TaskId>(tasks_.size());
+  tasks_.push_back({ name, std::move(work), critical, 0, {} });
+  pending_ = std::vector<std::atomic<unsigned int>>(tasks_.size());
+  timeline_.resize(tasks_.size());
+
+  // Room for every task in every queue
+  for (unsigned int i = 0; i < threads(); i++)
+  {
+    queues_[i].tasks[0].resize(tasks_.size());
+    queues_[i].tasks[1].resize(tasks_.size());
+  }
+
+  return id;
+}
+
+void TaskGraph::addDependency(TaskId before, TaskId after)
+{
+  if (before >= tasks_.size() || after >= tasks_.size() || before == after)
+  {
+    throw std::invalid_argument("Invalid task dependency");
+  }
+
+  tasks_[before].successors.push_back(after);
+  tasks_[after].num_predecessors++;
+}
+
+void TaskGraph::run()
+{
+  if (tasks_.empty())
+  {
+    return;
+  }
+
+  {
+    // A worker that woke after the last run finished may still be leaving it
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return active_ == 0; });
+
+    for (unsigned int i = 0; i < threads(); i++)
+    {
+      queues_[i].head[0] = queues_[i].head[1] = 0;
+      queues_[i].tail[0] = queues_[i].tail[1] = 0;
+    }
+
+    for (TaskId id = 0; id < tasks_.size(); id++)
+    {
+      pending_[id].store(tasks_[id].num_predecessors, std::memory_order_relaxed);
+      if (tasks_[id].num_predecessors == 0)
+      {
+        push(0, id);
+      }
+    }
+
+    remaining_.store(static_cast<unsigned int>(tasks_.size()), std::memory_order_release);
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  work(0);
+
+  // Every task is finished, wait for the workers so none is still taking part
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return active_ == 0; });
+}
+
+unsigned int TaskGraph::size() const
+{
+  return static_cast<unsigned int>(tasks_.size());
+}
+
+unsigned int TaskGraph::threads() const
+{
+  return num_threads_;
+}
+
+const char* TaskGraph::name(TaskId id) const
+{
+  return tasks_.at(id).name;
+}
+
+bool TaskGraph::critical(TaskId id) const
+{
+  return tasks_.at(id).critical;
+}
+
+const std::vector<TaskRecord>& TaskGraph::timeline() const
+{
+  return timeline_;
+}
+
+void TaskGraph::runWorker(unsigned int thread, int cpu)
+{
+  // Allocate this thread's queues before the first run
+  RTLogger::instance().registerThread();
+  TRACE_THREAD("task_graph");
+
+  if (cpu >= 0)
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+    {
+      RT_LOG_WARN_NAMED(LOGNAME, "Failed to pin task graph thread to CPU %d", cpu);
+    }
+  }
+
+  uint64_t generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [this, generation] {
+        return !running_ || generation_ != generation;
+      });
+
+      if (!running_)
+      {
+        return;
+      }
+
+      generation = generation_;
+      active_++;
+    }
+
+    work(thread);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      active_--;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+void TaskGraph::work(unsigned int thread)
+{
+  while (remaining_.load(std::memory_order_acquire) > 0)
+  {
+    TaskId id;
+    if (take(thread, id))
+    {
+      execute(thread, id);
+    }
+    else
+    {
+      // Ready tasks appear within a task duration, spinning beats a wake up
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool TaskGraph::take(unsigned int thread, TaskId& id)
+{
+  const unsigned int num_threads = threads();
+  for (int queue = 1; queue >= 0; queue--)
+  {
+    for (unsigned int i = 0; i < num_threads; i++)
+    {
+      // Own queue newest first, the others oldest first
+      const unsigned int victim = (thread + i) % num_threads;
+      WorkQueue& work_queue = queues_[victim];
+      while (work_queue.lock.test_and_set(std::memory_order_acquire))
+      {
+      }
+
+      const bool found = work_queue.head[queue] != work_queue.tail[queue];
+      if (found)
+      {
+        id = i == 0 ? work_queue.tasks[queue][--work_queue.tail[queue]] :
+                      work_queue.tasks[queue][work_queue.head[queue]++];
+      }
+
+      work_queue.lock.clear(std::memory_order_release);
+      if (found)
+      {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void TaskGraph::execute(unsigned int thread, TaskId id)
+{
+  const Task& task = tasks_[id];
+  TaskRecord& record = timeline_[id];
+  record.thread = thread;
+  record.start_ns = now_ns();
+  {
+    TRACE_SCOPE("task_graph", task.name);
+    task.work();
+  }
+  record.end_ns = now_ns();
+
+  for (const TaskId successor : task.successors)
+  {
+    if (pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      push(thread, successor);
+    }
+  }
+
+  remaining_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskGraph::push(unsigned int thread, TaskId id)
+{
+  WorkQueue& work_queue = queues_[thread];
+  const int queue = tasks_[id].critical ? 1 : 0;
+  while (work_queue.lock.test_and_set(std::memory_order_acquire))
+  {
+  }
+
+  work_queue.tasks[queue][work_queue.tail[queue]++] = id;
+  work_queue.lock.clear(std::memory_order_release);
+}
+}  // namespace realtime
+}  // namespace quadruped_controller
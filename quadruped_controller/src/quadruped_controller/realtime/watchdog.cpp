@@ -0,0 +1,183 @@
+/**
+ * @file watchdog.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Deadline monitoring of the control loop
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/watchdog.hpp>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+static const std::string LOGNAME = "watchdog";
+
+void WatchdogStats::reset()
+{
+  ticks = 0;
+  misses = 0;
+  stalls = 0;
+  escalations = 0;
+  recoveries = 0;
+  last_time = 0.0;
+  max_time = 0.0;
+  level_ticks.fill(0);
+}
+
+DeadlineWatchdog::DeadlineWatchdog(double deadline, unsigned int num_levels,
+                                   unsigned int escalate_after,
+                                   unsigned int recover_after, double stall_timeout)
+  : deadline_ns_(static_cast<int64_t>(deadline * 1e9))
+  , stall_timeout_ns_(static_cast<int64_t>(stall_timeout * 1e9))
+  , num_levels_(std::clamp(num_levels, 1u, WATCHDOG_MAX_LEVELS))
+  , escalate_after_(std::max(escalate_after, 1u))
+  , recover_after_(std::max(recover_after, 1u))
+  , level_(0)
+  , consecutive_misses_(0)
+  , consecutive_hits_(0)
+  , tick_start_ns_(0)
+  , stalled_(false)
+  , running_(true)
+{
+  monitor_ = std::thread(&DeadlineWatchdog::run, this);
+}
+
+DeadlineWatchdog::~DeadlineWatchdog()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_one();
+  monitor_.join();
+}
+
+void DeadlineWatchdog::tickStart()
+{
+  tick_start_ns_.store(RTLogger::now(), std::memory_order_release);
+}
+
+bool DeadlineWatchdog::tickEnd()
+{
+  const int64_t start_ns = tick_start_ns_.exchange(0, std::memory_order_acq_rel);
+  if (start_ns == 0)
+  {
+    return false;
+  }
+
+  const int64_t tick_ns = RTLogger::now() - start_ns;
+  const double tick_time = tick_ns * 1e-9;
+
+  stats_.ticks++;
+  stats_.level_ticks.at(level_)++;
+  stats_.last_time = tick_time;
+  stats_.max_time = std::max(stats_.max_time, tick_time);
+
+  // A stall skips the intermediate levels
+  if (stalled_.exchange(false, std::memory_order_acq_rel))
+  {
+    stats_.misses++;
+    stats_.stalls++;
+    consecutive_misses_ = 0;
+    consecutive_hits_ = 0;
+    setLevel(num_levels_ - 1, "stall");
+    return true;
+  }
+
+  if (tick_ns > deadline_ns_)
+  {
+    stats_.misses++;
+    consecutive_hits_ = 0;
+    if (++consecutive_misses_ >= escalate_after_ && level_ + 1 < num_levels_)
+    {
+      RT_LOG_WARN_NAMED(LOGNAME, "Tick took %.3f ms, deadline %.3f ms", 1e3 * tick_time,
+                        1e-6 * deadline_ns_);
+      consecutive_misses_ = 0;
+      setLevel(level_ + 1, "deadline miss");
+    }
+
+    return true;
+  }
+
+  consecutive_misses_ = 0;
+  if (++consecutive_hits_ >= recover_after_ && level_ > 0)
+  {
+    consecutive_hits_ = 0;
+    setLevel(level_ - 1, "recovered");
+  }
+
+  return false;
+}
+
+unsigned int DeadlineWatchdog::level() const
+{
+  return level_;
+}
+
+const WatchdogStats& DeadlineWatchdog::stats() const
+{
+  return stats_;
+}
+
+void DeadlineWatchdog::resetStats()
+{
+  stats_.reset();
+}
+
+void DeadlineWatchdog::setLevel(unsigned int level, const char* reason)
+{
+  if (level == level_)
+  {
+    return;
+  }
+
+  if (level > level_)
+  {
+    stats_.escalations++;
+  }
+  else
+  {
+    stats_.recoveries++;
+  }
+
+  RT_LOG_WARN_NAMED(LOGNAME, "Degradation level %u -> %u (%s)", level_, level, reason);
+  level_ = level;
+}
+
+void DeadlineWatchdog::run()
+{
+  // Poll often enough to report a stall soon after the timeout
+  const auto poll_period = std::chrono::nanoseconds(
+      std::max<int64_t>(stall_timeout_ns_ / 4, 1000000));
+
+  int64_t reported_start_ns = 0;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_)
+  {
+    cv_.wait_for(lock, poll_period);
+
+    const int64_t start_ns = tick_start_ns_.load(std::memory_order_acquire);
+    if (start_ns == 0 || start_ns == reported_start_ns)
+    {
+      continue;
+    }
+
+    const int64_t elapsed_ns = RTLogger::now() - start_ns;
+    if (elapsed_ns > stall_timeout_ns_)
+    {
+      RT_LOG_ERROR_NAMED(LOGNAME, "Control tick stalled for %.1f ms", 1e-6 * elapsed_ns);
+      stalled_.store(true, std::memory_order_release);
+      reported_start_ns = start_ns;
+    }
+  }
+}
+}  // namespace realtime
+}  // namespace quadruped_controller
@@ -0,0 +1,143 @@
+/**
+ * @file worker_pool.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Fixed pool of threads for running independent control work in parallel
+ */
+
+// C++
+#include <pthread.h>
+#include <sched.h>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/realtime/trace.hpp>
+#include <quadruped_controller/realtime/worker_pool.hpp>
+
+namespace quadruped_controller
+{
+namespace realtime
+{
+static const std::string LOGNAME = "worker_pool";
+
+WorkerPool::WorkerPool(unsigned int num_threads, const std::vector<int>& cpus)
+  : work_(nullptr)
+  , num_items_(0)
+  , next_(0)
+  , generation_(0)
+  , active_(0)
+  , running_(true)
+{
+  workers_.reserve(num_threads);
+  for (unsigned int i = 0; i < num_threads; i++)
+  {
+    const int cpu = cpus.empty() ? -1 : cpus.at(i % cpus.size());
+    workers_.emplace_back(&WorkerPool::run, this, cpu);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  start_cv_.notify_all();
+
+  for (auto& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+void WorkerPool::parallelFor(std::size_t n, const std::function<void(std::size_t)>& work)
+{
+  // Nothing to hand out, skip the wake up
+  if (workers_.empty() || n <= 1)
+  {
+    for (std::size_t i = 0; i < n; i++)
+    {
+      work(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    work_ = &work;
+    num_items_ = n;
+    next_.store(0, std::memory_order_relaxed);
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  drain();
+
+  // Every item has been taken. Once the workers that joined the batch leave, all
+  // items are finished and no worker can still be reading the batch.
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return active_ == 0; });
+  work_ = nullptr;
+}
+
+unsigned int WorkerPool::size() const
+{
+  return static_cast<unsigned int>(workers_.size());
+}
+
+void WorkerPool::run(int cpu)
+{
+  // Allocate this thread's queues before the first batch
+  RTLogger::instance().registerThread();
+  TRACE_THREAD("worker");
+
+  if (cpu >= 0)
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+    {
+      RT_LOG_WARN_NAMED(LOGNAME, "Failed to pin worker thread to CPU %d", cpu);
+    }
+  }
+
+  uint64_t generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [this, generation] {
+        return !running_ || (work_ && generation_ != generation);
+      });
+
+      if (!running_)
+      {
+        return;
+      }
+
+      generation = generation_;
+      active_++;
+    }
+
+    drain();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      active_--;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void WorkerPool::drain()
+{
+  std::size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+  while (i < num_items_)
+  {
+    (*work_)(i);
+    i = next_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+}  // namespace realtime
+}  // namespace quadruped_controller
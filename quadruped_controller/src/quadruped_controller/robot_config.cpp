@@ -0,0 +1,179 @@
+/**
+ * @file robot_config.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Robot configuration compiled from the robot config YAML
+ */
+
+// C++
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/robot_config.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "robot_config";
+
+/**
+ * @brief Override a value if the parameter is set
+ * @details A single element list is accepted, e.g. w_diagonal: [1e-5]
+ * @return false if the parameter is set but rejected
+ */
+static bool override_value(const ros::NodeHandle& pnh, const std::string& name,
+                           double& value)
+{
+  std::vector<double> param;
+  if (pnh.getParam(name, param))
+  {
+    if (param.size() != 1)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "%s has %zu values instead of 1, keeping the current one",
+                      name.c_str(), param.size());
+      return false;
+    }
+
+    value = param.front();
+    return true;
+  }
+
+  if (pnh.hasParam(name) && !pnh.getParam(name, value))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "%s is not a number, keeping the current one", name.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Override an array if the parameter is set and has the same size
+ * @return false if the parameter is set but rejected
+ */
+template <std::size_t N>
+static bool override_array(const ros::NodeHandle& pnh, const std::string& name,
+                           std::array<double, N>& value)
+{
+  std::vector<double> param;
+  if (!pnh.getParam(name, param))
+  {
+    if (pnh.hasParam(name))
+    {
+      ROS_ERROR_NAMED(LOGNAME, "%s is not a list of numbers, keeping the current ones",
+                      name.c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+  if (param.size() != N)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "%s has %zu values instead of %zu, keeping the current ones",
+                    name.c_str(), param.size(), N);
+    return false;
+  }
+
+  std::copy(param.begin(), param.end(), value.begin());
+  return true;
+}
+
+RobotConfig load_robot_config(const ros::NodeHandle& pnh, const RobotConfig& config)
+{
+  unsigned int rejected = 0;
+  return load_robot_config(pnh, config, rejected);
+}
+
+RobotConfig load_robot_config(const ros::NodeHandle& pnh, const RobotConfig& config,
+                              unsigned int& rejected)
+{
+  RobotConfig robot_config = config;
+  rejected = 0;
+
+  // The structure is compiled in
+  int num_joints = static_cast<int>(NUM_JOINTS);
+  std::vector<std::string> actuator_names(config.actuator_names.begin(),
+                                          config.actuator_names.end());
+  std::vector<std::string> joint_names(config.joint_names.begin(),
+                                       config.joint_names.end());
+  std::string base_link = config.base_link;
+  const std::vector<std::string> compiled_names = actuator_names;
+  const std::vector<std::string> compiled_joint_names = joint_names;
+  const std::string compiled_link = base_link;
+  pnh.getParam("joints/num_joints", num_joints);
+  pnh.getParam("joints/joint_actuator_names", actuator_names);
+  pnh.getParam("joints/joint_names", joint_names);
+  pnh.getParam("links/base_link", base_link);
+  if (num_joints != static_cast<int>(NUM_JOINTS) || actuator_names != compiled_names ||
+      joint_names != compiled_joint_names || base_link != compiled_link)
+  {
+    ROS_WARN_NAMED(LOGNAME, "The joints and links differ from the compiled robot "
+                            "configuration and are ignored, rebuild with "
+                            "ROBOT_CONFIG_YAML set to change them");
+  }
+
+  // Tuning
+  rejected += !override_value(pnh, "frequency", robot_config.frequency);
+  rejected += !override_value(pnh, "gait/t_stance", robot_config.t_stance);
+  rejected += !override_value(pnh, "gait/t_swing", robot_config.t_swing);
+  rejected += !override_value(pnh, "gait/height", robot_config.height);
+  rejected += !override_array(pnh, "gait/gait_offset_phases", robot_config.phase_offset);
+
+  rejected += !override_array(pnh, "joint_control/kff", robot_config.jc_kff);
+  rejected += !override_array(pnh, "joint_control/kp", robot_config.jc_kp);
+  rejected += !override_array(pnh, "joint_control/kd", robot_config.jc_kd);
+
+  rejected += !override_value(pnh, "balance_control/torque_min", robot_config.tau_min);
+  rejected += !override_value(pnh, "balance_control/torque_max", robot_config.tau_max);
+  rejected += !override_array(pnh, "balance_control/s_diagonal", robot_config.s_diagonal);
+  rejected += !override_value(pnh, "balance_control/w_diagonal", robot_config.w_diagonal);
+  rejected += !override_array(pnh, "balance_control/kff", robot_config.kff);
+  rejected += !override_array(pnh, "balance_control/kp_p", robot_config.kp_p);
+  rejected += !override_array(pnh, "balance_control/kp_w", robot_config.kp_w);
+  rejected += !override_array(pnh, "balance_control/kd_p", robot_config.kd_p);
+  rejected += !override_array(pnh, "balance_control/kd_w", robot_config.kd_w);
+
+  rejected += !override_array(pnh, "dynamics/Ib", robot_config.Ib);
+  rejected += !override_value(pnh, "dynamics/mass", robot_config.mass);
+  rejected += !override_value(pnh, "dynamics/mu", robot_config.mu);
+  rejected += !override_value(pnh, "dynamics/fzmin", robot_config.fzmin);
+  rejected += !override_value(pnh, "dynamics/fzmax", robot_config.fzmax);
+
+  // The limits checked by static_asserts in robot_config_generated.hpp
+  if (!(robot_config.tau_min < robot_config.tau_max))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "balance_control/torque_min must be below torque_max, "
+                             "keeping the current ones");
+    rejected++;
+    robot_config.tau_min = config.tau_min;
+    robot_config.tau_max = config.tau_max;
+  }
+
+  if (!(robot_config.fzmin >= 0.0 && robot_config.fzmin < robot_config.fzmax))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "dynamics/fzmin must be on [0 fzmax), keeping the current "
+                             "fzmin and fzmax");
+    rejected++;
+    robot_config.fzmin = config.fzmin;
+    robot_config.fzmax = config.fzmax;
+  }
+
+  if (!(robot_config.mass > 0.0))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "dynamics/mass must be positive, keeping the current one");
+    rejected++;
+    robot_config.mass = config.mass;
+  }
+
+  if (!(robot_config.mu > 0.0))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "dynamics/mu must be positive, keeping the current one");
+    rejected++;
+    robot_config.mu = config.mu;
+  }
+
+  return robot_config;
+}
+}  // namespace quadruped_controller
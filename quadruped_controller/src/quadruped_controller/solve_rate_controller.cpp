@@ -0,0 +1,269 @@
+/**
+ * @file solve_rate_controller.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Skips balance QP solves when the problem barely changes
+ */
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+// Quadruped Control
+#include <quadruped_controller/math/rigid3d.hpp>
+#include <quadruped_controller/solve_rate_controller.hpp>
+
+namespace quadruped_controller
+{
+static constexpr unsigned int FRICTION_ROWS = 5;  // friction constraints per leg
+static constexpr double ACTIVE_TOLERANCE = 1e-6;  // relative distance to a bound
+static constexpr double PRIMAL_TOLERANCE = 1e-6;  // inequality violation (N)
+static constexpr double DUAL_TOLERANCE = 1e-6;    // multiplier of the wrong sign
+
+SolveRateController::SolveRateController(const SolveRateSettings& settings)
+  : settings_(settings), valid_(false), updates_(0), stance_mask_(0)
+{
+}
+
+bool SolveRateController::update(uint32_t stance_mask, const mat& ft_p, const mat& Rwb,
+                                 const vec& b, const vec& lb, const vec& ub, vec& fw)
+{
+  if (!settings_.enabled || !valid_ || stance_mask != stance_mask_ ||
+      updates_ >= settings_.max_updates)
+  {
+    return false;
+  }
+
+  // The swing feet do not enter the QP
+  for (unsigned int i = 0; i < ft_p.n_cols; i++)
+  {
+    if ((stance_mask & (1u << i)) &&
+        arma::norm(ft_p.col(i) - ft_p_.col(i), "inf") > settings_.foot_tolerance)
+    {
+      return false;
+    }
+  }
+
+  // Angle of Rwb_.T*Rwb from tr(R) = 1 + 2*cos(angle)
+  const double cos_angle =
+      std::max(-1.0, std::min(1.0, 0.5 * (arma::accu(Rwb_ % Rwb) - 1.0)));
+  if (std::acos(cos_angle) > settings_.rotation_tolerance)
+  {
+    return false;
+  }
+
+  const vec db = b - b_;
+  if (arma::norm(db.rows(0, 2)) > settings_.force_tolerance ||
+      arma::norm(db.rows(3, 5)) > settings_.moment_tolerance)
+  {
+    return false;
+  }
+
+  const vec dr = arma::vectorise(Rwb * ft_p - r_);
+  fw = fw_ + dfw_db_ * db + dfw_dr_ * dr;
+
+  // Within the active set of the anchor the update is the optimum if the
+  // inactive constraints hold and the active multipliers keep their sign
+  const vec Cf = C_ * fw;
+  for (unsigned int i = 0; i < rows_.size(); i++)
+  {
+    const unsigned int row = rows_[i];
+    if (Cf(i) < lb(row) - PRIMAL_TOLERANCE || Cf(i) > ub(row) + PRIMAL_TOLERANCE)
+    {
+      return false;
+    }
+  }
+
+  if (!y_.is_empty())
+  {
+    const vec y = y_ + dy_db_ * db + dy_dr_ * dr;
+    unsigned int k = 0;
+    for (unsigned int i = 0; i < active_.size(); i++)
+    {
+      if (active_[i] == 0)
+      {
+        continue;
+      }
+
+      if (active_[i] * y(k) < -DUAL_TOLERANCE)
+      {
+        return false;
+      }
+
+      k++;
+    }
+  }
+
+  updates_++;
+  return true;
+}
+
+void SolveRateController::anchor(uint32_t stance_mask, const mat& ft_p, const mat& Rwb,
+                                 const vec& b, const mat& A, const mat& S, const mat& Q,
+                                 const vec& c, const mat& C, const vec& lb, const vec& ub,
+                                 const vec& fw)
+{
+  valid_ = false;
+  updates_ = 0;
+  if (!settings_.enabled)
+  {
+    return;
+  }
+
+  // Swing leg GRFs are fixed at zero so only the stance legs enter the KKT system
+  std::vector<unsigned int> vars;
+  rows_.clear();
+  active_.clear();
+  for (unsigned int i = 0; i < ft_p.n_cols; i++)
+  {
+    if (stance_mask & (1u << i))
+    {
+      for (unsigned int j = 0; j < 3; j++)
+      {
+        vars.push_back(3 * i + j);
+      }
+
+      for (unsigned int j = 0; j < FRICTION_ROWS; j++)
+      {
+        rows_.push_back(FRICTION_ROWS * i + j);
+      }
+    }
+  }
+
+  if (vars.empty())
+  {
+    return;
+  }
+
+  // Active set of the solution
+  unsigned int num_active = 0;
+  C_.set_size(rows_.size(), C.n_cols);
+  for (unsigned int i = 0; i < rows_.size(); i++)
+  {
+    const unsigned int row = rows_[i];
+    C_.row(i) = C.row(row);
+
+    const double Cf = arma::dot(C_.row(i), fw);
+    int active = 0;
+    if (std::abs(Cf - lb(row)) <= ACTIVE_TOLERANCE * (1.0 + std::abs(lb(row))))
+    {
+      active = -1;
+    }
+    else if (std::abs(Cf - ub(row)) <= ACTIVE_TOLERANCE * (1.0 + std::abs(ub(row))))
+    {
+      active = 1;
+    }
+
+    active_.push_back(active);
+    num_active += active != 0;
+  }
+
+  // Derivative of Q*f + c with respect to the feet, the moment rows of A are
+  // [r_i]x so dA*f = -[f_i]x*dr_i and dA.T*v = [v_m]x*dr_i for leg i
+  const unsigned int num_r = 3 * ft_p.n_cols;
+  const mat ASt = 2.0 * A.t() * S;
+  const vec3 vm = S.rows(3, 5) * (A * fw - b);
+  const mat skew_vm = math::skew_symmetric(vm);
+  mat dg_dr(fw.n_rows, num_r, arma::fill::zeros);
+  for (unsigned int i = 0; i < ft_p.n_cols; i++)
+  {
+    const vec3 f = fw.rows(3 * i, 3 * i + 2);
+    dg_dr.cols(3 * i, 3 * i + 2) = -ASt.cols(3, 5) * math::skew_symmetric(f);
+    dg_dr.submat(3 * i, 3 * i, 3 * i + 2, 3 * i + 2) += 2.0 * skew_vm;
+  }
+
+  // Stationarity Q*f + c + Ca.T*y = 0 and Ca*f = ba. The right hand side holds the
+  // derivatives with respect to b (dc/db = -2*A.T*S), then r, then the anchor itself.
+  const unsigned int n = vars.size();
+  const unsigned int col_r = 6;
+  const unsigned int col_x = col_r + num_r;
+  mat K(n + num_active, n + num_active, arma::fill::zeros);
+  mat rhs(n + num_active, col_x + 1, arma::fill::zeros);
+  for (unsigned int i = 0; i < n; i++)
+  {
+    for (unsigned int j = 0; j < n; j++)
+    {
+      K(i, j) = Q(vars[i], vars[j]);
+    }
+
+    rhs.submat(i, 0, i, 5) = ASt.row(vars[i]);
+    rhs.submat(i, col_r, i, col_x - 1) = -dg_dr.row(vars[i]);
+    rhs(i, col_x) = -c(vars[i]);
+  }
+
+  unsigned int k = n;
+  for (unsigned int i = 0; i < rows_.size(); i++)
+  {
+    if (active_[i] == 0)
+    {
+      continue;
+    }
+
+    for (unsigned int j = 0; j < n; j++)
+    {
+      K(k, j) = C_(i, vars[j]);
+      K(j, k) = C_(i, vars[j]);
+    }
+
+    rhs(k, col_x) = active_[i] < 0 ? lb(rows_[i]) : ub(rows_[i]);
+    k++;
+  }
+
+  mat sol;
+  if (!arma::solve(sol, K, rhs, arma::solve_opts::no_approx))
+  {
+    return;
+  }
+
+  dfw_db_.zeros(fw.n_rows, 6);
+  dfw_dr_.zeros(fw.n_rows, num_r);
+  for (unsigned int i = 0; i < n; i++)
+  {
+    dfw_db_.row(vars[i]) = sol.submat(i, 0, i, 5);
+    dfw_dr_.row(vars[i]) = sol.submat(i, col_r, i, col_x - 1);
+  }
+
+  if (num_active > 0)
+  {
+    const unsigned int last = n + num_active - 1;
+    y_ = sol.submat(n, col_x, last, col_x);
+    dy_db_ = sol.submat(n, 0, last, 5);
+    dy_dr_ = sol.submat(n, col_r, last, col_x - 1);
+
+    // A wrong sign means the active set was not detected correctly
+    k = 0;
+    for (unsigned int i = 0; i < active_.size(); i++)
+    {
+      if (active_[i] != 0 && active_[i] * y_(k++) < -DUAL_TOLERANCE)
+      {
+        return;
+      }
+    }
+  }
+  else
+  {
+    y_.reset();
+    dy_db_.reset();
+    dy_dr_.reset();
+  }
+
+  stance_mask_ = stance_mask;
+  ft_p_ = ft_p;
+  Rwb_ = Rwb;
+  r_ = Rwb * ft_p;
+  b_ = b;
+  fw_ = fw;
+  valid_ = true;
+}
+
+void SolveRateController::reset()
+{
+  valid_ = false;
+  updates_ = 0;
+}
+
+bool SolveRateController::enabled() const
+{
+  return settings_.enabled;
+}
+}  // namespace quadruped_controller
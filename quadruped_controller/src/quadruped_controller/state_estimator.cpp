@@ -0,0 +1,244 @@
+/**
+ * @file state_estimator.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Body state estimation from an IMU and leg kinematics
+ */
+
+// Quadruped Control
+#include <quadruped_controller/state_estimator.hpp>
+
+namespace quadruped_controller
+{
+// Index of the first state of each block
+static const unsigned int POSITION = 0;
+static const unsigned int VELOCITY = 3;
+static const unsigned int FEET = 6;
+
+StateEstimator::StateEstimator(const StateEstimatorConfig& config)
+  : config_(config)
+  , x_(arma::fill::zeros)
+  , P_(arma::fill::zeros)
+  , PHt_(arma::fill::zeros)
+  , g_({ 0.0, 0.0, -9.81 })
+  , x_init_(arma::fill::zeros)
+  , initialized_(false)
+{
+  state_.x.zeros();
+  state_.xdot.zeros();
+  state_.w.zeros();
+  state_.Rwb.eye();
+}
+
+void StateEstimator::reset(const vec3& x)
+{
+  x_init_ = x;
+  initialized_ = false;
+}
+
+const RobotStateCoM& StateEstimator::update(const ImuMeasurement& imu,
+                                            const JointStatesMap& joint_states_map,
+                                            const GaitMap& gait_map)
+{
+  if (!initialized_)
+  {
+    initialize(imu, joint_states_map);
+  }
+
+  // Feet not in stance may be moving or off the ground
+  std::array<double, 4> noise_scale;
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    const auto it = gait_map.find(config_.leg_names[i]);
+    const bool stance = it != gait_map.end() && it->second.first == LegState::stance;
+    noise_scale[i] = stance ? 1.0 : 1.0 + config_.swing_noise_scale;
+  }
+
+  const vec3 accel = imu.Rwb * imu.accel + g_;
+  predict(accel, noise_scale);
+
+  const double r_p = config_.sensor_noise_p_rel * config_.sensor_noise_p_rel;
+  const double r_v = config_.sensor_noise_v_rel * config_.sensor_noise_v_rel;
+  const double r_h = config_.sensor_noise_height * config_.sensor_noise_height;
+
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    const std::string& leg_name = config_.leg_names[i];
+    const LegJointStates& joint_states = joint_states_map.at(leg_name);
+
+    // Foot position and velocity relative to the body in body frame
+    const vec3 p_b = kinematics_.forwardKinematics(leg_name, joint_states.q);
+    const mat33 J = kinematics_.legJacobian(leg_name, joint_states.q);
+    const vec3 v_b = J * joint_states.qdot + arma::cross(imu.omega, p_b);
+
+    // Rotated into world frame
+    const vec3 p_rel = imu.Rwb * p_b;
+    const vec3 v_rel = imu.Rwb * v_b;
+
+    const unsigned int foot = FEET + 3 * i;
+    for (unsigned int j = 0; j < 3; j++)
+    {
+      // p_foot - p = p_rel
+      correct(foot + j, POSITION + j, p_rel(j), r_p);
+
+      // A stationary foot gives v = -v_rel
+      correct(VELOCITY + j, NUM_ESTIMATOR_STATES, -v_rel(j), r_v * noise_scale[i]);
+    }
+
+    // A foot in stance is on the ground
+    correct(foot + 2, NUM_ESTIMATOR_STATES, config_.ground_height, r_h * noise_scale[i]);
+  }
+
+  state_.x = x_.rows(POSITION, POSITION + 2);
+  state_.xdot = x_.rows(VELOCITY, VELOCITY + 2);
+  state_.w = imu.Rwb * imu.omega;
+  state_.Rwb = imu.Rwb;
+
+  return state_;
+}
+
+const RobotStateCoM& StateEstimator::state() const
+{
+  return state_;
+}
+
+vec3 StateEstimator::footPosition(unsigned int leg) const
+{
+  return x_.rows(FEET + 3 * leg, FEET + 3 * leg + 2);
+}
+
+const EstimatorMatrix& StateEstimator::covariance() const
+{
+  return P_;
+}
+
+bool StateEstimator::initialized() const
+{
+  return initialized_;
+}
+
+void StateEstimator::initialize(const ImuMeasurement& imu,
+                                const JointStatesMap& joint_states_map)
+{
+  x_.zeros();
+
+  // Place the feet relative to the body, assumes all feet are on the ground
+  double height = 0.0;
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    const std::string& leg_name = config_.leg_names[i];
+    const vec3& q = joint_states_map.at(leg_name).q;
+    const vec3 p_rel = imu.Rwb * kinematics_.forwardKinematics(leg_name, q);
+
+    x_.rows(FEET + 3 * i, FEET + 3 * i + 2) = p_rel;
+    height += (config_.ground_height - p_rel(2)) / 4.0;
+  }
+
+  const vec3 p = { x_init_(0), x_init_(1), height };
+  x_.rows(POSITION, POSITION + 2) = p;
+  for (unsigned int i = 0; i < 4; i++)
+  {
+    x_.rows(FEET + 3 * i, FEET + 3 * i + 2) += p;
+  }
+
+  P_.eye();
+  P_ *= config_.initial_covariance;
+
+  initialized_ = true;
+}
+
+void StateEstimator::predict(const vec3& accel,
+                             const std::array<double, 4>& foot_noise_scale)
+{
+  const double dt = config_.dt;
+  const unsigned int n = NUM_ESTIMATOR_STATES;
+
+  // x = F*x + B*a, feet are stationary
+  for (unsigned int j = 0; j < 3; j++)
+  {
+    x_(POSITION + j) += dt * x_(VELOCITY + j);
+    x_(VELOCITY + j) += dt * accel(j);
+  }
+
+  // P = F*P*F^T where F = I except for the dt*I velocity block in the position rows.
+  // Rows of F*P then columns of (F*P)*F^T, everything else is unchanged.
+  for (unsigned int c = 0; c < n; c++)
+  {
+    for (unsigned int j = 0; j < 3; j++)
+    {
+      P_.at(POSITION + j, c) += dt * P_.at(VELOCITY + j, c);
+    }
+  }
+
+  for (unsigned int j = 0; j < 3; j++)
+  {
+    for (unsigned int r = 0; r < n; r++)
+    {
+      P_.at(r, POSITION + j) += dt * P_.at(r, VELOCITY + j);
+    }
+  }
+
+  // P += Q, diagonal
+  const double q_p = config_.process_noise_p * config_.process_noise_p * dt;
+  const double q_v = config_.process_noise_v * config_.process_noise_v * dt;
+  const double q_foot = config_.process_noise_foot * config_.process_noise_foot * dt;
+
+  for (unsigned int j = 0; j < 3; j++)
+  {
+    P_.at(POSITION + j, POSITION + j) += q_p;
+    P_.at(VELOCITY + j, VELOCITY + j) += q_v;
+
+    for (unsigned int i = 0; i < 4; i++)
+    {
+      const unsigned int k = FEET + 3 * i + j;
+      P_.at(k, k) += q_foot * foot_noise_scale[i];
+    }
+  }
+}
+
+void StateEstimator::correct(unsigned int i, unsigned int j, double y, double r)
+{
+  const unsigned int n = NUM_ESTIMATOR_STATES;
+
+  // H has a 1 at i and a -1 at j so P*H^T is a difference of two columns
+  double innovation = y - x_(i);
+  if (j < n)
+  {
+    innovation += x_(j);
+    for (unsigned int k = 0; k < n; k++)
+    {
+      PHt_(k) = P_.at(k, i) - P_.at(k, j);
+    }
+  }
+  else
+  {
+    for (unsigned int k = 0; k < n; k++)
+    {
+      PHt_(k) = P_.at(k, i);
+    }
+  }
+
+  // Scalar innovation covariance H*P*H^T + r
+  const double s = (j < n ? PHt_(i) - PHt_(j) : PHt_(i)) + r;
+  if (s <= 0.0)
+  {
+    return;
+  }
+
+  // K = P*H^T / s, x += K*innovation, P -= K*H*P
+  const double gain = innovation / s;
+  for (unsigned int k = 0; k < n; k++)
+  {
+    x_(k) += PHt_(k) * gain;
+  }
+
+  for (unsigned int c = 0; c < n; c++)
+  {
+    const double scale = PHt_(c) / s;
+    for (unsigned int k = 0; k < n; k++)
+    {
+      P_.at(k, c) -= PHt_(k) * scale;
+    }
+  }
+}
+}  // namespace quadruped_controller
@@ -0,0 +1,116 @@
+/**
+ * @file state_predictor.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Forward prediction of the COM state to compensate for latency
+ */
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+// Quadruped Control
+#include <quadruped_controller/state_predictor.hpp>
+#include <quadruped_controller/math/rigid3d.hpp>
+
+namespace quadruped_controller
+{
+using math::rotation_exp;
+
+StatePredictor::StatePredictor(double mass, const mat33& Ib, double max_horizon,
+                               double step)
+  : mass_(mass)
+  , Ib_(Ib)
+  , Ib_inv_(arma::inv(Ib))
+  , g_({ 0.0, 0.0, -9.81 })
+  , max_horizon_(max_horizon)
+  , step_(step)
+{
+}
+
+RobotStateCoM StatePredictor::predict(const RobotStateCoM& com_state,
+                                      const FootholdMap& foot_map,
+                                      const ForceMap& force_map, double latency)
+{
+  const double horizon = std::clamp(latency, 0.0, max_horizon_);
+
+  RobotStateCoM state = com_state;
+
+  // GRFs on the body and the stance feet in world frame
+  vec3 f(arma::fill::zeros);
+  vec3 feet[4];
+  vec3 forces[4];
+  unsigned int num_feet = 0;
+  for (const auto& [leg_name, force] : force_map)
+  {
+    const auto it = foot_map.find(leg_name);
+    if (it == foot_map.end() || num_feet == 4)
+    {
+      continue;
+    }
+
+    feet[num_feet] = com_state.x + com_state.Rwb * it->second;
+    forces[num_feet] = -com_state.Rwb * force;
+    f += forces[num_feet];
+    num_feet++;
+  }
+
+  const vec3 xddot = num_feet > 0 ? vec3(f / mass_ + g_) : vec3(arma::fill::zeros);
+
+  double t = 0.0;
+  while (t < horizon)
+  {
+    const double dt = std::min(step_, horizon - t);
+
+    // Newton-Euler single rigid body dynamics in world frame
+    vec3 tau(arma::fill::zeros);
+    for (unsigned int i = 0; i < num_feet; i++)
+    {
+      tau += arma::cross(feet[i] - state.x, forces[i]);
+    }
+
+    vec3 wdot(arma::fill::zeros);
+    if (num_feet > 0)
+    {
+      const mat33 Iw = state.Rwb * Ib_ * state.Rwb.t();
+      const mat33 Iw_inv = state.Rwb * Ib_inv_ * state.Rwb.t();
+      wdot = Iw_inv * (tau - arma::cross(state.w, Iw * state.w));
+    }
+
+    // Semi-implicit Euler
+    state.xdot += xddot * dt;
+    state.x += state.xdot * dt;
+    state.w += wdot * dt;
+    state.Rwb = rotation_exp(state.w * dt) * state.Rwb;
+
+    t += dt;
+  }
+
+  // Compensation applied
+  const double position_correction = arma::norm(state.x - com_state.x);
+  const double cos_angle = 0.5 * (arma::trace(state.Rwb * com_state.Rwb.t()) - 1.0);
+  const double angle_correction = std::acos(std::clamp(cos_angle, -1.0, 1.0));
+
+  stats_.predictions++;
+  stats_.last_latency = horizon;
+  stats_.total_latency += horizon;
+  stats_.max_latency = std::max(stats_.max_latency, horizon);
+  stats_.last_position_correction = position_correction;
+  stats_.max_position_correction =
+      std::max(stats_.max_position_correction, position_correction);
+  stats_.last_angle_correction = angle_correction;
+  stats_.max_angle_correction = std::max(stats_.max_angle_correction, angle_correction);
+
+  return state;
+}
+
+const LatencyStats& StatePredictor::stats() const
+{
+  return stats_;
+}
+
+void StatePredictor::resetStats()
+{
+  stats_.reset();
+}
+}  // namespace quadruped_controller
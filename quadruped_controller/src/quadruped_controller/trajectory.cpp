@@ -9,12 +9,10 @@
 #include <exception>
 #include <algorithm>
 
-// ROS
-#include <ros/console.h>
-
 // Quadruped Control
 #include <quadruped_controller/trajectory.hpp>
 #include <quadruped_controller/math/numerics.hpp>
+#include <quadruped_controller/realtime/rt_log.hpp>
 
 namespace quadruped_controller
 {
@@ -212,8 +210,11 @@ vec SupportPolygon::position(const ScheduledPhasesMap& phase_map,
 
 /////////////////////////////////////////////////////////
 // FootTrajectory
-FootTrajectory::FootTrajectory()
-  : A_(initSystem()), coefficients_(7, 3, arma::fill::zeros)
+// The system only depends on the boundary times so it is inverted once when the
+// library is loaded rather than factored for every trajectory
+const mat FootTrajectory::A_inv_ = arma::inv(FootTrajectory::initSystem());
+
+FootTrajectory::FootTrajectory() : coefficients_(7, 3, arma::fill::zeros)
 {
 }
 
@@ -221,7 +222,8 @@ bool FootTrajectory::generateTrajetory(const vec3& p_start, const vec3& p_center
                                        const vec3& p_final) const
 {
   const mat B = constantTerms(p_start, p_center, p_final);
-  return arma::solve(coefficients_, A_, B, arma::solve_opts::fast);
+  coefficients_ = A_inv_ * B;
+  return coefficients_.is_finite();
 }
 
 FootState FootTrajectory::trackTrajectory(double t) const
@@ -253,7 +255,7 @@ FootState FootTrajectory::trackTrajectory(double t) const
   return FootState(p_ref, v_ref);
 }
 
-mat FootTrajectory::initSystem() const
+mat FootTrajectory::initSystem()
 {
   // t:[0, 1]
   // position: s(t) = a0 + a1*t + a2*t^2 + a3*t^3 + a4*t^4 + a5*t^5 + a6*t^6
@@ -295,6 +297,11 @@ mat FootTrajectory::constantTerms(const vec3& p_start, const vec3& p_center,
   return B;
 }
 
+const mat& FootTrajectory::coefficients() const
+{
+  return coefficients_;
+}
+
 /////////////////////////////////////////////////////////
 // FootTrajectoryManager
 FootTrajectoryManager::FootTrajectoryManager(double height, double t_swing,
@@ -332,11 +339,11 @@ FootTrajectoryManager::referenceStates(const GaitMap& gait_map,
 
     else
     {
-      ROS_ERROR_NAMED(LOGNAME, "Failed to generate foot trajectory for leg: %s",
-                      leg_name.c_str());
+      RT_LOG_ERROR_NAMED(LOGNAME, "Failed to generate foot trajectory for leg: %s",
+                         leg_name);
     }
 
-    ROS_DEBUG_NAMED(LOGNAME, "Finished planning trajectory for leg: %s", leg_name.c_str());
+    RT_LOG_DEBUG_NAMED(LOGNAME, "Finished planning trajectory for leg: %s", leg_name);
     // Get reference foot states for leg
     const FootState foot_state = referenceState(leg_name, gait_map.at(leg_name).second);
     foot_state_map.emplace(leg_name, foot_state);
@@ -379,11 +386,17 @@ FootState FootTrajectoryManager::referenceState(const std::string& leg_name,
     return traj_map_.at(leg_name).trackTrajectory(t);
   }
 
-  ROS_ERROR_NAMED(LOGNAME,
-                  "Failed to find trajectory for leg: %s. May need to re-plan foot "
-                  "trajectories.",
-                  leg_name.c_str());
+  RT_LOG_ERROR_NAMED(LOGNAME,
+                     "Failed to find trajectory for leg: %s. May need to re-plan foot "
+                     "trajectories.",
+                     leg_name);
 
   return FootState();
 }
+
+const FootTrajectory* FootTrajectoryManager::trajectory(const std::string& leg_name) const
+{
+  const auto search = traj_map_.find(leg_name);
+  return search != traj_map_.end() ? &search->second : nullptr;
+}
 }  // namespace quadruped_controller
@@ -0,0 +1,173 @@
+/**
+ * @file foot_trajectory_visualizer.cpp
+ * @date 2026-10-17
+ * @author agent
+ * @brief Publishes the swing leg trajectories as markers off the control thread
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
+
+// Quadruped Control
+#include <quadruped_controller/realtime/rt_log.hpp>
+#include <quadruped_controller/visualization/foot_trajectory_visualizer.hpp>
+
+namespace quadruped_controller
+{
+static const std::string LOGNAME = "foot_trajectory_visualizer";
+
+FootTrajectoryVisualizer::FootTrajectoryVisualizer(
+    const ros::Publisher& publisher, const std::vector<std::string>& leg_names,
+    const FootTrajectoryVisualizerConfig& config)
+  : publisher_(publisher)
+  , config_(config)
+  , leg_names_(leg_names)
+  , leg_changed_(leg_names.size(), 0)
+  , running_(true)
+{
+  config_.points = std::max(config_.points, 2u);
+
+  // Everything but the points and stamps is fixed
+  markers_.markers.resize(leg_names_.size());
+  for (unsigned int i = 0; i < leg_names_.size(); i++)
+  {
+    visualization_msgs::Marker& marker = markers_.markers[i];
+    marker.header.frame_id = config_.frame_id;
+    marker.ns = leg_names_[i];
+    marker.id = 0;
+    marker.type = visualization_msgs::Marker::SPHERE_LIST;
+    marker.action = visualization_msgs::Marker::ADD;
+    marker.lifetime = ros::Duration(config_.lifetime);
+    marker.pose.orientation.w = 1.0;
+    marker.scale.x = config_.scale;
+    marker.scale.y = config_.scale;
+    marker.scale.z = config_.scale;
+
+    const bool red = leg_names_[i] == "FL" || leg_names_[i] == "RR";
+    marker.color.r = red ? 1.0 : 0.0;
+    marker.color.g = 0.0;
+    marker.color.b = red ? 0.0 : 1.0;
+    marker.color.a = 1.0;
+
+    marker.points.resize(config_.points);
+  }
+
+  changed_.markers.reserve(leg_names_.size());
+  thread_ = std::thread(&FootTrajectoryVisualizer::run, this);
+}
+
+FootTrajectoryVisualizer::~FootTrajectoryVisualizer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  stop_cv_.notify_one();
+  thread_.join();
+}
+
+bool FootTrajectoryVisualizer::update(const FootTrajectoryManager& foot_traj_manager,
+                                      const FootholdMap& footholds)
+{
+  bool queued = true;
+  for (unsigned int i = 0; i < leg_names_.size(); i++)
+  {
+    if (footholds.find(leg_names_[i]) == footholds.end())
+    {
+      continue;
+    }
+
+    const FootTrajectory* trajectory = foot_traj_manager.trajectory(leg_names_[i]);
+    if (!trajectory)
+    {
+      continue;
+    }
+
+    TrajectoryUpdate update;
+    update.leg = i;
+    std::copy_n(trajectory->coefficients().memptr(), update.coefficients.size(),
+                update.coefficients.begin());
+    queued &= queue_.push(update);
+  }
+
+  return queued;
+}
+
+void FootTrajectoryVisualizer::run()
+{
+  // Yield to everything else on the CPU
+  sched_param param{};
+  if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+  {
+    RT_LOG_WARN_NAMED(LOGNAME, "Failed to lower the priority of the publishing thread");
+  }
+
+  const auto period = std::chrono::duration<double>(1.0 / std::max(config_.rate, 1e-3));
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_)
+  {
+    // Rate cap, trajectories queued in between are decimated
+    stop_cv_.wait_for(lock, period, [this] { return !running_; });
+    if (!running_)
+    {
+      break;
+    }
+
+    lock.unlock();
+    publish();
+    lock.lock();
+  }
+}
+
+void FootTrajectoryVisualizer::publish()
+{
+  // Sample the newest trajectory of each leg, s(t) = sum a_k*t^k
+  TrajectoryUpdate update;
+  bool changed = false;
+  while (queue_.pop(update))
+  {
+    auto& points = markers_.markers.at(update.leg).points;
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+      const double t = static_cast<double>(i) / static_cast<double>(points.size() - 1);
+      double p[3] = { 0.0, 0.0, 0.0 };
+      for (int k = 6; k >= 0; k--)
+      {
+        for (unsigned int j = 0; j < 3; j++)
+        {
+          p[j] = p[j] * t + update.coefficients[7 * j + k];
+        }
+      }
+
+      points[i].x = p[0];
+      points[i].y = p[1];
+      points[i].z = p[2];
+    }
+
+    leg_changed_[update.leg] = 1;
+    changed = true;
+  }
+
+  if (!changed)
+  {
+    return;
+  }
+
+  const ros::Time stamp = ros::Time::now();
+  changed_.markers.clear();
+  for (unsigned int i = 0; i < leg_names_.size(); i++)
+  {
+    if (leg_changed_[i])
+    {
+      markers_.markers[i].header.stamp = stamp;
+      changed_.markers.push_back(markers_.markers[i]);
+      leg_changed_[i] = 0;
+    }
+  }
+
+  publisher_.publish(changed_);
+}
+}  // namespace quadruped_controller
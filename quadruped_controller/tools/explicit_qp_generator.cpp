@@ -0,0 +1,163 @@
+/**
+ * @file explicit_qp_generator.cpp
+ * @author agent
+ * @date 2026-10-17
+ * @brief Compute the explicit balance QP solutions for the commander
+ *
+ * @ARGUMENTS:
+ *    --output PATH - table file, loaded with balance_control/explicit_qp_path
+ *    --patterns NAMES - comma separated contact patterns stand|trot|pace|bound
+ *                       (default: stand,trot)
+ *    --samples N - QP solves per stance mask (default: 20000)
+ *    --mu MU - friction coefficient (default: 0.8)
+ *    --fzmin N - min normal reaction force (default: 10)
+ *    --fzmax N - max normal reaction force (default: 120)
+ *    --height M - standing COM height, the nominal feet are below it (default: 0.26)
+ *    --foot-range M - max foot offset from nominal in x and y (default: 0.05)
+ *    --seed N - random number generator seed (default: 0)
+ *
+ * The least squares and GRF weights are the defaults of mit_cheetah_config.yaml,
+ * the commander rejects a table computed for other parameters.
+ */
+
+// C++
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/explicit_balance_qp.hpp>
+#include <quadruped_controller/kinematics.hpp>
+
+using namespace quadruped_controller;
+
+int main(int argc, char** argv)
+{
+  std::string output;
+  std::string pattern_names = "stand,trot";
+  unsigned int samples = 20000;
+  double mu = 0.8;
+  double fzmin = 10.0;
+  double fzmax = 120.0;
+  double height = 0.26;
+  double foot_range = 0.05;
+  unsigned int seed = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--output" && i + 1 < argc)
+    {
+      output = argv[++i];
+    }
+    else if (arg == "--patterns" && i + 1 < argc)
+    {
+      pattern_names = argv[++i];
+    }
+    else if (arg == "--samples" && i + 1 < argc)
+    {
+      samples = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (arg == "--mu" && i + 1 < argc)
+    {
+      mu = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--fzmin" && i + 1 < argc)
+    {
+      fzmin = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--fzmax" && i + 1 < argc)
+    {
+      fzmax = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--height" && i + 1 < argc)
+    {
+      height = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--foot-range" && i + 1 < argc)
+    {
+      foot_range = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--seed" && i + 1 < argc)
+    {
+      seed = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else
+    {
+      output.clear();
+      break;
+    }
+  }
+
+  if (output.empty())
+  {
+    std::fprintf(stderr,
+                 "usage: %s --output PATH [--patterns stand,trot] [--samples N] "
+                 "[--mu MU] [--fzmin N] [--fzmax N] [--height M] [--foot-range M] "
+                 "[--seed N]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  // Weights of mit_cheetah_config.yaml
+  const mat S = arma::diagmat(vec({ 1.0, 1.0, 1.0, 10.0, 10.0, 5.0 }));
+  const mat W = 1e-5 * arma::eye(12, 12);
+
+  // Nominal feet relative to the COM, as in the standing pose of the control pipeline
+  const std::vector<std::string> leg_names = { "RL", "FL", "RR", "FR" };
+  const QuadrupedKinematics kinematics;
+  mat feet(3, EXPLICIT_QP_NUM_LEGS);
+  for (unsigned int i = 0; i < EXPLICIT_QP_NUM_LEGS; i++)
+  {
+    feet.col(i) = kinematics.forwardKinematics(leg_names.at(i), vec3(arma::fill::zeros));
+    feet(2, i) = -height;
+  }
+
+  ExplicitBalanceQP explicit_qp(mu, fzmin, fzmax, S, W);
+
+  std::stringstream ss(pattern_names);
+  std::string name;
+  while (std::getline(ss, name, ','))
+  {
+    const std::vector<uint32_t> masks = contact_pattern_masks(name);
+    if (masks.empty())
+    {
+      std::fprintf(stderr, "Unknown contact pattern %s\n", name.c_str());
+      return 1;
+    }
+
+    for (const auto mask : masks)
+    {
+      if (explicit_qp.hasPattern(mask))
+      {
+        continue;
+      }
+
+      ExplicitQPSampling sampling;
+      sampling.stance_mask = mask;
+      sampling.feet = feet;
+      sampling.foot_range = foot_range;
+      sampling.samples = samples;
+      sampling.seed = seed + mask;
+
+      const ExplicitQPSamplingStats stats = explicit_qp.generate(sampling);
+      const unsigned int regions =
+          explicit_qp.hasPattern(mask) ? explicit_qp.patterns().back().regions.size() : 0;
+
+      std::printf("%s stance mask 0x%X: %u samples, %u regions, %u failed, "
+                  "%u degenerate\n",
+                  name.c_str(), mask, stats.solved, regions, stats.failed,
+                  stats.degenerate);
+    }
+  }
+
+  if (!explicit_qp.save(output))
+  {
+    std::fprintf(stderr, "Failed to write %s\n", output.c_str());
+    return 1;
+  }
+
+  return 0;
+}
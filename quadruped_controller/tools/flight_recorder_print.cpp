@@ -0,0 +1,125 @@
+/**
+ * @file flight_recorder_print.cpp
+ * @author agent
+ * @date 2026-10-17
+ * @brief Print a flight recorder dump as CSV
+ *
+ * @ARGUMENTS:
+ *    dump - flight recorder dump file
+ *
+ * The header is printed to stderr and the records as CSV to stdout.
+ */
+
+// C++
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/io/flight_recorder.hpp>
+
+using namespace quadruped_controller;
+
+/** @brief Print CSV column names for an array field */
+static void print_columns(const char* name, unsigned int n)
+{
+  for (unsigned int i = 0; i < n; i++)
+  {
+    std::printf(",%s_%u", name, i);
+  }
+}
+
+/** @brief Print an array field */
+static void print_values(const double* values, unsigned int n)
+{
+  for (unsigned int i = 0; i < n; i++)
+  {
+    std::printf(",%.9g", values[i]);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 2)
+  {
+    std::fprintf(stderr, "usage: %s DUMP\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file)
+  {
+    std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+    return 1;
+  }
+
+  io::FlightRecorderHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(io::FlightRecorderHeader));
+  if (!file || std::strncmp(header.magic, "QPFLIGHT", 8) != 0 ||
+      header.version != io::FLIGHT_RECORDER_VERSION ||
+      header.record_size != sizeof(io::FlightRecord))
+  {
+    std::fprintf(stderr, "%s is not a version %u flight recorder dump\n", argv[1],
+                 io::FLIGHT_RECORDER_VERSION);
+    return 1;
+  }
+
+  std::vector<io::FlightRecord> records(header.num_records);
+  file.read(reinterpret_cast<char*>(records.data()),
+            header.num_records * sizeof(io::FlightRecord));
+  records.resize(file.gcount() / sizeof(io::FlightRecord));
+
+  std::fprintf(stderr, "reason: %s, trigger tick: %lu, ticks: %zu, frequency: %.1f Hz\n",
+               io::dump_reason_name(static_cast<io::DumpReason>(header.reason)),
+               static_cast<unsigned long>(header.trigger_tick), records.size(),
+               header.frequency);
+
+  std::printf("tick,stamp,tick_time");
+  print_columns("x", 3);
+  print_columns("xdot", 3);
+  print_columns("w", 3);
+  print_columns("Rwb", 9);
+  print_columns("x_d", 3);
+  print_columns("xdot_d", 3);
+  print_columns("w_d", 3);
+  print_columns("Rwb_d", 9);
+  print_columns("q", io::NUM_JOINTS);
+  print_columns("qdot", io::NUM_JOINTS);
+  print_columns("phase", io::NUM_LEGS);
+  print_columns("leg_state", io::NUM_LEGS);
+  print_columns("force", io::NUM_JOINTS);
+  print_columns("torque", io::NUM_JOINTS);
+  std::printf(",qp_return_value,qp_iterations,qp_cpu_time,balance_solver,balance_solved,"
+              "degradation_mode\n");
+
+  for (const auto& record : records)
+  {
+    std::printf("%lu,%.9g,%.9g", static_cast<unsigned long>(record.tick), record.stamp,
+                record.tick_time);
+    print_values(record.x, 3);
+    print_values(record.xdot, 3);
+    print_values(record.w, 3);
+    print_values(record.Rwb, 9);
+    print_values(record.x_d, 3);
+    print_values(record.xdot_d, 3);
+    print_values(record.w_d, 3);
+    print_values(record.Rwb_d, 9);
+    print_values(record.q, io::NUM_JOINTS);
+    print_values(record.qdot, io::NUM_JOINTS);
+    print_values(record.phase, io::NUM_LEGS);
+    for (unsigned int i = 0; i < io::NUM_LEGS; i++)
+    {
+      std::printf(",%u", record.leg_state[i]);
+    }
+    print_values(record.force, io::NUM_JOINTS);
+    print_values(record.torque, io::NUM_JOINTS);
+    std::printf(",%d,%d,%.9g,%s,%u,%u\n", record.qp_return_value, record.qp_iterations,
+                record.qp_cpu_time,
+                balance_solver_name(static_cast<BalanceSolver>(record.balance_solver)),
+                record.balance_solved, record.degradation_mode);
+  }
+
+  return 0;
+}
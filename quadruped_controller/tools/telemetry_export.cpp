@@ -0,0 +1,260 @@
+/**
+ * @file telemetry_export.cpp
+ * @author agent
+ * @date 2026-10-17
+ * @brief Export a telemetry log as CSV or NumPy arrays
+ *
+ * @ARGUMENTS:
+ *    log - telemetry log
+ *    --npy DIR - write one <signal>.npy per signal to DIR instead of CSV to stdout
+ *    signal... - signals to export, all if none are given
+ *
+ * The schema is printed to stderr. A signal of width one is exported as a column
+ * "name" or an array of shape (rows,), wider signals as columns "name_i" or an
+ * array of shape (rows, width).
+ */
+
+// C++
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Quadruped Control
+#include <quadruped_controller/io/telemetry.hpp>
+
+using namespace quadruped_controller;
+
+/** @brief Return the NumPy dtype of a value type */
+static const char* npy_dtype(io::TelemetryType type)
+{
+  switch (type)
+  {
+    case io::TelemetryType::float64:
+      return "<f8";
+    case io::TelemetryType::int32:
+      return "<i4";
+    case io::TelemetryType::uint64:
+      return "<u8";
+    default:
+      return "|u1";
+  }
+}
+
+/**
+ * @brief Write a signal to a version 1.0 .npy file
+ * @param reader - telemetry log
+ * @param signal - signal index
+ * @param path - file path
+ * @return true on success
+ * @details The columns are written straight from the mapping, chunk by chunk.
+ */
+static bool write_npy(const io::TelemetryReader& reader, std::size_t signal,
+                      const std::string& path)
+{
+  const io::TelemetrySignal& info = reader.signals()[signal];
+  const auto size = static_cast<unsigned long>(reader.size());
+
+  char shape[64];
+  if (info.width == 1)
+  {
+    std::snprintf(shape, sizeof(shape), "(%lu,)", size);
+  }
+  else
+  {
+    std::snprintf(shape, sizeof(shape), "(%lu, %u)", size, info.width);
+  }
+
+  // The header ends with a newline and pads the preamble to 64 bytes
+  std::string header = std::string("{'descr': '") +
+                       npy_dtype(static_cast<io::TelemetryType>(info.type)) +
+                       "', 'fortran_order': False, 'shape': " + shape + ", }";
+  header.append(63 - (10 + header.size()) % 64, ' ');
+  header.push_back('\n');
+
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file)
+  {
+    return false;
+  }
+
+  // Magic, version 1.0, and the little endian header length
+  const unsigned char preamble[10] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                                       static_cast<unsigned char>(header.size() & 0xff),
+                                       static_cast<unsigned char>(header.size() >> 8) };
+  bool written = std::fwrite(preamble, 1, sizeof(preamble), file) == sizeof(preamble) &&
+                 std::fwrite(header.data(), 1, header.size(), file) == header.size();
+
+  for (std::size_t chunk = 0; written && chunk < reader.numChunks(); chunk++)
+  {
+    const auto column = reader.columnBytes(chunk, signal);
+    written = (!column.empty() || reader.chunkRows(chunk) == 0) &&
+              std::fwrite(column.data(), 1, column.size(), file) == column.size();
+  }
+
+  return std::fclose(file) == 0 && written;
+}
+
+/** @brief Print a value of a column */
+static void print_value(io::TelemetryType type, const unsigned char* column,
+                        std::size_t i)
+{
+  switch (type)
+  {
+    case io::TelemetryType::float64:
+      std::printf("%.9g", reinterpret_cast<const double*>(column)[i]);
+      break;
+    case io::TelemetryType::int32:
+      std::printf("%" PRId32, reinterpret_cast<const int32_t*>(column)[i]);
+      break;
+    case io::TelemetryType::uint64:
+      std::printf("%" PRIu64, reinterpret_cast<const uint64_t*>(column)[i]);
+      break;
+    default:
+      std::printf("%u", column[i]);
+      break;
+  }
+}
+
+/**
+ * @brief Print signals as CSV
+ * @param reader - telemetry log
+ * @param signals - signal indices
+ * @return true on success
+ */
+static bool print_csv(const io::TelemetryReader& reader,
+                      const std::vector<std::size_t>& signals)
+{
+  const char* separator = "";
+  for (const auto signal : signals)
+  {
+    const io::TelemetrySignal& info = reader.signals()[signal];
+    if (info.width == 1)
+    {
+      std::printf("%s%s", separator, info.name);
+      separator = ",";
+    }
+
+    for (uint32_t i = 0; info.width > 1 && i < info.width; i++)
+    {
+      std::printf("%s%s_%u", separator, info.name, i);
+      separator = ",";
+    }
+  }
+  std::printf("\n");
+
+  std::vector<const unsigned char*> columns(signals.size());
+  for (std::size_t chunk = 0; chunk < reader.numChunks(); chunk++)
+  {
+    for (std::size_t j = 0; j < signals.size(); j++)
+    {
+      columns[j] = reader.columnBytes(chunk, signals[j]).data();
+      if (!columns[j] && reader.chunkRows(chunk) > 0)
+      {
+        return false;
+      }
+    }
+
+    for (uint32_t row = 0; row < reader.chunkRows(chunk); row++)
+    {
+      for (std::size_t j = 0; j < signals.size(); j++)
+      {
+        const io::TelemetrySignal& info = reader.signals()[signals[j]];
+        for (uint32_t i = 0; i < info.width; i++)
+        {
+          if (j > 0 || i > 0)
+          {
+            std::printf(",");
+          }
+          print_value(static_cast<io::TelemetryType>(info.type), columns[j],
+                      row * info.width + i);
+        }
+      }
+      std::printf("\n");
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: %s LOG [--npy DIR] [SIGNAL...]\n", argv[0]);
+    return 1;
+  }
+
+  std::string npy_directory;
+  std::vector<std::string> names;
+  for (int i = 2; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--npy") == 0 && i + 1 < argc)
+    {
+      npy_directory = argv[++i];
+    }
+    else
+    {
+      names.emplace_back(argv[i]);
+    }
+  }
+
+  io::TelemetryReader reader;
+  if (!reader.open(argv[1]))
+  {
+    std::fprintf(stderr, "%s is not a version %u telemetry log\n", argv[1],
+                 io::TELEMETRY_VERSION);
+    return 1;
+  }
+
+  std::fprintf(stderr, "rows: %lu, chunks: %zu, frequency: %.1f Hz\n",
+               static_cast<unsigned long>(reader.size()), reader.numChunks(),
+               reader.header().frequency);
+  for (const auto& signal : reader.signals())
+  {
+    std::fprintf(stderr, "  %s: %s x %u\n", signal.name,
+                 io::telemetry_type_name(static_cast<io::TelemetryType>(signal.type)),
+                 signal.width);
+  }
+
+  std::vector<std::size_t> signals;
+  for (const auto& name : names)
+  {
+    const int signal = reader.find(name);
+    if (signal < 0)
+    {
+      std::fprintf(stderr, "%s has no signal %s\n", argv[1], name.c_str());
+      return 1;
+    }
+    signals.push_back(signal);
+  }
+
+  for (std::size_t i = 0; names.empty() && i < reader.signals().size(); i++)
+  {
+    signals.push_back(i);
+  }
+
+  if (npy_directory.empty())
+  {
+    if (!print_csv(reader, signals))
+    {
+      std::fprintf(stderr, "Failed to read %s\n", argv[1]);
+      return 1;
+    }
+    return 0;
+  }
+
+  for (const auto signal : signals)
+  {
+    const std::string path =
+        npy_directory + "/" + reader.signals()[signal].name + ".npy";
+    if (!write_npy(reader, signal, path))
+    {
+      std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+      return 1;
+    }
+  }
+
+  return 0;
+}
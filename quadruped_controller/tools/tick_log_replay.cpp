@@ -0,0 +1,245 @@
+/**
+ * @file tick_log_replay.cpp
+ * @author agent
+ * @date 2026-10-17
+ * @brief Replay a recorded tick log through the control pipeline
+ *
+ * @details Feeds every recorded tick into a ControlPipeline built from the
+ * parameters stored in the log, as fast as possible, and compares the joint
+ * torques against the recorded torques. Does not require roscore or the
+ * simulator. The log must be recorded from the start of the commander so the
+ * pipeline state (standing, foot trajectories, QP warm start) matches. A log
+ * recorded with an explicit balance QP is replayed with the same table, the file is
+ * checked against the fingerprint stored in the log. Gains updated while recording are
+ * published to the pipeline before the tick that took them up.
+ *
+ * @ARGUMENTS:
+ *    log - tick log recorded by the commander (record_path parameter)
+ *    --tolerance TOL - max absolute torque error (N*m) (default: 1e-9)
+ *    --repeat N - replay the log N times for profiling (default: 1)
+ *    --explicit PATH - explicit balance QP file if it moved since recording
+ *
+ * Returns 0 if all torques match, 1 otherwise.
+ */
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// Quadruped Control
+#include <quadruped_controller/control_pipeline.hpp>
+#include <quadruped_controller/io/tick_log.hpp>
+
+using namespace quadruped_controller;
+
+int main(int argc, char** argv)
+{
+  std::string log_path;
+  double tolerance = 1e-9;
+  unsigned int repeat = 1;
+  std::string explicit_path;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--tolerance" && i + 1 < argc)
+    {
+      tolerance = std::strtod(argv[++i], nullptr);
+    }
+    else if (arg == "--repeat" && i + 1 < argc)
+    {
+      repeat = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (arg == "--explicit" && i + 1 < argc)
+    {
+      explicit_path = argv[++i];
+    }
+    else if (log_path.empty() && arg.rfind("--", 0) != 0)
+    {
+      log_path = arg;
+    }
+    else
+    {
+      log_path.clear();
+      break;
+    }
+  }
+
+  if (log_path.empty() || repeat == 0)
+  {
+    std::fprintf(stderr,
+                 "usage: %s LOG [--tolerance TOL] [--repeat N] [--explicit PATH]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  io::TickLogReader reader;
+  if (!reader.open(log_path))
+  {
+    return 1;
+  }
+
+  const io::TickLogHeader& header = reader.header();
+  ControlPipelineConfig config = io::unpack_config(header.config);
+
+  // Ticks solved explicitly only match with the same table
+  const uint64_t fingerprint = header.config.explicit_qp_fingerprint;
+  if (fingerprint != 0)
+  {
+    if (explicit_path.empty())
+    {
+      explicit_path = header.config.explicit_qp_path;
+    }
+
+    auto explicit_qp = std::make_shared<ExplicitBalanceQP>(
+        config.mu, config.fzmin, config.fzmax, config.S, config.W);
+    if (!explicit_qp->load(explicit_path) || explicit_qp->fingerprint() != fingerprint)
+    {
+      std::fprintf(stderr,
+                   "The log was recorded with the explicit balance QP %s (fingerprint "
+                   "%016lx), pass that file with --explicit PATH\n",
+                   header.config.explicit_qp_path,
+                   static_cast<unsigned long>(fingerprint));
+      return 1;
+    }
+
+    config.explicit_qp = explicit_qp;
+  }
+
+  // Ticks after the last stored gain update ran with gains the log does not have
+  if (header.num_gain_updates > io::TICK_LOG_MAX_GAIN_UPDATES)
+  {
+    std::fprintf(stderr,
+                 "The gains were updated %lu times while recording, the log only holds "
+                 "the first %u updates and can't be replayed\n",
+                 static_cast<unsigned long>(header.num_gain_updates),
+                 io::TICK_LOG_MAX_GAIN_UPDATES);
+    return 1;
+  }
+
+  std::printf("log: %s, ticks: %lu, frequency: %.1f Hz, duration: %.3f s, gain "
+              "updates: %lu\n",
+              log_path.c_str(), static_cast<unsigned long>(reader.size()),
+              header.frequency,
+              reader.size() > 0 ? reader.record(reader.size() - 1).stamp : 0.0,
+              static_cast<unsigned long>(header.num_gain_updates));
+
+  double max_error = 0.0;
+  uint64_t max_error_tick = 0;
+  uint64_t mismatches = 0;
+  uint64_t first_mismatch = reader.size();
+  double elapsed = 0.0;
+  PipelineStats stats;
+
+  for (unsigned int run = 0; run < repeat; run++)
+  {
+    // Fresh pipeline each run so the replay starts from the recorded initial state
+    ControlPipeline pipeline(config);
+    JointStatesMap joint_states_map;
+    uint64_t gain_updates = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < reader.size(); tick++)
+    {
+      const io::TickRecord& record = reader.record(tick);
+
+      if (record.cmd_received)
+      {
+        pipeline.setCommand(io::unpack_cmd(record));
+      }
+
+      pipeline.setDegradationMode(static_cast<DegradationMode>(record.degradation_mode));
+
+      // Taken up at the start of the tick like the commander's update_gains
+      if (record.gain_updates != gain_updates)
+      {
+        gain_updates = record.gain_updates;
+        pipeline.updateGains(io::unpack_gains(reader.gainUpdate(gain_updates - 1)));
+      }
+
+      io::unpack_joint_states(record, joint_states_map);
+      const TorqueMap& torque_map =
+          pipeline.update(io::unpack_com_state(record), joint_states_map,
+                          io::unpack_gait(record), record.gait_running);
+
+      // Only compare the first run, the others are for profiling
+      if (run != 0)
+      {
+        continue;
+      }
+
+      for (unsigned int i = 0; i < io::NUM_LEGS; i++)
+      {
+        // Legs without torques were recorded as zeros
+        const auto torque = torque_map.find(io::tick_log_leg_names().at(i));
+        for (unsigned int j = 0; j < 3; j++)
+        {
+          const double replayed = torque != torque_map.end() ? torque->second(j) : 0.0;
+          const auto error = std::fabs(replayed - record.torque[3 * i + j]);
+          if (error > max_error)
+          {
+            max_error = error;
+            max_error_tick = tick;
+          }
+
+          if (!(error <= tolerance))
+          {
+            mismatches++;
+            first_mismatch = std::min(first_mismatch, tick);
+          }
+        }
+      }
+    }
+
+    elapsed +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const PipelineStats& run_stats = pipeline.stats();
+    stats.ticks += run_stats.ticks;
+    for (unsigned int i = 0; i < num_pipeline_stages; i++)
+    {
+      stats.total_time.at(i) += run_stats.total_time.at(i);
+    }
+  }
+
+  // Report
+  const auto ticks = static_cast<double>(stats.ticks);
+
+  double stage_total = 0.0;
+  for (const auto time : stats.total_time)
+  {
+    stage_total += time;
+  }
+
+  std::printf("replayed: %lu ticks in %.3f s, ticks/sec: %.1f (pipeline only: %.1f)\n",
+              static_cast<unsigned long>(stats.ticks), elapsed, ticks / elapsed,
+              ticks / stage_total);
+
+  std::printf("%-20s %12s %8s\n", "stage", "mean (us)", "share");
+  for (unsigned int i = 0; i < num_pipeline_stages; i++)
+  {
+    std::printf("%-20s %12.3f %7.1f%%\n",
+                pipeline_stage_name(static_cast<PipelineStage>(i)),
+                1.0e6 * stats.total_time.at(i) / ticks,
+                100.0 * stats.total_time.at(i) / stage_total);
+  }
+
+  std::printf("\nmax torque error: %.3e N*m at tick %lu\n", max_error,
+              static_cast<unsigned long>(max_error_tick));
+
+  if (mismatches > 0)
+  {
+    std::printf("FAILED: %lu torques differ by more than %.3e, first at tick %lu\n",
+                static_cast<unsigned long>(mismatches), tolerance,
+                static_cast<unsigned long>(first_mismatch));
+    return 1;
+  }
+
+  std::printf("PASSED: all torques within %.3e\n", tolerance);
+  return 0;
+}
@@ -5,10 +5,14 @@
  * @brief Interface Drake Physics with ROS
  *
  * @PARAMETERS:
+ *    imu/gyro_noise (double) - standard deviation of the gyroscope noise (rad/s)
+ *    imu/accel_noise (double) - standard deviation of the accelerometer noise (m/s^2)
+ *    trace_path (string) - Chrome trace output, only with -DQUADRUPED_TRACE=ON
  *
  * @PUBLISHES:
  *    joint_states (sensor_msgs/JointState) - joint names, positions, and velocities
  *    com_state (quadruped_msgs/CoMState) - COM pose and velocity twist in world frame
+ *    imu (sensor_msgs/Imu) - base_link orientation, angular velocity, and specific force
  * @SUBSCRIBES:
  *    joint_torque_cmd (quadruped_msgs/JointTorqueCmd) - joint torques
  * @SERVICES:
@@ -20,13 +24,16 @@
 // C++
 #include <memory>
 #include <filesystem>
+#include <random>
 
 // ROS
 #include <ros/ros.h>
 #include <std_srvs/Empty.h>
+#include <sensor_msgs/Imu.h>
 #include <sensor_msgs/JointState.h>
 
 // Quadruped Control
+#include <quadruped_controller/realtime/trace.hpp>
 #include <quadruped_msgs/CoMState.h>
 #include <quadruped_msgs/JointTorqueCmd.h>
 
@@ -46,6 +53,7 @@
 
 using drake::math::RigidTransformd;
 using drake::systems::VectorBase;
+using Eigen::Matrix3d;
 using Eigen::Quaterniond;
 using Eigen::Translation3d;
 using Eigen::Vector3d;
@@ -62,6 +70,7 @@ static VectorXd tau;
 
 void jointTorqueCallback(const quadruped_msgs::JointTorqueCmd::ConstPtr& msg)
 {
+  TRACE_INSTANT("sim", "joint_torque_cmd");
   joint_cmd_received = true;
   if (msg->actuator_name.size() != msg->torque.size())
   {
@@ -102,6 +111,7 @@ int main(int argc, char** argv)
 
   ros::Publisher joint_pub = nh.advertise<sensor_msgs::JointState>("joint_states", 1);
   ros::Publisher com_pub = nh.advertise<quadruped_msgs::CoMState>("com_state", 1);
+  ros::Publisher imu_pub = nh.advertise<sensor_msgs::Imu>("imu", 1);
   ros::Subscriber joint_torque_sub =
       nh.subscribe("joint_torque_cmd", 1, jointTorqueCallback);
 
@@ -121,6 +131,10 @@ int main(int argc, char** argv)
   // const auto stiction_tolerance = pnh.param<double>("stiction_tolerance", 0.001);
   const auto real_time_rate = pnh.param<double>("real_time_rate", 1.0);
 
+  // IMU noise
+  const auto gyro_noise = pnh.param<double>("imu/gyro_noise", 0.0);
+  const auto accel_noise = pnh.param<double>("imu/accel_noise", 0.0);
+
   // Robot initial pose
   // See MultibodyPlant SetPositions() to set init joint positions
   std::vector<double> init_position = { 0.0, 0.0, 0.0 };
@@ -271,10 +285,28 @@ int main(int argc, char** argv)
   // simulator.set_publish_every_time_step(true);
   // simulator.AdvanceTo(10.0);
 
+  // IMU acceleration is the difference of the base_link velocity between updates
+  const Vector3d gravity(0.0, 0.0, -9.81);
+  Vector3d prev_velocity = Vector3d::Zero();
+  auto prev_imu_time = 0.0;
+
+  std::mt19937 rng(std::random_device{}());
+  std::normal_distribution<double> normal(0.0, 1.0);
+
+  // Timeline of the simulation loop
+  TRACE_START(pnh.param<std::string>("trace_path", "/tmp/drake_interface.trace.json"),
+              "drake_interface");
+  TRACE_THREAD("simulation");
+
   auto current_time = 0.0;
   while (nh.ok())
   {
-    ros::spinOnce();
+    TRACE_SCOPE("sim", "step");
+
+    {
+      TRACE_SCOPE("sim", "spin");
+      ros::spinOnce();
+    }
 
     // TODO: which context to use? I think this is required to get the current trajectory context.
     const drake::systems::Context<double>& context = simulator.get_context();
@@ -335,6 +367,8 @@ int main(int argc, char** argv)
     ////////////////
     // CoM
     quadruped_msgs::CoMState com_msg;
+    com_msg.header.frame_id = "world";
+    com_msg.header.stamp = ros::Time::now();
     com_msg.pose.orientation.w = state_vector(0);
     com_msg.pose.orientation.x = state_vector(1);
     com_msg.pose.orientation.y = state_vector(2);
@@ -354,6 +388,51 @@ int main(int argc, char** argv)
 
     com_pub.publish(com_msg);
 
+    ////////////////
+    // IMU
+    const Quaterniond quat_wb(state_vector(0), state_vector(1), state_vector(2),
+                              state_vector(3));
+    const Matrix3d Rwb = quat_wb.toRotationMatrix();
+    const Vector3d angular_velocity = state_vector.segment<3>(7 + num_joints);
+    const Vector3d linear_velocity = state_vector.segment<3>(10 + num_joints);
+
+    Vector3d linear_acceleration = Vector3d::Zero();
+    const auto imu_time = context.get_time();
+    if (imu_time > prev_imu_time)
+    {
+      linear_acceleration =
+          (linear_velocity - prev_velocity) / (imu_time - prev_imu_time);
+    }
+    prev_velocity = linear_velocity;
+    prev_imu_time = imu_time;
+
+    // Measured in body frame, an accelerometer measures the specific force
+    const Vector3d gyro = Rwb.transpose() * angular_velocity +
+                          gyro_noise * Vector3d(normal(rng), normal(rng), normal(rng));
+    const Vector3d accel = Rwb.transpose() * (linear_acceleration - gravity) +
+                           accel_noise * Vector3d(normal(rng), normal(rng), normal(rng));
+
+    sensor_msgs::Imu imu_msg;
+    imu_msg.header.frame_id = base_link_name;
+    imu_msg.header.stamp = ros::Time::now();
+    imu_msg.orientation = com_msg.pose.orientation;
+
+    imu_msg.angular_velocity.x = gyro(0);
+    imu_msg.angular_velocity.y = gyro(1);
+    imu_msg.angular_velocity.z = gyro(2);
+
+    imu_msg.linear_acceleration.x = accel(0);
+    imu_msg.linear_acceleration.y = accel(1);
+    imu_msg.linear_acceleration.z = accel(2);
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+      imu_msg.angular_velocity_covariance.at(4 * i) = gyro_noise * gyro_noise;
+      imu_msg.linear_acceleration_covariance.at(4 * i) = accel_noise * accel_noise;
+    }
+
+    imu_pub.publish(imu_msg);
+
     // const drake::multibody::Joint<double>& RL_hip_joint =
     // plant.GetJointByName("RL_hip_joint"); const drake::multibody::Joint<double>&
     // FL_hip_joint = plant.GetJointByName("FL_hip_joint"); const
@@ -376,10 +455,14 @@ int main(int argc, char** argv)
     // discrete_values.num_groups(), discrete_values.size()); ROS_INFO_NAMED(LOGNAME,
     // "Real time rate: %s", output_port.GetFullDescription().c_str()); ROS_INFO_NAMED(LOGNAME,
     // "Real time rate: %f", simulator.get_actual_realtime_rate());
-    simulator.AdvanceTo(current_time);
+    {
+      TRACE_SCOPE("sim", "advance");
+      simulator.AdvanceTo(current_time);
+    }
     current_time += viz_time_step;
   }
 
+  TRACE_STOP();
   ros::shutdown();
   return 0;
 }